@@ -0,0 +1,58 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_ABSTRACT_CHECKSUM_H
+#define DEEPSOLVER_ABSTRACT_CHECKSUM_H
+
+namespace Deepsolver
+{
+  /**\brief The abstract interface for checksum calculation
+   *
+   * The data is given in any number of update() calls between init() and
+   * commit(). The result is returned in lower case hexadecimal form as it
+   * is saved in checksum files. The same object may be used for the next
+   * calculation after new init() call.
+   *
+   * \sa Md5 Sha256 Xxh64 Md5File
+   */
+  class AbstractChecksum
+  {
+  public:
+    typedef std::shared_ptr<AbstractChecksum> Ptr;
+
+  public:
+    enum {
+      TypeMd5 = 0,
+      TypeSha256 = 1,
+      TypeXxh64 = 2//Not cryptographic, only for detection of accidental damage;
+    };
+
+  public:
+    /**\brief The default constructor*/
+    AbstractChecksum() {}
+
+    /**\brief The destructor*/
+    virtual ~AbstractChecksum() {}
+
+  public:
+    virtual void init() = 0;
+    virtual void update(const void* buf, size_t len) = 0;
+    virtual std::string commit() = 0;
+  }; //class AbstractChecksum;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_ABSTRACT_CHECKSUM_H;
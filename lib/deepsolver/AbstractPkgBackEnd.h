@@ -77,6 +77,18 @@ namespace Deepsolver
 	EpochAlways
       };
 
+    //The fields of package file header to read, see readPkgFile();
+    enum {
+      PkgFieldMainData = 1,
+      PkgFieldProvides = 2,
+      PkgFieldRequires = 4,
+      PkgFieldConflicts = 8,
+      PkgFieldObsoletes = 16,
+      PkgFieldChangeLog = 32,
+      PkgFieldFileList = 64,
+      PkgFieldAll = 127
+    };
+
   public:
     typedef std::shared_ptr<AbstractPkgBackEnd> Ptr;
 
@@ -121,6 +133,29 @@ namespace Deepsolver
      */
     virtual bool verOverlap(const VerSubset& ver1, const VerSubset& ver2) const = 0;
 
+    /**\brief Overlaps two version ranges given by plain strings
+     *
+     * This method does the same as verOverlap() but takes the version
+     * values without constructing VerSubset objects, so back-ends able to
+     * compare C strings directly may do it without memory allocation. The
+     * default implementation just calls verOverlap().
+     *
+     * \param [in] ver1 The version of the first range
+     * \param [in] dir1 The direction of the first range
+     * \param [in] ver2 The version of the second range
+     * \param [in] dir2 The direction of the second range
+     *
+     * \return Non-zero if intersection is not empty and zero otherwise
+     */
+    virtual bool verRangesOverlap(const char* ver1,
+				  VerDirection dir1,
+				  const char* ver2,
+				  VerDirection dir2) const
+    {
+      assert(ver1 != NULL && ver2 != NULL);
+      return verOverlap(VerSubset(ver1, dir1), VerSubset(ver2, dir2));
+    }
+
     /**\brief Checks the equality of two version values
      *
      * \param [in] ver1 The first string to compare
@@ -145,11 +180,36 @@ namespace Deepsolver
     virtual AbstractInstalledPkgIterator::Ptr enumInstalledPkg() const = 0;
 
     /**\brief Reads header information from package file on disk
+     *
+     * Only the fields mentioned in the mask are extracted, the rest of
+     * pkgFile is left untouched. Skipping large fields like the change
+     * log or the file list saves noticeable time on big repositories.
+     *
+     * The digest requested with the last argument is the same as the one
+     * of getPkgFileDigest(), but it is taken while the file is already
+     * opened for the header reading.
      *
      * \param [in] fileName The name of the file to read data from
      * \param [out] pkgFile The object to save retrieved data to
+     * \param [in] fields The combination of PkgField* values to read
+     * \param [out] digest The place to save the package file digest to, may be NULL
+     */
+    virtual void readPkgFile(const std::string& fileName,
+			     PkgFile& pkgFile,
+			     int fields = PkgFieldAll,
+			     std::string* digest = NULL) const = 0;
+
+    /**\brief Calculates the digest identifying the package file content
+     *
+     * The digest is used to find changed packages without reading their
+     * headers completely. Back-ends may take only the part of the file
+     * describing the whole content, like the signature and the header.
+     *
+     * \param [in] fileName The name of the package file
+     *
+     * \return The digest in hexadecimal form
      */
-    virtual void readPkgFile(const std::string& fileName, PkgFile& pkgFile) const = 0;
+    virtual std::string getPkgFileDigest(const std::string& fileName) const = 0;
 
     /**\brief Checks if provided file name is a proper package name
      *
@@ -20,6 +20,11 @@
 
 namespace Deepsolver 
 {
+  namespace PkgSnapshot
+  {
+    struct Component;
+  }
+
   /**\brief The interface for handling sequences of package records
    *
    * This abstract class declares unified interface for any object purposed
@@ -45,6 +50,20 @@ namespace Deepsolver
      * \param [in] pkgFile The newly available package file entry
      */
     virtual void onNewPkgFile(const PkgFile& pkgFile) = 0;
+
+    /**\brief Accepts packages of the whole repository component at once
+     *
+     * The recipients working with package snapshots take the prepared
+     * component without converting it back to package file entries.
+     *
+     * \param [in] component The packages of the component
+     *
+     * \return Non-zero if the component is taken or zero if the packages must be passed with onNewPkgFile()
+     */
+    virtual bool onNewComponent(const PkgSnapshot::Component& component)
+    {
+      return 0;
+    }
   }; //class AbstractPkgRecipient;
 } //namespace Deepsolver;
 
@@ -20,6 +20,8 @@
 
 #include"deepsolver/AbstractPkgBackEnd.h"
 #include"deepsolver/SolverBase.h"
+#include"deepsolver/RequireCache.h"
+#include"deepsolver/AbstractContinueRequest.h"
 
 namespace Deepsolver
 {
@@ -30,11 +32,33 @@ namespace Deepsolver
 		   const Solver::AbstractProvidePriority& p)
       : backend(b),
 	scope(s),
-	providePriority(p) {}
+	providePriority(p),
+	satSolver(CONF_DEFAULT_SAT_SOLVER),
+	timeLimit(0),
+	conflictLimit(0),
+	satPreprocess(1),
+	parallelComponents(0),
+	buildThreads(1),
+	satOptimize(0),
+	satExplain(1),
+	explainMinimize(CONF_DEFAULT_EXPLAIN_MINIMIZE),
+	continueRequest(NULL) {}
 
     const AbstractPkgBackEnd& backend;
     const AbstractPkgScope& scope;
     const Solver::AbstractProvidePriority&providePriority; 
+    std::string satSolver;//The name of SAT solver as accepted by Sat::createSatSolver();
+    StringVector satPortfolio;//Members for the portfolio mode, the default ones are used if empty;
+    size_t timeLimit;//In seconds for the entire solving, zero means no limit, uninterruptible SAT solvers (minisat) are checked only between solvings;
+    size_t conflictLimit;//For each SAT solving, zero means no limit;
+    bool satPreprocess;//Simplify SAT and split it into independent components before solving;
+    bool parallelComponents;//Solve independent components in parallel threads;
+    size_t buildThreads;//Threads for SAT construction, zero means the number of processors;
+    bool satOptimize;//Find the minimal change with MaxSAT instead of the updates iterations;
+    bool satExplain;//Solve unsolvable tasks again with tracked relation clauses to explain them;
+    size_t explainMinimize;//Deletion attempts to minimize the explanation within the budget, zero means none;
+    const AbstractOperationContinueRequest* continueRequest;//Polled during the solving if not NULL;
+    Solver::RequireCache::Ptr requireCache;//Shared between solvers with the same scope, every solver has its own if empty;
   }; //struct TaskSolverData;
 
   class AbstractTaskSolver
@@ -52,6 +76,23 @@ namespace Deepsolver
 		       VarIdVector& remove) const = 0;
 
     virtual void dumpSat(const UserTask& userTask, std::ostream& s) const = 0;
+
+    /**\brief Saves the initial SAT equation in DIMACS CNF format
+     *
+     * The saved equation is the one of the first solving attempt as it is
+     * before the preprocessing, without the soft literals of the
+     * optimization and without the clause selectors used only to explain
+     * unsolvable tasks. The second stream receives one line
+     * for each DIMACS variable with its number and the designation of the
+     * corresponding package.
+     *
+     * \param [in] userTask The task to construct SAT for
+     * \param [in] s The stream to save DIMACS CNF to
+     * \param [in] varsMap The stream to save variables designations to
+     */
+    virtual void dumpDimacs(const UserTask& userTask,
+			    std::ostream& s,
+			    std::ostream& varsMap) const = 0;
   }; //class AbstractTaskSolver;
 
   AbstractTaskSolver::Ptr createTaskSolver(const TaskSolverData& taskSolverData);
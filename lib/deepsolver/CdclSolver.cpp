@@ -0,0 +1,636 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/CdclSolver.h"
+
+#define RESTART_BASE 100
+#define VAR_DECAY 0.95
+#define CLAUSE_DECAY 0.999
+#define RANDOM_DECISION_FREQ 64//One of each number of decisions is random if the seed is given;
+
+DEEPSOLVER_BEGIN_SAT_NAMESPACE
+
+static size_t luby(size_t x);
+
+const CdclSolver::ClauseRef CdclSolver::NoReason;
+const size_t CdclSolver::NotInHeap;
+
+void CdclSolver::reset()
+{
+  m_stat = SatStat();
+  m_randState = m_seed;
+  m_interrupted = 0;
+  m_aborted = 0;
+  m_varIdToVar.clear();
+  m_varToVarId.clear();
+  m_values.clear();
+  m_polarity.clear();
+  m_levels.clear();
+  m_reasons.clear();
+  m_activity.clear();
+  m_varInc = 1;
+  m_heap.clear();
+  m_heapIndices.clear();
+  m_clauses.clear();
+  m_watches.clear();
+  m_units.clear();
+  m_clauseInc = 1;
+  m_learntCount = 0;
+  m_maxLearnts = 0;
+  m_trail.clear();
+  m_trailLim.clear();
+  m_qhead = 0;
+  m_seen.clear();
+}
+
+void CdclSolver::addClause(const Clause& clause)
+{
+  if (clause.empty())
+    return;
+  CLitVector lits;
+  for(Clause::size_type i = 0;i < clause.size();i++)
+    lits.push_back((CLit)(newVar(clause[i].varId) << 1) | (clause[i].neg?1:0));
+  std::sort(lits.begin(), lits.end());
+  lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+  //Both literals of the same variable are adjacent after sorting;
+  for(CLitVector::size_type i = 1;i < lits.size();i++)
+    if ((lits[i] >> 1) == (lits[i - 1] >> 1))
+      return;
+  const ClauseRef ref = attachClause(lits, 0);
+  if (lits.size() == 1)
+    m_units.push_back(ref);
+}
+
+bool CdclSolver::solve(VarIdToBoolMap& res, VarIdVector& conflicts)
+{
+  CLitVector core;
+  return search(CLitVector(), res, conflicts, core);
+}
+
+bool CdclSolver::solveAssuming(const Clause& assumptions,
+			       VarIdToBoolMap& res,
+			       Clause& core)
+{
+  CLitVector lits;
+  for(Clause::size_type i = 0;i < assumptions.size();i++)
+    lits.push_back((CLit)(newVar(assumptions[i].varId) << 1) | (assumptions[i].neg?1:0));
+  VarIdVector conflicts;
+  CLitVector failed;
+  const bool solved = search(lits, res, conflicts, failed);
+  core.clear();
+  for(CLitVector::size_type i = 0;i < failed.size();i++)
+    core.push_back(Lit(m_varToVarId[failed[i] >> 1], (failed[i] & 1) != 0));
+  return solved;
+}
+
+bool CdclSolver::search(const CLitVector& assumptions,
+			VarIdToBoolMap& res,
+			VarIdVector& conflicts,
+			CLitVector& core)
+{
+  core.clear();
+  logMsg(LOG_DEBUG, "cdcl:solving the task with %zu variables in %zu clauses (seed %u)", m_varToVarId.size(), m_clauses.size() - m_learntCount, m_seed);
+  m_stat = SatStat();
+  m_aborted = 0;
+  //Every solving starts from the empty assignment, learnt clauses are kept since they are implied by the equation;
+  const size_t varCount = m_varToVarId.size();
+  m_values.assign(varCount, ValueUndef);
+  m_levels.assign(varCount, 0);
+  m_reasons.assign(varCount, NoReason);
+  m_seen.assign(varCount, 0);
+  m_trail.clear();
+  m_trailLim.clear();
+  m_qhead = 0;
+  m_heap.clear();
+  m_heapIndices.assign(varCount, NotInHeap);
+  for(size_t i = 0;i < varCount;i++)
+    heapInsert(i);
+  if (m_maxLearnts < 1000)
+    m_maxLearnts = 1000;
+  if (m_maxLearnts < (double)m_clauses.size() / 3)
+    m_maxLearnts = (double)m_clauses.size() / 3;
+  ClauseRef conflict = NoReason;
+  for(ClauseRefVector::size_type i = 0;i < m_units.size();i++)
+    {
+      const CLit lit = m_clauses[m_units[i]].lits[0];
+      if (litValue(lit) == ValueFalse)
+	{
+	  conflict = m_units[i];
+	  break;
+	}
+      if (litValue(lit) == ValueUndef)
+	enqueue(lit, m_units[i]);
+    }
+  CLitVector learnt;
+  size_t restartNum = 0, conflictsBeforeRestart = luby(restartNum) * RESTART_BASE;
+  while(1)
+    {
+      if (m_interrupted)
+	{
+	  logMsg(LOG_DEBUG, "cdcl:solving was interrupted after %zu conflicts", m_stat.conflicts);
+	  m_aborted = 1;
+	  conflicts.clear();
+	  return 0;
+	}
+      if (m_conflictLimit > 0 && m_stat.conflicts >= m_conflictLimit)
+	{
+	  logMsg(LOG_DEBUG, "cdcl:the conflict limit %zu is reached", m_conflictLimit);
+	  m_aborted = 1;
+	  conflicts.clear();
+	  backtrack(0);
+	  return 0;
+	}
+      if (conflict != NoReason || !propagate(conflict))
+	{
+	  m_stat.conflicts++;
+	  if (decisionLevel() == 0)
+	    {
+	      collectCollisions(conflict, conflicts);
+	      logMsg(LOG_DEBUG, "cdcl:no solution with %zu highlighted collisions (%zu decisions, %zu conflicts)", conflicts.size(), m_stat.decisions, m_stat.conflicts);
+	      return 0;
+	    }
+	  size_t backtrackLevel;
+	  analyze(conflict, learnt, backtrackLevel);
+	  conflict = NoReason;
+	  backtrack(backtrackLevel);
+	  const ClauseRef ref = attachClause(learnt, 1);
+	  if (learnt.size() == 1)
+	    m_units.push_back(ref);
+	  enqueue(learnt[0], ref);
+	  m_varInc /= VAR_DECAY;
+	  m_clauseInc /= CLAUSE_DECAY;
+	  if (conflictsBeforeRestart > 0)
+	    conflictsBeforeRestart--;
+	  continue;
+	}
+      if (conflictsBeforeRestart == 0)
+	{
+	  backtrack(0);
+	  restartNum++;
+	  conflictsBeforeRestart = luby(restartNum) * RESTART_BASE;
+	  continue;
+	}
+      if ((double)m_learntCount >= m_maxLearnts + (double)m_trail.size())
+	{
+	  reduceLearnts();
+	  m_maxLearnts *= 1.1;
+	}
+      //Assumptions are the first decisions, one level for each;
+      if (decisionLevel() < assumptions.size())
+	{
+	  const CLit lit = assumptions[decisionLevel()];
+	  if (litValue(lit) == ValueFalse)
+	    {
+	      analyzeFinal(lit, core);
+	      backtrack(0);
+	      conflicts.clear();
+	      logMsg(LOG_DEBUG, "cdcl:no solution under %zu assumptions, the core has %zu of them", assumptions.size(), core.size());
+	      return 0;
+	    }
+	  m_trailLim.push_back(m_trail.size());
+	  if (litValue(lit) == ValueUndef)
+	    enqueue(lit, NoReason);
+	  continue;
+	}
+      if (!decide())
+	break;
+    }
+  logMsg(LOG_DEBUG, "cdcl:solution found (%zu decisions, %zu conflicts, %zu propagations)", m_stat.decisions, m_stat.conflicts, m_stat.propagations);
+  for(size_t i = 0;i < varCount;i++)
+    res.insert(VarIdToBoolMap::value_type(m_varToVarId[i], m_values[i] == ValueTrue));
+  backtrack(0);
+  return 1;
+}
+
+bool CdclSolver::getStat(SatStat& stat) const
+{
+  stat = m_stat;
+  return 1;
+}
+
+void CdclSolver::interrupt()
+{
+  m_interrupted = 1;
+}
+
+void CdclSolver::setConflictLimit(size_t limit)
+{
+  m_conflictLimit = limit;
+}
+
+bool CdclSolver::isAborted() const
+{
+  return m_aborted;
+}
+
+void CdclSolver::setPhase(const Lit& lit)
+{
+  m_polarity[newVar(lit.varId)] = lit.neg;
+}
+
+bool CdclSolver::isInterruptible() const
+{
+  return 1;
+}
+
+bool CdclSolver::hasAssumptions() const
+{
+  return 1;
+}
+
+size_t CdclSolver::newVar(VarId varId)
+{
+  assert(varId != BadVarId);
+  std::unordered_map<VarId, size_t>::const_iterator it = m_varIdToVar.find(varId);
+  if (it != m_varIdToVar.end())
+    return it->second;
+  const size_t var = m_varToVarId.size();
+  m_varIdToVar.insert(std::unordered_map<VarId, size_t>::value_type(varId, var));
+  m_varToVarId.push_back(varId);
+  m_polarity.push_back(1);
+  //Different seeds give different initial order of variables;
+  m_activity.push_back(m_seed != 0?(double)(rand() % 1000) * 1e-5:0);
+  m_watches.resize(m_watches.size() + 2);
+  return var;
+}
+
+CdclSolver::ClauseRef CdclSolver::attachClause(const CLitVector& lits, bool learnt)
+{
+  assert(!lits.empty());
+  const ClauseRef ref = m_clauses.size();
+  m_clauses.push_back(CClause());
+  CClause& c = m_clauses.back();
+  c.lits = lits;
+  c.learnt = learnt;
+  if (learnt)
+    {
+      m_learntCount++;
+      bumpClause(c);
+    }
+  if (lits.size() > 1)
+    {
+      m_watches[lits[0]].push_back(ref);
+      m_watches[lits[1]].push_back(ref);
+    }
+  return ref;
+}
+
+void CdclSolver::enqueue(CLit lit, ClauseRef reason)
+{
+  const size_t var = lit >> 1;
+  assert(m_values[var] == ValueUndef);
+  m_values[var] = (lit & 1)?ValueFalse:ValueTrue;
+  m_levels[var] = decisionLevel();
+  m_reasons[var] = reason;
+  m_trail.push_back(lit);
+}
+
+bool CdclSolver::propagate(ClauseRef& conflict)
+{
+  while(m_qhead < m_trail.size())
+    {
+      const CLit falseLit = m_trail[m_qhead++] ^ 1;
+      m_stat.propagations++;
+      ClauseRefVector& ws = m_watches[falseLit];
+      ClauseRefVector::size_type i = 0, j = 0;
+      while(i < ws.size())
+	{
+	  const ClauseRef ref = ws[i++];
+	  CClause& c = m_clauses[ref];
+	  if (c.removed)
+	    continue;
+	  if (c.lits[0] == falseLit)
+	    std::swap(c.lits[0], c.lits[1]);
+	  assert(c.lits[1] == falseLit);
+	  if (litValue(c.lits[0]) == ValueTrue)
+	    {
+	      ws[j++] = ref;
+	      continue;
+	    }
+	  bool found = 0;
+	  for(CLitVector::size_type k = 2;k < c.lits.size();k++)
+	    if (litValue(c.lits[k]) != ValueFalse)
+	      {
+		std::swap(c.lits[1], c.lits[k]);
+		m_watches[c.lits[1]].push_back(ref);
+		found = 1;
+		break;
+	      }
+	  if (found)
+	    continue;
+	  ws[j++] = ref;
+	  if (litValue(c.lits[0]) == ValueFalse)
+	    {
+	      conflict = ref;
+	      while(i < ws.size())
+		ws[j++] = ws[i++];
+	      ws.resize(j);
+	      m_qhead = m_trail.size();
+	      return 0;
+	    }
+	  enqueue(c.lits[0], ref);
+	}
+      ws.resize(j);
+    }
+  return 1;
+}
+
+void CdclSolver::analyze(ClauseRef conflict, CLitVector& learnt, size_t& backtrackLevel)
+{
+  learnt.clear();
+  learnt.push_back(0);//The place for the asserting literal;
+  size_t pathCount = 0;
+  bool first = 1;
+  CLit p = 0;
+  size_t index = m_trail.size();
+  ClauseRef ref = conflict;
+  do {
+    assert(ref != NoReason);
+    CClause& c = m_clauses[ref];
+    if (c.learnt)
+      bumpClause(c);
+    //The first literal of the reason clause is the implied one;
+    for(CLitVector::size_type k = first?0:1;k < c.lits.size();k++)
+      {
+	const CLit q = c.lits[k];
+	const size_t var = q >> 1;
+	if (m_seen[var] || m_levels[var] == 0)
+	  continue;
+	bumpVar(var);
+	m_seen[var] = 1;
+	if (m_levels[var] >= decisionLevel())
+	  pathCount++; else
+	  learnt.push_back(q);
+      }
+    first = 0;
+    assert(index > 0);
+    while(!m_seen[m_trail[index - 1] >> 1])
+      index--;
+    index--;
+    p = m_trail[index];
+    ref = m_reasons[p >> 1];
+    m_seen[p >> 1] = 0;
+    pathCount--;
+  } while(pathCount > 0);
+  learnt[0] = p ^ 1;
+  backtrackLevel = 0;
+  for(CLitVector::size_type k = 1;k < learnt.size();k++)
+    {
+      m_seen[learnt[k] >> 1] = 0;
+      if (m_levels[learnt[k] >> 1] > backtrackLevel)
+	{
+	  backtrackLevel = m_levels[learnt[k] >> 1];
+	  std::swap(learnt[1], learnt[k]);//The second watch must be on the literal to be unassigned last;
+	}
+    }
+}
+
+void CdclSolver::analyzeFinal(CLit failed, CLitVector& core)
+{
+  core.clear();
+  core.push_back(failed);
+  const size_t failedVar = failed >> 1;
+  if (m_levels[failedVar] == 0)
+    return;
+  m_seen[failedVar] = 1;
+  //All decisions made so far are assumptions;
+  for(size_t i = m_trail.size();i > m_trailLim[0];i--)
+    {
+      const size_t var = m_trail[i - 1] >> 1;
+      if (!m_seen[var])
+	continue;
+      m_seen[var] = 0;
+      //The decision is another assumption (it may be the opposite to the failed one);
+      if (m_reasons[var] == NoReason)
+	{
+	  core.push_back(m_trail[i - 1]);
+	  continue;
+	}
+      const CLitVector& lits = m_clauses[m_reasons[var]].lits;
+      for(CLitVector::size_type k = 1;k < lits.size();k++)
+	if (m_levels[lits[k] >> 1] > 0)
+	  m_seen[lits[k] >> 1] = 1;
+    }
+}
+
+void CdclSolver::backtrack(size_t level)
+{
+  if (decisionLevel() <= level)
+    return;
+  for(size_t i = m_trail.size();i > m_trailLim[level];i--)
+    {
+      const CLit lit = m_trail[i - 1];
+      const size_t var = lit >> 1;
+      m_values[var] = ValueUndef;
+      m_reasons[var] = NoReason;
+      m_polarity[var] = (lit & 1) != 0;
+      if (m_heapIndices[var] == NotInHeap)
+	heapInsert(var);
+    }
+  m_trail.resize(m_trailLim[level]);
+  m_trailLim.resize(level);
+  m_qhead = m_trail.size();
+}
+
+bool CdclSolver::decide()
+{
+  size_t var = NotInHeap;
+  if (m_seed != 0 && !m_varToVarId.empty() && rand() % RANDOM_DECISION_FREQ == 0)
+    {
+      const size_t v = rand() % m_varToVarId.size();
+      if (m_values[v] == ValueUndef)
+	var = v;
+    }
+  while(var == NotInHeap)
+    {
+      if (m_heap.empty())
+	return 0;
+      const size_t v = heapRemoveMax();
+      if (m_values[v] == ValueUndef)
+	var = v;
+    }
+  m_stat.decisions++;
+  m_trailLim.push_back(m_trail.size());
+  enqueue((CLit)(var << 1) | (m_polarity[var]?1:0), NoReason);
+  return 1;
+}
+
+void CdclSolver::reduceLearnts()
+{
+  ClauseRefVector learnts;
+  for(CClauseVector::size_type i = 0;i < m_clauses.size();i++)
+    if (m_clauses[i].learnt && !m_clauses[i].removed && m_clauses[i].lits.size() > 2 && !isLocked(i))
+      learnts.push_back(i);
+  std::sort(learnts.begin(), learnts.end(), [this](ClauseRef a, ClauseRef b) {
+      return m_clauses[a].activity < m_clauses[b].activity;
+    });
+  const size_t toRemove = learnts.size() / 2;
+  for(size_t i = 0;i < toRemove;i++)
+    {
+      CClause& c = m_clauses[learnts[i]];
+      c.removed = 1;
+      CLitVector().swap(c.lits);
+      m_learntCount--;
+    }
+  //Watch lists are cleaned lazily during propagation;
+  logMsg(LOG_DEBUG, "cdcl:%zu learnt clauses removed, %zu left", toRemove, m_learntCount);
+}
+
+void CdclSolver::collectCollisions(ClauseRef conflict, VarIdVector& conflicts) const
+{
+  conflicts.clear();
+  std::vector<bool> marked(m_varToVarId.size(), 0);
+  const CLitVector& lits = m_clauses[conflict].lits;
+  for(CLitVector::size_type i = 0;i < lits.size();i++)
+    marked[lits[i] >> 1] = 1;
+  //Everything at the level zero is implied by some clause, following the reasons back to the unit clauses;
+  for(size_t i = m_trail.size();i > 0;i--)
+    {
+      const size_t var = m_trail[i - 1] >> 1;
+      if (!marked[var] || m_reasons[var] == NoReason)
+	continue;
+      const CLitVector& reason = m_clauses[m_reasons[var]].lits;
+      for(CLitVector::size_type k = 0;k < reason.size();k++)
+	marked[reason[k] >> 1] = 1;
+    }
+  for(size_t i = 0;i < marked.size();i++)
+    if (marked[i])
+      conflicts.push_back(m_varToVarId[i]);
+}
+
+void CdclSolver::bumpVar(size_t var)
+{
+  m_activity[var] += m_varInc;
+  if (m_activity[var] > 1e100)
+    {
+      for(size_t i = 0;i < m_activity.size();i++)
+	m_activity[i] *= 1e-100;
+      m_varInc *= 1e-100;
+    }
+  if (m_heapIndices[var] != NotInHeap)
+    heapUp(m_heapIndices[var]);
+}
+
+void CdclSolver::bumpClause(CClause& c)
+{
+  c.activity += m_clauseInc;
+  if (c.activity > 1e20)
+    {
+      for(CClauseVector::size_type i = 0;i < m_clauses.size();i++)
+	if (m_clauses[i].learnt)
+	  m_clauses[i].activity *= 1e-20;
+      m_clauseInc *= 1e-20;
+    }
+}
+
+bool CdclSolver::isLocked(ClauseRef ref) const
+{
+  const CLitVector& lits = m_clauses[ref].lits;
+  assert(!lits.empty());
+  return m_reasons[lits[0] >> 1] == ref && litValue(lits[0]) == ValueTrue;
+}
+
+unsigned int CdclSolver::rand()
+{
+  //xorshift32, the sequence must not depend on the platform C library;
+  if (m_randState == 0)
+    m_randState = 1;
+  m_randState ^= m_randState << 13;
+  m_randState ^= m_randState >> 17;
+  m_randState ^= m_randState << 5;
+  return m_randState;
+}
+
+void CdclSolver::heapInsert(size_t var)
+{
+  assert(m_heapIndices[var] == NotInHeap);
+  m_heapIndices[var] = m_heap.size();
+  m_heap.push_back(var);
+  heapUp(m_heap.size() - 1);
+}
+
+size_t CdclSolver::heapRemoveMax()
+{
+  assert(!m_heap.empty());
+  const size_t var = m_heap[0];
+  m_heapIndices[var] = NotInHeap;
+  m_heap[0] = m_heap.back();
+  m_heap.pop_back();
+  if (!m_heap.empty())
+    {
+      m_heapIndices[m_heap[0]] = 0;
+      heapDown(0);
+    }
+  return var;
+}
+
+void CdclSolver::heapUp(size_t pos)
+{
+  const size_t var = m_heap[pos];
+  while(pos > 0)
+    {
+      const size_t parent = (pos - 1) / 2;
+      if (!heapLess(var, m_heap[parent]))
+	break;
+      m_heap[pos] = m_heap[parent];
+      m_heapIndices[m_heap[pos]] = pos;
+      pos = parent;
+    }
+  m_heap[pos] = var;
+  m_heapIndices[var] = pos;
+}
+
+void CdclSolver::heapDown(size_t pos)
+{
+  const size_t var = m_heap[pos];
+  while(2 * pos + 1 < m_heap.size())
+    {
+      size_t child = 2 * pos + 1;
+      if (child + 1 < m_heap.size() && heapLess(m_heap[child + 1], m_heap[child]))
+	child++;
+      if (!heapLess(m_heap[child], var))
+	break;
+      m_heap[pos] = m_heap[child];
+      m_heapIndices[m_heap[pos]] = pos;
+      pos = child;
+    }
+  m_heap[pos] = var;
+  m_heapIndices[var] = pos;
+}
+
+//Static functions;
+
+size_t luby(size_t x)
+{
+  //The x-th item of the sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ...;
+  size_t size = 1, seq = 0;
+  while(size < x + 1)
+    {
+      seq++;
+      size = 2 * size + 1;
+    }
+  while(size - 1 != x)
+    {
+      size = (size - 1) >> 1;
+      seq--;
+      x = x % size;
+    }
+  return (size_t)1 << seq;
+}
+
+DEEPSOLVER_END_SAT_NAMESPACE
@@ -0,0 +1,196 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_CDCL_SOLVER_H
+#define DEEPSOLVER_CDCL_SOLVER_H
+
+#include"deepsolver/Sat.h"
+
+namespace Deepsolver
+{
+  namespace Sat
+  {
+    /**\brief The built-in CDCL SAT solver
+     *
+     * This class is a self-contained conflict-driven clause learning
+     * solver without any external dependencies. It uses two watched
+     * literals for propagation, first UIP conflict analysis, VSIDS
+     * variable ordering with phase saving, Luby restarts and periodical
+     * reduction of learnt clauses. The initial phase of every variable
+     * is negative, since for package management tasks it means
+     * "do not install", what is usually the most preferable choice,
+     * unless another phase is suggested with setPhase().
+     *
+     * Different seed values make the solver to break ties and to make
+     * occasional random decisions differently, so several instances
+     * with different seeds may be run in parallel in portfolio mode.
+     * The solving can be interrupted from another thread with the
+     * interrupt() method or stopped by the conflict limit.
+     *
+     * The solver is incremental: clauses may be added between solvings
+     * and the learnt clauses are kept. The assumptions are taken as the
+     * first decisions, the core of a failed assumption is collected by
+     * following the reasons of its negation back to other assumptions.
+     */
+    class CdclSolver: public AbstractSatSolver
+    {
+    public:
+      /**\brief The constructor
+       *
+       * \param [in] seed The seed for random decisions, zero means no random decisions at all
+       */
+      CdclSolver(unsigned int seed = 0)
+	: m_seed(seed),
+	  m_randState(seed),
+	  m_interrupted(0),
+	  m_conflictLimit(0),
+	  m_aborted(0),
+	  m_varInc(1),
+	  m_clauseInc(1),
+	  m_learntCount(0),
+	  m_maxLearnts(0),
+	  m_qhead(0) {}
+
+      /**\brief The destructor*/
+      virtual ~CdclSolver() {}
+
+    public:
+      void reset() override;
+      void addClause(const Clause& clause) override;
+      bool solve(VarIdToBoolMap& res, VarIdVector& conflicts) override;
+      bool getStat(SatStat& stat) const override;
+      void interrupt() override;
+      bool isInterruptible() const override;
+      void setConflictLimit(size_t limit) override;
+      void setPhase(const Lit& lit) override;
+      bool isAborted() const override;
+      bool hasAssumptions() const override;
+      bool solveAssuming(const Clause& assumptions,
+			 VarIdToBoolMap& res,
+			 Clause& core) override;
+
+    private:
+      typedef unsigned int CLit;//Variable number multiplied by 2 plus 1 if negative;
+      typedef std::vector<CLit> CLitVector;
+      typedef size_t ClauseRef;
+      typedef std::vector<ClauseRef> ClauseRefVector;
+
+      enum {
+	ValueFalse = 0,
+	ValueTrue = 1,
+	ValueUndef = 2
+      };
+
+      struct CClause
+      {
+	CClause()
+	  : learnt(0),
+	    removed(0),
+	    activity(0) {}
+
+	CLitVector lits;
+	bool learnt;
+	bool removed;
+	double activity;
+      }; //struct CClause;
+
+      typedef std::vector<CClause> CClauseVector;
+
+    private:
+      bool search(const CLitVector& assumptions,
+		  VarIdToBoolMap& res,
+		  VarIdVector& conflicts,
+		  CLitVector& core);
+      size_t newVar(VarId varId);
+      ClauseRef attachClause(const CLitVector& lits, bool learnt);
+      void enqueue(CLit lit, ClauseRef reason);
+      bool propagate(ClauseRef& conflict);
+      void analyze(ClauseRef conflict, CLitVector& learnt, size_t& backtrackLevel);
+      void analyzeFinal(CLit failed, CLitVector& core);
+      void backtrack(size_t level);
+      bool decide();
+      void reduceLearnts();
+      void collectCollisions(ClauseRef conflict, VarIdVector& conflicts) const;
+      void bumpVar(size_t var);
+      void bumpClause(CClause& c);
+      bool isLocked(ClauseRef ref) const;
+      unsigned int rand();
+
+      //Heap of variables ordered by activity;
+      void heapInsert(size_t var);
+      size_t heapRemoveMax();
+      void heapUp(size_t pos);
+      void heapDown(size_t pos);
+      bool heapLess(size_t var1, size_t var2) const
+      {
+	return m_activity[var1] > m_activity[var2];
+      }
+
+      unsigned char litValue(CLit lit) const
+      {
+	const unsigned char v = m_values[lit >> 1];
+	if (v == ValueUndef)
+	  return ValueUndef;
+	return v ^ (unsigned char)(lit & 1);
+      }
+
+      size_t decisionLevel() const
+      {
+	return m_trailLim.size();
+      }
+
+    private:
+      static const ClauseRef NoReason = (ClauseRef)-1;
+      static const size_t NotInHeap = (size_t)-1;
+
+      const unsigned int m_seed;
+      unsigned int m_randState;
+      std::atomic<bool> m_interrupted;
+      size_t m_conflictLimit;
+      bool m_aborted;
+      SatStat m_stat;
+
+      //Variables;
+      std::unordered_map<VarId, size_t> m_varIdToVar;
+      VarIdVector m_varToVarId;
+      std::vector<unsigned char> m_values;
+      std::vector<bool> m_polarity;//Non-zero means the variable was false last time;
+      SizeVector m_levels;
+      ClauseRefVector m_reasons;
+      std::vector<double> m_activity;
+      double m_varInc;
+      SizeVector m_heap;
+      SizeVector m_heapIndices;
+
+      //Clauses;
+      CClauseVector m_clauses;
+      std::vector<ClauseRefVector> m_watches;
+      ClauseRefVector m_units;
+      double m_clauseInc;
+      size_t m_learntCount;
+      double m_maxLearnts;
+
+      //Trail;
+      CLitVector m_trail;
+      SizeVector m_trailLim;
+      size_t m_qhead;
+      std::vector<bool> m_seen;
+    }; //class CdclSolver;
+  } //namespace Sat;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_CDCL_SOLVER_H;
@@ -17,6 +17,7 @@
 
 #include"deepsolver/deepsolver.h"
 #include"deepsolver/ConfigCenter.h"
+#include"deepsolver/Sat.h"
 
 #define DELIMITERS ";"
 
@@ -38,6 +39,17 @@ void ConfigCenter::initValues()
   addNonEmptyStringParam3("core", "dir", "pkg-data", m_root.dir.pkgData);
   addNonEmptyStringParam3("core", "dir", "pkg-cache", m_root.dir.pkgCache);
   addStringListParam3("core", "os", "transact-read-ahead", m_root.os.transactReadAhead);
+  addNonEmptyStringParam3("core", "solver", "sat", m_root.solver.sat);
+  addStringListParam3("core", "solver", "portfolio", m_root.solver.portfolio);
+  addUIntParam3("core", "solver", "time-limit", m_root.solver.timeLimit);
+  addUIntParam3("core", "solver", "conflict-limit", m_root.solver.conflictLimit);
+  addBooleanParam3("core", "solver", "preprocess", m_root.solver.preprocess);
+  addBooleanParam3("core", "solver", "parallel-components", m_root.solver.parallelComponents);
+  addUIntParam3("core", "solver", "build-threads", m_root.solver.buildThreads);
+  addBooleanParam3("core", "solver", "optimize", m_root.solver.optimize);
+  addBooleanParam3("core", "solver", "cache", m_root.solver.cache);
+  addBooleanParam3("core", "solver", "explain", m_root.solver.explain);
+  addUIntParam3("core", "solver", "explain-minimize", m_root.solver.explainMinimize);
 }
 
 void ConfigCenter::initRepoValues()
@@ -114,6 +126,9 @@ void ConfigCenter::commit()
   m_root.dir.pkgData = trim(m_root.dir.pkgData);
   for(StringVector::size_type i = 0;i < m_root.os.transactReadAhead.size();i++)
     m_root.os.transactReadAhead[i] = trim(m_root.os.transactReadAhead[i]);
+  m_root.solver.sat = trim(m_root.solver.sat);
+  for(StringVector::size_type i = 0;i < m_root.solver.portfolio.size();i++)
+    m_root.solver.portfolio[i] = trim(m_root.solver.portfolio[i]);
   for(ConfProvideVector::size_type i = 0;i < m_root.provide.size();i++)
     {
       ConfProvide& provide = m_root.provide[i];
@@ -139,6 +154,15 @@ void ConfigCenter::commit()
 	m_stringValues[i].path[1] == "url" &&
 	!checkUrl(*m_stringValues[i].value))
       throwConfigException(ConfigException::InvalidUrl, m_stringValues[i]);
+  for(StringValueVector::size_type i = 0;i < m_stringValues.size();i++)
+    if (m_stringValues[i].pathToString() == "core.solver.sat" &&
+	!Sat::createSatSolver(*m_stringValues[i].value))
+      throwConfigException(ConfigException::UnknownSatSolver, m_stringValues[i]);
+  for(StringListValueVector::size_type i = 0;i < m_stringListValues.size();i++)
+    if (m_stringListValues[i].pathToString() == "core.solver.portfolio")
+      for(StringVector::size_type k = 0;k < m_stringListValues[i].value->size();k++)
+	if (!Sat::createSatSolver((*m_stringListValues[i].value)[k]))
+	  throwConfigException(ConfigException::UnknownSatSolver, m_stringListValues[i]);
 }
 
 void ConfigCenter::printConfigData(std::ostream& s) const
@@ -310,6 +334,19 @@ void ConfigCenter::addNonEmptyStringListParam3(const std::string& path1,
   m_stringListValues.push_back(stringListValue);
 }
 
+void ConfigCenter::addUIntParam3(const std::string& path1,
+				  const std::string& path2,
+				  const std::string& path3,
+				  unsigned int& value)
+{
+  assert(!path1.empty() && !path2.empty() && !path3.empty());
+  UIntValue uintValue(value);
+  uintValue.path.push_back(path1);
+  uintValue.path.push_back(path2);
+  uintValue.path.push_back(path3);
+  m_uintValues.push_back(uintValue);
+}
+
 void ConfigCenter::addBooleanParam2(const std::string& path1,
 				    const std::string& path2,
 				    bool& value)
@@ -321,6 +358,19 @@ void ConfigCenter::addBooleanParam2(const std::string& path1,
   m_booleanValues.push_back(boolValue);
 }
 
+void ConfigCenter::addBooleanParam3(const std::string& path1,
+				    const std::string& path2,
+				    const std::string& path3,
+				    bool& value)
+{
+  assert(!path1.empty() && !path2.empty() && !path3.empty());
+  BooleanValue boolValue(value);
+  boolValue.path.push_back(path1);
+  boolValue.path.push_back(path2);
+  boolValue.path.push_back(path3);
+  m_booleanValues.push_back(boolValue);
+}
+
 
 //Static functions;
 
@@ -139,10 +139,20 @@ namespace Deepsolver
 				     const std::string& path3,
 				     StringVector& value);
 
+    void addUIntParam3(const std::string& path1,
+		       const std::string& path2,
+		       const std::string& path3,
+		       unsigned int& value);
+
     void addBooleanParam2(const std::string& path1,
 			  const std::string& path2,
 			  bool& value);
 
+    void addBooleanParam3(const std::string& path1,
+			  const std::string& path2,
+			  const std::string& path3,
+			  bool& value);
+
   private://AbstractConfigFileHandler;
     void onConfigFileValue(const StringVector& path, 
 			   const std::string& sectArg,
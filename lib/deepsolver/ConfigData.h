@@ -35,6 +35,33 @@ namespace Deepsolver
     StringVector transactReadAhead;
   }; //struct ConfOs;
 
+  struct ConfSolver
+  {
+    ConfSolver()
+      : sat(CONF_DEFAULT_SAT_SOLVER),
+	timeLimit(0),
+	conflictLimit(0),
+	preprocess(1),
+	parallelComponents(0),
+	buildThreads(1),
+	optimize(0),
+	cache(0),
+	explain(1),
+	explainMinimize(CONF_DEFAULT_EXPLAIN_MINIMIZE) {}
+
+    std::string sat;
+    unsigned int timeLimit;//In seconds, zero means no limit, minisat cannot be stopped in the middle of the solving;
+    unsigned int conflictLimit;//Zero means no limit;
+    bool preprocess;
+    bool parallelComponents;
+    unsigned int buildThreads;//Zero means the number of processors;
+    bool optimize;
+    bool cache;//Reuse the solutions of the same tasks until the package data or installed packages change;
+    bool explain;//Solve unsolvable tasks again with tracked relation clauses to explain them;
+    unsigned int explainMinimize;//Deletion attempts to minimize the explanation, zero means no minimization;
+    StringVector portfolio;//Used only if sat is "portfolio", the default set of members is taken if empty;
+  }; //struct ConfSolver;
+
   struct ConfRepo
   {
     ConfRepo()
@@ -95,6 +122,7 @@ namespace Deepsolver
     size_t tinyFileSizeLimit;//FIXME:Inaccessible;
     ConfDir dir;
     ConfOs os;
+    ConfSolver solver;
     ConfRepoVector repo;
     ConfProvideVector provide;
   }; //struct ConfRoot;
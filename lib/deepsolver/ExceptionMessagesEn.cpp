@@ -87,6 +87,9 @@ void ExceptionMessagesEn::visit(const ConfigException& e)
     case ConfigException::InvalidUrl:
       m_stream << "An invalid URL" << std::endl;
       break;
+    case ConfigException::UnknownSatSolver:
+      m_stream << "An unknown SAT solver" << std::endl;
+      break;
     default:
       assert(0);
       return;
@@ -188,12 +191,26 @@ void ExceptionMessagesEn::visit(const TaskException& e)
     case TaskException::UnsolvableSat:
       m_stream << "Your request has no solution. That can be caused either by a contradiction" << std::endl;
       m_stream << "in the list of requested packages or by the problems in the attached repositories." << std::endl;
+      if (!e.getParam().empty())
+	{
+	  m_stream << std::endl << "The following relations cannot be satisfied together:" << std::endl << std::endl;
+	  m_stream << e.getParam() << std::endl;
+	}
       return;
     case TaskException::Unmet:
       m_stream << "There is a require entry without any matching packages neither in the" << std::endl;
       m_stream << "system not in the available repositories. The entry caused the break is:" << std::endl << std::endl;
       m_stream << e.getParam() << std::endl;
       return;
+    case TaskException::LimitExceeded:
+      m_stream << "Your request cannot be solved within the limits given in the configuration." << std::endl;
+      m_stream << "Try to increase core.solver.time-limit or core.solver.conflict-limit values." << std::endl << std::endl;
+      m_stream << "The reached stage: " << e.getParam() << std::endl;
+      return;
+    case TaskException::Cancelled:
+      m_stream << "The solving of your request has been cancelled." << std::endl << std::endl;
+      m_stream << "The reached stage: " << e.getParam() << std::endl;
+      return;
     default:
       assert(0);
     };
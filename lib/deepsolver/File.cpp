@@ -153,6 +153,29 @@ void File::create(const std::string& fileName)
     }
 }
 
+std::string File::createUnique(const std::string& fileName)
+{
+  assert(m_fd == -1);
+  std::string name = fileName + ".XXXXXX";
+  std::vector<char> buf(name.begin(), name.end());
+  buf.push_back('\0');
+  m_fd = ::mkstemp(&buf[0]);
+  if (m_fd < 0)
+    {
+      m_fd = -1;
+      SYS_STOP("mkstemp(" + name + ")");
+    }
+  name = &buf[0];
+  //mkstemp() makes the file accessible only by the owner;
+  if (::fchmod(m_fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0)
+    {
+      close();
+      ::unlink(name.c_str());
+      SYS_STOP("fchmod(" + name + ")");
+    }
+  return name;
+}
+
 void File::close()
 {
   if (m_fd < 0)
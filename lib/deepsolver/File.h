@@ -61,6 +61,18 @@ namespace Deepsolver
      */
     void create(const std::string& fileName);
 
+    /**\brief Creates a new file with a unique name next to the given one
+     *
+     * The name is made of the given one with a random suffix, so
+     * concurrent writers never share the file. It is intended for
+     * writing the content to be moved to the given name afterwards.
+     *
+     * \param [in] fileName The name the unique one is derived from
+     *
+     * \return The name of the created file
+     */
+    std::string createUnique(const std::string& fileName);
+
     /**\brief Closes previously opened file
      *
      * This method closes previously opened file. If file is already closed
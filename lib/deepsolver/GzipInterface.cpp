@@ -22,19 +22,61 @@
 DEEPSOLVER_BEGIN_NAMESPACE
 
 #define GZIP_STOP(x) throw GzipException(x)
+#define OUTPUT_BUF_SIZE 65536
+
+//The block of data with its compressed form;
+struct GzipParallelJob
+{
+  GzipParallelJob()
+    : done(0) {}
+
+  std::string data;
+  std::string compressed;
+  bool done;
+}; //struct GzipParallelJob;
+
+typedef std::shared_ptr<GzipParallelJob> GzipParallelJobPtr;
+
+//The state shared between the writing thread and the workers;
+struct GzipParallelOutputFile::State
+{
+  State()
+    : stopped(0) {}
+
+  std::mutex mutex;
+  std::condition_variable workCond;//New blocks or stopping for workers;
+  std::condition_variable doneCond;//Compressed blocks or errors for the writing thread;
+  std::deque<GzipParallelJobPtr> pending;//Not taken by any worker yet;
+  std::deque<GzipParallelJobPtr> queue;//All blocks not written yet in the original order;
+  std::exception_ptr error;
+  bool stopped;
+}; //struct GzipParallelOutputFile::State;
+
+static void compressMember(const std::string& data, std::string& res);
+static void runGzipWorker(GzipParallelOutputFile::StatePtr state);
 
 void GzipOutputFile::open(const std::string& fileName)
 {
-  assert(m_fd == -1);
-  m_fd = ::open(fileName.c_str(), O_CREAT | O_TRUNC | O_WRONLY, NEW_FILE_MODE);
-  TRY_SYS_CALL(m_fd != -1, "open(" + fileName + ", O_CREAT | O_TRUNC | O_WRONLY)");
-  m_gzfile = gzdopen(m_fd, "w");
-  if (m_gzfile == NULL)
+  assert(m_stream == NULL);
+  z_stream* stream = new z_stream;
+  memset(stream, 0, sizeof(z_stream));
+  //The window bits value greater than 15 makes zlib write gzip header and trailer;
+  if (deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
     {
-      ::close(m_fd);
-      m_fd = -1;
-      GZIP_STOP("gzdfile(" + fileName + ") cannot create valid gzip file descriptor");
+      delete stream;
+      GZIP_STOP("deflateInit2() cannot initialize compression stream for " + fileName);
     }
+  try {
+    m_file.create(fileName);
+  }
+  catch(...)
+    {
+      deflateEnd(stream);
+      delete stream;
+      throw;
+    }
+  m_stream = stream;
+  m_outBuf.resize(OUTPUT_BUF_SIZE);
   m_fileName = fileName;
 }
 
@@ -43,42 +85,196 @@ void GzipOutputFile::write(const void* buf, size_t bufSize)
   if (bufSize == 0)
     return;
   assert(buf);
-  assert(m_gzfile != NULL && m_fd != -1);
-  gzFile f = static_cast<gzFile>(m_gzfile);
-  size_t written = 0;
+  assert(m_stream != NULL);
   const char* c = static_cast<const char*>(buf);
-  while(written < bufSize)
+  //zlib takes the input length as unsigned int;
+  while(bufSize > 0)
     {
-      const int res = gzwrite(f, &c[written], bufSize - written);
-      if (res == 0)//the was an error;
+      const size_t count = std::min(bufSize, (size_t)OUTPUT_BUF_SIZE);
+      compress(c, count, Z_NO_FLUSH);
+      c += count;
+      bufSize -= count;
+    }
+}
+
+void GzipOutputFile::close()
+{
+  if (m_stream == NULL)
+    return;
+  z_stream* stream = static_cast<z_stream*>(m_stream);
+  try {
+    compress(NULL, 0, Z_FINISH);
+  }
+  catch(...)
+    {
+      m_stream = NULL;
+      deflateEnd(stream);
+      delete stream;
+      m_file.close();
+      throw;
+    }
+  m_stream = NULL;
+  deflateEnd(stream);
+  delete stream;
+  m_file.close();
+  m_outBuf.clear();
+  m_fileName.erase();
+}
+
+void GzipOutputFile::compress(const void* buf, size_t bufSize, int flush)
+{
+  assert(m_stream != NULL);
+  z_stream* stream = static_cast<z_stream*>(m_stream);
+  stream->next_in = reinterpret_cast<Bytef*>(const_cast<void*>(buf));
+  stream->avail_in = bufSize;
+  //The output buffer filled completely means zlib may have more to write;
+  do {
+    stream->next_out = reinterpret_cast<Bytef*>(&m_outBuf[0]);
+    stream->avail_out = m_outBuf.size();
+    if (deflate(stream, flush) == Z_STREAM_ERROR)
+      GZIP_STOP(m_fileName + ":" + (stream->msg != NULL ? stream->msg : "deflate() cannot compress the data"));
+    const size_t count = m_outBuf.size() - stream->avail_out;
+    if (count > 0)
+      {
+	m_file.write(&m_outBuf[0], count);
+	if (m_checksum != NULL)
+	  m_checksum->update(&m_outBuf[0], count);
+      }
+  } while(stream->avail_out == 0);
+  assert(stream->avail_in == 0);
+}
+
+void GzipParallelOutputFile::open(const std::string& fileName, size_t threadCount)
+{
+  assert(!m_state);
+  m_file.create(fileName);
+  m_state = StatePtr(new State());
+  m_block.reserve(GZIP_PARALLEL_BLOCK_SIZE);
+  m_written = 0;
+  m_fileName = fileName;
+  for(size_t i = 0;i < threadCount;++i)
+    {
+      try {
+	m_threads.push_back(std::thread(runGzipWorker, m_state));
+      }
+      catch(const std::system_error& e)
 	{
-	  int code;
-	  const char* msg = gzerror(f, &code);
-	  if (code == Z_ERRNO)//The error is in the system, not in the zlib;
-	    SYS_STOP("gzwrite(" + m_fileName + ")");
-	  assert(msg);
-	  GZIP_STOP(msg);
+	  logMsg(LOG_WARNING, "gzip:unable to start new thread (%s), %zu threads are used for \'%s\'", e.what(), m_threads.size(), fileName.c_str());
+	  break;
 	}
-      assert(res > 0);
-      written += (size_t)res;
-      assert(written <= bufSize);
     }
 }
 
-void GzipOutputFile::close()
+void GzipParallelOutputFile::write(const void* buf, size_t bufSize)
 {
-  if (m_gzfile == NULL)
+  if (bufSize == 0)
     return;
-  assert(m_fd != -1);
-  gzFile f = static_cast<gzFile>(m_gzfile);
-  const int res = gzclose(f);
-  if (res == Z_ERRNO)
-    SYS_STOP("gzclose(" + m_fileName + ")");
-  m_gzfile = NULL;
-  m_fd = -1;//gzclose() automatically closes associated file descriptor;
+  assert(buf);
+  assert(m_state);
+  const char* c = static_cast<const char*>(buf);
+  while(bufSize > 0)
+    {
+      const size_t count = std::min(bufSize, (size_t)GZIP_PARALLEL_BLOCK_SIZE - m_block.size());
+      m_block.append(c, count);
+      c += count;
+      bufSize -= count;
+      if (m_block.size() >= GZIP_PARALLEL_BLOCK_SIZE)
+	submitBlock();
+    }
+}
+
+void GzipParallelOutputFile::close()
+{
+  if (!m_state)
+    return;
+  try {
+    //The file without members is not accepted by gzip utility;
+    if (!m_block.empty() || m_written == 0)
+      submitBlock();
+    writeCompressed(0);
+  }
+  catch(...)
+    {
+      stopThreads();
+      m_file.close();
+      throw;
+    }
+  stopThreads();
+  m_file.close();
+  m_block.clear();
   m_fileName.erase();
 }
 
+void GzipParallelOutputFile::submitBlock()
+{
+  assert(m_state);
+  GzipParallelJobPtr job(new GzipParallelJob());
+  job->data.swap(m_block);
+  m_block.reserve(GZIP_PARALLEL_BLOCK_SIZE);
+  m_written++;
+  if (m_threads.empty())
+    {
+      compressMember(job->data, job->compressed);
+      writeMember(job->compressed);
+      return;
+    }
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->pending.push_back(job);
+    m_state->queue.push_back(job);
+  }
+  m_state->workCond.notify_one();
+  //Each worker may have one block in progress and one waiting;
+  writeCompressed(2 * m_threads.size());
+}
+
+void GzipParallelOutputFile::writeCompressed(size_t limit)
+{
+  assert(m_state);
+  while(1)
+    {
+      GzipParallelJobPtr job;
+      {
+	std::unique_lock<std::mutex> lock(m_state->mutex);
+	if (m_state->error)
+	  std::rethrow_exception(m_state->error);
+	if (m_state->queue.empty())
+	  return;
+	if (!m_state->queue.front()->done)
+	  {
+	    if (m_state->queue.size() <= limit)
+	      return;
+	    m_state->doneCond.wait(lock);
+	    continue;
+	  }
+	job = m_state->queue.front();
+	m_state->queue.pop_front();
+      }
+      writeMember(job->compressed);
+    }
+}
+
+void GzipParallelOutputFile::stopThreads()
+{
+  assert(m_state);
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->stopped = 1;
+  }
+  m_state->workCond.notify_all();
+  for(std::vector<std::thread>::size_type i = 0;i < m_threads.size();++i)
+    m_threads[i].join();
+  m_threads.clear();
+  m_state.reset();
+}
+
+void GzipParallelOutputFile::writeMember(const std::string& member)
+{
+  m_file.write(member.data(), member.size());
+  if (m_checksum != NULL)
+    m_checksum->update(member.data(), member.size());
+}
+
 void GzipInputFile::open(const std::string& fileName)
 {
   assert(m_fd == -1);
@@ -128,4 +324,66 @@ void GzipInputFile::close()
   m_fileName.erase();
 }
 
+//Static functions;
+
+void compressMember(const std::string& data, std::string& res)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  //The window bits value greater than 15 makes zlib write gzip header and trailer;
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    GZIP_STOP("deflateInit2() cannot initialize compression stream");
+  res.resize(deflateBound(&stream, data.size()));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&res[0]);
+  stream.avail_out = res.size();
+  //The output buffer is large enough to get everything at once;
+  const int code = deflate(&stream, Z_FINISH);
+  const std::string msg = stream.msg != NULL ? stream.msg : "deflate() cannot compress the block";
+  const size_t resSize = res.size() - stream.avail_out;
+  deflateEnd(&stream);
+  if (code != Z_STREAM_END)
+    GZIP_STOP(msg);
+  res.resize(resSize);
+}
+
+void runGzipWorker(GzipParallelOutputFile::StatePtr state)
+{
+  while(1)
+    {
+      GzipParallelJobPtr job;
+      {
+	std::unique_lock<std::mutex> lock(state->mutex);
+	while(state->pending.empty() && !state->stopped)
+	  state->workCond.wait(lock);
+	if (state->stopped)
+	  return;
+	job = state->pending.front();
+	state->pending.pop_front();
+      }
+      std::string compressed;
+      try {
+	compressMember(job->data, compressed);
+      }
+      catch(...)
+	{
+	  {
+	    std::lock_guard<std::mutex> lock(state->mutex);
+	    if (!state->error)
+	      state->error = std::current_exception();
+	  }
+	  state->doneCond.notify_all();
+	  continue;
+	}
+      {
+	std::lock_guard<std::mutex> lock(state->mutex);
+	job->compressed.swap(compressed);
+	std::string().swap(job->data);
+	job->done = 1;
+      }
+      state->doneCond.notify_all();
+    }
+}
+
 DEEPSOLVER_END_NAMESPACE
@@ -18,14 +18,16 @@
 #ifndef DEEPSOLVER_GZIP_INTERFACE_H
 #define DEEPSOLVER_GZIP_INTERFACE_H
 
+#include"deepsolver/AbstractChecksum.h"
+
 namespace Deepsolver
 {
   class GzipOutputFile
   {
   public:
     GzipOutputFile()
-      : m_fd(-1),
-	m_gzfile(NULL) {}
+      : m_stream(NULL),
+	m_checksum(NULL) {}
 
     virtual ~GzipOutputFile()
     {
@@ -37,12 +39,90 @@ namespace Deepsolver
     void write(const void* buf, size_t bufSize);
     void close();
 
+    /**\brief Passes all bytes written to the disk to the checksum calculation
+     *
+     * \param [in] checksum The initialized checksum object, may be NULL to stop the passing
+     */
+    void setChecksum(AbstractChecksum* checksum)
+    {
+      m_checksum = checksum;
+    }
+
   private:
-    int m_fd;
-    void* m_gzfile;
+    void compress(const void* buf, size_t bufSize, int flush);
+
+  private:
+    File m_file;
+    void* m_stream;
+    std::vector<char> m_outBuf;
+    AbstractChecksum* m_checksum;
     std::string m_fileName;
   }; //class GzipOutputFile;
 
+  /**\brief The gzip file compressed by several threads
+   *
+   * The data is split into blocks of GZIP_PARALLEL_BLOCK_SIZE bytes and
+   * every block is compressed as a separate gzip member on worker
+   * threads, like pigz does. The members are written in the original
+   * order, their concatenation is a valid gzip file read by zlib
+   * (including GzipInputFile) and by gzip utility as a single
+   * stream. The calling thread only fills the blocks and writes the
+   * compressed members, the number of blocks waiting for writing is
+   * limited, so the memory usage doesn't depend on the file size.
+   */
+  class GzipParallelOutputFile
+  {
+  public:
+    GzipParallelOutputFile()
+      : m_written(0),
+	m_checksum(NULL) {}
+
+    virtual ~GzipParallelOutputFile()
+    {
+      close();
+    }
+
+  public:
+    /**\brief Creates the file and starts the worker threads
+     *
+     * \param [in] fileName The name of the file to create
+     * \param [in] threadCount The number of worker threads, zero means compressing in the calling thread
+     */
+    void open(const std::string& fileName, size_t threadCount);
+
+    void write(const void* buf, size_t bufSize);
+    void close();
+
+    /**\brief Passes all bytes written to the disk to the checksum calculation
+     *
+     * \param [in] checksum The initialized checksum object, may be NULL to stop the passing
+     */
+    void setChecksum(AbstractChecksum* checksum)
+    {
+      m_checksum = checksum;
+    }
+
+  public:
+    struct State;
+    typedef std::shared_ptr<State> StatePtr;
+
+  private:
+    void submitBlock();
+    //Writes compressed members from the head of the queue, waiting until it is not longer than the limit;
+    void writeCompressed(size_t limit);
+    void stopThreads();
+    void writeMember(const std::string& member);
+
+  private:
+    File m_file;
+    StatePtr m_state;
+    std::vector<std::thread> m_threads;
+    std::string m_block;
+    size_t m_written;//The number of submitted blocks;
+    AbstractChecksum* m_checksum;
+    std::string m_fileName;
+  }; //class GzipParallelOutputFile;
+
   class GzipInputFile
   {
   public:
@@ -22,32 +22,58 @@
 #include"deepsolver/TextFormatSectionReader.h"
 #include"deepsolver/Md5File.h"
 #include"deepsolver/GzipInterface.h"
+#include"deepsolver/ZstdInterface.h"
 #include"deepsolver/RegExp.h"
+#include"deepsolver/Md5.h"
+#include"deepsolver/IndexManifest.h"
+#include"deepsolver/PkgSnapshot.h"
+#include"deepsolver/AutoReleaseStrings.h"
 
 DEEPSOLVER_BEGIN_NAMESPACE
 
 #define TMP_FILE_NAME "tmp_data"
+#define REFS_CACHE_HEADER "#refs:"
+#define REFS_CACHE_TRAILER "#end:"
 
+//Every output calculates the checksum of the bytes going to the disk, so written files are never read again;
 class UnifiedOutput
 {
 public:
   typedef std::shared_ptr<UnifiedOutput> Ptr;
 
 public:
-  UnifiedOutput() {}
+  UnifiedOutput(char checksumType)
+    : m_checksum(Md5File::createChecksum(checksumType)) {}
+
   virtual ~UnifiedOutput() {}
 
 public:
   virtual void writeData(const std::string& str) = 0;
   virtual void close() = 0;
+
+  //May be called only after close();
+  const std::string& getChecksum()
+  {
+    if (m_checksumValue.empty())
+      m_checksumValue = m_checksum->commit();
+    return m_checksumValue;
+  }
+
+protected:
+  const AbstractChecksum::Ptr m_checksum;
+
+private:
+  std::string m_checksumValue;
 }; //class UnifiedOutput;
 
 class StdOutput: public UnifiedOutput
 {
 public:
-  StdOutput() {}
+  StdOutput()
+    : UnifiedOutput(AbstractChecksum::TypeMd5) {}
 
-  StdOutput(const std::string& fileName)
+  StdOutput(const std::string& fileName, char checksumType = AbstractChecksum::TypeMd5)
+    : UnifiedOutput(checksumType)
   {
     open(fileName);
   }
@@ -72,6 +98,7 @@ public:
   {
     assert(m_stream.is_open());
     m_stream << str;
+    m_checksum->update(str.c_str(), str.length());
   }
 
   void close()
@@ -89,9 +116,11 @@ private:
 class GzipOutput: public UnifiedOutput
 {
 public:
-  GzipOutput() {}
+  GzipOutput()
+    : UnifiedOutput(AbstractChecksum::TypeMd5) {}
 
-  GzipOutput(const std::string& fileName)
+  GzipOutput(const std::string& fileName, char checksumType)
+    : UnifiedOutput(checksumType)
   {
     open(fileName);
   }
@@ -105,6 +134,7 @@ public:
   void open(const std::string& fileName)
   {
     m_file.open(fileName);
+    m_file.setChecksum(m_checksum.get());
   }
 
   void writeData(const std::string& str)
@@ -121,34 +151,218 @@ private:
   GzipOutputFile m_file;
 }; //class GzipOutput;
 
+class GzipParallelOutput: public UnifiedOutput
+{
+public:
+  GzipParallelOutput(const std::string& fileName, size_t threadCount, char checksumType)
+    : UnifiedOutput(checksumType)
+  {
+    open(fileName, threadCount);
+  }
+
+  virtual ~GzipParallelOutput() 
+  {
+    close();
+  }
+
+public:
+  void open(const std::string& fileName, size_t threadCount)
+  {
+    m_file.open(fileName, threadCount);
+    m_file.setChecksum(m_checksum.get());
+  }
+
+  void writeData(const std::string& str)
+  {
+    m_file.write(str.c_str(), str.length());
+  }
+
+  void close()
+  {
+    m_file.close();
+  }
+
+private:
+  GzipParallelOutputFile m_file;
+}; //class GzipParallelOutput;
+
+#ifdef HAVE_ZSTD
+class ZstdOutput: public UnifiedOutput
+{
+public:
+  ZstdOutput(const std::string& fileName, size_t threadCount, char checksumType)
+    : UnifiedOutput(checksumType)
+  {
+    open(fileName, threadCount);
+  }
+
+  virtual ~ZstdOutput() 
+  {
+    close();
+  }
+
+public:
+  void open(const std::string& fileName, size_t threadCount)
+  {
+    m_file.open(fileName, ZSTD_COMPRESSION_LEVEL, threadCount);
+    m_file.setChecksum(m_checksum.get());
+  }
+
+  void writeData(const std::string& str)
+  {
+    m_file.write(str.c_str(), str.length());
+  }
+
+  void close()
+  {
+    m_file.close();
+  }
+
+private:
+  ZstdOutputFile m_file;
+}; //class ZstdOutput;
+#endif //HAVE_ZSTD;
+
+/*
+ * All expressions are joined into one alternation, so each line is
+ * checked by a single regexec() call. Expressions with back references
+ * can't be joined since the group numbers change, they are checked one
+ * by one. If every expression starts with an anchored literal prefix,
+ * lines beginning with none of the prefixes are rejected without any
+ * regexec() at all. The results are remembered for each line, since the
+ * same requires appear in many packages, up to a fixed number of lines.
+ */
 class RegExpCollection
 {
 public:
-  RegExpCollection() {}
+  RegExpCollection()
+    : m_hasJoined(0),
+      m_prefixesOnly(0) {}
+
   virtual ~RegExpCollection() {}
 
 public:
   void fill(const StringVector& exps)
   {
-    m_regExps.clear();
-    m_regExps.resize(exps.size());
+    m_joined.close();
+    m_hasJoined = 0;
+    m_prefixes.clear();
+    m_prefixesOnly = !exps.empty();
+    m_results.clear();
+    //Each expression is compiled alone first to report errors as before;
+    StringVector joinable, separate;
     for(StringVector::size_type i = 0;i < exps.size();i++)
       {
 	assert(!exps[i].empty());
-	m_regExps[i].compile(exps[i]);
+	RegExp re;
+	re.compile(exps[i]);
+	const std::string prefix = anchoredPrefix(exps[i]);
+	if (prefix.empty())
+	  m_prefixesOnly = 0; else
+	  m_prefixes.push_back(prefix);
+	if (hasBackRefs(exps[i]))
+	  separate.push_back(exps[i]); else
+	  joinable.push_back(exps[i]);
       }
+    if (joinable.size() == 1)
+      separate.push_back(joinable.front());
+    if (joinable.size() > 1)
+      {
+	std::string joined;
+	for(StringVector::size_type i = 0;i < joinable.size();i++)
+	  joined += (i > 0?"|(":"(") + joinable[i] + ")";
+	try {
+	  m_joined.compile(joined);
+	  m_hasJoined = 1;
+	}
+	catch(const RegExpException&)
+	  {
+	    logMsg(LOG_DEBUG, "index:unable to join %zu regular expressions, checking them separately", joinable.size());
+	    separate.insert(separate.end(), joinable.begin(), joinable.end());
+	  }
+      }
+    m_regExps.clear();
+    m_regExps.resize(separate.size());
+    for(StringVector::size_type i = 0;i < separate.size();i++)
+      m_regExps[i].compile(separate[i]);
+  }
+
+  bool matchAtLeastOne(const std::string& line)
+  {
+    if (!m_hasJoined && m_regExps.empty())
+      return 0;
+    std::unordered_map<std::string, bool>::const_iterator it = m_results.find(line);
+    if (it != m_results.end())
+      return it->second;
+    const bool res = match(line);
+    //Every index run has its own collection, the limit only keeps a huge run within bounded memory;
+    if (m_results.size() >= REGEXP_RESULTS_MAX_ENTRIES)
+      m_results.clear();
+    m_results.insert(std::unordered_map<std::string, bool>::value_type(line, res));
+    return res;
   }
 
-  bool matchAtLeastOne(const std::string& line) const
+private:
+  bool match(const std::string& line) const
   {
+    if (m_prefixesOnly)
+      {
+	StringVector::size_type i = 0;
+	while(i < m_prefixes.size() && line.compare(0, m_prefixes[i].length(), m_prefixes[i]) != 0)
+	  i++;
+	if (i >= m_prefixes.size())
+	  return 0;
+      }
+    if (m_hasJoined && m_joined.match(line))
+      return 1;
     for(RegExpVector::size_type i = 0;i < m_regExps.size();i++)
       if (m_regExps[i].match(line))
 	return 1;
     return 0;
   }
 
+  //The literal every matching line must begin with, empty if there is no such literal;
+  static std::string anchoredPrefix(const std::string& exp)
+  {
+    if (exp.empty() || exp[0] != '^' || exp.find('|') != std::string::npos)
+      return "";
+    std::string res;
+    std::string::size_type i = 1;
+    //Any escape ends the prefix, GNU extensions like \< or \` are zero-width;
+    while(i < exp.length())
+      {
+	const char c = exp[i];
+	if (strchr(".[]()*+?{}^$\\", c) != NULL)
+	  break;
+	res += c;
+	i++;
+      }
+    //The last character may be optional;
+    if (i < exp.length() && !res.empty() && strchr("*?{", exp[i]) != NULL)
+      res.resize(res.length() - 1);
+    return res;
+  }
+
+  static bool hasBackRefs(const std::string& exp)
+  {
+    for(std::string::size_type i = 0;i + 1 < exp.length();i++)
+      {
+	if (exp[i] != '\\')
+	  continue;
+	if (exp[i + 1] >= '1' && exp[i + 1] <= '9')
+	  return 1;
+	i++;
+      }
+    return 0;
+  }
+
 private:
   RegExpVector m_regExps;
+  RegExp m_joined;
+  bool m_hasJoined;
+  StringVector m_prefixes;
+  bool m_prefixesOnly;
+  std::unordered_map<std::string, bool> m_results;
 }; //class RegExpCollection;
 
 namespace 
@@ -157,19 +371,156 @@ namespace
   {
     if (compressionType == RepoParams::CompressionTypeGzip)
       return COMPRESSION_SUFFIX_GZIP;
+    if (compressionType == RepoParams::CompressionTypeZstd)
+      return COMPRESSION_SUFFIX_ZSTD;
     assert(compressionType == RepoParams::CompressionTypeNone);
     return "";
   }
 
-  bool fileFromDirs(const std::string& fileName, const StringVector& dirs)
+  //The patched files keep the checksum algorithm they have;
+  char itemChecksumType(const Md5File& md5File, const std::string& fileName)
   {
-    std::string tail;
-    for(StringVector::const_iterator it = dirs.begin();it != dirs.end();it++)
-      if (stringBegins(fileName, *it, tail))
-	return 1;
+    for(Md5File::ItemVector::size_type i = 0;i < md5File.items.size();i++)
+      if (md5File.items[i].fileName == fileName)
+	return md5File.items[i].checksumType;
+    return AbstractChecksum::TypeMd5;
+  }
+
+  //The change log is read only if it is saved in descriptions;
+  int pkgFileFields(const RepoParams& params, bool isSource)
+  {
+    if (isSource?params.changeLogSources:params.changeLogBinary)
+      return AbstractPkgBackEnd::PkgFieldAll;
+    return AbstractPkgBackEnd::PkgFieldAll & ~AbstractPkgBackEnd::PkgFieldChangeLog;
+  }
+
+  //The key of the repository index is the checksum of its md5sum file, it changes with any index file;
+  std::string indexRefsKey(const std::string& dirName, const RepoParams& repoParams)
+  {
+    if (repoParams.md5sumFileName.empty())
+      return "";
+    const std::string md5sumFileName = Directory::mixNameComponents(dirName, repoParams.md5sumFileName);
+    std::ifstream is(md5sumFileName.c_str(), std::ios::binary);
+    if (!is.is_open())
+      return "";
+    Md5 md5;
+    md5.init();
+    char buf[4096];
+    while(is)
+      {
+	is.read(buf, sizeof(buf));
+	md5.update(buf, is.gcount());
+      }
+    return md5.commit();
+  }
+
+  //Without index the packages are considered unchanged if their names, sizes and modification times are the same;
+  std::string pkgDirRefsKey(const std::string& dirName, const AbstractPkgBackEnd& backend)
+  {
+    StringVector entries;
+    Directory::Iterator::Ptr it = Directory::enumerate(dirName);
+    while(it->moveNext())
+      {
+	if (it->name() == "." || it->name() == "..")
+	  continue;
+	if (!backend.validPkgFileName(it->name()))
+	  continue;
+	struct stat st;
+	if (stat(it->fullPath().c_str(), &st) != 0)
+	  return "";
+	std::ostringstream ss;
+	ss << it->name() << " " << st.st_size << " " << st.st_mtime << std::endl;
+	entries.push_back(ss.str());
+      }
+    std::sort(entries.begin(), entries.end());
+    Md5 md5;
+    md5.init();
+    for(StringVector::size_type i = 0;i < entries.size();i++)
+      md5.update(entries[i].c_str(), entries[i].length());
+    return md5.commit();
+  }
+
+  //Each reference source has its own cache file in our index, named by the checksum of the source path;
+  std::string refsCacheFileName(const std::string& indexPath, const std::string& dirName)
+  {
+    std::string path = dirName;
+    char* resolved = realpath(dirName.c_str(), NULL);
+    if (resolved != NULL)
+      {
+	path = resolved;
+	free(resolved);
+      }
+    Md5 md5;
+    md5.init();
+    md5.update(path.c_str(), path.length());
+    return Directory::mixNameComponents(indexPath, std::string(REPO_REFS_CACHE_FILE) + "." + md5.commit());
+  }
+
+  bool loadRefsCache(const std::string& fileName, const std::string& dirName, const std::string& key, StringHashSet& res)
+  {
+    if (key.empty())
+      return 0;
+    std::ifstream is(fileName.c_str());
+    if (!is.is_open())
+      return 0;
+    std::string line;
+    if (!std::getline(is, line) || line != REFS_CACHE_HEADER + key)
+      return 0;
+    //The trailer with the number of entries confirms the file is complete;
+    while(std::getline(is, line))
+      {
+	std::string tail;
+	if (!stringBegins(line, REFS_CACHE_TRAILER, tail))
+	  {
+	    res.insert(line);
+	    continue;
+	  }
+	std::ostringstream ss;
+	ss << res.size();
+	if (tail == ss.str() && !std::getline(is, line))
+	  return 1;
+	break;
+      }
+    logMsg(LOG_WARNING, "index:ignoring incomplete references cache in '%s'", dirName.c_str());
+    res.clear();
     return 0;
   }
 
+  //The failed saving only leaves the references without the cache;
+  void saveRefsCache(const std::string& fileName, const std::string& dirName, const std::string& key, const StringHashSet& refs)
+  {
+    if (key.empty())
+      return;
+    std::ostringstream ss;
+    ss << REFS_CACHE_HEADER << key << std::endl;
+    for(StringHashSet::const_iterator it = refs.begin();it != refs.end();it++)
+      ss << *it << std::endl;
+    ss << REFS_CACHE_TRAILER << refs.size() << std::endl;
+    const std::string s = ss.str();
+    File f;
+    std::string tmpFileName;
+    try {
+      tmpFileName = f.createUnique(fileName);
+    }
+    catch(const SystemException& e)
+      {
+	logMsg(LOG_DEBUG, "index:references of '%s' are not cached:%s", dirName.c_str(), e.getMessage().c_str());
+	return;
+      }
+    try {
+      f.write(s.c_str(), s.length());
+      f.close();
+      File::move(tmpFileName, fileName);
+      logMsg(LOG_DEBUG, "index:%zu references of '%s' saved to '%s'", refs.size(), dirName.c_str(), fileName.c_str());
+    }
+    catch(const AbstractException& e)
+      {
+	f.close();
+	::unlink(tmpFileName.c_str());
+	logMsg(LOG_WARNING, "index:unable to save references cache '%s':%s", fileName.c_str(), e.getMessage().c_str());
+      }
+  }
+
   AbstractTextFormatSectionReader::Ptr createRebuildReader(const std::string& fileName, const RepoParams& params)
   {
     if (params.compressionType == RepoParams::CompressionTypeNone)
@@ -184,6 +535,16 @@ namespace
 	reader->open(fileName);
 	return reader;
       }
+    if (params.compressionType == RepoParams::CompressionTypeZstd)
+      {
+#ifdef HAVE_ZSTD
+	TextFormatSectionReaderZstd::Ptr reader(new TextFormatSectionReaderZstd());
+	reader->open(fileName);
+	return reader;
+#else
+	throw ZstdException("Zstandard support is not built in");
+#endif //HAVE_ZSTD;
+      }
     assert(0);
     return NULL;
   }
@@ -195,14 +556,94 @@ namespace
     return reader;
   }
 
-  UnifiedOutput::Ptr createRebuildWriter(const std::string& fileName, const RepoParams& params)
+  void splitSectionLines(const std::string& sect, StringVector& lines)
+  {
+    lines.clear();
+    std::string line;
+    for(std::string::size_type i = 0;i < sect.length();i++)
+      {
+	if (sect[i] == '\r')
+	  continue;
+	if (sect[i] == '\n')
+	  {
+	    line = trim(line);
+	    if (!line.empty())
+	      lines.push_back(line);
+	    line.erase();
+	    continue;
+	  }
+	line += sect[i];
+      }
+    line = trim(line);
+    if (!line.empty())
+      lines.push_back(line);
+  }
+
+  //The snapshot is made of the final packages file, so clients get exactly what they would parse from the text;
+  class ComponentSnapshotWriter: private AutoReleaseStrings
+  {
+  public:
+    void write(const RepoParams& params)
+    {
+      const std::string pkgFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_FILE + compressionExtension(params.compressionType));
+      const std::string snapshotFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_SNAPSHOT_FILE);
+      logMsg(LOG_INFO, "Writing component snapshot \'%s\'", snapshotFileName.c_str());
+      PkgSnapshot::Snapshot snapshot;
+      StringToPkgIdMap stringToPkgIdMap;
+      StringVector fileNames, arches;
+      size_t invalidLineNum;
+      std::string invalidLineValue;
+      std::string sect;
+      StringVector lines;
+      AbstractTextFormatSectionReader::Ptr reader = createRebuildReader(pkgFileName, params);
+      reader->init();
+      while(reader->readNext(sect))
+	{
+	  PkgFile pkgFile;
+	  splitSectionLines(sect, lines);
+	  if (!PkgSection::parsePkgFileSection(lines, pkgFile, invalidLineNum, invalidLineValue) || !pkgFile.valid())
+	    throw IndexCoreException(IndexCoreException::CorruptedFile, pkgFileName);
+	  PkgSnapshot::addNewPkg(snapshot, pkgFile, m_autoReleaseStrings, stringToPkgIdMap);
+	  fileNames.push_back(pkgFile.fileName);
+	  arches.push_back(pkgFile.arch);
+	}
+      reader->close();
+      PkgSnapshot::saveComponentToFile(snapshot, fileNames, arches, snapshotFileName);
+      logMsg(LOG_DEBUG, "Component snapshot has %zu packages with %zu names", snapshot.pkgs.size(), snapshot.pkgNames.size());
+    }
+  }; //class ComponentSnapshotWriter;
+
+  //The parameters affecting the content of sections must be the same for the whole index;
+  bool sameIndexParams(const RepoParams& params1, const RepoParams& params2)
+  {
+    return params1.compressionType == params2.compressionType &&
+      params1.formatType == params2.formatType &&
+      params1.filterProvidesByDirs == params2.filterProvidesByDirs &&
+      params1.filterProvidesByRefs == params2.filterProvidesByRefs &&
+      params1.excludeRequiresRegExp == params2.excludeRequiresRegExp &&
+      params1.changeLogBinary == params2.changeLogBinary &&
+      params1.changeLogSources == params2.changeLogSources &&
+      params1.userParams == params2.userParams;
+  }
+
+  UnifiedOutput::Ptr createRebuildWriter(const std::string& fileName,
+					 const RepoParams& params,
+					 char checksumType)
   {
     switch (params.compressionType)
       {
       case RepoParams::CompressionTypeNone:
-	return UnifiedOutput::Ptr(new StdOutput(fileName));
+	return UnifiedOutput::Ptr(new StdOutput(fileName, checksumType));
       case RepoParams::CompressionTypeGzip:
-	return UnifiedOutput::Ptr(new GzipOutput(fileName));
+	if (params.compressionThreads > 0)
+	  return UnifiedOutput::Ptr(new GzipParallelOutput(fileName, params.compressionThreads, checksumType));
+	return UnifiedOutput::Ptr(new GzipOutput(fileName, checksumType));
+      case RepoParams::CompressionTypeZstd:
+#ifdef HAVE_ZSTD
+	return UnifiedOutput::Ptr(new ZstdOutput(fileName, params.compressionThreads, checksumType));
+#else
+	throw ZstdException("Zstandard support is not built in");
+#endif //HAVE_ZSTD;
       default:
 	assert(0);
       }
@@ -221,19 +662,20 @@ void IndexCore::buildIndex(const RepoParams& params)
   RegExpCollection regExps;
   regExps.fill(params.excludeRequiresRegExp);
   params.writeInfoFile(Directory::mixNameComponents(params.indexPath, REPO_INDEX_INFO_FILE));
-  StringSet internalProvidesRefs, externalProvidesRefs;
+  //Internal and external references go to the same set, the provide is kept if it is in either of them;
+  StringHashSet providesRefs;
   logMsg(LOG_DEBUG, "index:Has %zu provide references given with repository params, adding them to external references set", params.providesRefs.size());
     for(StringVector::size_type i = 0;i < params.providesRefs.size();i++)
-      externalProvidesRefs.insert(params.providesRefs[i]);
+      providesRefs.insert(params.providesRefs[i]);
   if (params.filterProvidesByRefs)
     {
       logMsg(LOG_DEBUG, "Provides filtering by references is enabled, has %zu sources of external references", params.providesRefsSources.size());
       for(StringVector::size_type i = 0;i < params.providesRefsSources.size();i++)
 	{
 	  m_listener.onReferenceCollecting(params.providesRefsSources[i]);
-	  collectRefs(params.providesRefsSources[i], externalProvidesRefs);
+	  collectRefs(params.indexPath, params.providesRefsSources[i], providesRefs);
 	}
-      logMsg(LOG_DEBUG, "Has %zu external provides references", externalProvidesRefs.size());
+      logMsg(LOG_DEBUG, "Has %zu external provides references", providesRefs.size());
     } else 
     {
       logMsg(LOG_DEBUG, "Provides filtering by references is disabled, skipping collecting of external  references");
@@ -247,24 +689,18 @@ void IndexCore::buildIndex(const RepoParams& params)
   const std::string pkgFileListFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_FILELIST_FILE + compressionExtension(params.compressionType));
   const std::string pkgCompleteFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_COMPLETE_FILE);
   UnifiedOutput::Ptr pkgFile, pkgDescrFile, pkgFileListFile, pkgCompleteFile, srcFile, srcDescrFile;
-  if (params.compressionType == RepoParams::CompressionTypeGzip)
-    {
-      pkgFile = UnifiedOutput::Ptr(new GzipOutput(pkgFileName));
-      pkgDescrFile = UnifiedOutput::Ptr(new GzipOutput(pkgDescrFileName));
-      pkgFileListFile = UnifiedOutput::Ptr(new GzipOutput(pkgFileListFileName));
-      srcFile = UnifiedOutput::Ptr(new GzipOutput(srcFileName));
-      srcDescrFile = UnifiedOutput::Ptr(new GzipOutput(srcDescrFileName));
-    } else 
-    {
-      assert(params.compressionType == RepoParams::CompressionTypeNone);
-      pkgFile = UnifiedOutput::Ptr(new StdOutput(pkgFileName));
-      pkgDescrFile = UnifiedOutput::Ptr(new StdOutput(pkgDescrFileName));
-      pkgFileListFile = UnifiedOutput::Ptr(new StdOutput(pkgFileListFileName));
-      srcFile = UnifiedOutput::Ptr(new StdOutput(srcFileName));
-      srcDescrFile = UnifiedOutput::Ptr(new StdOutput(srcDescrFileName));
-    }
+  pkgFile = createRebuildWriter(pkgFileName, params, params.checksumType);
+  pkgDescrFile = createRebuildWriter(pkgDescrFileName, params, params.checksumType);
+  pkgFileListFile = createRebuildWriter(pkgFileListFileName, params, params.checksumType);
+  srcFile = createRebuildWriter(srcFileName, params, params.checksumType);
+  srcDescrFile = createRebuildWriter(srcDescrFileName, params, params.checksumType);
   pkgCompleteFile = UnifiedOutput::Ptr(new StdOutput(pkgCompleteFileName));
   logMsg(LOG_DEBUG, "All files were created");
+  //Binary packages sections are kept in memory to be filtered without reading the complete file back;
+  StringVector completeSections;
+  size_t completeSize = 0;
+  bool completeBuffered = params.filterProvidesByRefs;
+  IndexManifest manifest;
   AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
   logMsg(LOG_DEBUG, "Package backend was created");
   //We ready to collect information about packages in specified directories;
@@ -281,9 +717,13 @@ void IndexCore::buildIndex(const RepoParams& params)
 	  if (!backend->validPkgFileName(it->name()))
 	    continue;
 	  PkgFile pkg;
-	  backend->readPkgFile(it->fullPath(), pkg);
-	  pkg.fileName = it->name();
 	  pkg.isSource = backend->validSourcePkgFileName(it->name());
+	  IndexManifest::Item item;
+	  IndexManifest::statItem(it->fullPath(), item);
+	  item.fileName = it->name();
+	  backend->readPkgFile(it->fullPath(), pkg, pkgFileFields(params, pkg.isSource), &item.digest);
+	  pkg.fileName = it->name();
+	  manifest.items.push_back(item);
 	  NamedPkgRelVector requires = pkg.requires;
 	  pkg.requires.clear();
 	  for(NamedPkgRelVector::size_type i = 0;i < requires.size();i++)
@@ -292,9 +732,9 @@ void IndexCore::buildIndex(const RepoParams& params)
 	  if (params.filterProvidesByRefs)
 	    {
 	      for(NamedPkgRelVector::size_type k = 0;k < pkg.requires.size();k++)
-		internalProvidesRefs.insert(pkg.requires[k].pkgName);
+		providesRefs.insert(pkg.requires[k].pkgName);
 	      for(NamedPkgRelVector::size_type k = 0;k < pkg.conflicts.size();k++)
-		internalProvidesRefs.insert(pkg.conflicts[k].pkgName);
+		providesRefs.insert(pkg.conflicts[k].pkgName);
 	    }
 	  if (!pkg.isSource)
 	    {
@@ -303,7 +743,19 @@ void IndexCore::buildIndex(const RepoParams& params)
 		pkgFile->writeData(PkgSection::saveBaseInfo(pkg, params.filterProvidesByRefs?StringVector():params.filterProvidesByDirs));
 	      pkgDescrFile->writeData(PkgSection::saveDescr(pkg, params.changeLogBinary));
 	      pkgFileListFile->writeData(PkgSection::saveFileList(pkg));
-	      pkgCompleteFile->writeData(PkgSection::saveBaseInfo(pkg, StringVector()));
+	      const std::string completeSection = PkgSection::saveBaseInfo(pkg, StringVector());
+	      pkgCompleteFile->writeData(completeSection);
+	      if (completeBuffered)
+		{
+		  completeSize += completeSection.length();
+		  if (completeSize <= PROVIDES_FILTER_BUFFER_SIZE)
+		    completeSections.push_back(completeSection); else
+		    {
+		      logMsg(LOG_DEBUG, "index:complete packages data exceeds %zu bytes, provides filtering will read it from \'%s\'", (size_t)PROVIDES_FILTER_BUFFER_SIZE, pkgCompleteFileName.c_str());
+		      StringVector().swap(completeSections);
+		      completeBuffered = 0;
+		    }
+		}
 	    } else
 	    {
 	      countSource++;
@@ -323,28 +775,24 @@ void IndexCore::buildIndex(const RepoParams& params)
   //Additional phase for provides filtering if needed;
   if (params.filterProvidesByRefs)
     {
-    logMsg(LOG_INFO, "Performing additional phase for provides cleaning, has %zu internal provides references and %zu external provides references", internalProvidesRefs.size(), externalProvidesRefs.size());
+      ProvidesFilter filter(1, params.filterProvidesByDirs);
+      filter.setRefs(providesRefs);
+      logMsg(LOG_INFO, "Performing additional phase for provides cleaning, has %zu provides references", filter.getRefCount());
       m_listener.onProvidesCleaning();
-      std::ifstream is(pkgCompleteFileName.c_str());
-      if (!is.is_open())
-	throw 0;//FIXME:InternalProblem;
-      while(1)
+      if (completeBuffered)
 	{
-	  std::string line;
-	  std::getline(is, line);
-	  if (!is)
-	    break;
-	  std::string pkgName;
-	  if (!PkgSection::isProvidesLine(line, pkgName))
-	    {
-	      pkgFile->writeData(line + "\n");
-	      continue;
-	    }
-	  if (internalProvidesRefs.find(pkgName) != internalProvidesRefs.end() || 
-	  externalProvidesRefs.find(pkgName) != externalProvidesRefs.end() ||
-	  (!params.filterProvidesByDirs.empty() && fileFromDirs(pkgName, params.filterProvidesByDirs)))
-	pkgFile->writeData(line + "\n");
-	} //for(lines);
+	  for(StringVector::size_type i = 0;i < completeSections.size();i++)
+	    pkgFile->writeData(PkgSection::filterProvides(completeSections[i], filter));
+	  StringVector().swap(completeSections);
+	} else
+	{
+	  AbstractTextFormatSectionReader::Ptr reader = createRebuildReaderNoCompression(pkgCompleteFileName);
+	  std::string sect;
+	  reader->init();
+	  while(reader->readNext(sect))
+	    pkgFile->writeData(PkgSection::filterProvides(sect, filter));
+	  reader->close();
+	}
       pkgFile->close();
       logMsg(LOG_DEBUG, "Provides filtering completed");
     } else 
@@ -353,19 +801,24 @@ void IndexCore::buildIndex(const RepoParams& params)
   m_listener.onChecksumWriting();
   Md5File md5;
   logMsg(LOG_DEBUG, "Registering \'%s\'", Directory::mixNameComponents(params.indexPath, REPO_INDEX_INFO_FILE).c_str());
-  md5.addItemFromFile(REPO_INDEX_INFO_FILE, Directory::mixNameComponents(params.indexPath, REPO_INDEX_INFO_FILE));
+  md5.addItemFromFile(REPO_INDEX_INFO_FILE, Directory::mixNameComponents(params.indexPath, REPO_INDEX_INFO_FILE), params.checksumType);
   logMsg(LOG_DEBUG, "Registering \'%s\'", pkgFileName.c_str());
-  md5.addItemFromFile(File::baseName(pkgFileName), pkgFileName);
+  md5.addItem(File::baseName(pkgFileName), pkgFile->getChecksum(), params.checksumType);
   logMsg(LOG_DEBUG, "Registering \'%s\'", pkgDescrFileName.c_str());
-  md5.addItemFromFile(File::baseName(pkgDescrFileName), pkgDescrFileName);
+  md5.addItem(File::baseName(pkgDescrFileName), pkgDescrFile->getChecksum(), params.checksumType);
   logMsg(LOG_DEBUG, "Registering \'%s\'", pkgFileListFileName.c_str());
-  md5.addItemFromFile(File::baseName(pkgFileListFileName), pkgFileListFileName);
+  md5.addItem(File::baseName(pkgFileListFileName), pkgFileListFile->getChecksum(), params.checksumType);
   logMsg(LOG_DEBUG, "Registering \'%s\'", srcFileName.c_str());
-  md5.addItemFromFile(File::baseName(srcFileName), srcFileName);
+  md5.addItem(File::baseName(srcFileName), srcFile->getChecksum(), params.checksumType);
   logMsg(LOG_DEBUG, "Registering \'%s\'", srcDescrFileName.c_str());
-  md5.addItemFromFile(File::baseName(srcDescrFileName), srcDescrFileName);
+  md5.addItem(File::baseName(srcDescrFileName), srcDescrFile->getChecksum(), params.checksumType);
+  ComponentSnapshotWriter().write(params);
+  logMsg(LOG_DEBUG, "Registering \'%s\'", REPO_INDEX_PACKAGES_SNAPSHOT_FILE);
+  md5.addItemFromFile(REPO_INDEX_PACKAGES_SNAPSHOT_FILE, Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_SNAPSHOT_FILE), params.checksumType);
   logMsg(LOG_INFO, "Writing md5sum file");
   md5.saveToFile(Directory::mixNameComponents(params.indexPath, REPO_INDEX_MD5SUM_FILE));
+  logMsg(LOG_DEBUG, "Writing index manifest with %zu package files", manifest.items.size());
+  manifest.saveToFile(Directory::mixNameComponents(params.indexPath, REPO_INDEX_MANIFEST_FILE));
   logMsg(LOG_DEBUG, "Exiting index building procedure, everything done successfully");
 }
 
@@ -380,21 +833,18 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   logMsg(LOG_INFO, "Verifying md5sums");
   Md5File md5File;
   md5File.loadFromFile(Directory::mixNameComponents(params.indexPath, params.md5sumFileName));
-  for(Md5File::ItemVector::size_type i = 0;i < md5File.items.size();i++)
-    {
-      logMsg(LOG_DEBUG, "Verifying checksum for \'%s\'", Directory::mixNameComponents(params.indexPath, md5File.items[i].fileName).c_str());
-      if (!md5File.verifyItem(i, Directory::mixNameComponents(params.indexPath, md5File.items[i].fileName)))
-	throw IndexCoreException(IndexCoreException::CorruptedFile, Directory::mixNameComponents(params.indexPath, md5File.items[i].fileName));
-    }
+  size_t invalidItem;
+  if (!md5File.verifyItems(params.indexPath, invalidItem))
+    throw IndexCoreException(IndexCoreException::CorruptedFile, Directory::mixNameComponents(params.indexPath, md5File.items[invalidItem].fileName));
   AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
   PkgFileVector pkgs;
   pkgs.resize(toAdd.size());
   logMsg(LOG_INFO, "Reading packages to add (%zu total)", pkgs.size());
   for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
     {
-      backend->readPkgFile(toAdd[i], pkgs[i]);
-      pkgs[i].fileName = File::baseName(toAdd[i]);
       pkgs[i].isSource = backend->validSourcePkgFileName(toAdd[i]);
+      backend->readPkgFile(toAdd[i], pkgs[i], pkgFileFields(params, pkgs[i].isSource));
+      pkgs[i].fileName = File::baseName(toAdd[i]);
       NamedPkgRelVector requires = pkgs[i].requires;
       pkgs[i].requires.clear();
       for(NamedPkgRelVector::size_type j = 0;j < requires.size();j++)
@@ -407,6 +857,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   std::string inputFileName, outputFileName;
   AbstractTextFormatSectionReader::Ptr reader;
     UnifiedOutput::Ptr writer;
+  StringToStringMap checksums;//The checksum of every patched file by its base name;
 
     //Packages file;
   for(BoolVector::size_type i = 0;i < skipToAdd.size();i++)
@@ -416,13 +867,23 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   logMsg(LOG_INFO, "Patching \'%s\' to \'%s\'", inputFileName.c_str(), outputFileName.c_str());
   m_listener.onPatchingFile(inputFileName);
   reader = createRebuildReader(inputFileName, params);
-  writer = createRebuildWriter(outputFileName, params);
+  writer = createRebuildWriter(outputFileName, params, itemChecksumType(md5File, File::baseName(inputFileName)));
   reader->init();
   while(reader->readNext(sect))
     {
       const std::string fileName = PkgSection::getPkgFileName(sect);
           if(fileName.empty())
 	    throw 0;//FIXME:InternalProblem;
+      //The package being removed may be added again with new content;
+      StringVector::size_type i = 0;
+      for(i = 0;i < toRemove.size();i++)
+	if (fileName == toRemove[i])
+	  break;
+      if (i < toRemove.size())
+	{
+	  logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+	  continue;
+	}
       for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
 	{
 	  if (fileName != pkgs[i].fileName)
@@ -431,23 +892,18 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	  logMsg(LOG_WARNING, "File \'%s\' already present in index \'%s\', skipping adding", fileName.c_str(), inputFileName.c_str());
 	  m_listener.onNoTwiceAdding(fileName);
 	}
-      StringVector::size_type i = 0;
-      for(i = 0;i < toRemove.size();i++)
-	if (fileName == toRemove[i])
-	  break;
-      if (i >= toRemove.size())
-	writer->writeData(sect); else
-	logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+      writer->writeData(sect);
     }
   for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
     if (!pkgs[i].isSource)
       if (!skipToAdd[i])
 	{
-	  writer->writeData(PkgSection::saveBaseInfo(pkgs[i], StringVector()));
+	  writer->writeData(PkgSection::saveBaseInfo(pkgs[i], params.filterProvidesByRefs?StringVector():params.filterProvidesByDirs));
 	  logMsg(LOG_DEBUG, "File \'%s\' added to index", pkgs[i].fileName.c_str());
 	}
   reader->close();
   writer->close();
+  checksums[File::baseName(inputFileName)] = writer->getChecksum();
   File::unlink(inputFileName);
   File::move(outputFileName, inputFileName);
 
@@ -459,13 +915,23 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   logMsg(LOG_INFO, "Patching \'%s\' to \'%s\'", inputFileName.c_str(), outputFileName.c_str());
   m_listener.onPatchingFile(inputFileName);
   reader = createRebuildReader(inputFileName, params);
-  writer = createRebuildWriter(outputFileName, params);
+  writer = createRebuildWriter(outputFileName, params, itemChecksumType(md5File, File::baseName(inputFileName)));
   reader->init();
   while(reader->readNext(sect))
     {
       const std::string fileName = PkgSection::getPkgFileName(sect);
       if(fileName.empty())
 	throw 0;//FIXME:InternalProblem;
+      //The package being removed may be added again with new content;
+      StringVector::size_type i = 0;
+      for(i = 0;i < toRemove.size();i++)
+	if (fileName == toRemove[i])
+	  break;
+      if (i < toRemove.size())
+	{
+	  logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+	  continue;
+	}
       for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
 	{
 	  if (fileName != pkgs[i].fileName)
@@ -474,13 +940,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	  logMsg(LOG_WARNING, "File \'%s\' already present in index \'%s\', skipping adding", fileName.c_str(), inputFileName.c_str());
 	  m_listener.onNoTwiceAdding(fileName);
 	}
-      StringVector::size_type i = 0;
-      for(i = 0;i < toRemove.size();i++)
-	if (fileName == toRemove[i])
-	  break;
-      if (i >= toRemove.size())
-	writer->writeData(sect); else
-	logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+      writer->writeData(sect);
     }
   for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
     if (!pkgs[i].isSource)
@@ -491,6 +951,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	}
   reader->close();
   writer->close();
+  checksums[File::baseName(inputFileName)] = writer->getChecksum();
   File::unlink(inputFileName);
   File::move(outputFileName, inputFileName);
 
@@ -502,13 +963,23 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   logMsg(LOG_INFO, "Patching \'%s\' to \'%s\'", inputFileName.c_str(), outputFileName.c_str());
   m_listener.onPatchingFile(inputFileName);
   reader = createRebuildReader(inputFileName, params);
-  writer = createRebuildWriter(outputFileName, params);
+  writer = createRebuildWriter(outputFileName, params, itemChecksumType(md5File, File::baseName(inputFileName)));
   reader->init();
   while(reader->readNext(sect))
     {
       const std::string fileName = PkgSection::getPkgFileName(sect);
       if(fileName.empty())
 	throw 0;//FIXME:InternalProblem;
+      //The package being removed may be added again with new content;
+      StringVector::size_type i = 0;
+      for(i = 0;i < toRemove.size();i++)
+	if (fileName == toRemove[i])
+	  break;
+      if (i < toRemove.size())
+	{
+	  logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+	  continue;
+	}
       for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
 	{
 	  if (fileName != pkgs[i].fileName)
@@ -517,23 +988,18 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	  logMsg(LOG_WARNING, "File \'%s\' already present in index \'%s\', skipping adding", fileName.c_str(), inputFileName.c_str());
 	  m_listener.onNoTwiceAdding(fileName);
 	}
-      StringVector::size_type i = 0;
-      for(i = 0;i < toRemove.size();i++)
-	if (fileName == toRemove[i])
-	  break;
-      if (i >= toRemove.size())
-	writer->writeData(sect); else
-	logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+      writer->writeData(sect);
     }
   for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
     if (pkgs[i].isSource)
       if (!skipToAdd[i])
 	{
-	  writer->writeData(PkgSection::saveBaseInfo(pkgs[i], StringVector()));
+	  writer->writeData(PkgSection::saveBaseInfo(pkgs[i], params.filterProvidesByRefs?StringVector():params.filterProvidesByDirs));
 	  logMsg(LOG_DEBUG, "File \'%s\' added to index", pkgs[i].fileName.c_str());
 	}
   reader->close();
   writer->close();
+  checksums[File::baseName(inputFileName)] = writer->getChecksum();
   File::unlink(inputFileName);
   File::move(outputFileName, inputFileName);
 
@@ -545,13 +1011,23 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   logMsg(LOG_INFO, "Patching \'%s\' to \'%s\'", inputFileName.c_str(), outputFileName.c_str());
   m_listener.onPatchingFile(inputFileName);
   reader = createRebuildReader(inputFileName, params);
-  writer = createRebuildWriter(outputFileName, params);
+  writer = createRebuildWriter(outputFileName, params, itemChecksumType(md5File, File::baseName(inputFileName)));
   reader->init();
   while(reader->readNext(sect))
     {
       const std::string fileName = PkgSection::getPkgFileName(sect);
       if(fileName.empty())
 	throw 0;//FIXME:InternalProblem;
+      //The package being removed may be added again with new content;
+      StringVector::size_type i = 0;
+      for(i = 0;i < toRemove.size();i++)
+	if (fileName == toRemove[i])
+	  break;
+      if (i < toRemove.size())
+	{
+	  logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+	  continue;
+	}
       for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
 	{
 	  if (fileName != pkgs[i].fileName)
@@ -560,13 +1036,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	  logMsg(LOG_WARNING, "File \'%s\' already present in index \'%s\', skipping adding", fileName.c_str(), inputFileName.c_str());
 	  m_listener.onNoTwiceAdding(fileName);
 	}
-      StringVector::size_type i = 0;
-      for(i = 0;i < toRemove.size();i++)
-	if (fileName == toRemove[i])
-	  break;
-      if (i >= toRemove.size())
-	writer->writeData(sect); else
-	logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+      writer->writeData(sect);
     }
   for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
     if (pkgs[i].isSource)
@@ -577,6 +1047,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	}
   reader->close();
   writer->close();
+  checksums[File::baseName(inputFileName)] = writer->getChecksum();
   File::unlink(inputFileName);
   File::move(outputFileName, inputFileName);
 
@@ -588,13 +1059,23 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   logMsg(LOG_INFO, "Patching \'%s\' to \'%s\'", inputFileName.c_str(), outputFileName.c_str());
   m_listener.onPatchingFile(inputFileName);
   reader = createRebuildReaderNoCompression(inputFileName);
-  writer = UnifiedOutput::Ptr(new StdOutput(outputFileName));
+  writer = UnifiedOutput::Ptr(new StdOutput(outputFileName, itemChecksumType(md5File, File::baseName(inputFileName))));
   reader->init();
   while(reader->readNext(sect))
     {
       const std::string fileName = PkgSection::getPkgFileName(sect);
       if(fileName.empty())
 	throw 0;//FIXME:INternalProblem;
+      //The package being removed may be added again with new content;
+      StringVector::size_type i = 0;
+      for(i = 0;i < toRemove.size();i++)
+	if (fileName == toRemove[i])
+	  break;
+      if (i < toRemove.size())
+	{
+	  logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+	  continue;
+	}
       for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
 	{
 	  if (fileName != pkgs[i].fileName)
@@ -603,13 +1084,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	  logMsg(LOG_WARNING, "File \'%s\' already present in index \'%s\', skipping adding", fileName.c_str(), inputFileName.c_str());
 	  m_listener.onNoTwiceAdding(fileName);
 	}
-      StringVector::size_type i = 0;
-      for(i = 0;i < toRemove.size();i++)
-	if (fileName == toRemove[i])
-	  break;
-      if (i >= toRemove.size())
-	writer->writeData(sect); else
-	logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+      writer->writeData(sect);
     }
   for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
     if (!pkgs[i].isSource)
@@ -620,6 +1095,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	}
   reader->close();
   writer->close();
+  checksums[File::baseName(inputFileName)] = writer->getChecksum();
   File::unlink(inputFileName);
   File::move(outputFileName, inputFileName);
 
@@ -631,13 +1107,23 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
   logMsg(LOG_INFO, "Patching \'%s\' to \'%s\'", inputFileName.c_str(), outputFileName.c_str());
   m_listener.onPatchingFile(inputFileName);
   reader = createRebuildReader(inputFileName, params);
-  writer = createRebuildWriter(outputFileName, params);
+  writer = createRebuildWriter(outputFileName, params, itemChecksumType(md5File, File::baseName(inputFileName)));
   reader->init();
   while(reader->readNext(sect))
     {
       const std::string fileName = PkgSection::getPkgFileName(sect);
       if(fileName.empty())
 	throw 0;//FIXME:InternalProblem;
+      //The package being removed may be added again with new content;
+      StringVector::size_type i = 0;
+      for(i = 0;i < toRemove.size();i++)
+	if (fileName == toRemove[i])
+	  break;
+      if (i < toRemove.size())
+	{
+	  logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+	  continue;
+	}
       for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
 	{
 	  if (fileName != pkgs[i].fileName)
@@ -646,13 +1132,7 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	  logMsg(LOG_WARNING, "File \'%s\' already present in index \'%s\', skipping adding", fileName.c_str(), inputFileName.c_str());
 	  m_listener.onNoTwiceAdding(fileName);
 	}
-      StringVector::size_type i = 0;
-      for(i = 0;i < toRemove.size();i++)
-	if (fileName == toRemove[i])
-	  break;
-      if (i >= toRemove.size())
-	writer->writeData(sect); else
-	logMsg(LOG_DEBUG, "Found package to exclude: \'%s\'", fileName.c_str());
+      writer->writeData(sect);
     }
   for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
     if (!pkgs[i].isSource)
@@ -663,23 +1143,130 @@ void IndexCore::rebuildIndex(const RepoParams& params, const StringVector& toAdd
 	}
   reader->close();
   writer->close();
+  checksums[File::baseName(inputFileName)] = writer->getChecksum();
   File::unlink(inputFileName);
   File::move(outputFileName, inputFileName);
 
+  ComponentSnapshotWriter().write(params);
+
   logMsg(LOG_INFO, "Updating md5sums");
   m_listener.onChecksumWriting();
   StringVector files;
   for(Md5File::ItemVector::size_type i = 0;i < md5File.items.size();i++)
     if (md5File.items[i].fileName != REPO_INDEX_INFO_FILE)
       files.push_back(md5File.items[i].fileName);
+  std::map<std::string, char> checksumTypes;
+  for(StringVector::size_type i = 0;i < files.size();i++)
+    checksumTypes[files[i]] = itemChecksumType(md5File, files[i]);
   for(StringVector::size_type i = 0;i < files.size();i++)
     md5File.removeItem(files[i]);
   for(StringVector::size_type i = 0;i < files.size();i++)
-    md5File.addItemFromFile(files[i], Directory::mixNameComponents(params.indexPath, files[i]));
+    {
+      StringToStringMap::const_iterator it = checksums.find(files[i]);
+      if (it != checksums.end())
+	md5File.addItem(files[i], it->second, checksumTypes[files[i]]); else
+	md5File.addItemFromFile(files[i], Directory::mixNameComponents(params.indexPath, files[i]), checksumTypes[files[i]]);
+    }
+  //Indices made before component snapshots were introduced get it with the first patching;
+  if (checksumTypes.find(REPO_INDEX_PACKAGES_SNAPSHOT_FILE) == checksumTypes.end())
+    md5File.addItemFromFile(REPO_INDEX_PACKAGES_SNAPSHOT_FILE, Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_SNAPSHOT_FILE), itemChecksumType(md5File, REPO_INDEX_PACKAGES_SNAPSHOT_FILE));
   md5File.saveToFile(Directory::mixNameComponents(params.indexPath, params.md5sumFileName));
   logMsg(LOG_DEBUG, "Repository index in \'%s\' fixing completed successfully", params.indexPath.c_str());
 }
 
+void IndexCore::updateIndex(const RepoParams& params)
+{
+  assert(!params.indexPath.empty());
+  assert(!params.pkgSources.empty());
+  Directory::ensureExists(params.indexPath);
+  if (Directory::empty(params.indexPath))
+    {
+      logMsg(LOG_INFO, "Index directory \'%s\' is empty, building the index from scratch", params.indexPath.c_str());
+      buildIndex(params);
+      return;
+    }
+  const std::string manifestFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_MANIFEST_FILE);
+  struct stat st;
+  if (stat(manifestFileName.c_str(), &st) != 0 && errno == ENOENT)
+    throw IndexCoreException(IndexCoreException::MissedManifest, params.indexPath);
+  RepoParams indexParams;
+  indexParams.readInfoFile(Directory::mixNameComponents(params.indexPath, REPO_INDEX_INFO_FILE));
+  if (!sameIndexParams(params, indexParams))
+    throw IndexCoreException(IndexCoreException::ParamsMismatch, params.indexPath);
+  IndexManifest manifest;
+  manifest.loadFromFile(manifestFileName);
+  std::unordered_map<std::string, IndexManifest::ItemVector::size_type> known;
+  for(IndexManifest::ItemVector::size_type i = 0;i < manifest.items.size();i++)
+    known.insert(std::make_pair(manifest.items[i].fileName, i));
+  logMsg(LOG_DEBUG, "Index in \'%s\' was made of %zu package files", params.indexPath.c_str(), manifest.items.size());
+  AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
+  IndexManifest newManifest;
+  BoolVector seen(manifest.items.size(), 0);
+  StringVector toAdd, toRemove;
+  for(StringVector::size_type i = 0;i < params.pkgSources.size();i++)
+    {
+      logMsg(LOG_INFO, "Looking for changed packages in \'%s\'", params.pkgSources[i].c_str());
+      m_listener.onPackageCollecting(params.pkgSources[i]);
+      Directory::Iterator::Ptr it = Directory::enumerate(params.pkgSources[i]);
+      while(it->moveNext())
+	{
+	  if (it->name() == "." || it->name() == "..")
+	    continue;
+	  if (!backend->validPkgFileName(it->name()))
+	    continue;
+	  IndexManifest::Item item;
+	  IndexManifest::statItem(it->fullPath(), item);
+	  item.fileName = it->name();
+	  std::unordered_map<std::string, IndexManifest::ItemVector::size_type>::const_iterator knownIt = known.find(item.fileName);
+	  if (knownIt == known.end())
+	    {
+	      item.digest = backend->getPkgFileDigest(it->fullPath());
+	      logMsg(LOG_DEBUG, "\'%s\' is new", it->fullPath().c_str());
+	      toAdd.push_back(it->fullPath());
+	      newManifest.items.push_back(item);
+	      continue;
+	    }
+	  const IndexManifest::Item& prev = manifest.items[knownIt->second];
+	  seen[knownIt->second] = 1;
+	  //The header is read only if the file was touched;
+	  if (item.size == prev.size && item.mtime == prev.mtime)
+	    item.digest = prev.digest; else
+	    item.digest = backend->getPkgFileDigest(it->fullPath());
+	  if (item.digest != prev.digest)
+	    {
+	      logMsg(LOG_DEBUG, "\'%s\' was changed", it->fullPath().c_str());
+	      toRemove.push_back(it->name());
+	      toAdd.push_back(it->fullPath());
+	    }
+	  newManifest.items.push_back(item);
+	}
+    }
+  for(IndexManifest::ItemVector::size_type i = 0;i < manifest.items.size();i++)
+    if (!seen[i])
+      {
+	logMsg(LOG_DEBUG, "\'%s\' was removed", manifest.items[i].fileName.c_str());
+	//Manifests of previous versions have full paths;
+	toRemove.push_back(File::baseName(manifest.items[i].fileName));
+      }
+  logMsg(LOG_INFO, "Has %zu package files to add and %zu package files to remove", toAdd.size(), toRemove.size());
+  if (!toAdd.empty() || !toRemove.empty())
+    {
+      //Everything not saved in the info file is taken from the current params;
+      indexParams.indexPath = params.indexPath;
+      indexParams.pkgSources = params.pkgSources;
+      indexParams.providesRefsSources = params.providesRefsSources;
+      indexParams.providesRefs = params.providesRefs;
+      indexParams.compressionThreads = params.compressionThreads;
+      indexParams.checksumType = params.checksumType;
+      rebuildIndex(indexParams, toAdd, toRemove);
+      if (indexParams.filterProvidesByRefs)
+	refilterProvides(indexParams);
+    }
+  manifest.items.swap(newManifest.items);
+  manifest.saveToFile(manifestFileName);
+  logMsg(LOG_DEBUG, "Index in \'%s\' is up to date", params.indexPath.c_str());
+}
+
 void IndexCore::refilterProvides(const RepoParams& params)
 {
   assert(!params.indexPath.empty());
@@ -689,16 +1276,13 @@ void IndexCore::refilterProvides(const RepoParams& params)
     throw IndexCoreException(IndexCoreException::MissedChecksumFileName);
   Md5File md5File;
   md5File.loadFromFile(Directory::mixNameComponents(params.indexPath, params.md5sumFileName));
-  for(Md5File::ItemVector::size_type i = 0;i < md5File.items.size();i++)
-    {
-      logMsg(LOG_DEBUG, "Verifying checksum for \'%s\'", Directory::mixNameComponents(params.indexPath, md5File.items[i].fileName).c_str());
-      if (!md5File.verifyItem(i, Directory::mixNameComponents(params.indexPath, md5File.items[i].fileName)))
-	throw IndexCoreException(IndexCoreException::CorruptedFile, Directory::mixNameComponents(params.indexPath, md5File.items[i].fileName));
-    }
+  size_t invalidItem;
+  if (!md5File.verifyItems(params.indexPath, invalidItem))
+    throw IndexCoreException(IndexCoreException::CorruptedFile, Directory::mixNameComponents(params.indexPath, md5File.items[invalidItem].fileName));
   const std::string pkgFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_FILE + compressionExtension(params.compressionType));
   const std::string pkgCompleteFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_COMPLETE_FILE);
   logMsg(LOG_DEBUG, "pkgFileName=\'%s\', pkgCompleteFileName=\'%s\'", pkgFileName.c_str(), pkgCompleteFileName.c_str());
-  StringSet internalReferences, externalReferences;
+  StringHashSet references;
   if (params.filterProvidesByRefs)
     {
       logMsg(LOG_DEBUG, "Provides filtering by references is enabled, we have %zu external references sources", params.providesRefsSources.size());
@@ -706,15 +1290,15 @@ void IndexCore::refilterProvides(const RepoParams& params)
 	{
 	  logMsg(LOG_DEBUG, "In addition %zu provides references were given explicitly, adding them to external references ", params.providesRefs.size());
 	  for(StringVector::size_type i = 0;i < params.providesRefs.size();i++)
-	    externalReferences.insert(params.providesRefs[i]);
+	    references.insert(params.providesRefs[i]);
 	}
       for(StringVector::size_type i = 0;i < params.providesRefsSources.size();i++)
 	{
 	  logMsg(LOG_DEBUG, "Collecting external references in \'%s\'", params.providesRefsSources[i].c_str());
 	  m_listener.onReferenceCollecting(params.providesRefsSources[i]);
-	  collectRefs(params.providesRefsSources[i], externalReferences);
+	  collectRefs(params.indexPath, params.providesRefsSources[i], references);
 	}
-      logMsg(LOG_DEBUG, "%zu external references collected", externalReferences.size());
+      logMsg(LOG_DEBUG, "%zu external references collected", references.size());
       logMsg(LOG_DEBUG, "Reading \'%s\' to pick up internal references", pkgFileName.c_str());
 	  m_listener.onReferenceCollecting(params.indexPath);
 	  AbstractTextFormatSectionReader::Ptr reader = createRebuildReader(pkgFileName, params);
@@ -723,62 +1307,70 @@ void IndexCore::refilterProvides(const RepoParams& params)
       reader->init();
       while(reader->readNext(sect))
 	{
-	PkgSection::extractProvidesReferences(sect, internalReferences);
+	PkgSection::extractProvidesReferences(sect, references);
 	count++;
 	}
       reader->close();
-      logMsg(LOG_DEBUG, "%zu internal references collected in %zu package records", internalReferences.size(), count);
+      //Source packages references are taken as well, exactly as buildIndex() does;
+      const std::string srcFileName = Directory::mixNameComponents(params.indexPath, REPO_INDEX_SOURCES_FILE + compressionExtension(params.compressionType));
+      logMsg(LOG_DEBUG, "Reading \'%s\' to pick up internal references", srcFileName.c_str());
+      reader = createRebuildReader(srcFileName, params);
+      reader->init();
+      while(reader->readNext(sect))
+	{
+	PkgSection::extractProvidesReferences(sect, references);
+	count++;
+	}
+      reader->close();
+      logMsg(LOG_DEBUG, "%zu references collected with %zu package records", references.size(), count);
     }
   logMsg(LOG_DEBUG, "Performing unlink() for \'%s\'", pkgFileName.c_str());
   File::unlink(pkgFileName);
   m_listener.onProvidesCleaning();
   logMsg(LOG_DEBUG, "Creating new \'%s\'", pkgFileName.c_str());
-  UnifiedOutput::Ptr pkgFile = createRebuildWriter(pkgFileName, params);
-  std::ifstream is(pkgCompleteFileName.c_str());
-  if (!is.is_open())
-    throw 0;//FIXME:InternalProblem;
-  while(1)
-    {
-      std::string line;
-      std::getline(is, line);
-      if (!is)
-	break;
-      std::string pkgName;
-      if (!PkgSection::isProvidesLine(line, pkgName))
-	{
-	  pkgFile->writeData(line + "\n");
-	  continue;
-	}
-      if (params.filterProvidesByRefs)
-	{
-	  if (internalReferences.find(pkgName) != internalReferences.end() || 
-	      externalReferences.find(pkgName) != externalReferences.end() ||
-	      (!params.filterProvidesByDirs.empty() && fileFromDirs(pkgName, params.filterProvidesByDirs)))
-	    pkgFile->writeData(line + "\n");
-	} else
-	{
-	  if (params.filterProvidesByDirs.empty() || fileFromDirs(pkgName, params.filterProvidesByDirs))
-	    pkgFile->writeData(line + "\n");
-	}
-    }
+  const char checksumType = itemChecksumType(md5File, File::baseName(pkgFileName));
+  UnifiedOutput::Ptr pkgFile = createRebuildWriter(pkgFileName, params, checksumType);
+  ProvidesFilter filter(params.filterProvidesByRefs, params.filterProvidesByDirs);
+  filter.setRefs(references);
+  AbstractTextFormatSectionReader::Ptr reader = createRebuildReaderNoCompression(pkgCompleteFileName);
+  std::string sect;
+  reader->init();
+  while(reader->readNext(sect))
+    pkgFile->writeData(PkgSection::filterProvides(sect, filter));
+  reader->close();
   pkgFile->close();
   logMsg(LOG_DEBUG, "New packages file writing completed");
   m_listener.onChecksumWriting();
   logMsg(LOG_DEBUG, "Updating md5sum for \'%s\' and writing new file", pkgFileName.c_str());
   md5File.removeItem(File::baseName(pkgFileName));
-  md5File.addItemFromFile(File::baseName(pkgFileName), pkgFileName);
+  md5File.addItem(File::baseName(pkgFileName), pkgFile->getChecksum(), checksumType);
+  ComponentSnapshotWriter().write(params);
+  const char snapshotChecksumType = itemChecksumType(md5File, REPO_INDEX_PACKAGES_SNAPSHOT_FILE);
+  md5File.removeItem(REPO_INDEX_PACKAGES_SNAPSHOT_FILE);
+  md5File.addItemFromFile(REPO_INDEX_PACKAGES_SNAPSHOT_FILE, Directory::mixNameComponents(params.indexPath, REPO_INDEX_PACKAGES_SNAPSHOT_FILE), snapshotChecksumType);
   md5File.saveToFile(Directory::mixNameComponents(params.indexPath, REPO_INDEX_MD5SUM_FILE));
   logMsg(LOG_DEBUG, "Exiting references fixing procedure, everything done successfully");
 }
 
-void IndexCore::collectRefs(const std::string& dirName, StringSet& res) 
+void IndexCore::collectRefs(const std::string& indexPath,
+			    const std::string& dirName,
+			    StringHashSet& res) 
 {
   logMsg(LOG_INFO, "Collecting references in \'%s\'", dirName.c_str());
+  const std::string cacheFileName = refsCacheFileName(indexPath, dirName);
   //First of all checking if there is already created repo index;
   try {
     logMsg(LOG_DEBUG, "Checking is there repo index");
     RepoParams repoParams;
     repoParams.readInfoFile(Directory::mixNameComponents(dirName, REPO_INDEX_INFO_FILE));
+    const std::string key = indexRefsKey(dirName, repoParams);
+    StringHashSet refs;
+    if (loadRefsCache(cacheFileName, dirName, key, refs))
+      {
+	logMsg(LOG_DEBUG, "index:%zu references of \'%s\' are taken from the cache", refs.size(), dirName.c_str());
+	res.insert(refs.begin(), refs.end());
+	return;
+      }
     const std::string pkgFileName = Directory::mixNameComponents(dirName, REPO_INDEX_PACKAGES_FILE) + compressionExtension(repoParams.compressionType);
     const std::string srcFileName = Directory::mixNameComponents(dirName, REPO_INDEX_SOURCES_FILE) + compressionExtension(repoParams.compressionType);
     AbstractTextFormatSectionReader::Ptr reader = createRebuildReader(pkgFileName, repoParams);
@@ -786,7 +1378,7 @@ void IndexCore::collectRefs(const std::string& dirName, StringSet& res)
     std::string sect;
     reader->init();
     while(reader->readNext(sect))
-      PkgSection::extractProvidesReferences(sect, res);
+      PkgSection::extractProvidesReferences(sect, refs);
     reader->close();
     logMsg(LOG_DEBUG, "Main packages file read successfully, now do the same for sources file \'%s\'", srcFileName.c_str());
     reader = createRebuildReader(srcFileName, repoParams);
@@ -794,9 +1386,11 @@ void IndexCore::collectRefs(const std::string& dirName, StringSet& res)
     sect.erase();
     reader->init();
     while(reader->readNext(sect))
-      PkgSection::extractProvidesReferences(sect, res);
+      PkgSection::extractProvidesReferences(sect, refs);
     reader->close();
-    logMsg(LOG_DEBUG, "We successfully read references from repository index, references set contains %zu entries", res.size());
+    logMsg(LOG_DEBUG, "We successfully read references from repository index, references set contains %zu entries", refs.size());
+    saveRefsCache(cacheFileName, dirName, key, refs);
+    res.insert(refs.begin(), refs.end());
     return;
   }
   catch (const AbstractException& e)
@@ -806,6 +1400,14 @@ void IndexCore::collectRefs(const std::string& dirName, StringSet& res)
     }
   logMsg(LOG_INFO, "Since repository index reading failed  we are looking for just packages itself");
   AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
+  const std::string key = pkgDirRefsKey(dirName, *backend);
+  StringHashSet refs;
+  if (loadRefsCache(cacheFileName, dirName, key, refs))
+    {
+      logMsg(LOG_DEBUG, "index:%zu references of \'%s\' are taken from the cache", refs.size(), dirName.c_str());
+      res.insert(refs.begin(), refs.end());
+      return;
+    }
   Directory::Iterator::Ptr it = Directory::enumerate(dirName);
   while(it->moveNext())
     {
@@ -814,12 +1416,14 @@ void IndexCore::collectRefs(const std::string& dirName, StringSet& res)
       if (!backend->validPkgFileName(it->name()))
 	continue;
       PkgFile pkgFile;
-      backend->readPkgFile(it->fullPath(), pkgFile);
+      backend->readPkgFile(it->fullPath(), pkgFile, AbstractPkgBackEnd::PkgFieldRequires | AbstractPkgBackEnd::PkgFieldConflicts);
       for(NamedPkgRelVector::size_type i =0; i < pkgFile.requires.size();i++)
-	res.insert(pkgFile.requires[i].pkgName);
+	refs.insert(pkgFile.requires[i].pkgName);
       for(NamedPkgRelVector::size_type i = 0;i < pkgFile.conflicts.size();i++)
-	res.insert(pkgFile.conflicts[i].pkgName);
+	refs.insert(pkgFile.conflicts[i].pkgName);
     }
+  saveRefsCache(cacheFileName, dirName, key, refs);
+  res.insert(refs.begin(), refs.end());
 }
 
 DEEPSOLVER_END_NAMESPACE
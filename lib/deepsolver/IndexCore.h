@@ -50,10 +50,27 @@ namespace Deepsolver
   public:
     void buildIndex(const RepoParams& params);
     void rebuildIndex(const RepoParams& params, const StringVector& toAdd, const StringVector& toRemove);
+
+    /**\brief Brings the index in line with the packages directories
+     *
+     * The package files are compared with the manifest saved by the
+     * previous buildIndex() or updateIndex() call, only new and changed
+     * files are read. The index files are patched with rebuildIndex()
+     * and the provides are filtered again if needed. The empty index
+     * directory is filled with buildIndex().
+     *
+     * \param [in] params The parameters must match the ones of the existing index
+     *
+     * \throws IndexCoreException with MissedManifest or ParamsMismatch codes if the index can't be updated
+     */
+    void updateIndex(const RepoParams& params);
     void refilterProvides(const RepoParams& params);
 
   private:
-    void collectRefs(const std::string& dirName, StringSet& res);
+    //The references of each source are cached in the index directory, see REPO_REFS_CACHE_FILE;
+    void collectRefs(const std::string& indexPath,
+		     const std::string& dirName,
+		     StringHashSet& res);
 
   private:
     AbstractIndexConstructionListener& m_listener;
@@ -0,0 +1,77 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/IndexManifest.h"
+
+DEEPSOLVER_BEGIN_NAMESPACE
+
+//Each line is "DIGEST SIZE MTIME PATH", the path goes last since it may have spaces;
+void IndexManifest::loadFromFile(const std::string& fileName)
+{
+  logMsg(LOG_DEBUG, "Reading index manifest \'%s\'", fileName.c_str());
+  File f;
+  f.openReadOnly(fileName);
+  StringVector lines;
+  f.readTextFile(lines);
+  f.close();
+  for(StringVector::size_type i = 0;i < lines.size();i++)
+    {
+      if (trim(lines[i]).empty())
+	continue;
+      std::istringstream ss(lines[i]);
+      Item item;
+      if (!(ss >> item.digest >> item.size >> item.mtime) || ss.get() != ' ')
+	throw IndexCoreException(IndexCoreException::InvalidManifest, fileName);
+      std::getline(ss, item.fileName);
+      if (item.fileName.empty())
+	throw IndexCoreException(IndexCoreException::InvalidManifest, fileName);
+      items.push_back(item);
+    }
+}
+
+void IndexManifest::saveToFile(const std::string& fileName) const
+{
+  std::ostringstream ss;
+  for(ItemVector::size_type i = 0;i < items.size();i++)
+    ss << items[i].digest << " " << items[i].size << " " << items[i].mtime << " " << items[i].fileName << std::endl;
+  const std::string s = ss.str();
+  //The interrupted writing must not leave the truncated manifest;
+  File f;
+  const std::string tmpFileName = f.createUnique(fileName);
+  try {
+    f.write(s.c_str(), s.length());
+    f.close();
+    File::move(tmpFileName, fileName);
+  }
+  catch(const SystemException&)
+    {
+      f.close();
+      ::unlink(tmpFileName.c_str());
+      throw;
+    }
+}
+
+void IndexManifest::statItem(const std::string& fileName, Item& item)
+{
+  struct stat st;
+  TRY_SYS_CALL(stat(fileName.c_str(), &st) == 0, "stat(" + fileName + ")");
+  item.size = st.st_size;
+  item.mtime = st.st_mtime;
+}
+
+DEEPSOLVER_END_NAMESPACE
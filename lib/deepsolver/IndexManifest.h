@@ -0,0 +1,89 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_INDEX_MANIFEST_H
+#define DEEPSOLVER_INDEX_MANIFEST_H
+
+namespace Deepsolver
+{
+  /**\brief The list of package files the repository index is made of
+   *
+   * The manifest is saved next to the index and lets ds-repo find the
+   * packages added, removed or changed since the last run without
+   * reading them. Each item has the name of the package file relative
+   * to its source directory, its size and modification time and the
+   * digest of the package header. The names don't depend on the way the
+   * sources are given, so the same sources mentioned by other paths
+   * don't make every package new. The digest is checked only if the size
+   * or the modification time differs, so touched but unchanged files are
+   * not read again.
+   */
+  class IndexManifest
+  {
+  public:
+    class Item
+    {
+    public:
+      Item()
+	: size(0),
+	  mtime(0) {}
+
+    public:
+      std::string fileName;
+      unsigned long long size;
+      long long mtime;
+      std::string digest;
+    }; //class Item;
+
+  public:
+    typedef std::vector<Item> ItemVector;
+
+  public:
+    /**\brief The default constructor*/
+    IndexManifest() {}
+
+    /**\brief The destructor*/
+    virtual ~IndexManifest() {}
+
+  public:
+    /**\brief Reads the manifest
+     *
+     * \param [in] fileName The name of the manifest file
+     *
+     * \throws IndexCoreException with InvalidManifest code if the content is broken
+     */
+    void loadFromFile(const std::string& fileName);
+
+    /**\brief Saves the manifest replacing the file as a whole
+     *
+     * \param [in] fileName The name of the manifest file
+     */
+    void saveToFile(const std::string& fileName) const;
+
+    /**\brief Fills the item with the size and the modification time of the file
+     *
+     * \param [in] fileName The path of the package file
+     * \param [out] item The item to fill, the name and the digest are not touched
+     */
+    static void statItem(const std::string& fileName, Item& item);
+
+  public:
+    ItemVector items;
+  }; //class IndexManifest;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_INDEX_MANIFEST_H;
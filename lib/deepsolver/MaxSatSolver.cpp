@@ -0,0 +1,391 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/MaxSatSolver.h"
+
+DEEPSOLVER_BEGIN_SAT_NAMESPACE
+
+static Lit negation(const Lit& lit);
+static bool lessWeight(const SoftLit& soft1, const SoftLit& soft2);
+
+enum {
+  SoftIdle = 0,
+  SoftAssumed = 1,
+  SoftRelaxed = 2
+};
+
+void MaxSatSolver::reset()
+{
+  m_satSolver->reset();
+  m_softs.clear();
+  m_nextVarId = 0;
+  m_firstAuxVarId = BadVarId;
+  m_cost = 0;
+  m_stat = SatStat();
+  m_hasStat = 0;
+  m_interrupted = 0;
+  m_aborted = 0;
+}
+
+void MaxSatSolver::addClause(const Clause& clause)
+{
+  for(Clause::size_type i = 0;i < clause.size();i++)
+    {
+      assert(clause[i].varId != BadVarId);
+      assert(m_firstAuxVarId == BadVarId || clause[i].varId < m_firstAuxVarId);
+      if (clause[i].varId >= m_nextVarId)
+	m_nextVarId = clause[i].varId + 1;
+    }
+  m_satSolver->addClause(clause);
+}
+
+void MaxSatSolver::addSoftLit(const SoftLit& soft)
+{
+  assert(soft.lit.varId != BadVarId);
+  assert(m_firstAuxVarId == BadVarId || soft.lit.varId < m_firstAuxVarId);
+  if (soft.lit.varId >= m_nextVarId)
+    m_nextVarId = soft.lit.varId + 1;
+  m_softs.push_back(soft);
+}
+
+bool MaxSatSolver::solve(VarIdToBoolMap& res, VarIdVector& conflicts)
+{
+  Clause core;
+  return optimize(Clause(), res, conflicts, core);
+}
+
+bool MaxSatSolver::solveAssuming(const Clause& assumptions,
+				 VarIdToBoolMap& res,
+				 Clause& core)
+{
+  VarIdVector conflicts;
+  return optimize(assumptions, res, conflicts, core);
+}
+
+bool MaxSatSolver::optimize(const Clause& hard,
+			    VarIdToBoolMap& res,
+			    VarIdVector& conflicts,
+			    Clause& core)
+{
+  m_stat = SatStat();
+  m_hasStat = 0;
+  m_aborted = 0;
+  m_cost = 0;
+  if (m_firstAuxVarId == BadVarId)
+    m_firstAuxVarId = m_nextVarId;
+  //Literals with greater weights are suggested last to take precedence;
+  SoftLitVector softs(m_softs);
+  std::stable_sort(softs.begin(), softs.end(), lessWeight);
+  for(SoftLitVector::size_type i = 0;i < softs.size();i++)
+    m_satSolver->setPhase(softs[i].lit);
+  //The first solving checks the hard clauses only;
+  VarIdToBoolMap model;
+  core.clear();
+  const bool solved = hard.empty()?m_satSolver->solve(model, conflicts):m_satSolver->solveAssuming(hard, model, core);
+  SatStat stat;
+  if (m_satSolver->getStat(stat))
+    {
+      m_stat = stat;
+      m_hasStat = 1;
+    }
+  if (!solved)
+    {
+      m_aborted = m_satSolver->isAborted();
+      return 0;
+    }
+  SizeVector weights;
+  for(SoftLitVector::size_type i = 0;i < softs.size();i++)
+    weights.push_back(softs[i].weight);
+  weights.erase(std::unique(weights.begin(), weights.end()), weights.end());
+  for(SizeVector::size_type i = weights.size();i > 0;i--)
+    if (!solveWeight(weights[i - 1], hard, model))
+      {
+	m_aborted = 1;
+	conflicts.clear();
+	return 0;
+      }
+  logMsg(LOG_DEBUG, "maxsat:the optimum has cost %zu (%zu decisions, %zu conflicts)", m_cost, m_stat.decisions, m_stat.conflicts);
+  for(VarIdToBoolMap::const_iterator it = model.begin();it != model.end();++it)
+    if (it->first < m_firstAuxVarId)
+      res.insert(*it);
+  return 1;
+}
+
+bool MaxSatSolver::getStat(SatStat& stat) const
+{
+  stat = m_stat;
+  return m_hasStat;
+}
+
+void MaxSatSolver::interrupt()
+{
+  m_interrupted = 1;
+  m_satSolver->interrupt();
+}
+
+void MaxSatSolver::setConflictLimit(size_t limit)
+{
+  m_satSolver->setConflictLimit(limit);
+}
+
+void MaxSatSolver::setPhase(const Lit& lit)
+{
+  m_satSolver->setPhase(lit);
+}
+
+bool MaxSatSolver::isAborted() const
+{
+  return m_aborted;
+}
+
+bool MaxSatSolver::isInterruptible() const
+{
+  return m_satSolver->isInterruptible();
+}
+
+bool MaxSatSolver::hasAssumptions() const
+{
+  return 1;
+}
+
+bool MaxSatSolver::solveWeight(size_t weight,
+			       const Clause& hard,
+			       VarIdToBoolMap& res)
+{
+  Clause sortedHard(hard);
+  std::sort(sortedHard.begin(), sortedHard.end());
+  Clause softs;
+  std::map<Lit, size_t> softIndices;
+  for(SoftLitVector::size_type i = 0;i < m_softs.size();i++)
+    {
+      if (m_softs[i].weight != weight)
+	continue;
+      Lit lit = m_softs[i].lit;
+      //Each repeated literal is counted separately through its own selector implying it;
+      if (softIndices.find(lit) != softIndices.end())
+	{
+	  lit = Lit(newVar());
+	  Clause clause;
+	  clause.push_back(negation(lit));
+	  clause.push_back(m_softs[i].lit);
+	  m_satSolver->addClause(clause);
+	  m_satSolver->setPhase(lit);
+	}
+      softIndices.insert(std::map<Lit, size_t>::value_type(lit, softs.size()));
+      softs.push_back(lit);
+    }
+  //Only the soft literals once falsified are assumed, the rest are checked in each solution;
+  std::vector<unsigned char> states(softs.size(), SoftIdle);
+  SizeVector idle;
+  for(Clause::size_type i = 0;i < softs.size();i++)
+    idle.push_back(i);
+  Clause assumptions;
+  std::map<Lit, size_t> bounds;//The totalizer of each bound assumption;
+  TotalizerVector totalizers;
+  size_t coreCount = 0;
+  bool solved = 1;//The current solution satisfies the assumptions;
+  while(1)
+    {
+      if (solved)
+	{
+	  //Only the new solution may falsify more literals;
+	  size_t offset = 0;
+	  for(Clause::size_type i = 0;i < idle.size();i++)
+	    if (!isSatisfied(softs[idle[i]], res))
+	      {
+		states[idle[i]] = SoftAssumed;
+		assumptions.push_back(softs[idle[i]]);
+		offset++;
+	      } else
+	      idle[i - offset] = idle[i];
+	  idle.resize(idle.size() - offset);
+	  //The solution satisfies everything except one literal of each core, it is the optimum;
+	  if (offset == 0)
+	    break;
+	}
+      if (m_interrupted)
+	return 0;
+      VarIdToBoolMap model;
+      Clause core;
+      if (callSolver(hard, assumptions, model, core))
+	{
+	  res.swap(model);
+	  solved = 1;
+	  continue;
+	}
+      if (m_satSolver->isAborted())
+	return 0;
+      solved = 0;
+      std::sort(core.begin(), core.end());
+      core.erase(std::unique(core.begin(), core.end()), core.end());
+      //The hard assumptions are never relaxed;
+      size_t hardCount = 0;
+      for(Clause::size_type i = 0;i < core.size();i++)
+	if (std::binary_search(sortedHard.begin(), sortedHard.end(), core[i]))
+	  hardCount++; else
+	  core[i - hardCount] = core[i];
+      core.resize(core.size() - hardCount);
+      //The hard part is satisfied by the previous solution, so there must be a core;
+      assert(!core.empty());
+      coreCount++;
+      size_t offset = 0;
+      for(Clause::size_type i = 0;i < assumptions.size();i++)
+	if (std::binary_search(core.begin(), core.end(), assumptions[i]))
+	  offset++; else
+	  assumptions[i - offset] = assumptions[i];
+      assumptions.resize(assumptions.size() - offset);
+      for(Clause::size_type i = 0;i < core.size();i++)
+	{
+	  std::map<Lit, size_t>::const_iterator softIt = softIndices.find(core[i]);
+	  if (softIt != softIndices.end() && states[softIt->second] == SoftAssumed)
+	    {
+	      states[softIt->second] = SoftRelaxed;
+	      continue;
+	    }
+	  //Weakening the bound found in the core;
+	  std::map<Lit, size_t>::const_iterator it = bounds.find(core[i]);
+	  assert(it != bounds.end());
+	  Totalizer& t = totalizers[it->second];
+	  t.bound++;
+	  if (t.bound < t.inputs.size())
+	    {
+	      const Lit lit = boundLit(t);
+	      bounds[lit] = it->second;
+	      assumptions.push_back(lit);
+	    }
+	}
+      //The only literal of the core is falsified in every solution;
+      if (core.size() == 1)
+	{
+	  m_satSolver->addClause(unitClause(negation(core.front())));
+	  continue;
+	}
+      Totalizer t;
+      for(Clause::size_type i = 0;i < core.size();i++)
+	t.inputs.push_back(negation(core[i]));
+      t.bound = 1;
+      const Lit lit = boundLit(t);
+      bounds[lit] = totalizers.size();
+      assumptions.push_back(lit);
+      totalizers.push_back(t);
+    }
+  logMsg(LOG_DEBUG, "maxsat:weight %zu has %zu of %zu soft literals falsified", weight, coreCount, softs.size());
+  m_cost += coreCount * weight;
+  //Fixing the optimum for the following weights;
+  for(SizeVector::size_type i = 0;i < idle.size();i++)
+    m_satSolver->addClause(unitClause(softs[idle[i]]));
+  for(Clause::size_type i = 0;i < assumptions.size();i++)
+    m_satSolver->addClause(unitClause(assumptions[i]));
+  return 1;
+}
+
+Lit MaxSatSolver::boundLit(Totalizer& t)
+{
+  assert(t.bound < t.inputs.size());
+  if (t.bound >= t.outputs.size())
+    {
+      //The limit is doubled to avoid rebuilding on every weakening;
+      t.outputs.clear();
+      totalizer(t.inputs, 0, t.inputs.size(), std::min(t.inputs.size(), 2 * (t.bound + 1)), t.outputs);
+    }
+  assert(t.bound < t.outputs.size());
+  return negation(t.outputs[t.bound]);
+}
+
+void MaxSatSolver::totalizer(const LitVector& inputs,
+			     size_t begin,
+			     size_t end,
+			     size_t limit,
+			     LitVector& outputs)
+{
+  assert(begin < end && limit > 0);
+  if (end - begin == 1)
+    {
+      outputs.push_back(inputs[begin]);
+      return;
+    }
+  const size_t middle = begin + (end - begin) / 2;
+  LitVector left, right;
+  totalizer(inputs, begin, middle, limit, left);
+  totalizer(inputs, middle, end, limit, right);
+  const size_t count = std::min(end - begin, limit);
+  for(size_t i = 0;i < count;i++)
+    outputs.push_back(Lit(newVar()));
+  //At least i of the left and at least j of the right give at least i + j;
+  for(LitVector::size_type i = 0;i <= left.size();i++)
+    for(LitVector::size_type j = 0;j <= right.size();j++)
+      {
+	if (i + j == 0)
+	  continue;
+	Clause clause;
+	if (i > 0)
+	  clause.push_back(negation(left[i - 1]));
+	if (j > 0)
+	  clause.push_back(negation(right[j - 1]));
+	clause.push_back(outputs[std::min(i + j, count) - 1]);
+	m_satSolver->addClause(clause);
+      }
+}
+
+VarId MaxSatSolver::newVar()
+{
+  assert(m_nextVarId != BadVarId);
+  return m_nextVarId++;
+}
+
+bool MaxSatSolver::isSatisfied(const Lit& lit, const VarIdToBoolMap& res) const
+{
+  VarIdToBoolMap::const_iterator it = res.find(lit.varId);
+  //Variables not mentioned in clauses are assigned only on assumptions;
+  if (it == res.end())
+    return 0;
+  return it->second != lit.neg;
+}
+
+bool MaxSatSolver::callSolver(const Clause& hard,
+			      const Clause& assumptions,
+			      VarIdToBoolMap& res,
+			      Clause& core)
+{
+  Clause all(hard);
+  all.insert(all.end(), assumptions.begin(), assumptions.end());
+  const bool solved = m_satSolver->solveAssuming(all, res, core);
+  SatStat stat;
+  if (m_satSolver->getStat(stat))
+    {
+      m_stat.decisions += stat.decisions;
+      m_stat.conflicts += stat.conflicts;
+      m_stat.propagations += stat.propagations;
+      m_hasStat = 1;
+    }
+  return solved;
+}
+
+//Static functions;
+
+Lit negation(const Lit& lit)
+{
+  return Lit(lit.varId, !lit.neg);
+}
+
+bool lessWeight(const SoftLit& soft1, const SoftLit& soft2)
+{
+  return soft1.weight < soft2.weight;
+}
+
+DEEPSOLVER_END_SAT_NAMESPACE
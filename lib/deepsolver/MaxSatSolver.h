@@ -0,0 +1,179 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_MAX_SAT_SOLVER_H
+#define DEEPSOLVER_MAX_SAT_SOLVER_H
+
+#include"deepsolver/Sat.h"
+
+namespace Deepsolver
+{
+  namespace Sat
+  {
+    /**\brief The literal desired to be true in the solution*/
+    struct SoftLit
+    {
+      SoftLit()
+	: weight(0) {}
+
+      SoftLit(const Lit& l, size_t w)
+	: lit(l),
+	  weight(w) {}
+
+      Lit lit;
+      size_t weight;
+    }; //struct SoftLit;
+
+    typedef std::vector<SoftLit> SoftLitVector;
+
+    /**\brief Finds the solution falsifying the least number of soft literals
+     *
+     * The clauses added with addClause() are hard and must be satisfied,
+     * the soft literals are satisfied as many as possible. The weights
+     * are optimized lexicographically: the soft literal with greater
+     * weight is never falsified to satisfy any number of literals with
+     * smaller weights. Within the same weight the number of falsified
+     * literals is minimized.
+     *
+     * Each weight is optimized by the core-guided search (the OLL
+     * algorithm): all its soft literals are taken as assumptions, the
+     * literals of every failed core are replaced by the assumption that
+     * at most one of them is falsified, expressed by the totalizer
+     * encoding over the core. When such a bound appears in a core, it is
+     * weakened by one. Each core increases the cost by one, so the first
+     * solvable set of assumptions gives the optimum, it is added to the
+     * equation as the hard constraint before the next weight is
+     * processed. The underlying solver must support the assumptions and
+     * gets all clauses incrementally, so the learnt clauses are kept
+     * between the solvings. The solver is asked to try the soft
+     * literals first, so the initial solution is usually close to the
+     * optimum and only the falsified literals are taken as assumptions.
+     *
+     * Auxiliary variables take VarId values following the greatest one
+     * used in clauses and soft literals, they are excluded from the
+     * solution. Since the values are chosen on the first solving, all
+     * clauses must be added before it.
+     *
+     * The assumptions given to solveAssuming() are hard: they are kept in
+     * every solving and never counted in the cost. If the hard part is
+     * unsolvable, the core consists of them only.
+     */
+    class MaxSatSolver: public AbstractSatSolver
+    {
+    public:
+      /**\brief The constructor
+       *
+       * \param [in] satSolver The solver with assumptions support to do the work
+       */
+      MaxSatSolver(AbstractSatSolver::Ptr satSolver)
+	: m_satSolver(satSolver),
+	  m_nextVarId(0),
+	  m_firstAuxVarId(BadVarId),
+	  m_cost(0),
+	  m_hasStat(0),
+	  m_interrupted(0),
+	  m_aborted(0)
+      {
+	assert(m_satSolver);
+	assert(m_satSolver->hasAssumptions());
+      }
+
+      /**\brief The destructor*/
+      virtual ~MaxSatSolver() {}
+
+    public:
+      void reset() override;
+      void addClause(const Clause& clause) override;
+      bool solve(VarIdToBoolMap& res, VarIdVector& conflicts) override;
+      bool getStat(SatStat& stat) const override;
+      void interrupt() override;
+      bool isInterruptible() const override;
+      void setConflictLimit(size_t limit) override;
+      void setPhase(const Lit& lit) override;
+      bool isAborted() const override;
+      bool hasAssumptions() const override;
+      bool solveAssuming(const Clause& assumptions,
+			 VarIdToBoolMap& res,
+			 Clause& core) override;
+
+      /**\brief Adds the literal desired to be true
+       *
+       * \param [in] soft The literal with its weight
+       */
+      void addSoftLit(const SoftLit& soft);
+
+      /**\brief Returns the sum of weights of soft literals falsified in the last solution*/
+      size_t getCost() const
+      {
+	return m_cost;
+      }
+
+    private:
+      typedef std::vector<Lit> LitVector;
+
+      struct Totalizer
+      {
+	Totalizer()
+	  : bound(0) {}
+
+	LitVector inputs;//True if the corresponding soft literal is falsified;
+	LitVector outputs;//outputs[k] is true if at least k + 1 inputs are true;
+	size_t bound;//The number of inputs allowed to be true by the current assumption;
+      }; //struct Totalizer;
+
+      typedef std::vector<Totalizer> TotalizerVector;
+
+      //Finds the optimum with the hard assumptions, the core is filled if they make the equation unsolvable;
+      bool optimize(const Clause& hard,
+		    VarIdToBoolMap& res,
+		    VarIdVector& conflicts,
+		    Clause& core);
+      //Returns zero if the solving is interrupted or aborted;
+      bool solveWeight(size_t weight,
+		       const Clause& hard,
+		       VarIdToBoolMap& res);
+      //Returns the literal to assume for the current bound, extending the outputs if needed;
+      Lit boundLit(Totalizer& t);
+
+      //Makes outputs[k] true if at least k + 1 of inputs are true, up to limit outputs;
+      void totalizer(const LitVector& inputs,
+		     size_t begin,
+		     size_t end,
+		     size_t limit,
+		     LitVector& outputs);
+      VarId newVar();
+      bool isSatisfied(const Lit& lit, const VarIdToBoolMap& res) const;
+      bool callSolver(const Clause& hard,
+		      const Clause& assumptions,
+		      VarIdToBoolMap& res,
+		      Clause& core);
+
+    private:
+      const AbstractSatSolver::Ptr m_satSolver;
+      SoftLitVector m_softs;
+      VarId m_nextVarId;
+      VarId m_firstAuxVarId;
+      size_t m_cost;
+      SatStat m_stat;
+      bool m_hasStat;
+      std::atomic<bool> m_interrupted;
+      bool m_aborted;
+    }; //class MaxSatSolver;
+  } //namespace Sat;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_MAX_SAT_SOLVER_H;
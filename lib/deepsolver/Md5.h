@@ -18,9 +18,11 @@
 #ifndef DEEPSOLVER_MD5_H
 #define DEEPSOLVER_MD5_H
 
+#include"deepsolver/AbstractChecksum.h"
+
 namespace Deepsolver
 {
-  class Md5
+  class Md5: public AbstractChecksum
   {
   private:
     typedef unsigned char Md5Byte;
@@ -30,9 +32,9 @@ namespace Deepsolver
     virtual ~Md5() {}
 
   public:
-    void init();
-    void update(const void* buf, size_t len);
-    std::string commit();
+    void init() override;
+    void update(const void* buf, size_t len) override;
+    std::string commit() override;
 
   private:
     struct Context 
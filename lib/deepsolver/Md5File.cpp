@@ -18,41 +18,54 @@
 #include"deepsolver/deepsolver.h"
 #include"deepsolver/Md5File.h"
 #include"deepsolver/Md5.h"
+#include"deepsolver/Sha256.h"
+#include"deepsolver/Xxh64.h"
 
-#define IO_BUF_SIZE 1024
+#define IO_BUF_SIZE 1048576
 
 DEEPSOLVER_BEGIN_NAMESPACE
 
-void Md5File::addItemFromFile(const std::string& fileName, const std::string& realPath)
+//The tags of the checksum types in the tagged lines and the lengths of their values;
+static const struct {
+  const char* tag;
+  size_t len;
+} checksumTypes[] = {
+  {"MD5", 32},
+  {"SHA256", 64},
+  {"XXH64", 16}
+};
+
+static std::string fileChecksum(const std::string& fileName, char checksumType);
+static bool parseLine(const std::string& line, Md5File::Item& item, int& errorCode);
+
+void Md5File::addItem(const std::string& fileName,
+		      const std::string& checksum,
+		      char checksumType)
 {
-  Md5 md5;
-  md5.init();
-  File f;
-  f.openReadOnly(realPath);
-  char buf[IO_BUF_SIZE];
-  while(1)
-    {
-      const size_t count = f.read(buf, sizeof(buf));
-      if (!count)
-	break;
-      md5.update(buf, count);
-    }
-  f.close();
-  const std::string res = md5.commit();
-  assert(res.length() == 32);
+  assert(checksumType >= 0 && (size_t)checksumType < sizeof(checksumTypes) / sizeof(checksumTypes[0]));
+  assert(checksum.length() == checksumTypes[(size_t)checksumType].len);
   Item item;
-  item.checksum = res;
+  item.checksum = checksum;
   item.fileName = fileName;
+  item.checksumType = checksumType;
   items.push_back(item);
 }
 
+void Md5File::addItemFromFile(const std::string& fileName,
+			      const std::string& realPath,
+			      char checksumType)
+{
+  addItem(fileName, fileChecksum(realPath, checksumType), checksumType);
+}
+
 void Md5File::loadFromString(const std::string& str, const std::string& fileName)
 {
   std::string line;
   size_t lineNum = 0;
-  for(std::string::size_type i = 0;i < str.length();i++)
+  for(std::string::size_type i = 0;i <= str.length();i++)
     {
-      const char c = str[i];
+      //The last line may have no line end;
+      const char c = i < str.length()?str[i]:'\n';
       if (c == '\r')
 	continue;
       if (c != '\n')
@@ -64,44 +77,13 @@ void Md5File::loadFromString(const std::string& str, const std::string& fileName
       line = trim(line);
       if (line.empty())
 	continue;
-      if (line.length() < 35)
-	throw Md5FileException(Md5FileException::TooShortLine, fileName, lineNum, line);
       Item item;
-      for(std::string::size_type k = 0;k < 32;k++)
-	item.checksum += line[k];
-      for(std::string::size_type k = 34;k < line.length();k++)
-	item.fileName += line[k];
-      for(std::string::size_type k = 0;k < item.checksum.length();k++)
-	{
-	  if (item.checksum[k] >= 'A' && item.checksum[k] <= 'F')
-	    item.checksum[k] = 'a' + (item.checksum[k] - 'A');
-	  if ((item.checksum [k] >= 'a' && item.checksum[k] <= 'f') || (item.checksum[k] >= '0' && item.checksum [k] <= '9'))
-	    continue;
-	  throw Md5FileException(Md5FileException::InvalidChecksumFormat, fileName, lineNum, line);
-	}
+      int errorCode;
+      if (!parseLine(line, item, errorCode))
+	throw Md5FileException(errorCode, fileName, lineNum, line);
       items.push_back(item);
       line.erase();
     }
-  line = trim(line);
-  if (line.empty())
-    return;
-  lineNum++;
-  if (line.length() < 35)
-    throw Md5FileException(Md5FileException::TooShortLine, fileName, lineNum, line);
-  Item item;
-  for(std::string::size_type k = 0;k < 32;k++)
-    item.checksum += line[k];
-  for(std::string::size_type k = 34;k < line.length();k++)
-    item.fileName += line[k];
-  for(std::string::size_type k = 0;k < item.checksum.length();k++)
-    {
-      if (item.checksum[k] >= 'A' && item.checksum[k] <= 'F')
-	item.checksum[k] = 'a' + (item.checksum[k] - 'A');
-      if ((item.checksum [k] >= 'a' && item.checksum[k] <= 'f') || (item.checksum[k] >= '0' && item.checksum [k] <= '9'))
-	continue;
-      throw Md5FileException(Md5FileException::InvalidChecksumFormat, fileName, lineNum, line);
-    }
-  items.push_back(item);
 }
 
 void Md5File::loadFromFile(const std::string& fileName)
@@ -117,21 +99,10 @@ void Md5File::loadFromFile(const std::string& fileName)
       const std::string line = trim(lines[i]);
       if (line.empty())
 	continue;
-      if (line.length() < 35)
-	throw Md5FileException(Md5FileException::TooShortLine, fileName, i + 1, line);
       Item item;
-      for(std::string::size_type k = 0;k < 32;k++)
-	item.checksum += line[k];
-      for(std::string::size_type k = 34;k < line.length();k++)
-	item.fileName += line[k];
-      for(std::string::size_type k = 0;k < item.checksum.length();k++)
-	{
-	  if (item.checksum[k] >= 'A' && item.checksum[k] <= 'F')
-	    item.checksum[k] = 'a' + (item.checksum[k] - 'A');
-	  if ((item.checksum [k] >= 'a' && item.checksum[k] <= 'f') || (item.checksum[k] >= '0' && item.checksum [k] <= '9'))
-	    continue;
-	  throw Md5FileException(Md5FileException::InvalidChecksumFormat, fileName, i + 1, line);
-	}
+      int errorCode;
+      if (!parseLine(line, item, errorCode))
+	throw Md5FileException(errorCode, fileName, i + 1, line);
       items.push_back(item);
     }
 }
@@ -140,7 +111,9 @@ void Md5File::saveToFile(const std::string& fileName) const
 {
   std::string s;
   for(ItemVector::size_type i = 0;i < items.size();i++)
-    s += (items[i].checksum + " *" + items[i].fileName + "\n");
+    if (items[i].checksumType == AbstractChecksum::TypeMd5)
+      s += (items[i].checksum + " *" + items[i].fileName + "\n"); else
+      s += (std::string(checksumTypes[(size_t)items[i].checksumType].tag) + " (" + items[i].fileName + ") = " + items[i].checksum + "\n");
   File f;
   f.create(fileName);
   f.write(s.c_str(), s.length());
@@ -150,29 +123,66 @@ void Md5File::saveToFile(const std::string& fileName) const
 bool Md5File::verifyItem(size_t itemIndex, const std::string& fileName) const
 {
   assert(itemIndex < items.size());
-  Md5 md5;
-  md5.init();
-  File f;
-  f.openReadOnly(fileName);
-  char buf[IO_BUF_SIZE];
-  while(1)
-    {
-      const size_t count = f.read(buf, sizeof(buf));
-      if (!count)
-	break;
-      md5.update(buf, count);
-    }
-  f.close();
-  return items[itemIndex].checksum == md5.commit();
+  return items[itemIndex].checksum == fileChecksum(fileName, items[itemIndex].checksumType);
 }
 
 bool Md5File::verifyItemByString(size_t itemIndex, const std::string& str) const
 {
   assert(itemIndex < items.size());
-  Md5 md5;
-  md5.init();
-  md5.update(str.c_str(), str.length());
-  return items[itemIndex].checksum == md5.commit();
+  AbstractChecksum::Ptr checksum = createChecksum(items[itemIndex].checksumType);
+  checksum->update(str.c_str(), str.length());
+  return items[itemIndex].checksum == checksum->commit();
+}
+
+bool Md5File::verifyItems(const std::string& dir, size_t& invalidItem) const
+{
+  std::vector<char> valid(items.size(), 1);
+  std::atomic<size_t> next(0);
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  auto worker = [&]() {
+    try {
+      size_t i;
+      while((i = next++) < items.size())
+	{
+	  const std::string fileName = Directory::mixNameComponents(dir, items[i].fileName);
+	  logMsg(LOG_DEBUG, "md5:verifying checksum for \'%s\'", fileName.c_str());
+	  valid[i] = verifyItem(i, fileName);
+	}
+    }
+    catch(...)
+      {
+	std::lock_guard<std::mutex> lock(errorMutex);
+	if (!error)
+	  error = std::current_exception();
+	next = items.size();
+      }
+  };
+  std::vector<std::thread> threads;
+  const size_t threadCount = std::min((size_t)std::thread::hardware_concurrency(), items.size());
+  for(size_t i = 1;i < threadCount;++i)
+    {
+      try {
+	threads.push_back(std::thread(worker));
+      }
+      catch(const std::system_error& e)
+	{
+	  logMsg(LOG_WARNING, "md5:unable to start new thread (%s), %zu threads are used for verification", e.what(), threads.size() + 1);
+	  break;
+	}
+    }
+  worker();
+  for(std::vector<std::thread>::size_type i = 0;i < threads.size();++i)
+    threads[i].join();
+  if (error)
+    std::rethrow_exception(error);
+  for(std::vector<char>::size_type i = 0;i < valid.size();++i)
+    if (!valid[i])
+      {
+	invalidItem = i;
+	return 0;
+      }
+  return 1;
 }
 
 void Md5File::removeItem(const std::string& fileName)
@@ -188,4 +198,111 @@ void Md5File::removeItem(const std::string& fileName)
   items.pop_back();
 }
 
+AbstractChecksum::Ptr Md5File::createChecksum(char checksumType)
+{
+  AbstractChecksum::Ptr checksum;
+  switch(checksumType)
+    {
+    case AbstractChecksum::TypeMd5:
+      checksum = AbstractChecksum::Ptr(new Md5());
+      break;
+    case AbstractChecksum::TypeSha256:
+      checksum = AbstractChecksum::Ptr(new Sha256());
+      break;
+    case AbstractChecksum::TypeXxh64:
+      checksum = AbstractChecksum::Ptr(new Xxh64());
+      break;
+    default:
+      assert(0);
+    }; //switch(checksumType);
+  checksum->init();
+  return checksum;
+}
+
+//Static functions;
+
+std::string fileChecksum(const std::string& fileName, char checksumType)
+{
+  AbstractChecksum::Ptr checksum = Md5File::createChecksum(checksumType);
+  File f;
+  f.openReadOnly(fileName);
+  struct stat st;
+  TRY_SYS_CALL(fstat(f.getFd(), &st) == 0, "fstat(" + fileName + ")");
+  //Empty files cannot be mapped, the reading below handles them as well;
+  void* addr = st.st_size > 0 ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, f.getFd(), 0) : MAP_FAILED;
+  if (addr != MAP_FAILED)
+    {
+      madvise(addr, st.st_size, MADV_SEQUENTIAL);
+      //The length counter of Md5 class is not ready for gigabytes at once;
+      const char* c = static_cast<const char*>(addr);
+      for(size_t pos = 0;pos < (size_t)st.st_size;pos += IO_BUF_SIZE)
+	checksum->update(c + pos, std::min((size_t)IO_BUF_SIZE, (size_t)st.st_size - pos));
+      munmap(addr, st.st_size);
+      f.close();
+      return checksum->commit();
+    }
+  std::vector<char> buf(IO_BUF_SIZE);
+  while(1)
+    {
+      const size_t count = f.read(&buf[0], buf.size());
+      if (!count)
+	break;
+      checksum->update(&buf[0], count);
+    }
+  f.close();
+  return checksum->commit();
+}
+
+bool parseLine(const std::string& line, Md5File::Item& item, int& errorCode)
+{
+  std::string value;
+  //The tagged line is "TAG (name) = value";
+  const std::string::size_type open = line.find(" (");
+  const std::string::size_type close = line.rfind(") = ");
+  if (open != std::string::npos && close != std::string::npos && open < close && open > 0 &&
+      line.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789") == open)
+    {
+      const std::string tag = line.substr(0, open);
+      size_t k;
+      for(k = 0;k < sizeof(checksumTypes) / sizeof(checksumTypes[0]);k++)
+	if (tag == checksumTypes[k].tag)
+	  break;
+      if (k >= sizeof(checksumTypes) / sizeof(checksumTypes[0]))
+	{
+	  errorCode = Md5FileException::InvalidChecksumFormat;
+	  return 0;
+	}
+      item.checksumType = (char)k;
+      item.fileName = line.substr(open + 2, close - open - 2);
+      value = line.substr(close + 4);
+    } else
+    {
+      //The line of md5sum utility is the value, two characters and the name;
+      if (line.length() < 35)
+	{
+	  errorCode = Md5FileException::TooShortLine;
+	  return 0;
+	}
+      item.checksumType = AbstractChecksum::TypeMd5;
+      value = line.substr(0, 32);
+      item.fileName = line.substr(34);
+    }
+  if (value.length() != checksumTypes[(size_t)item.checksumType].len)
+    {
+      errorCode = Md5FileException::InvalidChecksumFormat;
+      return 0;
+    }
+  for(std::string::size_type k = 0;k < value.length();k++)
+    {
+      if (value[k] >= 'A' && value[k] <= 'F')
+	value[k] = 'a' + (value[k] - 'A');
+      if ((value[k] >= 'a' && value[k] <= 'f') || (value[k] >= '0' && value[k] <= '9'))
+	continue;
+      errorCode = Md5FileException::InvalidChecksumFormat;
+      return 0;
+    }
+  item.checksum = value;
+  return 1;
+}
+
 DEEPSOLVER_END_NAMESPACE
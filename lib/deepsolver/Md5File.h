@@ -18,16 +18,31 @@
 #ifndef DEEPSOLVER_MD5FILE_H
 #define DEEPSOLVER_MD5FILE_H
 
+#include"deepsolver/AbstractChecksum.h"
+
 namespace Deepsolver
 {
+  /**\brief The list of files with their checksums
+   *
+   * The md5 items are saved in the format of md5sum utility, so the
+   * lists made without other algorithms are readable by older
+   * versions. The items with other algorithms are saved in the tagged
+   * format of coreutils (like "SHA256 (name) = value"), the tag
+   * specifies the algorithm of each item individually.
+   */
   class Md5File
   {
   public:
     class Item
     {
+    public:
+      Item()
+	: checksumType(AbstractChecksum::TypeMd5) {}
+
     public:
       std::string checksum;
       std::string fileName;
+      char checksumType;
     }; //class Item;
 
   public:
@@ -42,14 +57,46 @@ namespace Deepsolver
     virtual ~Md5File() {}
 
   public:
-    void addItemFromFile(const std::string& fileName, const std::string& realPath);
+    /**\brief Adds the item with the checksum calculated elsewhere
+     *
+     * \param [in] fileName The file name to save in the item
+     * \param [in] checksum The value in lower case hexadecimal form
+     * \param [in] checksumType The algorithm the value is calculated with
+     */
+    void addItem(const std::string& fileName,
+		 const std::string& checksum,
+		 char checksumType = AbstractChecksum::TypeMd5);
+
+    void addItemFromFile(const std::string& fileName,
+			 const std::string& realPath,
+			 char checksumType = AbstractChecksum::TypeMd5);
     void loadFromString(const std::string& str, const std::string& fileName);
     void loadFromFile(const std::string& fileName);
     void saveToFile(const std::string& fileName) const;
     bool verifyItem(size_t itemIndex, const std::string& fileName) const;
     bool verifyItemByString(size_t itemIndex, const std::string& str) const;
+
+    /**\brief Verifies all items with files in the given directory
+     *
+     * The files are read concurrently, one thread per file up to the
+     * number of processors.
+     *
+     * \param [in] dir The directory with the files of the items
+     * \param [out] invalidItem The index of the first item with incorrect checksum
+     *
+     * \return Non-zero if all files match their checksums or zero otherwise
+     */
+    bool verifyItems(const std::string& dir, size_t& invalidItem) const;
     void removeItem(const std::string& fileName);
 
+    /**\brief Creates the object calculating checksums of the given type
+     *
+     * \param [in] checksumType The algorithm, one of AbstractChecksum::Type* values
+     *
+     * \return The initialized checksum object
+     */
+    static AbstractChecksum::Ptr createChecksum(char checksumType);
+
   public:
     ItemVector items;
   }; //class Md5File;
@@ -15,8 +15,8 @@
    General Public License for more details.
 */
 
-#ifndef DEEPSOLVER_MINISAT _SOLVER_H
-#define DEEPSOLVER_MINISAT _SOLVER_H
+#ifndef DEEPSOLVER_MINISAT_SOLVER_H
+#define DEEPSOLVER_MINISAT_SOLVER_H
 
 #include"deepsolver/Sat.h"
 
@@ -56,4 +56,4 @@ namespace Deepsolver
   } //namespace Sat;
 } //namespace Deepsolver;
 
-#endif //DEEPSOLVER_MINISAT _SOLVER_H;
+#endif //DEEPSOLVER_MINISAT_SOLVER_H;
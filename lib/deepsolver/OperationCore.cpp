@@ -24,21 +24,19 @@
 #include"deepsolver/AbstractTaskSolver.h"
 #include"deepsolver/PkgScope.h"
 #include"deepsolver/PkgSnapshot.h"
+#include"deepsolver/PkgSection.h"
+#include"deepsolver/Md5.h"
 
 DEEPSOLVER_BEGIN_NAMESPACE
 
 namespace
 {
-  void fillWithhInstalledPackages(AbstractPkgBackEnd& backend,
-				  PkgSnapshot::Snapshot& snapshot,
-				  ConstCharVector& strings,
-				  bool stopOnInvalidPkg)
+  void enumInstalledPackages(AbstractPkgBackEnd& backend,
+			     PkgVector& installed,
+			     bool stopOnInvalidPkg)
   {
-    PkgSnapshot::removeEqualPkgs(snapshot);
-    PkgSnapshot::PkgVector& pkgs = snapshot.pkgs;
+    installed.clear();
     AbstractInstalledPkgIterator::Ptr it = backend.enumInstalledPkg();
-    size_t installedCount = 0;
-    PkgVector toInhanceWith;
     Pkg pkg;
     while(it->moveNext(pkg))
       {
@@ -48,7 +46,20 @@ namespace
 	      throw OperationCoreException(OperationCoreException::InvalidInstalledPkg); else //FIXME:Add package designation here;
 	      logMsg(LOG_WARNING, "OS has an invalid package: %s", backend.getDesignation(pkg, AbstractPkgBackEnd::EpochIfNonZero).c_str());
 	  }
-	installedCount++;
+	installed.push_back(pkg);
+      }
+  }
+
+  void fillWithhInstalledPackages(const PkgVector& installed,
+				  PkgSnapshot::Snapshot& snapshot,
+				  ConstCharVector& strings)
+  {
+    PkgSnapshot::removeEqualPkgs(snapshot);
+    PkgSnapshot::PkgVector& pkgs = snapshot.pkgs;
+    PkgVector toInhanceWith;
+    for(PkgVector::size_type i = 0;i < installed.size();i++)
+      {
+	const Pkg& pkg = installed[i];
 	const PkgId pkgId = PkgSnapshot::strToPkgId(snapshot, pkg.name);//FIXME:must be got with checkName();
 	if (pkgId == BadPkgId)
 	  {
@@ -72,11 +83,35 @@ namespace
 	  }
 	if (!found)
 	  toInhanceWith.push_back(pkg);
-      } //while(installed packages);
-    logMsg(LOG_DEBUG, "operation:the system has %zu installed packages, %zu of them should be added to the existing snapshot", installedCount, toInhanceWith.size());
+      } //for(installed packages);
+    logMsg(LOG_DEBUG, "operation:the system has %zu installed packages, %zu of them should be added to the existing snapshot", installed.size(), toInhanceWith.size());
     PkgSnapshot::enhance(snapshot, toInhanceWith, PkgFlagInstalled, strings);
   }
 
+  void fillWithhInstalledPackages(AbstractPkgBackEnd& backend,
+				  PkgSnapshot::Snapshot& snapshot,
+				  ConstCharVector& strings,
+				  bool stopOnInvalidPkg)
+  {
+    PkgVector installed;
+    enumInstalledPackages(backend, installed, stopOnInvalidPkg);
+    fillWithhInstalledPackages(installed, snapshot, strings);
+  }
+
+  void fillTaskSolverData(const ConfRoot& root, TaskSolverData& taskSolverData)
+  {
+    taskSolverData.satSolver = root.solver.sat;
+    taskSolverData.satPortfolio = root.solver.portfolio;
+    taskSolverData.timeLimit = root.solver.timeLimit;
+    taskSolverData.conflictLimit = root.solver.conflictLimit;
+    taskSolverData.satPreprocess = root.solver.preprocess;
+    taskSolverData.parallelComponents = root.solver.parallelComponents;
+    taskSolverData.buildThreads = root.solver.buildThreads;
+    taskSolverData.satOptimize = root.solver.optimize;
+    taskSolverData.satExplain = root.solver.explain;
+    taskSolverData.explainMinimize = root.solver.explainMinimize;
+  }
+
   void fillUpgradeDowngrade(const AbstractPkgBackEnd& backend,
 			    const AbstractPkgScope& scope,
 			    VarIdVector& install,
@@ -140,6 +175,211 @@ namespace
     return s;
   }
 
+  //Package data is always replaced by moving a new file in place, so its identity is enough instead of hashing the content;
+  std::string fileStamp(const std::string& fileName)
+  {
+    struct stat st;
+    TRY_SYS_CALL(stat(fileName.c_str(), &st) == 0, "stat(" + fileName + ")");
+    std::ostringstream ss;
+    ss << st.st_dev << ":" << st.st_ino << ":" << st.st_size << ":" << st.st_mtim.tv_sec << "." << st.st_mtim.tv_nsec;
+    return ss.str();
+  }
+
+  std::string stringMd5(const std::string& s)
+  {
+    Md5 md5;
+    md5.init();
+    md5.update(s.c_str(), s.length());
+    return md5.commit();
+  }
+
+  /*
+   * The solution depends on the package data, the installed packages,
+   * the task itself and the solver settings, so all of them are in the
+   * key. The task is normalized to make the order of items meaningless.
+   */
+  std::string solutionCacheKey(const ConfRoot& root,
+			       const std::string& pkgDataFileName,
+			       const PkgVector& installed,
+			       const UserTask& userTask)
+  {
+    StringVector installedList;
+    for(PkgVector::size_type i = 0;i < installed.size();i++)
+      {
+	std::ostringstream ss;
+	ss << installed[i].name << ":" << installed[i].epoch << ":" << installed[i].version << ":" << installed[i].release << ":" << installed[i].buildTime;
+	installedList.push_back(ss.str());
+      }
+    std::sort(installedList.begin(), installedList.end());
+    StringVector toInstall;
+    for(UserTaskItemToInstallVector::size_type i = 0;i < userTask.itemsToInstall.size();i++)
+      toInstall.push_back(userTask.itemsToInstall[i].toString());
+    std::sort(toInstall.begin(), toInstall.end());
+    toInstall.erase(std::unique(toInstall.begin(), toInstall.end()), toInstall.end());
+    std::ostringstream ss;
+    ss << "pkg-data=" << fileStamp(pkgDataFileName) << std::endl;
+    Md5 md5;
+    md5.init();
+    for(StringVector::size_type i = 0;i < installedList.size();i++)
+      {
+	md5.update(installedList[i].c_str(), installedList[i].length());
+	md5.update("\n", 1);
+      }
+    ss << "installed=" << md5.commit() << std::endl;
+    ss << "sat=" << root.solver.sat << std::endl;
+    for(StringVector::size_type i = 0;i < root.solver.portfolio.size();i++)
+      ss << "portfolio=" << root.solver.portfolio[i] << std::endl;
+    ss << "preprocess=" << root.solver.preprocess << std::endl;
+    ss << "optimize=" << root.solver.optimize << std::endl;
+    for(ConfProvideVector::size_type i = 0;i < root.provide.size();i++)
+      {
+	ss << "provide=" << root.provide[i].name;
+	for(StringVector::size_type k = 0;k < root.provide[i].providers.size();k++)
+	  ss << " " << root.provide[i].providers[k];
+	ss << std::endl;
+      }
+    for(StringVector::size_type i = 0;i < toInstall.size();i++)
+      ss << "install=" << toInstall[i] << std::endl;
+    for(StringSet::const_iterator it = userTask.urlsToInstall.begin();it != userTask.urlsToInstall.end();it++)
+      ss << "url=" << *it << std::endl;
+    for(StringSet::const_iterator it = userTask.namesToRemove.begin();it != userTask.namesToRemove.end();it++)
+      ss << "remove=" << *it << std::endl;
+    return ss.str();
+  }
+
+  bool addCachedPkg(const std::string& fileName,
+		    const StringVector& lines,
+		    PkgVector& install,
+		    PkgVector& remove,
+		    PkgVector& upgradeFrom,
+		    PkgVector& upgradeTo,
+		    PkgVector& downgradeFrom,
+		    PkgVector& downgradeTo)
+  {
+    PkgFile pkgFile;
+    size_t invalidLineNum;
+    std::string invalidLineValue;
+    if (!PkgSection::parsePkgFileSection(lines, pkgFile, invalidLineNum, invalidLineValue))
+      {
+	logMsg(LOG_WARNING, "operation:ignoring broken solution cache file \'%s\', invalid line %zu: \'%s\'", fileName.c_str(), invalidLineNum, invalidLineValue.c_str());
+	return 0;
+      }
+    Pkg pkg;
+    static_cast<PkgBase&>(pkg) = pkgFile;
+    static_cast<PkgRelations&>(pkg) = pkgFile;
+    if (pkgFile.fileName == "install")
+      install.push_back(pkg); else
+      if (pkgFile.fileName == "remove")
+	remove.push_back(pkg); else
+	if (pkgFile.fileName == "upgrade-from")
+	  upgradeFrom.push_back(pkg); else
+	  if (pkgFile.fileName == "upgrade-to")
+	    upgradeTo.push_back(pkg); else
+	    if (pkgFile.fileName == "downgrade-from")
+	      downgradeFrom.push_back(pkg); else
+	      if (pkgFile.fileName == "downgrade-to")
+		downgradeTo.push_back(pkg); else
+		{
+		  logMsg(LOG_WARNING, "operation:ignoring solution cache file \'%s\' with unknown section \'%s\'", fileName.c_str(), pkgFile.fileName.c_str());
+		  return 0;
+		}
+    return 1;
+  }
+
+  //The cache file consists of sections in the format of the repository index, the list of each package is given by the section name;
+  bool loadCachedSolution(const std::string& fileName,
+			  PkgVector& install,
+			  PkgVector& remove,
+			  PkgVector& upgradeFrom,
+			  PkgVector& upgradeTo,
+			  PkgVector& downgradeFrom,
+			  PkgVector& downgradeTo)
+  {
+    std::ifstream is(fileName.c_str());
+    if (!is.is_open())
+      return 0;
+    StringVector lines;
+    while(1)
+      {
+	std::string line;
+	const bool read = std::getline(is, line)?1:0;
+	line = trim(line);
+	if (read && !line.empty())
+	  {
+	    lines.push_back(line);
+	    continue;
+	  }
+	if (!lines.empty() && !addCachedPkg(fileName, lines, install, remove, upgradeFrom, upgradeTo, downgradeFrom, downgradeTo))
+	  return 0;
+	lines.clear();
+	if (!read)
+	  break;
+      }
+    if (upgradeFrom.size() != upgradeTo.size() || downgradeFrom.size() != downgradeTo.size())
+      {
+	logMsg(LOG_WARNING, "operation:ignoring solution cache file \'%s\' with unpaired upgrades or downgrades", fileName.c_str());
+	return 0;
+      }
+    return 1;
+  }
+
+  void saveCachedPkgs(std::ostream& s, const std::string& listName, const PkgVector& pkgs)
+  {
+    for(PkgVector::size_type i = 0;i < pkgs.size();i++)
+      {
+	PkgFile pkgFile;
+	static_cast<PkgBase&>(pkgFile) = pkgs[i];
+	static_cast<PkgRelations&>(pkgFile) = pkgs[i];
+	pkgFile.fileName = listName;
+	s << PkgSection::saveBaseInfo(pkgFile, StringVector());
+      }
+  }
+
+  void saveCachedSolution(const std::string& dir,
+			  const std::string& fileName,
+			  const PkgVector& install,
+			  const PkgVector& remove,
+			  const PkgVector& upgradeFrom,
+			  const PkgVector& upgradeTo,
+			  const PkgVector& downgradeFrom,
+			  const PkgVector& downgradeTo)
+  {
+    Directory::ensureExists(dir);
+    //Solutions for old states are never requested again, so the cache is just dropped when it grows too big;
+    size_t count = 0;
+    Directory::Iterator::Ptr it = Directory::enumerate(dir);
+    while(it->moveNext())
+      if (it->name() != "." && it->name() != "..")
+	count++;
+    if (count >= SOLUTION_CACHE_MAX_ENTRIES)
+      {
+	logMsg(LOG_DEBUG, "operation:solution cache has %zu entries, clearing", count);
+	Directory::eraseContent(dir);
+      }
+    std::ostringstream ss;
+    saveCachedPkgs(ss, "install", install);
+    saveCachedPkgs(ss, "remove", remove);
+    saveCachedPkgs(ss, "upgrade-from", upgradeFrom);
+    saveCachedPkgs(ss, "upgrade-to", upgradeTo);
+    saveCachedPkgs(ss, "downgrade-from", downgradeFrom);
+    saveCachedPkgs(ss, "downgrade-to", downgradeTo);
+    const std::string s = ss.str();
+    //The file appears under its name only being complete;
+    File f;
+    const std::string tmpFileName = f.createUnique(fileName);
+    try {
+      f.write(s.c_str(), s.length());
+      f.close();
+      File::move(tmpFileName, fileName);
+    }
+    catch(const SystemException&)
+      {
+	f.close();
+	::unlink(tmpFileName.c_str());
+	throw;
+      }
+  }
+
   void buildTemporaryIndexFileNames(StringToStringMap& files, const std::string& tmpDirName)
   {
     for(StringToStringMap::iterator it = files.begin();it != files.end();it++)
@@ -147,7 +387,9 @@ namespace
   }
 }
 
-TransactionIterator::Ptr OperationCore::transaction(AbstractTransactionListener& listener, const UserTask& userTask)
+TransactionIterator::Ptr OperationCore::transaction(AbstractTransactionListener& listener,
+						    const AbstractOperationContinueRequest& continueRequest,
+						    const UserTask& userTask)
 {
   const ConfRoot& root = m_conf.root();
   freeAutoReleaseStrings();
@@ -155,16 +397,36 @@ TransactionIterator::Ptr OperationCore::transaction(AbstractTransactionListener&
     File::readAhead(root.os.transactReadAhead[i]);
   AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
   backend->initialize();
+  const std::string pkgDataFileName = Directory::mixNameComponents(root.dir.pkgData, PKG_DATA_FILE_NAME);
+  const std::string cacheDir = Directory::mixNameComponents(root.dir.pkgData, PKG_SOLUTION_CACHE_DIR);
+  PkgVector installed;
+  enumInstalledPackages(*backend.get(), installed, root.stopOnInvalidInstalledPkg);
+  std::string cacheFileName;
+  if (root.solver.cache)
+    {
+      cacheFileName = Directory::mixNameComponents(cacheDir, stringMd5(solutionCacheKey(root, pkgDataFileName, installed, userTask)));
+      PkgVector pkgInstall, pkgRemove, pkgUpgradeFrom, pkgUpgradeTo, pkgDowngradeFrom, pkgDowngradeTo;
+      if (loadCachedSolution(cacheFileName, pkgInstall, pkgRemove, pkgUpgradeFrom, pkgUpgradeTo, pkgDowngradeFrom, pkgDowngradeTo))
+	{
+	  logMsg(LOG_DEBUG, "operation:the solution is taken from the cache file \'%s\'", cacheFileName.c_str());
+	  return TransactionIterator::Ptr(new TransactionIterator(m_conf, backend,
+								    pkgInstall, pkgRemove,
+								    pkgUpgradeFrom, pkgUpgradeTo,
+								    pkgDowngradeFrom, pkgDowngradeTo));
+	}
+    }
   PkgSnapshot::Snapshot snapshot;
   listener.onPkgListProcessingBegin();
-  PkgSnapshot::loadFromFile(snapshot, Directory::mixNameComponents(m_conf.root().dir.pkgData, PKG_DATA_FILE_NAME), m_autoReleaseStrings);
+  PkgSnapshot::loadFromFile(snapshot, pkgDataFileName, m_autoReleaseStrings);
   if (snapshot.pkgs.empty())//FIXME:
     throw NotImplementedException("Empty set of attached repositories");
-  fillWithhInstalledPackages(*backend.get(), snapshot, m_autoReleaseStrings, root.stopOnInvalidInstalledPkg);
+  fillWithhInstalledPackages(installed, snapshot, m_autoReleaseStrings);
   PkgScope scope(*backend.get(), snapshot);
   scope.initMetadata();
   listener.onPkgListProcessingEnd();
   TaskSolverData taskSolverData(*backend.get(), scope, m_conf);
+  fillTaskSolverData(root, taskSolverData);
+  taskSolverData.continueRequest = &continueRequest;
   AbstractTaskSolver::Ptr solver = createTaskSolver(taskSolverData);
   VarIdVector toInstall, toRemove;
   solver->solve(userTask, toInstall, toRemove);
@@ -200,6 +462,21 @@ TransactionIterator::Ptr OperationCore::transaction(AbstractTransactionListener&
       pkgDowngradeTo.push_back(pkg2);
     }
   freeAutoReleaseStrings();
+  if (!cacheFileName.empty())
+    {
+      logMsg(LOG_DEBUG, "operation:saving the solution to the cache file \'%s\'", cacheFileName.c_str());
+      //The solution is already found, the cache must not fail the transaction;
+      try {
+	saveCachedSolution(cacheDir, cacheFileName,
+			   pkgInstall, pkgRemove,
+			   pkgUpgradeFrom, pkgUpgradeTo,
+			   pkgDowngradeFrom, pkgDowngradeTo);
+      }
+      catch(const SystemException& e)
+	{
+	  logMsg(LOG_WARNING, "operation:unable to save the solution to the cache file \'%s\':%s", cacheFileName.c_str(), e.getMessage().c_str());
+	}
+    }
   return TransactionIterator::Ptr(new TransactionIterator(m_conf, backend,
 								    pkgInstall, pkgRemove,
 								    pkgUpgradeFrom, pkgUpgradeTo,
@@ -222,6 +499,7 @@ void OperationCore::closure(const UserTaskItemToInstallVector& toInstall, PkgVec
   PkgScope scope(*backend.get(), snapshot);
   scope.initMetadata();
   TaskSolverData taskSolverData(*backend.get(), scope, m_conf);
+  fillTaskSolverData(root, taskSolverData);
   AbstractTaskSolver::Ptr solver = createTaskSolver(taskSolverData);
   VarIdVector install, remove;
   solver->solve(task, install, remove);
@@ -321,24 +599,15 @@ void OperationCore::generateSat(AbstractTransactionListener& listener,
 				const UserTask& userTask,
 				std::ostream& s)
 {
-  const ConfRoot& root = m_conf.root();
-  freeAutoReleaseStrings();
-  for(StringVector::size_type i = 0;i < root.os.transactReadAhead.size();i++)
-    File::readAhead(root.os.transactReadAhead[i]);
-  AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
-  backend->initialize();
-  PkgSnapshot::Snapshot snapshot;
-  listener.onPkgListProcessingBegin();
-  PkgSnapshot::loadFromFile(snapshot, Directory::mixNameComponents(m_conf.root().dir.pkgData, PKG_DATA_FILE_NAME), m_autoReleaseStrings);
-  if (snapshot.pkgs.empty())//FIXME:
-    throw NotImplementedException("Empty set of attached repositories");
-  fillWithhInstalledPackages(*backend.get(), snapshot, m_autoReleaseStrings, root.stopOnInvalidInstalledPkg);
-  PkgScope scope(*backend.get(), snapshot);
-  scope.initMetadata();
-  listener.onPkgListProcessingEnd();
-  TaskSolverData taskSolverData(*backend.get(), scope, m_conf);
-  AbstractTaskSolver::Ptr solver = createTaskSolver(taskSolverData);
-  solver->dumpSat(userTask, s);
+  exportSat(listener, userTask, s, NULL);
+}
+
+void OperationCore::generateDimacs(AbstractTransactionListener& listener,
+				   const UserTask& userTask,
+				   std::ostream& s,
+				   std::ostream& varsMap)
+{
+  exportSat(listener, userTask, s, &varsMap);
 }
 
 void OperationCore::printPackagesByRequire(const NamedPkgRel& rel, std::ostream& s)
@@ -420,4 +689,32 @@ void OperationCore::getPkgNames(bool withInstalled, StringVector& res)
   freeAutoReleaseStrings();
 }
 
+void OperationCore::exportSat(AbstractTransactionListener& listener,
+			      const UserTask& userTask,
+			      std::ostream& s,
+			      std::ostream* varsMap)
+{
+  const ConfRoot& root = m_conf.root();
+  freeAutoReleaseStrings();
+  for(StringVector::size_type i = 0;i < root.os.transactReadAhead.size();i++)
+    File::readAhead(root.os.transactReadAhead[i]);
+  AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
+  backend->initialize();
+  PkgSnapshot::Snapshot snapshot;
+  listener.onPkgListProcessingBegin();
+  PkgSnapshot::loadFromFile(snapshot, Directory::mixNameComponents(m_conf.root().dir.pkgData, PKG_DATA_FILE_NAME), m_autoReleaseStrings);
+  if (snapshot.pkgs.empty())//FIXME:
+    throw NotImplementedException("Empty set of attached repositories");
+  fillWithhInstalledPackages(*backend.get(), snapshot, m_autoReleaseStrings, root.stopOnInvalidInstalledPkg);
+  PkgScope scope(*backend.get(), snapshot);
+  scope.initMetadata();
+  listener.onPkgListProcessingEnd();
+  TaskSolverData taskSolverData(*backend.get(), scope, m_conf);
+  fillTaskSolverData(root, taskSolverData);
+  AbstractTaskSolver::Ptr solver = createTaskSolver(taskSolverData);
+  if (varsMap != NULL)
+    solver->dumpDimacs(userTask, s, *varsMap); else
+    solver->dumpSat(userTask, s);
+}
+
 DEEPSOLVER_END_NAMESPACE
@@ -70,13 +70,16 @@ namespace Deepsolver
      * process can be interrupted at any stage.
      *
      * \param [in] listener The reference to an object to following calculation progress
+     * \param [in] continueRequest The reference to an object for solving interruption by user request
      * \param [in] task The desirable changes
      * 
      * \return Smart pointer to transaction iterator
      *
      * \throws OperationException TaskException SystemException InternalException
      */
-    TransactionIterator::Ptr transaction(AbstractTransactionListener& listener, const UserTask& task);
+    TransactionIterator::Ptr transaction(AbstractTransactionListener& listener,
+					 const AbstractOperationContinueRequest& continueRequest,
+					 const UserTask& task);
 
     /**\brief Restores all dependencies for specified package set
      *
@@ -124,6 +127,25 @@ namespace Deepsolver
 		     const UserTask& task,
 		     std::ostream& s);
 
+    /**\brief Generates SAT and saves it in DIMACS CNF format
+     *
+     * The saved equation is the initial one before the preprocessing and
+     * without the clause selectors tracked to explain unsolvable tasks. The
+     * additional stream receives the designations of the packages
+     * corresponding to each DIMACS variable.
+     *
+     * \param [in] listener The reference to an object to follow calculation progress
+     * \param [in] task The reference to task object to generate SAT for
+     * \param [in] s The reference to a stream to save DIMACS CNF in
+     * \param [in] varsMap The reference to a stream to save variables designations in
+     *
+     * \throws OperationException TaskException SystemException InternalException
+     */
+    void generateDimacs(AbstractTransactionListener& listener,
+			const UserTask& task,
+			std::ostream& s,
+			std::ostream& varsMap);
+
     /**\brief Print  to stream the list of packages matching to a require
      *
      * \param [in] rel The require entry to search packages for
@@ -145,6 +167,13 @@ namespace Deepsolver
 		       bool withIds,
 		       std::ostream& s);
 
+  private:
+    //Saves DIMACS CNF if varsMap is not NULL or the SAT in the text form otherwise;
+    void exportSat(AbstractTransactionListener& listener,
+		   const UserTask& task,
+		   std::ostream& s,
+		   std::ostream* varsMap);
+
   private:
     const ConfigCenter& m_conf;
   }; //class OperationCore;
@@ -228,9 +228,63 @@ namespace Deepsolver
     std::string ver;
   }; //class IdPkgRel;
 
+  struct IdPkgRelHash
+  {
+    size_t operator()(const IdPkgRel& rel) const
+    {
+      return std::hash<std::string>()(rel.ver) * 31 + (size_t)rel.pkgId * 7 + (size_t)rel.verDir;
+    }
+  }; //struct IdPkgRelHash;
+
   typedef std::vector<IdPkgRel> IdPkgRelVector;
   typedef std::list<IdPkgRel> IdPkgRelList;
 
+  /**\brief The relation referring to the version string stored elsewhere
+   *
+   * Unlike IdPkgRel this class doesn't own the version value, so it can be
+   * constructed without any memory allocation. The version pointer is
+   * NULL if there is no version restriction and must remain valid while
+   * the object is used.
+   *
+   * \sa IdPkgRel
+   */
+  class IdPkgRelRef
+  {
+  public:
+    IdPkgRelRef()
+      : pkgId(BadPkgId), verDir(VerNone), ver(NULL) {}
+
+    explicit IdPkgRelRef(PkgId id)
+      : pkgId(id), verDir(VerNone), ver(NULL) {}
+
+    IdPkgRelRef(PkgId id, VerDirection dir, const char* v)
+      : pkgId(id), verDir(dir), ver(v) {}
+
+    explicit IdPkgRelRef(const IdPkgRel& rel)
+      : pkgId(rel.pkgId), verDir(rel.verDir), ver(rel.verRestricted() ? rel.ver.c_str() : NULL) {}
+
+  public:
+    bool verRestricted() const
+    {
+      assert(ver != NULL || verDir == VerNone);
+      assert(ver == NULL || verDir != VerNone);
+      return verDir != VerNone;
+    }
+
+    /**\brief Makes the relation with its own copy of the version*/
+    IdPkgRel toIdPkgRel() const
+    {
+      if (!verRestricted())
+	return IdPkgRel(pkgId);
+      return IdPkgRel(pkgId, verDir, ver);
+    }
+
+  public:
+    PkgId pkgId;
+    VerDirection verDir;
+    const char* ver;
+  }; //class IdPkgRelRef;
+
   class ChangeLogEntry
   {
   public:
@@ -19,6 +19,7 @@
 #include"deepsolver/PkgScope.h"
 
 #define HAS_VERSION(x) ((x).ver != NULL)
+#define PKG_VER_BUF_SIZE 256
 
 DEEPSOLVER_BEGIN_NAMESPACE
 
@@ -34,6 +35,18 @@ namespace
     ss  << epoch << ":" << version << "-" << release;
     return VerSubset(ss.str(), VerEquals);
   }
+
+  //Relations without version go first as it always was in this API;
+  void fillRels(const IdPkgRelSpan& rels, IdPkgRelVector& res)
+  {
+    res.clear();
+    for(IdPkgRelSpan::size_type i = 0;i < rels.size();i++)
+      if (!rels[i].verRestricted())
+	res.push_back(IdPkgRel(rels[i].pkgId));
+    for(IdPkgRelSpan::size_type i = 0;i < rels.size();i++)
+      if (rels[i].verRestricted())
+	res.push_back(rels[i].toIdPkgRel());
+  }
 }
 
 void PkgScope::selectMatchingVarsProvidesOnly(const IdPkgRel& rel, VarIdVector& vars) const
@@ -48,35 +61,18 @@ void PkgScope::selectMatchingVarsProvidesOnly(const IdPkgRel& rel, VarIdVector&
 void PkgScope::selectMatchingVarsProvidesOnly(PkgId pkgId, VarIdVector& vars) const
 {
   vars.clear();
-  selectVarsToTry(pkgId, vars, 0);//0 means do not include packageId itself;
+  const VarIdSpan providers = findProviders(pkgId);
+  vars.insert(vars.end(), providers.begin(), providers.end());
 }
 
 void PkgScope::selectMatchingVarsProvidesOnly(PackageId packageId, const VerSubset& ver, VarIdVector& vars) const
 {
   //Considering only provides entries and only with version information;
   vars.clear();
-  VarIdVector toTry;
-  selectVarsToTry(packageId, toTry, 0);//0 means do not include packageId itself;
-  for(VarIdVector::size_type i = 0;i < toTry.size();i++)
-    {
-      assert(toTry[i] < m_pkgs.size());
-      const size_t pos = m_pkgs[toTry[i]].providesPos;
-      const size_t count = m_pkgs[toTry[i]].providesCount;
-      assert(count > 0);
-      size_t j;
-      for(j = 0;j < count;j++)
-	{
-	  assert(pos + j < m_relations.size());
-	  if (!HAS_VERSION(m_relations[pos + j]))
-	    continue;  
-	  assert(m_relations[pos + j].verDir != VerNone);
-	  if (m_relations[pos + j].pkgId == packageId && 
-	      verOverlap(VerSubset(m_relations[pos + j].ver, m_relations[pos + j].verDir), ver))
-	    break;
-	}
-      if (j < count)
-	vars.push_back(toTry[i]);
-    }
+  const VarIdSpan providers = findProviders(packageId);
+  for(VarIdSpan::size_type i = 0;i < providers.size();i++)
+    if (provideVerOverlap(providers[i], packageId, ver.type, ver.version.c_str()))
+      vars.push_back(providers[i]);
 }
 
 void PkgScope::selectMatchingVarsRealNames(const IdPkgRel& rel, VarIdVector& vars) const
@@ -93,7 +89,7 @@ void PkgScope::selectMatchingVarsRealNames(PackageId packageId, VarIdVector& var
   vars.clear();
   VarId fromPos, toPos;
   PkgSnapshot::locateRange(m_snapshot, packageId, fromPos, toPos);
-  assert(fromPos < m_pkgs.size() && toPos < m_pkgs.size());
+  assert(fromPos <= toPos && toPos <= m_pkgs.size());
   for(VarId i = fromPos;i < toPos;i++)
     {
       assert(m_pkgs[i].pkgId == packageId);
@@ -107,11 +103,11 @@ void PkgScope::selectMatchingVarsRealNames(PackageId packageId, const VerSubset&
   vars.clear();
   VarId fromPos, toPos;
   PkgSnapshot::locateRange(m_snapshot, packageId, fromPos, toPos);
-  assert(fromPos < m_pkgs.size() && toPos < m_pkgs.size());
+  assert(fromPos <= toPos && toPos <= m_pkgs.size());
   for(VarId i = fromPos;i < toPos;i++)
     {
       assert(m_pkgs[i].pkgId == packageId);
-      if (verOverlap(constructVerSubsetEquals(m_pkgs[i].epoch, m_pkgs[i].ver, m_pkgs[i].release), ver))
+      if (pkgVerOverlap(i, ver.type, ver.version.c_str()))
 	vars.push_back(i);
     }
 }
@@ -127,39 +123,16 @@ void PkgScope::selectMatchingVarsWithProvides(const IdPkgRel& rel, VarIdVector&
 void PkgScope::selectMatchingVarsWithProvides(PackageId pkgId, VarIdVector& vars) const
 {
   vars.clear();
-  selectVarsToTry(pkgId, vars, 1);//1 means include packageId itself;
+  const RelCandidates candidates = getCandidates(pkgId);
+  for(size_t i = 0;i < candidates.size();i++)
+    vars.push_back(candidates[i]);
 }
 
 void PkgScope::selectMatchingVarsWithProvides(PackageId packageId, const VerSubset& ver, VarIdVector& vars) const
 {
   vars.clear();
-  VarIdVector toTry;
-  selectVarsToTry(packageId, toTry, 1);//1 means include packageId itself;
-  for(VarIdVector::size_type i = 0;i < toTry.size();i++)
-    {
-      assert(toTry[i] < m_pkgs.size());
-      if (m_pkgs[toTry[i]].pkgId == packageId && verOverlap(constructVerSubsetEquals(m_pkgs[toTry[i]].epoch, m_pkgs[toTry[i]].ver, m_pkgs[toTry[i]].release), ver))
-	{
-	  vars.push_back(toTry[i]);
-	  continue;
-	}
-      const size_t pos = m_pkgs[toTry[i]].providesPos;
-      const size_t count = m_pkgs[toTry[i]].providesCount;
-      if (count == 0)//There are no provides entries;
-	continue;
-      size_t j;
-      for(j = 0;j < count;j++)
-	{
-	  assert(pos + j < m_relations.size());
-	  if (!HAS_VERSION(m_relations[pos + j]))
-	    continue;  
-	  assert(m_relations[pos + j].verDir != VerNone);
-	  if (m_relations[pos + j].pkgId == packageId && verOverlap(VerSubset(m_relations[pos + j].ver, m_relations[pos + j].verDir), ver))
-	    break;
-	}
-      if (j < count)
-	vars.push_back(toTry[i]);
-    }
+  const MatchingVars matching = matchingVarsWithProvides(IdPkgRelRef(packageId, ver.type, ver.version.c_str()));
+  vars.insert(vars.end(), matching.begin(), matching.end());
 }
 
 bool PkgScope::isInstalled(VarId varId) const
@@ -259,84 +232,26 @@ bool PkgScope::allProvidesHaveTheVersion(const VarIdVector& vars, PackageId prov
 void PkgScope::getRequires(VarId varId, IdPkgRelVector& res) const
 {
   assert(varId != BadVarId);
-  PackageIdVector withVersion, withoutVersion;
-  VerSubsetVector versions;
-  getRequires(varId, withoutVersion, withVersion, versions);
-  assert(withVersion.size() == versions.size());
-  res.clear();
-  for(PackageIdVector::size_type i = 0;i < withoutVersion.size();i++)
-    res.push_back(IdPkgRel(withoutVersion[i]));
-  for(PackageIdVector::size_type i = 0;i < withVersion.size();i++)
-    res.push_back(IdPkgRel(withVersion[i], versions[i]));
+  fillRels(getRequiresSpan(varId), res);
 }
 
 void PkgScope::getConflicts(VarId varId, IdPkgRelVector& res) const
 {
   assert(varId != BadVarId);
-  PackageIdVector withVersion, withoutVersion;
-  VerSubsetVector versions;
-  getConflicts(varId, withoutVersion, withVersion, versions);
-  assert(withVersion.size() == versions.size());
-  res.clear();
-  for(PackageIdVector::size_type i = 0;i < withoutVersion.size();i++)
-    res.push_back(IdPkgRel(withoutVersion[i]));
-  for(PackageIdVector::size_type i = 0;i < withVersion.size();i++)
-    res.push_back(IdPkgRel(withVersion[i], versions[i]));
+  fillRels(getConflictsSpan(varId), res);
 }
 
 void PkgScope::whatSatisfyAmongInstalled(const IdPkgRel& rel, VarIdVector& res) const
 {
   assert(rel.pkgId != BadPkgId);
   res.clear();
-
-  //If there is no version restrictions;
-  if (!rel.verRestricted())
+  const MatchingVars matching = matchingVarsWithProvides(IdPkgRelRef(rel));
+  for(MatchingVars::const_iterator it = matching.begin();it != matching.end();++it)
     {
-      VarIdVector vars;
-      selectVarsToTry(rel.pkgId, vars, 1);//1 means to include package itself;
-      for(VarIdVector::size_type i = 0;i < vars.size();i++)
-	{
-	  assert(vars[i] < m_pkgs.size());
-	  if (m_pkgs[vars[i]].flags & PkgFlagInstalled)
-	    res.push_back(vars[i]);
-	}
-      return;
-    } //without version;
-
-  //If there is version restriction;
-  VarIdVector vars;
-  selectVarsToTry(rel.pkgId, vars, 1);//1 means to include package itself;
-  for(VarIdVector::size_type i = 0;i < vars.size();i++)
-    {
-      assert(vars[i] < m_pkgs.size());
-      const SnapshotPkg& pkg = m_pkgs[vars[i]];
-      if (!(pkg.flags & PkgFlagInstalled))
-	continue;
-      if (pkg.pkgId == rel.pkgId &&
-	  verOverlap(constructVerSubsetEquals(pkg.epoch, pkg.ver, pkg.release), VerSubset(rel.ver, rel.verDir)))
-	{
-	  res.push_back(vars[i]);
-	  continue;
-	}
-      const size_t pos = pkg.providesPos;
-      const size_t count = pkg.providesCount;
-      if (count == 0)//There are no provides entries;
-	continue;
-      size_t j;
-      for(j = 0;j < count;j++)
-	{
-	  assert(pos + j < m_relations.size());
-	  if (m_relations[pos + j].pkgId != rel.pkgId ||
-	      !HAS_VERSION(m_relations[pos + j]))//Provide entry has no version;
-	    continue;
-	  assert(m_relations[pos + j].verDir != VerNone);
-	  if (verOverlap(VerSubset(m_relations[pos + j].ver, m_relations[pos + j].verDir), VerSubset(rel.ver, rel.verDir)))
-	    {
-	      res.push_back(vars[i]);
-	      break;
-	    }
-	} //for(provides);
-    } //for(packages);
+      assert(*it < m_pkgs.size());
+      if (m_pkgs[*it].flags & PkgFlagInstalled)
+	res.push_back(*it);
+    }
 }
 
 void PkgScope::whatDependAmongInstalled(VarId varId, VarIdVector& res, IdPkgRelVector& resRels) const
@@ -345,30 +260,8 @@ void PkgScope::whatDependAmongInstalled(VarId varId, VarIdVector& res, IdPkgRelV
   resRels.clear();
   assert(varId < m_pkgs.size());
   const SnapshotPkg& pkg = m_pkgs[varId];
-  VarIdVector v;
   //First of all checking the package itself;
-  findPkgsByRequire(m_pkgs[varId].pkgId, v);
-  for(VarIdVector::size_type i = 0;i < v.size();i++)
-    {
-      assert(v[i] < m_pkgs.size());
-      assert(m_pkgs[v[i]].flags & PkgFlagInstalled);
-      PackageIdVector withoutVersion, withVersion;
-      VerSubsetVector versions;
-      getRequires(v[i], withoutVersion, withVersion, versions);
-      assert(withVersion.size() == versions.size());
-      for(PackageIdVector::size_type k = 0;k < withoutVersion.size();k++)
-	if (withoutVersion[k] == pkg.pkgId)
-	  {
-	    res.push_back(v[i]);
-	    resRels.push_back(IdPkgRel(withoutVersion[k]));
-	  }
-      for(PackageIdVector::size_type k = 0;k < withVersion.size();k++)
-	if (withVersion[k] == pkg.pkgId && verOverlap(constructVerSubsetEquals(pkg.epoch, pkg.ver, pkg.release), versions[k]))
-	  {
-	    res.push_back(v[i]);
-	    resRels.push_back(IdPkgRel(withVersion[k], versions[k]));
-	  }
-    } //For every package depending on varId without provides;
+  collectReferringRels(varId, NULL, findPkgsByRequire(pkg.pkgId), 0, res, resRels);
   //Now we check all provide entries of pkg;
   const size_t pos = pkg.providesPos;
   const size_t count = pkg.providesCount;
@@ -376,36 +269,8 @@ void PkgScope::whatDependAmongInstalled(VarId varId, VarIdVector& res, IdPkgRelV
     {
       assert(pos + i < m_relations.size());
       const SnapshotRelation& rel = m_relations[pos + i];
-      v.clear();
-      findPkgsByRequire(rel.pkgId, v);
-      for(VarIdVector::size_type k = 0;k < v.size();k++)
-	{
-	  assert(v[k] < m_pkgs.size());
-	  assert(m_pkgs[v[k]].flags & PkgFlagInstalled);
-	  PackageIdVector withoutVersion, withVersion;
-	  VerSubsetVector versions;
-	  getRequires(v[k], withoutVersion, withVersion, versions);
-	  assert(withVersion.size() == versions.size());
-	  //Checking without version anyway;
-	  for(PackageIdVector::size_type q = 0;q < withoutVersion.size();q++)
-	    if (withoutVersion[q] == rel.pkgId)
-	      {
-		res.push_back(v[k]);
-		resRels.push_back(IdPkgRel(withoutVersion[q]));
-	      }
-	  //With version must be checked only if provide entry has the version
-	  if (HAS_VERSION(rel))
-	    {
-	      assert(rel.verDir == VerEquals);//Actually it shouldn't be an assert, we can silently skip this provide;
-	      for(PackageIdVector::size_type q = 0;q < withVersion.size();q++)
-		if (withVersion[q] == rel.pkgId && verOverlap(VerSubset(rel.ver, VerEquals), versions[q]))
-		  {
-		    res.push_back(v[k]);
-		    resRels.push_back(IdPkgRel(withVersion[q], versions[q]));
-		  }
-	    }//if has version;
-	}
-    } //for provides;
+      collectReferringRels(varId, &rel, findPkgsByRequire(rel.pkgId), 0, res, resRels);
+    }
 }
 
 void PkgScope::whatConflictAmongInstalled(VarId varId, VarIdVector& res, IdPkgRelVector& resRels) const
@@ -414,30 +279,8 @@ void PkgScope::whatConflictAmongInstalled(VarId varId, VarIdVector& res, IdPkgRe
   resRels.clear();
   assert(varId < m_pkgs.size());
   const SnapshotPkg& pkg = m_pkgs[varId];
-  VarIdVector v;
   //First of all checking the package itself;
-findPkgsByConflict(m_pkgs[varId].pkgId, v);
-  for(VarIdVector::size_type i = 0;i < v.size();i++)
-    {
-      assert(v[i] < m_pkgs.size());
-      assert(m_pkgs[v[i]].flags & PkgFlagInstalled);
-      PackageIdVector withoutVersion, withVersion;
-      VerSubsetVector versions;
-      getConflicts(v[i], withoutVersion, withVersion, versions);
-      assert(withVersion.size() == versions.size());
-      for(PackageIdVector::size_type k = 0;k < withoutVersion.size();k++)
-	if (withoutVersion[k] == pkg.pkgId)
-	  {
-	    res.push_back(v[i]);
-	    resRels.push_back(IdPkgRel(withoutVersion[k]));
-	  }
-      for(PackageIdVector::size_type k = 0;k < withVersion.size();k++)
-	if (withVersion[k] == pkg.pkgId && verOverlap(constructVerSubsetEquals(pkg.epoch, pkg.ver, pkg.release), versions[k]))
-	  {
-	    res.push_back(v[i]);
-	    resRels.push_back(IdPkgRel(withVersion[k], versions[k]));
-	  }
-    } //For every package depending on varId without provides;
+  collectReferringRels(varId, NULL, findPkgsByConflict(pkg.pkgId), 1, res, resRels);
   //Now we check all provide entries of pkg;
   const size_t pos = pkg.providesPos;
   const size_t count = pkg.providesCount;
@@ -445,106 +288,122 @@ findPkgsByConflict(m_pkgs[varId].pkgId, v);
     {
       assert(pos + i < m_relations.size());
       const SnapshotRelation& rel = m_relations[pos + i];
-      v.clear();
-findPkgsByConflict(rel.pkgId, v);
-      for(VarIdVector::size_type k = 0;k < v.size();k++)
-	{
-	  assert(v[k] < m_pkgs.size());
-	  assert(m_pkgs[v[k]].flags & PkgFlagInstalled);
-	  PackageIdVector withoutVersion, withVersion;
-	  VerSubsetVector versions;
-	  getConflicts(v[k], withoutVersion, withVersion, versions);
-	  assert(withVersion.size() == versions.size());
-	  //Checking without version anyway;
-	  for(PackageIdVector::size_type q = 0;q < withoutVersion.size();q++)
-	    if (withoutVersion[q] == rel.pkgId)
-	      {
-		res.push_back(v[k]);
-		resRels.push_back(IdPkgRel(withoutVersion[q]));
-	      }
-	  //With version must be checked only if provide entry has the version
-	  if (HAS_VERSION(rel))
-	    {
-	      assert(rel.verDir == VerEquals);//FIXME:Actually it shouldn't be an assert, we can silently skip this provide;
-	      for(PackageIdVector::size_type q = 0;q < withVersion.size();q++)
-		if (withVersion[q] == rel.pkgId && verOverlap(VerSubset(rel.ver, VerEquals), versions[q]))
-		  {
-		    res.push_back(v[k]);
-		    resRels.push_back(IdPkgRel(withVersion[q], versions[q]));
-		  }
-	    }//if has version;
-	}
-    } //for provides;
+      collectReferringRels(varId, &rel, findPkgsByConflict(rel.pkgId), 1, res, resRels);
+    }
 }
 
-// Private methods;
+IdPkgRelSpan PkgScope::getRequiresSpan(VarId varId) const
+{
+  assert(varId < m_pkgs.size());
+  const SnapshotPkg& pkg = m_pkgs[varId];
+  assert(pkg.requiresPos + pkg.requiresCount <= m_relations.size());
+  const SnapshotRelation* rels = m_relations.data();
+  return IdPkgRelSpan(rels + pkg.requiresPos, rels + pkg.requiresPos + pkg.requiresCount);
+}
 
-void PkgScope::getRequires(VarId varId,
-			       PackageIdVector& depWithoutVersion,
-			       PackageIdVector& depWithVersion,
-			       VerSubsetVector& versions) const
+IdPkgRelSpan PkgScope::getConflictsSpan(VarId varId) const
 {
-  depWithoutVersion.clear();
-  depWithVersion.clear();
-  versions.clear();
   assert(varId < m_pkgs.size());
   const SnapshotPkg& pkg = m_pkgs[varId];
-  const size_t pos = pkg.requiresPos;
-  const size_t count = pkg.requiresCount;
-  for(size_t i = 0;i < count;i++)
-    {
-      assert(pos + i < m_relations.size());
-      if (!HAS_VERSION(m_relations[pos + i]))
-	depWithoutVersion.push_back(m_relations[pos + i].pkgId); else 
-	{
-	  depWithVersion.push_back(m_relations[pos + i].pkgId);
-	  versions.push_back(VerSubset(m_relations[pos + i].ver, m_relations[pos + i].verDir));
-	}
-    }
+  assert(pkg.conflictsPos + pkg.conflictsCount <= m_relations.size());
+  const SnapshotRelation* rels = m_relations.data();
+  return IdPkgRelSpan(rels + pkg.conflictsPos, rels + pkg.conflictsPos + pkg.conflictsCount);
 }
 
-void PkgScope::getConflicts(VarId varId,
-				PackageIdVector& withoutVersion,
-				PackageIdVector& withVersion,
-				VerSubsetVector& versions) const
+RelCandidates PkgScope::getCandidates(PkgId pkgId) const
+{
+  assert(pkgId != BadPkgId);
+  RelCandidates candidates;
+  PkgSnapshot::locateRange(m_snapshot, pkgId, candidates.namedBegin, candidates.namedEnd);
+  assert(candidates.namedBegin <= candidates.namedEnd && candidates.namedEnd <= m_pkgs.size());
+  candidates.providers = findProviders(pkgId);
+  return candidates;
+}
+
+bool PkgScope::satisfiesWithProvides(VarId varId, const IdPkgRelRef& rel) const
+{
+  assert(varId < m_pkgs.size());
+  assert(rel.verRestricted());
+  if (m_pkgs[varId].pkgId == rel.pkgId && pkgVerOverlap(varId, rel.verDir, rel.ver))
+    return 1;
+  return provideVerOverlap(varId, rel.pkgId, rel.verDir, rel.ver);
+}
+
+// Private methods;
+
+bool PkgScope::pkgVerOverlap(VarId varId, VerDirection dir, const char* ver) const
 {
-  withoutVersion.clear();
-  withVersion.clear();
-  versions.clear();
   assert(varId < m_pkgs.size());
   const SnapshotPkg& pkg = m_pkgs[varId];
-  const size_t pos = pkg.conflictsPos;
-  const size_t count = pkg.conflictsCount;
-  for(size_t i = 0;i < count;i++)
+  assert(pkg.ver != NULL && pkg.release != NULL);
+  char buf[PKG_VER_BUF_SIZE];
+  const int len = snprintf(buf, sizeof(buf), "%u:%s-%s", (unsigned int)pkg.epoch, pkg.ver, pkg.release);
+  if (len >= 0 && (size_t)len < sizeof(buf))
+    return verOverlap(buf, VerEquals, ver, dir);
+  //The value too long for the buffer;
+  return verOverlap(constructVerSubsetEquals(pkg.epoch, pkg.ver, pkg.release), VerSubset(ver, dir));
+}
+
+bool PkgScope::provideVerOverlap(VarId varId,
+				 PkgId pkgId,
+				 VerDirection dir,
+				 const char* ver) const
+{
+  assert(varId < m_pkgs.size());
+  const size_t pos = m_pkgs[varId].providesPos;
+  const size_t count = m_pkgs[varId].providesCount;
+  for(size_t j = 0;j < count;j++)
     {
-      assert(pos + i < m_relations.size());
-      if (m_relations[pos + i].ver == NULL)
-	withoutVersion.push_back(m_relations[pos + i].pkgId); else 
-	{
-	  withVersion.push_back(m_relations[pos + i].pkgId);
-	  versions.push_back(VerSubset(m_relations[pos + i].ver, m_relations[pos + i].verDir));
-	}
+      assert(pos + j < m_relations.size());
+      const SnapshotRelation& rel = m_relations[pos + j];
+      if (rel.pkgId != pkgId || !HAS_VERSION(rel))
+	continue;
+      assert(rel.verDir != VerNone);
+      if (verOverlap(rel.ver, rel.verDir, ver, dir))
+	return 1;
     }
+  return 0;
 }
 
-void PkgScope::selectVarsToTry(PkgId pkgId,
-			    VarIdVector& toTry,
-			       bool includeItself) const
+void PkgScope::collectReferringRels(VarId varId,
+				    const SnapshotRelation* provide,
+				    const VarIdSpan& users,
+				    bool conflicts,
+				    VarIdVector& res,
+				    IdPkgRelVector& resRels) const
 {
-  toTry.clear();
-  if (includeItself)
+  const PkgId pkgId = provide != NULL ? provide->pkgId : m_pkgs[varId].pkgId;
+  for(VarIdSpan::size_type i = 0;i < users.size();i++)
     {
-      VarId fromPos, toPos;
-      PkgSnapshot::locateRange(m_snapshot, pkgId, fromPos, toPos);
-      assert(fromPos < m_pkgs.size() && toPos < m_pkgs.size());
-      for(VarId i = fromPos;i < toPos;i++)
-	toTry.push_back(i);
+      assert(users[i] < m_pkgs.size());
+      assert(m_pkgs[users[i]].flags & PkgFlagInstalled);
+      const IdPkgRelSpan rels = conflicts ? getConflictsSpan(users[i]) : getRequiresSpan(users[i]);
+      //Checking without version anyway;
+      for(IdPkgRelSpan::size_type k = 0;k < rels.size();k++)
+	if (rels[k].pkgId == pkgId && !rels[k].verRestricted())
+	  {
+	    res.push_back(users[i]);
+	    resRels.push_back(IdPkgRel(pkgId));
+	  }
+      //With version must be checked only if provide entry has the version;
+      if (provide != NULL && !HAS_VERSION(*provide))
+	continue;
+      assert(provide == NULL || provide->verDir == VerEquals);//FIXME:Actually it shouldn't be an assert, we can silently skip this provide;
+      for(IdPkgRelSpan::size_type k = 0;k < rels.size();k++)
+	{
+	  const IdPkgRelRef rel = rels[k];
+	  if (rel.pkgId != pkgId || !rel.verRestricted())
+	    continue;
+	  const bool overlap = provide != NULL?
+	    verOverlap(provide->ver, VerEquals, rel.ver, rel.verDir):
+	    pkgVerOverlap(varId, rel.verDir, rel.ver);
+	  if (overlap)
+	    {
+	      res.push_back(users[i]);
+	      resRels.push_back(rel.toIdPkgRel());
+	    }
+	}
     }
-  VarIdVector providers;
-findProviders(pkgId, providers);//FIXME:Good idea to push to toTry vector directly;
-  for(VarIdVector::size_type i = 0;i < providers.size();i++)
-    toTry.push_back(providers[i]);
-  //Maybe it is good idea to perform doubling cleaning here, but it will take time;
 }
 
 DEEPSOLVER_END_NAMESPACE
@@ -70,20 +70,27 @@ namespace Deepsolver
 
     void whatSatisfyAmongInstalled(const IdPkgRel& rel, VarIdVector& res) const override;
 
+    IdPkgRelSpan getRequiresSpan(VarId varId) const override;
+    IdPkgRelSpan getConflictsSpan(VarId varId) const override;
+    RelCandidates getCandidates(PkgId pkgId) const override;
+    bool satisfiesWithProvides(VarId varId, const IdPkgRelRef& rel) const override;
+
   private:
-    void getRequires(VarId varId,
-		     PackageIdVector& depWithoutVersion,
-		     PackageIdVector& depWithVersion,
-		     VerSubsetVector& versions) const;
-
-    void selectVarsToTry(PkgId pkgId,
-			 VarIdVector& toTry,
-			 bool includeItself) const;
-
-    void getConflicts(VarId varId,
-		      PackageIdVector& withoutVersion,
-		      PackageIdVector& withVersion,
-		      VerSubsetVector& versions) const;
+    //Overlaps the exact version of the package with the range;
+    bool pkgVerOverlap(VarId varId, VerDirection dir, const char* ver) const;
+    //Checks if any versioned provide entry of pkgId overlaps the range;
+    bool provideVerOverlap(VarId varId,
+			   PkgId pkgId,
+			   VerDirection dir,
+			   const char* ver) const;
+
+    //Collects the relations of users referring to varId by its name (provide is NULL) or by the provide entry;
+    void collectReferringRels(VarId varId,
+			      const SnapshotRelation* provide,
+			      const VarIdSpan& users,
+			      bool conflicts,
+			      VarIdVector& res,
+			      IdPkgRelVector& resRels) const;
   }; //class PkgScope;
 } //namespace Deepsolver;
 
@@ -120,6 +120,15 @@ bool PkgScopeBase::verOverlap(const VerSubset& ver1, const VerSubset& ver2) cons
   return m_backend.verOverlap(ver1, ver2);
 }
 
+bool PkgScopeBase::verOverlap(const char* ver1,
+			      VerDirection dir1,
+			      const char* ver2,
+			      VerDirection dir2) const
+{
+  assert(ver1 != NULL && ver2 != NULL);
+  return m_backend.verRangesOverlap(ver1, dir1, ver2, dir2);
+}
+
 bool PkgScopeBase::verEqual(const std::string& ver1, const std::string& ver2) const
 {
   assert(!ver1.empty() && !ver2.empty());
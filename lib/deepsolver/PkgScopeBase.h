@@ -59,6 +59,12 @@ protected:
     NamedPkgRel makeNamedPkgRel(const SnapshotRelation& rel) const;
     int verCmp(const std::string& ver1, const std::string& ver2) const;
     bool verOverlap(const VerSubset& ver1, const VerSubset& ver2) const;
+
+    bool verOverlap(const char* ver1,
+		    VerDirection dir1,
+		    const char* ver2,
+		    VerDirection dir2) const;
+
     bool verEqual(const std::string& ver1, const std::string& ver2) const;
     bool verGreater(const std::string& ver1, const std::string& ver2) const;
 
@@ -23,95 +23,77 @@ DEEPSOLVER_BEGIN_NAMESPACE
 void PkgScopeMetadata::initMetadata()
 {
   const clock_t start = clock();
-  fillRevMapProvides();
-  fillRevMapRequires();
-  fillRevMapConflicts();
+  fillRevMap(m_revMapProvides, &SnapshotPkg::providesPos, &SnapshotPkg::providesCount, 0);
+  fillRevMap(m_revMapInstalledRequires, &SnapshotPkg::requiresPos, &SnapshotPkg::requiresCount, 1);
+  fillRevMap(m_revMapInstalledConflicts, &SnapshotPkg::conflictsPos, &SnapshotPkg::conflictsCount, 1);
   const double duration = (double)(clock() - start) / CLOCKS_PER_SEC;
   logMsg(LOG_DEBUG, "scope:metadata constructed in %f sec", duration);
   logMsg(LOG_DEBUG, "scope:the scope is initialized for %zu packages", m_pkgs.size());
-  logMsg(LOG_DEBUG, "scope:revmap for provides contains %zu items", m_revMapProvides.size());
-  logMsg(LOG_DEBUG, "scope:revmap for installed requires contains %zu items", m_revMapInstalledRequires.size());
-  logMsg(LOG_DEBUG, "scope:revmap for installed conflicts contains %zu items", m_revMapInstalledConflicts.size());
+  logMsg(LOG_DEBUG, "scope:revmap for provides contains %zu items", m_revMapProvides.vars.size());
+  logMsg(LOG_DEBUG, "scope:revmap for installed requires contains %zu items", m_revMapInstalledRequires.vars.size());
+  logMsg(LOG_DEBUG, "scope:revmap for installed conflicts contains %zu items", m_revMapInstalledConflicts.vars.size());
 }
 
-void PkgScopeMetadata::fillRevMapProvides()
+void PkgScopeMetadata::fillRevMap(RevMap& revMap,
+				  RelPosField posField,
+				  RelPosField countField,
+				  bool installedOnly) const
 {
+  //Counting sort: the first pass counts entries of every PkgId, the second one places them;
+  SizeVector& offsets = revMap.offsets;
+  offsets.assign(m_snapshot.pkgNames.size() + 1, 0);
   for(SnapshotPkgVector::size_type i = 0;i < m_pkgs.size();++i)
     {
-      const size_t pos = m_pkgs[i].providesPos; 
-      const size_t count = m_pkgs[i].providesCount;
+      if (installedOnly && !(m_pkgs[i].flags & PkgFlagInstalled))
+	continue;
+      const size_t pos = m_pkgs[i].*posField;
+      const size_t count = m_pkgs[i].*countField;
       for(size_t k = 0;k < count;++k)
-	m_revMapProvides.push_back(RevMapItem(m_relations[pos + k].pkgId, i));
+	{
+	  assert(m_relations[pos + k].pkgId + 1 < offsets.size());
+	  offsets[m_relations[pos + k].pkgId + 1]++;
+	}
     }
-  std::sort(m_revMapProvides.begin(), m_revMapProvides.end());
-}
-
-void PkgScopeMetadata::fillRevMapRequires()
-{
+  for(SizeVector::size_type i = 1;i < offsets.size();++i)
+    offsets[i] += offsets[i - 1];
+  revMap.vars.resize(offsets.back());
+  //Filling positions are kept in the shifted offsets to avoid one more vector;
   for(SnapshotPkgVector::size_type i = 0;i < m_pkgs.size();++i)
-    if (m_pkgs[i].flags & PkgFlagInstalled)
-      {
-	const size_t pos = m_pkgs[i].requiresPos; 
-	const size_t count = m_pkgs[i].requiresCount;
-	for(size_t k = 0;k < count;++k)
-	  m_revMapInstalledRequires.push_back(RevMapItem(m_relations[pos + k].pkgId, i));
-      }
-  std::sort(m_revMapInstalledRequires.begin(), m_revMapInstalledRequires.end());
+    {
+      if (installedOnly && !(m_pkgs[i].flags & PkgFlagInstalled))
+	continue;
+      const size_t pos = m_pkgs[i].*posField;
+      const size_t count = m_pkgs[i].*countField;
+      for(size_t k = 0;k < count;++k)
+	revMap.vars[offsets[m_relations[pos + k].pkgId]++] = i;
+    }
+  for(SizeVector::size_type i = offsets.size() - 1;i > 0;--i)
+    offsets[i] = offsets[i - 1];
+  offsets[0] = 0;
 }
 
-void PkgScopeMetadata::fillRevMapConflicts()
+VarIdSpan PkgScopeMetadata::findInRevMap(const RevMap& revMap, PkgId pkgId) const
 {
-  for(SnapshotPkgVector::size_type i = 0;i < m_pkgs.size();++i)
-    if (m_pkgs[i].flags & PkgFlagInstalled)
-      {
-	const size_t pos = m_pkgs[i].conflictsPos; 
-	const size_t count = m_pkgs[i].conflictsCount;
-	for(size_t k = 0;k < count;++k)
-	  m_revMapInstalledConflicts.push_back(RevMapItem(m_relations[pos + k].pkgId, i));
-      }
-  std::sort(m_revMapInstalledConflicts.begin(), m_revMapInstalledConflicts.end());
+  assert(pkgId != BadPkgId);
+  if (pkgId + 1 >= revMap.offsets.size())
+    return VarIdSpan();
+  const VarId* vars = revMap.vars.data();
+  return VarIdSpan(vars + revMap.offsets[pkgId], vars + revMap.offsets[pkgId + 1]);
 }
 
-void PkgScopeMetadata::findProviders(PkgId providePkgId, VarIdVector& res) const
+VarIdSpan PkgScopeMetadata::findProviders(PkgId providePkgId) const
 {
-  assert(providePkgId != BadPkgId);
-  res.clear();
-  RevMap::size_type fromPos = 0, toPos = 0;
-  if (!Dichotomy<RevMapItem>().findMultiple(m_revMapProvides, RevMapItem(providePkgId, BadVarId), fromPos, toPos))
-    return;
-  for(RevMap::size_type i = fromPos;i < toPos;++i)
-    {
-      assert(m_revMapProvides[i].first == providePkgId);
-      res.push_back(m_revMapProvides[i].second);
-    }
+  return findInRevMap(m_revMapProvides, providePkgId);
 }
 
-void PkgScopeMetadata::findPkgsByRequire(PkgId requirePkgId, VarIdVector& res) const
+VarIdSpan PkgScopeMetadata::findPkgsByRequire(PkgId requirePkgId) const
 {
-  assert(requirePkgId != BadPkgId);
-  res.clear();
-  RevMap::size_type fromPos = 0, toPos = 0;
-  if (!Dichotomy<RevMapItem>().findMultiple(m_revMapInstalledRequires, RevMapItem(requirePkgId, BadVarId), fromPos, toPos))
-    return;
-  for(RevMap::size_type i = fromPos;i < toPos;++i)
-    {
-      assert(m_revMapInstalledRequires[i].first == requirePkgId);
-      res.push_back(m_revMapInstalledRequires[i].second);
-    }
+  return findInRevMap(m_revMapInstalledRequires, requirePkgId);
 }
 
-void PkgScopeMetadata::findPkgsByConflict(PkgId conflictPkgId, VarIdVector& res) const
+VarIdSpan PkgScopeMetadata::findPkgsByConflict(PkgId conflictPkgId) const
 {
-  assert(conflictPkgId != BadPkgId);
-  res.clear();
-  RevMap::size_type fromPos = 0, toPos = 0;
-  if (!Dichotomy<RevMapItem>().findMultiple(m_revMapInstalledConflicts, RevMapItem(conflictPkgId, BadVarId), fromPos, toPos))
-    return;
-  for(RevMap::size_type i = fromPos;i < toPos;++i)
-    {
-      assert(m_revMapInstalledConflicts[i].first == conflictPkgId);
-      res.push_back(m_revMapInstalledConflicts[i].second);
-    }
+  return findInRevMap(m_revMapInstalledConflicts, conflictPkgId);
 }
 
 DEEPSOLVER_END_NAMESPACE
@@ -35,37 +35,32 @@ namespace Deepsolver
   void initMetadata();
 
   protected:
-    void findProviders(PkgId providePkgId, VarIdVector& res) const;
-    void findPkgsByRequire(PkgId requirePkgId, VarIdVector& res) const;
-    void findPkgsByConflict(PkgId conflictPkgId, VarIdVector& res) const;
+    VarIdSpan findProviders(PkgId providePkgId) const;
+    VarIdSpan findPkgsByRequire(PkgId requirePkgId) const;
+    VarIdSpan findPkgsByConflict(PkgId conflictPkgId) const;
 
   private:
-    void fillRevMapProvides();
-    void fillRevMapRequires();
-    void fillRevMapConflicts();
-
-  private:
-  template<typename T1, typename T2>
-    struct DichotomyItem
+    /**\brief The reverse map from PkgId to VarId in compressed sparse row form
+     *
+     * The packages referring to the PkgId p take positions from
+     * offsets[p] to offsets[p + 1] of the vars vector in ascending
+     * order. The offsets vector has one item for every known PkgId and
+     * one more item at the end.
+     */
+    struct RevMap
     {
-    DichotomyItem(T1 f, T2 s)
-    : first(f),
-	second(s) {}
-
-      bool operator ==(const DichotomyItem<T1, T2>& d) const {return first == d.first;};
-      bool operator !=(const DichotomyItem<T1, T2>& d) const {return first != d.first;};
-      bool operator <(const DichotomyItem<T1, T2>& d) const {return first < d.first;};
-      bool operator <=(const DichotomyItem<T1, T2>& d) const {return first <= d.first;};
-      bool operator >(const DichotomyItem<T1, T2>& d) const {return first > d.first;};
-      bool operator >=(const DichotomyItem<T1, T2>& d) const {return first >= d.first;};
+      SizeVector offsets;
+      VarIdVector vars;
+    }; //struct RevMap;
 
-      T1 first;
-      T2 second;
-    }; //struct DichotomyItem; 
+    typedef size_t SnapshotPkg::*RelPosField;
 
   private:
-  typedef DichotomyItem<PkgId, VarId> RevMapItem;
-  typedef std::vector<RevMapItem> RevMap;
+    void fillRevMap(RevMap& revMap,
+		    RelPosField posField,
+		    RelPosField countField,
+		    bool installedOnly) const;
+    VarIdSpan findInRevMap(const RevMap& revMap, PkgId pkgId) const;
 
   private:
   RevMap m_revMapProvides, m_revMapInstalledRequires, m_revMapInstalledConflicts;
@@ -136,7 +136,7 @@ std::string PkgSection::getPkgFileName(const std::string& section)
   return fileName;
 }
 
-void PkgSection::extractProvidesReferences(const std::string& section, StringSet& refs)
+void PkgSection::extractProvidesReferences(const std::string& section, StringHashSet& refs)
 {
   std::string line;
   for(std::string::size_type i = 0;i < section.length();i++)
@@ -164,6 +164,27 @@ void PkgSection::extractProvidesReferences(const std::string& section, StringSet
     refs.insert(extractPkgRelName(tail));
 }
 
+std::string PkgSection::filterProvides(const std::string& section, const ProvidesFilter& filter)
+{
+  //Lines are copied as is, only rejected provides are skipped;
+  const std::string::size_type prefixLen = strlen(PROVIDES_STR);
+  std::string res;
+  res.reserve(section.length());
+  std::string::size_type pos = 0;
+  while(pos < section.length())
+    {
+      std::string::size_type lineEnd = section.find('\n', pos);
+      if (lineEnd == std::string::npos)
+	lineEnd = section.length();
+      const std::string::size_type next = lineEnd < section.length()?lineEnd + 1:lineEnd;
+      if (lineEnd - pos < prefixLen || section.compare(pos, prefixLen, PROVIDES_STR) != 0 ||
+	  filter.keep(extractPkgRelName(section.substr(pos + prefixLen, lineEnd - pos - prefixLen))))
+	res.append(section, pos, next - pos);
+      pos = next;
+    }
+  return res;
+}
+
 bool PkgSection::parsePkgFileSection(const StringVector& sect, PkgFile& pkgFile, size_t& invalidLineNum, std::string& invalidLineValue)
 {
   assert(!sect.empty());
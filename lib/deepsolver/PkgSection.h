@@ -18,6 +18,8 @@
 #ifndef DEEPSOLVER_PKG_SECTION_H
 #define DEEPSOLVER_PKG_SECTION_H
 
+#include"deepsolver/ProvidesFilter.h"
+
 namespace Deepsolver
 {
   class PkgSection
@@ -28,7 +30,8 @@ namespace Deepsolver
     static std::string saveFileList(const PkgFile& pkgFile);
     static bool isProvidesLine(const std::string& line, std::string& pkgName);
     static std::string getPkgFileName(const std::string& section);
-    static void extractProvidesReferences(const std::string& section, StringSet& refs);
+    static void extractProvidesReferences(const std::string& section, StringHashSet& refs);
+    static std::string filterProvides(const std::string& section, const ProvidesFilter& filter);
     static bool parsePkgFileSection(const StringVector& sect, PkgFile& pkgFile, size_t& invalidLineNum, std::string& invalidLineValue);
   }; //class PkgSection;
 } //namespace Deepsolver;
@@ -22,6 +22,15 @@
 //#define THROW_INTERNAL_ERROR throw Deepsolver::OperationException(Deepsolver::OperationException::InternalIOProblem)
 #define THROW_INTERNAL_ERROR //FIXME:
 
+//Component snapshot values are little-endian of the following sizes;
+#define COMPONENT_MAGIC "DSCS"
+#define COMPONENT_MAGIC_SIZE 4
+#define COMPONENT_FORMAT_VERSION 2
+#define COMPONENT_COUNT_SIZE 4
+#define COMPONENT_EPOCH_SIZE 2
+#define COMPONENT_BUILD_TIME_SIZE 8
+#define COMPONENT_VER_DIR_SIZE 1
+
 DEEPSOLVER_BEGIN_NAMESPACE
 DEEPSOLVER_BEGIN_PKG_SNAPSHOT_NAMESPACE
 
@@ -71,6 +80,50 @@ static void onNewName(Snapshot& snapshot,
 		      bool complete,
 		      std::string& chunk);
 
+//For components;
+
+static void putValue(std::string& buf,
+		     unsigned long long value,
+		     size_t bytes);
+
+static void putString(std::string& buf, const char* value);
+
+static void putRelations(const Snapshot& snapshot,
+			 const SizeVector& ids,
+			 size_t pos,
+			 size_t count,
+			 std::string& buf);
+
+static bool getValue(const char* data,
+		     size_t size,
+		     size_t& pos,
+		     size_t bytes,
+		     unsigned long long& value);
+
+static bool getString(char* data,
+		      size_t size,
+		      size_t& pos,
+		      char*& value);
+
+static bool getRelations(Component& component,
+			 char* data,
+			 size_t size,
+			 size_t& pos,
+			 size_t& relPos,
+			 size_t& relationsPos,
+			 size_t& relationsCount);
+
+static void addComponentRelations(Snapshot& snapshot,
+				  const Component& component,
+				  const SizeVector& ids,
+				  size_t fromPos,
+				  size_t fromCount,
+				  size_t& pos,
+				  size_t& count,
+				  ConstCharVector& strings);
+
+static char* copyString(const char* value, ConstCharVector& strings);
+
 // For printing;
 
 static void printRelations(const Snapshot& snapshot,
@@ -650,6 +703,314 @@ void saveToFile(const Snapshot& snapshot,
   s.flush();
 }
 
+void saveComponentToFile(const Snapshot& snapshot,
+			 const StringVector& fileNames,
+			 const StringVector& arches,
+			 const std::string& fileName)
+{
+  assert(!fileName.empty());
+  assert(fileNames.size() == snapshot.pkgs.size());
+  assert(arches.size() == snapshot.pkgs.size());
+  logMsg(LOG_DEBUG, "snapshot:saving %zu packages as component snapshot to '%s'", snapshot.pkgs.size(), fileName.c_str());
+  //Names are sorted as rearrangeNames() does, but packages keep their order to go in parallel with file names;
+  SizeVector order;
+  order.resize(snapshot.pkgNames.size());
+  for(SizeVector::size_type i = 0;i < order.size();i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&snapshot](size_t i1, size_t i2) { return snapshot.pkgNames[i1] < snapshot.pkgNames[i2]; });
+  SizeVector ids;
+  ids.resize(order.size());
+  for(SizeVector::size_type i = 0;i < order.size();i++)
+    ids[order[i]] = i;
+  std::string buf(COMPONENT_MAGIC, COMPONENT_MAGIC_SIZE);
+  putValue(buf, COMPONENT_FORMAT_VERSION, COMPONENT_COUNT_SIZE);
+  putValue(buf, snapshot.pkgNames.size(), COMPONENT_COUNT_SIZE);
+  putValue(buf, snapshot.pkgs.size(), COMPONENT_COUNT_SIZE);
+  putValue(buf, snapshot.relations.size(), COMPONENT_COUNT_SIZE);
+  for(SizeVector::size_type i = 0;i < order.size();i++)
+    putString(buf, snapshot.pkgNames[order[i]].c_str());
+  for(PkgVector::size_type i = 0;i < snapshot.pkgs.size();i++)
+    {
+      const Pkg& pkg = snapshot.pkgs[i];
+      assert(pkg.pkgId < ids.size());
+      assert(pkg.ver != NULL && pkg.release != NULL);
+      putValue(buf, ids[pkg.pkgId], COMPONENT_COUNT_SIZE);
+      putValue(buf, pkg.epoch, COMPONENT_EPOCH_SIZE);
+      putValue(buf, (unsigned long long)(long long)pkg.buildTime, COMPONENT_BUILD_TIME_SIZE);
+      putString(buf, pkg.ver);
+      putString(buf, pkg.release);
+      putString(buf, fileNames[i].c_str());
+      putString(buf, arches[i].c_str());
+      //The same order as addNewPkg() uses;
+      putRelations(snapshot, ids, pkg.requiresPos, pkg.requiresCount, buf);
+      putRelations(snapshot, ids, pkg.conflictsPos, pkg.conflictsCount, buf);
+      putRelations(snapshot, ids, pkg.providesPos, pkg.providesCount, buf);
+      putRelations(snapshot, ids, pkg.obsoletesPos, pkg.obsoletesCount, buf);
+    }
+  File f;
+  f.create(fileName);
+  f.write(buf.c_str(), buf.length());
+  f.close();
+}
+
+bool loadComponentFromFile(Component& component,
+			   const std::string& fileName,
+			   ConstCharVector& strings)
+{
+  assert(!fileName.empty());
+  logMsg(LOG_DEBUG, "snapshot:reading component snapshot from '%s'", fileName.c_str());
+  File f;
+  f.openReadOnly(fileName);
+  struct stat st;
+  TRY_SYS_CALL(fstat(f.getFd(), &st) == 0, "fstat(" + fileName + ")");
+  //All strings are taken in place, so the file is read directly into the buffer living until the strings are freed;
+  char* data = new char[st.st_size + 1];
+  strings.push_back(data);
+  size_t size = 0;
+  while(size < (size_t)st.st_size)
+    {
+      const size_t count = f.read(data + size, (size_t)st.st_size - size);
+      if (!count)
+	break;
+      size += count;
+    }
+  f.close();
+  data[size] = '\0';
+  size_t pos = COMPONENT_MAGIC_SIZE;
+  unsigned long long formatVersion, nameCount, pkgCount, relationCount;
+  if (size < COMPONENT_MAGIC_SIZE || memcmp(data, COMPONENT_MAGIC, COMPONENT_MAGIC_SIZE) != 0 ||
+      !getValue(data, size, pos, COMPONENT_COUNT_SIZE, formatVersion) ||
+      formatVersion != COMPONENT_FORMAT_VERSION ||
+      !getValue(data, size, pos, COMPONENT_COUNT_SIZE, nameCount) ||
+      !getValue(data, size, pos, COMPONENT_COUNT_SIZE, pkgCount) ||
+      !getValue(data, size, pos, COMPONENT_COUNT_SIZE, relationCount))
+    {
+      logMsg(LOG_ERR, "snapshot:'%s' has no valid component snapshot header", fileName.c_str());
+      return 0;
+    }
+  logMsg(LOG_DEBUG, "snapshot:component has %llu names, %llu packages and %llu relations", nameCount, pkgCount, relationCount);
+  //Every name takes at least one byte, so the counts can't be greater than the size;
+  if (nameCount > size || pkgCount > size || relationCount > size)
+    return 0;
+  component.pkgNames.resize(nameCount);
+  for(StringVector::size_type i = 0;i < component.pkgNames.size();i++)
+    {
+      char* name;
+      if (!getString(data, size, pos, name) || name[0] == '\0')
+	return 0;
+      component.pkgNames[i] = name;
+      //Names are sorted and unique;
+      if (i > 0 && component.pkgNames[i - 1] >= component.pkgNames[i])
+	return 0;
+    }
+  component.pkgs.resize(pkgCount);
+  component.fileNames.resize(pkgCount);
+  component.arches.resize(pkgCount);
+  component.relations.resize(relationCount);
+  size_t relPos = 0;
+  for(PkgVector::size_type i = 0;i < component.pkgs.size();i++)
+    {
+      Pkg& pkg = component.pkgs[i];
+      unsigned long long pkgId, epoch, buildTime;
+      char* pkgFileName;
+      char* arch;
+      if (!getValue(data, size, pos, COMPONENT_COUNT_SIZE, pkgId) ||
+	  pkgId >= nameCount ||
+	  !getValue(data, size, pos, COMPONENT_EPOCH_SIZE, epoch) ||
+	  !getValue(data, size, pos, COMPONENT_BUILD_TIME_SIZE, buildTime) ||
+	  !getString(data, size, pos, pkg.ver) ||
+	  !getString(data, size, pos, pkg.release) ||
+	  !getString(data, size, pos, pkgFileName) ||
+	  !getString(data, size, pos, arch))
+	return 0;
+      pkg.pkgId = pkgId;
+      pkg.epoch = epoch;
+      pkg.buildTime = (time_t)(long long)buildTime;
+      component.fileNames[i] = pkgFileName;
+      component.arches[i] = arch;
+      if (!getRelations(component, data, size, pos, relPos, pkg.requiresPos, pkg.requiresCount) ||
+	  !getRelations(component, data, size, pos, relPos, pkg.conflictsPos, pkg.conflictsCount) ||
+	  !getRelations(component, data, size, pos, relPos, pkg.providesPos, pkg.providesCount) ||
+	  !getRelations(component, data, size, pos, relPos, pkg.obsoletesPos, pkg.obsoletesCount))
+	return 0;
+    }
+  if (relPos != relationCount || pos != size)
+    {
+      logMsg(LOG_ERR, "snapshot:'%s' has %zu relations and %zu bytes, but %llu relations and %zu bytes are expected", fileName.c_str(), relPos, pos, relationCount, size);
+      return 0;
+    }
+  return 1;
+}
+
+void addComponent(Snapshot& snapshot,
+		  const Component& component,
+		  ConstCharVector& strings,
+		  StringToPkgIdMap& stringToPkgIdMap)
+{
+  SizeVector ids;
+  ids.resize(component.pkgNames.size());
+  for(StringVector::size_type i = 0;i < component.pkgNames.size();i++)
+    ids[i] = registerName(snapshot, component.pkgNames[i], stringToPkgIdMap);
+  for(PkgVector::size_type i = 0;i < component.pkgs.size();i++)
+    {
+      const Pkg& p = component.pkgs[i];
+      assert(p.pkgId < ids.size());
+      Pkg pkg;
+      pkg.pkgId = ids[p.pkgId];
+      pkg.epoch = p.epoch;
+      pkg.ver = copyString(p.ver, strings);
+      pkg.aux = strings.size() - 1;
+      pkg.release = copyString(p.release, strings);
+      pkg.buildTime = p.buildTime;
+      addComponentRelations(snapshot, component, ids, p.requiresPos, p.requiresCount, pkg.requiresPos, pkg.requiresCount, strings);
+      addComponentRelations(snapshot, component, ids, p.conflictsPos, p.conflictsCount, pkg.conflictsPos, pkg.conflictsCount, strings);
+      addComponentRelations(snapshot, component, ids, p.providesPos, p.providesCount, pkg.providesPos, pkg.providesCount, strings);
+      addComponentRelations(snapshot, component, ids, p.obsoletesPos, p.obsoletesCount, pkg.obsoletesPos, pkg.obsoletesCount, strings);
+      snapshot.pkgs.push_back(pkg);
+    }
+}
+
+void putValue(std::string& buf,
+	      unsigned long long value,
+	      size_t bytes)
+{
+  for(size_t i = 0;i < bytes;i++)
+    buf += (char)((value >> (8 * i)) & 0xff);
+}
+
+void putString(std::string& buf, const char* value)
+{
+  assert(value != NULL);
+  buf.append(value, strlen(value) + 1);
+}
+
+void putRelations(const Snapshot& snapshot,
+		  const SizeVector& ids,
+		  size_t pos,
+		  size_t count,
+		  std::string& buf)
+{
+  putValue(buf, count, COMPONENT_COUNT_SIZE);
+  for(size_t i = pos;i < pos + count;i++)
+    {
+      assert(i < snapshot.relations.size());
+      const Relation& rel = snapshot.relations[i];
+      assert(rel.pkgId < ids.size());
+      putValue(buf, ids[rel.pkgId], COMPONENT_COUNT_SIZE);
+      putValue(buf, (unsigned char)rel.verDir, COMPONENT_VER_DIR_SIZE);
+      if (rel.verDir != VerNone)
+	putString(buf, rel.ver);
+    }
+}
+
+bool getValue(const char* data,
+	      size_t size,
+	      size_t& pos,
+	      size_t bytes,
+	      unsigned long long& value)
+{
+  if (pos + bytes > size)
+    return 0;
+  value = 0;
+  for(size_t i = 0;i < bytes;i++)
+    value |= (unsigned long long)(unsigned char)data[pos + i] << (8 * i);
+  pos += bytes;
+  return 1;
+}
+
+bool getString(char* data,
+	       size_t size,
+	       size_t& pos,
+	       char*& value)
+{
+  if (pos >= size)
+    return 0;
+  const char* end = (const char*)memchr(data + pos, '\0', size - pos);
+  if (end == NULL)
+    return 0;
+  value = data + pos;
+  pos = end - data + 1;
+  return 1;
+}
+
+bool getRelations(Component& component,
+		  char* data,
+		  size_t size,
+		  size_t& pos,
+		  size_t& relPos,
+		  size_t& relationsPos,
+		  size_t& relationsCount)
+{
+  unsigned long long count;
+  if (!getValue(data, size, pos, COMPONENT_COUNT_SIZE, count) || count > component.relations.size() - relPos)
+    return 0;
+  //Empty lists have zero position as processRelations() makes them;
+  relationsPos = count > 0?relPos:0;
+  relationsCount = count;
+  for(size_t i = 0;i < count;i++)
+    {
+      Relation& rel = component.relations[relPos++];
+      unsigned long long pkgId, verDir;
+      if (!getValue(data, size, pos, COMPONENT_COUNT_SIZE, pkgId) ||
+	  pkgId >= component.pkgNames.size() ||
+	  !getValue(data, size, pos, COMPONENT_VER_DIR_SIZE, verDir))
+	return 0;
+      rel.pkgId = pkgId;
+      rel.verDir = verDir;
+      rel.ver = NULL;
+      if (rel.verDir != VerNone && !getString(data, size, pos, rel.ver))
+	return 0;
+    }
+  return 1;
+}
+
+void addComponentRelations(Snapshot& snapshot,
+			   const Component& component,
+			   const SizeVector& ids,
+			   size_t fromPos,
+			   size_t fromCount,
+			   size_t& pos,
+			   size_t& count,
+			   ConstCharVector& strings)
+{
+  if (fromCount == 0)
+    {
+      pos = 0;
+      count = 0;
+      return;
+    }
+  pos = snapshot.relations.size();
+  count = fromCount;
+  for(size_t i = fromPos;i < fromPos + fromCount;i++)
+    {
+      assert(i < component.relations.size());
+      const Relation& rel = component.relations[i];
+      assert(rel.pkgId < ids.size());
+      Relation newEntry;
+      newEntry.pkgId = ids[rel.pkgId];
+      newEntry.verDir = rel.verDir;
+      if (rel.verDir != VerNone)
+	{
+	  newEntry.ver = copyString(rel.ver, strings);
+	  newEntry.aux = strings.size() - 1;
+	} else
+	{
+	  newEntry.ver = NULL;
+	  newEntry.aux = (size_t)-1;
+	}
+      snapshot.relations.push_back(newEntry);
+    }
+}
+
+char* copyString(const char* value, ConstCharVector& strings)
+{
+  assert(value != NULL);
+  char* res = new char[strlen(value) + 1];
+  strcpy(res, value);
+  strings.push_back(res);
+  return res;
+}
+
 void removeEqualPkgs(Snapshot& snapshot)
 {
   PkgSnapshot::PkgVector& pkgs = snapshot.pkgs;
@@ -141,6 +141,24 @@ namespace Deepsolver
       RelationVector relations;
     }; //struct Snapshot; 
 
+    /**\brief The packages of single repository component prepared by ds-repo
+     *
+     * Names are sorted and relations refer to them by component-local
+     * ids, the indices in pkgNames. Packages go in order of the text
+     * index, relations of each package are placed one after another and
+     * fileNames and arches have the package file name and the
+     * architecture of each item of pkgs. Version strings point into the
+     * buffer filled by loadComponentFromFile().
+     */
+    struct Component
+    {
+      StringVector pkgNames;
+      PkgVector pkgs;
+      RelationVector relations;
+      StringVector fileNames;
+      StringVector arches;
+    }; //struct Component;
+
     void addNewPkg(Snapshot& snapshot,
 		   const PkgFile& pkgFile,
 		   ConstCharVector& strings,
@@ -169,6 +187,49 @@ namespace Deepsolver
 		    const std::string& fileName,
 		    ConstCharVector& strings);
 
+    /**\brief Saves packages as the snapshot of single repository component
+     *
+     * The snapshot must be filled with addNewPkg() and the package file
+     * names and architectures go in parallel with its packages, since
+     * the snapshot itself doesn't keep them. Unlike saveToFile() all
+     * values have fixed size and byte order, since the file is served to
+     * clients of any architecture.
+     *
+     * \param [in] snapshot The packages to save
+     * \param [in] fileNames The package file name of each package
+     * \param [in] arches The architecture of each package
+     * \param [in] fileName The name of the file to write
+     */
+    void saveComponentToFile(const Snapshot& snapshot,
+			     const StringVector& fileNames,
+			     const StringVector& arches,
+			     const std::string& fileName);
+
+    /**\brief Loads the snapshot of single repository component
+     *
+     * All strings of the component are placed in the single buffer,
+     * which is added to the strings vector to be freed by the caller.
+     *
+     * \param [out] component The loaded component
+     * \param [in] fileName The name of the file to read
+     * \param [in,out] strings The vector to add the strings buffer to
+     *
+     * \return Non-zero if the content is valid or zero otherwise
+     */
+    bool loadComponentFromFile(Component& component,
+			       const std::string& fileName,
+			       ConstCharVector& strings);
+
+    /**\brief Adds packages of the loaded component to the snapshot
+     *
+     * The result is the same as adding the packages of the component
+     * one by one with addNewPkg(), but each name is looked up only once.
+     */
+    void addComponent(Snapshot& snapshot,
+		      const Component& component,
+		      ConstCharVector& strings,
+		      StringToPkgIdMap& stringToPkgIdMap);
+
     void removeEqualPkgs(Snapshot& snapshot);
 
     void printContent(const Snapshot& snapshot, 
@@ -198,6 +259,12 @@ namespace Deepsolver
 	addNewPkg(m_snapshot, pkgFile, m_strings, m_stringToPkgIdMap);
       }
 
+      bool onNewComponent(const Component& component)
+      {
+	addComponent(m_snapshot, component, m_strings, m_stringToPkgIdMap);
+	return 1;
+      }
+
     private:
       Snapshot& m_snapshot;
       ConstCharVector& m_strings;
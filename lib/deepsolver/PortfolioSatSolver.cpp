@@ -0,0 +1,205 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/PortfolioSatSolver.h"
+
+DEEPSOLVER_BEGIN_SAT_NAMESPACE
+
+//The state shared between the caller and all member threads;
+struct PortfolioSatSolver::State
+{
+  State()
+    : done(0),
+      cancelled(0),
+      finished(0),
+      result(0),
+      hasStat(0) {}
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::vector<AbstractSatSolver::Ptr> solvers;
+  StringVector names;
+  bool done;
+  bool cancelled;
+  size_t finished;
+  bool result;
+  AbstractSatSolver::VarIdToBoolMap res;
+  VarIdVector conflicts;
+  std::string winner;
+  SatStat stat;
+  bool hasStat;
+}; //struct PortfolioSatSolver::State;
+
+static void runMember(PortfolioSatSolver::StatePtr state, size_t index);
+
+void PortfolioSatSolver::reset()
+{
+  m_sat.clear();
+  m_stat = SatStat();
+  m_hasStat = 0;
+  m_aborted = 0;
+  m_interrupted = 0;
+}
+
+void PortfolioSatSolver::addClause(const Clause& clause)
+{
+  m_sat.push_back(clause);
+}
+
+bool PortfolioSatSolver::solve(VarIdToBoolMap& res, VarIdVector& conflicts)
+{
+  StatePtr state(new State());
+  for(StringVector::size_type i = 0;i < m_members.size();i++)
+    {
+      AbstractSatSolver::Ptr solver = createSatSolver(m_members[i]);
+      if (!solver)
+	{
+	  logMsg(LOG_WARNING, "portfolio:unknown SAT solver \'%s\', skipping", m_members[i].c_str());
+	  continue;
+	}
+      state->solvers.push_back(solver);
+      state->names.push_back(m_members[i]);
+    }
+  if (state->solvers.empty())
+    {
+      state->solvers.push_back(createDefaultSatSolver());
+      state->names.push_back("default");
+    }
+  for(size_t i = 0;i < state->solvers.size();i++)
+    {
+      state->solvers[i]->setConflictLimit(m_conflictLimit);
+      for(Sat::size_type k = 0;k < m_sat.size();k++)
+	state->solvers[i]->addClause(m_sat[k]);
+    }
+  logMsg(LOG_DEBUG, "portfolio:starting %zu SAT solvers for %zu clauses", state->solvers.size(), m_sat.size());
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_state = state;
+  }
+  if (m_interrupted)
+    {
+      for(size_t i = 0;i < state->solvers.size();i++)
+	state->solvers[i]->interrupt();
+      state->cancelled = 1;
+    }
+  std::vector<std::thread> threads;
+  for(size_t i = 0;i < state->solvers.size();i++)
+    {
+      try {
+	threads.push_back(std::thread(runMember, state, i));
+      }
+      catch(const std::system_error& e)
+	{
+	  logMsg(LOG_WARNING, "portfolio:unable to start new thread (%s), running solver \'%s\' in place", e.what(), state->names[i].c_str());
+	  runMember(state, i);
+	}
+    }
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while(!state->done && !state->cancelled && state->finished < state->solvers.size())
+      state->cond.wait(lock);
+    res = state->res;
+    conflicts = state->conflicts;
+    m_stat = state->stat;
+    m_hasStat = state->hasStat;
+    m_aborted = !state->done;
+    if (state->done)
+      logMsg(LOG_DEBUG, "portfolio:the answer is given by \'%s\'", state->winner.c_str()); else
+      logMsg(LOG_DEBUG, "portfolio:solving is aborted without an answer");
+  }
+  for(size_t i = 0;i < state->solvers.size();i++)
+    state->solvers[i]->interrupt();
+  //Uninterruptible members are waited for until they finish by themselves;
+  for(std::vector<std::thread>::size_type i = 0;i < threads.size();i++)
+    threads[i].join();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_state.reset();
+  }
+  return state->result;
+}
+
+bool PortfolioSatSolver::getStat(SatStat& stat) const
+{
+  stat = m_stat;
+  return m_hasStat;
+}
+
+void PortfolioSatSolver::interrupt()
+{
+  m_interrupted = 1;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_state)
+    return;
+  for(size_t i = 0;i < m_state->solvers.size();i++)
+    m_state->solvers[i]->interrupt();
+  std::lock_guard<std::mutex> stateLock(m_state->mutex);
+  m_state->cancelled = 1;
+  m_state->cond.notify_all();
+}
+
+bool PortfolioSatSolver::isInterruptible() const
+{
+  for(StringVector::size_type i = 0;i < m_members.size();i++)
+    {
+      AbstractSatSolver::Ptr solver = createSatSolver(m_members[i]);
+      //Unknown members are skipped by solve();
+      if (solver && !solver->isInterruptible())
+	return 0;
+    }
+  return 1;
+}
+
+void PortfolioSatSolver::setConflictLimit(size_t limit)
+{
+  m_conflictLimit = limit;
+}
+
+bool PortfolioSatSolver::isAborted() const
+{
+  return m_aborted;
+}
+
+void runMember(PortfolioSatSolver::StatePtr state, size_t index)
+{
+  AbstractSatSolver::VarIdToBoolMap res;
+  VarIdVector conflicts;
+  bool result = 0, answered = 1;
+  try {
+    result = state->solvers[index]->solve(res, conflicts);
+    answered = !state->solvers[index]->isAborted();
+  }
+  catch(...)
+    {
+      answered = 0;
+    }
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->finished++;
+  if (answered && !state->done)
+    {
+      state->done = 1;
+      state->result = result;
+      state->res.swap(res);
+      state->conflicts.swap(conflicts);
+      state->winner = state->names[index];
+      state->hasStat = state->solvers[index]->getStat(state->stat);
+    }
+  state->cond.notify_all();
+}
+
+DEEPSOLVER_END_SAT_NAMESPACE
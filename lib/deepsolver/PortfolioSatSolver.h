@@ -0,0 +1,89 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_PORTFOLIO_SAT_SOLVER_H
+#define DEEPSOLVER_PORTFOLIO_SAT_SOLVER_H
+
+#include"deepsolver/Sat.h"
+
+namespace Deepsolver
+{
+  namespace Sat
+  {
+    /**\brief Runs several SAT solvers in parallel and takes the first answer
+     *
+     * The time of solving the same equation may vary a lot between
+     * different solvers and even between different seeds of the same
+     * solver. This class starts each of the member solvers on its own
+     * thread with the same equation and returns the result of the one
+     * finished first, all others are interrupted. Aborted members (see
+     * AbstractSatSolver::isAborted()) are not considered as answered, the
+     * portfolio is aborted only if all members are. The members are given
+     * by their names as they are accepted by createSatSolver().
+     *
+     * All member threads are joined before solve() returns, so the
+     * solvers unable to stop in the middle of the work (like
+     * MinisatSolver) make the portfolio wait for them even after another
+     * member has answered. The portfolio is interruptible only if all of
+     * its members are.
+     */
+    class PortfolioSatSolver: public AbstractSatSolver
+    {
+    public:
+      /**\brief The constructor
+       *
+       * \param [in] members The names of solvers to run in parallel
+       */
+      PortfolioSatSolver(const StringVector& members)
+	: m_members(members),
+	  m_hasStat(0),
+	  m_conflictLimit(0),
+	  m_aborted(0),
+	  m_interrupted(0) {}
+
+      /**\brief The destructor*/
+      virtual ~PortfolioSatSolver() {}
+
+    public:
+      void reset() override;
+      void addClause(const Clause& clause) override;
+      bool solve(VarIdToBoolMap& res, VarIdVector& conflicts) override;
+      bool getStat(SatStat& stat) const override;
+      void interrupt() override;
+      bool isInterruptible() const override;
+      void setConflictLimit(size_t limit) override;
+      bool isAborted() const override;
+
+    public:
+      struct State;
+      typedef std::shared_ptr<State> StatePtr;
+
+    private:
+      const StringVector m_members;
+      Sat m_sat;
+      SatStat m_stat;
+      bool m_hasStat;
+      size_t m_conflictLimit;
+      bool m_aborted;
+      std::atomic<bool> m_interrupted;
+      std::mutex m_mutex;
+      StatePtr m_state;//Only while solving is in progress;
+    }; //class PortfolioSatSolver;
+  } //namespace Sat;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_PORTFOLIO_SAT_SOLVER_H;
@@ -0,0 +1,85 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/ProvidesFilter.h"
+
+DEEPSOLVER_BEGIN_NAMESPACE
+
+ProvidesFilter::ProvidesFilter(bool byRefs, const StringVector& dirs)
+  : m_byRefs(byRefs),
+    m_trie(1),
+    m_hasDirs(!dirs.empty())
+{
+  for(StringVector::size_type i = 0;i < dirs.size();i++)
+    {
+      size_t node = 0;
+      for(std::string::size_type k = 0;k < dirs[i].length();k++)
+	{
+	  const char c = dirs[i][k];
+	  size_t j = 0;
+	  while(j < m_trie[node].children.size() && m_trie[node].children[j].first != c)
+	    j++;
+	  if (j < m_trie[node].children.size())
+	    {
+	      node = m_trie[node].children[j].second;
+	      continue;
+	    }
+	  m_trie[node].children.push_back(std::pair<char, size_t>(c, m_trie.size()));
+	  node = m_trie.size();
+	  m_trie.push_back(TrieNode());
+	}
+      m_trie[node].terminal = 1;
+    }
+}
+
+void ProvidesFilter::setRefs(StringHashSet& refs)
+{
+  m_refs.clear();
+  m_refs.swap(refs);
+}
+
+bool ProvidesFilter::keep(const std::string& name) const
+{
+  if (!m_byRefs)
+    return !m_hasDirs || fileFromDirs(name);
+  if (m_refs.find(name) != m_refs.end())
+    return 1;
+  return m_hasDirs && fileFromDirs(name);
+}
+
+bool ProvidesFilter::fileFromDirs(const std::string& fileName) const
+{
+  size_t node = 0;
+  if (m_trie[node].terminal)
+    return 1;
+  for(std::string::size_type i = 0;i < fileName.length();i++)
+    {
+      const std::vector<std::pair<char, size_t> >& children = m_trie[node].children;
+      size_t j = 0;
+      while(j < children.size() && children[j].first != fileName[i])
+	j++;
+      if (j >= children.size())
+	return 0;
+      node = children[j].second;
+      if (m_trie[node].terminal)
+	return 1;
+    }
+  return 0;
+}
+
+DEEPSOLVER_END_NAMESPACE
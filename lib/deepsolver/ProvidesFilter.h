@@ -0,0 +1,94 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_PROVIDES_FILTER_H
+#define DEEPSOLVER_PROVIDES_FILTER_H
+
+namespace Deepsolver
+{
+  /**\brief Decides which provides are saved in the packages index
+   *
+   * The filter works in one of two modes. Without references, every
+   * provide is kept if there are no directories given or if it is a file
+   * name in one of the directories. In references mode, the provide is
+   * kept if its name is referenced by any requires or conflicts, or if it
+   * is a file in one of the given directories.
+   *
+   * References are stored in a hash set, so each check needs a single
+   * lookup. Directories form a prefix trie, so the file name is walked
+   * only once regardless of how many directories there are.
+   */
+  class ProvidesFilter
+  {
+  public:
+    /**\brief The constructor
+     *
+     * \param [in] byRefs Non-zero to keep referenced provides only
+     * \param [in] dirs The directories with files to keep regardless of references
+     */
+    ProvidesFilter(bool byRefs, const StringVector& dirs);
+
+    /**\brief The destructor*/
+    virtual ~ProvidesFilter() {}
+
+  public:
+    /**\brief Takes the set of referenced names
+     *
+     * The content of the set is moved into the filter, the set given
+     * as the argument becomes empty.
+     *
+     * \param [in,out] refs The names referenced by requires and conflicts
+     */
+    void setRefs(StringHashSet& refs);
+
+    /**\brief Checks if the provide must be saved
+     *
+     * \param [in] name The name of the provide
+     *
+     * \return Non-zero if the provide must be saved or zero otherwise
+     */
+    bool keep(const std::string& name) const;
+
+    /**\brief Checks if the file name is in one of the directories*/
+    bool fileFromDirs(const std::string& fileName) const;
+
+    size_t getRefCount() const
+    {
+      return m_refs.size();
+    }
+
+  private:
+    struct TrieNode
+    {
+      TrieNode()
+	: terminal(0) {}
+
+      std::vector<std::pair<char, size_t> > children;
+      bool terminal;//The path from the root is one of the directories;
+    }; //struct TrieNode;
+
+    typedef std::vector<TrieNode> TrieNodeVector;
+
+  private:
+    const bool m_byRefs;
+    StringHashSet m_refs;
+    TrieNodeVector m_trie;
+    bool m_hasDirs;
+  }; //class ProvidesFilter;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_PROVIDES_FILTER_H;
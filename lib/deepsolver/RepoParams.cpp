@@ -162,6 +162,9 @@ void RepoParams::writeInfoFile(const std::string& fileName) const
     case CompressionTypeGzip:
       params.insert(StringToStringMap::value_type(INFO_FILE_COMPRESSION_TYPE, INFO_FILE_COMPRESSION_TYPE_GZIP));
       break;
+    case CompressionTypeZstd:
+      params.insert(StringToStringMap::value_type(INFO_FILE_COMPRESSION_TYPE, INFO_FILE_COMPRESSION_TYPE_ZSTD));
+      break;
     default:
       assert(0);
     }; //switch(compressionType);
@@ -210,7 +213,9 @@ void RepoParams::readInfoFile(const std::string& fileName)
 	    compressionType = CompressionTypeNone; else
 	    if (trim(value) == INFO_FILE_COMPRESSION_TYPE_GZIP)
 	      compressionType = CompressionTypeGzip; else
-	      throw InfoFileValueException(InfoFileValueException::InvalidCompressionType, trim(value));
+	      if (trim(value) == INFO_FILE_COMPRESSION_TYPE_ZSTD)
+		compressionType = CompressionTypeZstd; else
+		throw InfoFileValueException(InfoFileValueException::InvalidCompressionType, trim(value));
 	  continue;
 	} //Compression type;
       //Version;
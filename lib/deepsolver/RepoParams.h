@@ -18,6 +18,8 @@
 #ifndef DEEPSOLVER_REPO_PARAMS_H
 #define DEEPSOLVER_REPO_PARAMS_H
 
+#include"deepsolver/AbstractChecksum.h"
+
 namespace Deepsolver
 {
   class RepoParams
@@ -25,7 +27,8 @@ namespace Deepsolver
   public:
     enum {
       CompressionTypeNone = 0,
-      CompressionTypeGzip = 1
+      CompressionTypeGzip = 1,
+      CompressionTypeZstd = 2
     };
 
     enum {
@@ -39,7 +42,9 @@ namespace Deepsolver
 	formatType(FormatTypeText),
 	filterProvidesByRefs(0),
 	changeLogBinary(0),
-	changeLogSources(0)
+	changeLogSources(0),
+	compressionThreads(0),
+	checksumType(AbstractChecksum::TypeMd5)
     {}
 
   public:
@@ -58,8 +63,10 @@ namespace Deepsolver
     //Values not mapped into repo information file;
     std::string indexPath;
     StringVector pkgSources;
-    StringVector providesRefsSources;
+    StringVector providesRefsSources;//The references of each source are cached in indexPath, see REPO_REFS_CACHE_FILE;
     StringVector providesRefs;
+    size_t compressionThreads;//Zero means compressing in the calling thread;
+    char checksumType;//The algorithm for new checksum file items, the existing items keep theirs;
 
   public:
     void writeInfoFile(const std::string& fileName) const;
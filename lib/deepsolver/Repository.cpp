@@ -23,6 +23,8 @@
 #include"deepsolver/InfoFileReader.h"
 #include"deepsolver/TextFormatSectionReader.h"
 #include"deepsolver/PkgSection.h"
+#include"deepsolver/PkgSnapshot.h"
+#include"deepsolver/AutoReleaseStrings.h"
 
 DEEPSOLVER_BEGIN_NAMESPACE
 
@@ -42,6 +44,13 @@ namespace
 	reader->open(fileName);
 	return reader;
       }
+#ifdef HAVE_ZSTD
+      case RepoParams::CompressionTypeZstd: {
+	TextFormatSectionReaderZstd::Ptr reader(new TextFormatSectionReaderZstd());
+	reader->open(fileName);
+	return reader;
+      }
+#endif //HAVE_ZSTD;
       default:
 	assert(0);
       }
@@ -71,6 +80,44 @@ namespace
       lines.push_back(line);
   }
 
+  class ComponentStrings: public AutoReleaseStrings
+  {
+  public:
+    ConstCharVector& get()
+    {
+      return m_autoReleaseStrings;
+    }
+  }; //class ComponentStrings;
+
+  void componentPkgFile(const PkgSnapshot::Component& component,
+			PkgSnapshot::PkgVector::size_type index,
+			PkgFile& pkgFile)
+  {
+    const PkgSnapshot::Pkg& pkg = component.pkgs[index];
+    pkgFile.name = component.pkgNames[pkg.pkgId];
+    pkgFile.epoch = pkg.epoch;
+    pkgFile.version = pkg.ver;
+    pkgFile.release = pkg.release;
+    pkgFile.buildTime = pkg.buildTime;
+    pkgFile.fileName = component.fileNames[index];
+    pkgFile.arch = component.arches[index];
+    pkgFile.isSource = 0;
+  }
+
+  void componentRelations(const PkgSnapshot::Component& component,
+			  size_t pos,
+			  size_t count,
+			  NamedPkgRelVector& rels)
+  {
+    for(size_t i = pos;i < pos + count;i++)
+      {
+	const PkgSnapshot::Relation& rel = component.relations[i];
+	if (rel.verDir != VerNone)
+	  rels.push_back(NamedPkgRel(component.pkgNames[rel.pkgId], rel.verDir, rel.ver)); else
+	  rels.push_back(NamedPkgRel(component.pkgNames[rel.pkgId]));
+      }
+  }
+
   std::string getFileNameFromUrl(const std::string& url)
   {
     if (trim(url).empty())
@@ -134,6 +181,11 @@ void Repository::fetchInfoAndChecksum()
       throw OperationCoreException(OperationCoreException::InvalidChecksumData, m_checksumFileUrl);
     }
   Md5File::ItemVector::size_type i;
+  m_hasComponentSnapshot = 0;
+  for(i = 0;i < md5File.items.size();i++)
+    if (md5File.items[i].fileName == REPO_INDEX_PACKAGES_SNAPSHOT_FILE)
+      m_hasComponentSnapshot = 1;
+  logMsg(LOG_DEBUG, "repository:'%s' %s component snapshot", m_url.c_str(), m_hasComponentSnapshot?"has":"has no");
   for(i = 0;i < md5File.items.size();i++)
     if (md5File.items[i].fileName == REPO_INDEX_INFO_FILE)
       break;
@@ -170,6 +222,10 @@ void Repository::fetchInfoAndChecksum()
     m_compressionType = RepoParams::CompressionTypeNone; else
     if (compressionType == INFO_FILE_COMPRESSION_TYPE_GZIP)
       m_compressionType = RepoParams::CompressionTypeGzip; else
+#ifdef HAVE_ZSTD
+      if (compressionType == INFO_FILE_COMPRESSION_TYPE_ZSTD)
+	m_compressionType = RepoParams::CompressionTypeZstd; else
+#endif //HAVE_ZSTD;
       {
 	logMsg(LOG_ERR, "Unsupported compression type in info file: \'%s\'", compressionType.c_str());
 	throw OperationCoreException(OperationCoreException::InvalidInfoFile, infoFileUrl);
@@ -179,7 +235,9 @@ void Repository::fetchInfoAndChecksum()
 void Repository::addIndexFilesForFetch(StringToStringMap& files)
 {
   assert(m_formatType == RepoParams::FormatTypeText || m_formatType == RepoParams::FormatTypeBinary);
-  assert(m_compressionType == RepoParams::CompressionTypeNone || m_compressionType == RepoParams::CompressionTypeGzip);
+  assert(m_compressionType == RepoParams::CompressionTypeNone ||
+	 m_compressionType == RepoParams::CompressionTypeGzip ||
+	 m_compressionType == RepoParams::CompressionTypeZstd);
   assert(!m_url.empty());
   assert(!m_arch.empty());
   assert(!m_component.empty());
@@ -189,6 +247,7 @@ void Repository::addIndexFilesForFetch(StringToStringMap& files)
   dir += m_arch + "/";
   dir += std::string(REPO_INDEX_DIR) + "/ds." + m_component + "/";
   logMsg(LOG_DEBUG, "repository:constructing list of files to download, basic URL is \'%s\'", dir.c_str());
+  m_pkgSnapshotFileUrl = dir + REPO_INDEX_PACKAGES_SNAPSHOT_FILE;
   m_pkgFileUrl = dir + REPO_INDEX_PACKAGES_FILE;
   m_pkgDescrFileUrl = dir + REPO_INDEX_PACKAGES_DESCR_FILE;
   m_pkgFileListFileUrl = dir + REPO_INDEX_PACKAGES_FILELIST_FILE;
@@ -202,7 +261,18 @@ m_srcDescrFileUrl = dir + REPO_INDEX_SOURCES_DESCR_FILE;
       m_srcFileUrl += COMPRESSION_SUFFIX_GZIP;
       m_srcDescrFileUrl += COMPRESSION_SUFFIX_GZIP;
     }
-  files.insert(StringToStringMap::value_type(m_pkgFileUrl, ""));
+ if (m_compressionType == RepoParams::CompressionTypeZstd)
+    {
+      m_pkgFileUrl += COMPRESSION_SUFFIX_ZSTD;
+      m_pkgDescrFileUrl += COMPRESSION_SUFFIX_ZSTD;
+      m_pkgFileListFileUrl += COMPRESSION_SUFFIX_ZSTD;
+      m_srcFileUrl += COMPRESSION_SUFFIX_ZSTD;
+      m_srcDescrFileUrl += COMPRESSION_SUFFIX_ZSTD;
+    }
+  //The text packages file is needed only for servers without component snapshots;
+  if (m_hasComponentSnapshot)
+    files.insert(StringToStringMap::value_type(m_pkgSnapshotFileUrl, "")); else
+    files.insert(StringToStringMap::value_type(m_pkgFileUrl, ""));
   if (m_takeDescr)
     files.insert(StringToStringMap::value_type(m_pkgDescrFileUrl, ""));
   if (m_takeFileList)
@@ -218,9 +288,6 @@ void Repository::loadPackageData(const StringToStringMap& files,
 				 PkgUrlsFile& urlsFile,
 		     AbstractPkgRecipient& pkgInfoData)
 {
-  StringToStringMap::const_iterator it = files.find(m_pkgFileUrl);
-  assert(it != files.end());
-  const std::string pkgFileName = it->second;
   Md5File md5File;
   try {
     md5File.loadFromString(m_checksums, m_checksumFileUrl);
@@ -230,21 +297,15 @@ void Repository::loadPackageData(const StringToStringMap& files,
       logMsg(LOG_ERR, "Checksum file problem:%s", e.getMessage().c_str());
       throw OperationCoreException(OperationCoreException::InvalidChecksumData, m_checksumFileUrl);
     }
-  Md5File::ItemVector::size_type i;
-  assert(!getFileNameFromUrl(m_pkgFileUrl).empty());
-  for(i = 0;i < md5File.items.size();i++)
-    if (md5File.items[i].fileName == getFileNameFromUrl(m_pkgFileUrl))
-      break;
-  if (i >= md5File.items.size())
-    {
-      logMsg(LOG_ERR, "Checksum file from \'%s\' does not contain entry for main packages file from \'%s\'", m_checksumFileUrl.c_str(), m_pkgFileUrl.c_str());
-      throw OperationCoreException(OperationCoreException::InvalidChecksumData, m_checksumFileUrl);
-    }
-  if (!md5File.verifyItem(i, pkgFileName))
+  if (m_hasComponentSnapshot)
     {
-      logMsg(LOG_ERR, "repository:packages data from \'%s\' has incorrect checksum from \'%s\'", m_pkgFileUrl.c_str(), m_checksumFileUrl.c_str());
-      throw OperationCoreException(OperationCoreException::BrokenIndexFile, m_pkgFileUrl);
+      loadComponentSnapshot(files, md5File, transactData, urlsFile);
+      return;
     }
+  StringToStringMap::const_iterator it = files.find(m_pkgFileUrl);
+  assert(it != files.end());
+  const std::string pkgFileName = it->second;
+  verifyIndexFile(md5File, m_pkgFileUrl, pkgFileName);
   size_t invalidLineNum;
   std::string invalidLineValue;
   std::string sect;
@@ -328,6 +389,70 @@ void Repository::loadPackageData(const StringToStringMap& files,
   */
 }
 
+void Repository::loadComponentSnapshot(const StringToStringMap& files,
+				       const Md5File& md5File,
+				       AbstractPkgRecipient& transactData,
+				       PkgUrlsFile& urlsFile)
+{
+  StringToStringMap::const_iterator it = files.find(m_pkgSnapshotFileUrl);
+  assert(it != files.end());
+  const std::string snapshotFileName = it->second;
+  verifyIndexFile(md5File, m_pkgSnapshotFileUrl, snapshotFileName);
+  ComponentStrings strings;
+  PkgSnapshot::Component component;
+  if (!PkgSnapshot::loadComponentFromFile(component, snapshotFileName, strings.get()))
+    {
+      logMsg(LOG_ERR, "repository:broken component snapshot '%s'", m_pkgSnapshotFileUrl.c_str());
+      throw OperationCoreException(OperationCoreException::BrokenIndexFile, m_pkgSnapshotFileUrl);
+    }
+  for(PkgSnapshot::PkgVector::size_type i = 0;i < component.pkgs.size();i++)
+    {
+      PkgFile pkgFile;
+      componentPkgFile(component, i, pkgFile);
+      if (m_stopOnInvalidRepoPkg && !pkgFile.valid())
+	throw OperationCoreException(OperationCoreException::InvalidRepoPkg);
+      urlsFile.addPkg(pkgFile, buildBinaryPackageUrl(pkgFile));
+    }
+  if (transactData.onNewComponent(component))
+    {
+      logMsg(LOG_DEBUG, "repository:%zu packages from '%s' were merged as the component snapshot", component.pkgs.size(), m_pkgSnapshotFileUrl.c_str());
+      return;
+    }
+  for(PkgSnapshot::PkgVector::size_type i = 0;i < component.pkgs.size();i++)
+    {
+      const PkgSnapshot::Pkg& pkg = component.pkgs[i];
+      PkgFile pkgFile;
+      componentPkgFile(component, i, pkgFile);
+      componentRelations(component, pkg.requiresPos, pkg.requiresCount, pkgFile.requires);
+      componentRelations(component, pkg.conflictsPos, pkg.conflictsCount, pkgFile.conflicts);
+      componentRelations(component, pkg.providesPos, pkg.providesCount, pkgFile.provides);
+      componentRelations(component, pkg.obsoletesPos, pkg.obsoletesCount, pkgFile.obsoletes);
+      transactData.onNewPkgFile(pkgFile);
+    }
+  logMsg(LOG_DEBUG, "repository:successfully read %zu packages from '%s'", component.pkgs.size(), m_pkgSnapshotFileUrl.c_str());
+}
+
+void Repository::verifyIndexFile(const Md5File& md5File,
+				 const std::string& url,
+				 const std::string& fileName) const
+{
+  Md5File::ItemVector::size_type i;
+  assert(!getFileNameFromUrl(url).empty());
+  for(i = 0;i < md5File.items.size();i++)
+    if (md5File.items[i].fileName == getFileNameFromUrl(url))
+      break;
+  if (i >= md5File.items.size())
+    {
+      logMsg(LOG_ERR, "Checksum file from '%s' does not contain entry for main packages file from '%s'", m_checksumFileUrl.c_str(), url.c_str());
+      throw OperationCoreException(OperationCoreException::InvalidChecksumData, m_checksumFileUrl);
+    }
+  if (!md5File.verifyItem(i, fileName))
+    {
+      logMsg(LOG_ERR, "repository:packages data from '%s' has incorrect checksum from '%s'", url.c_str(), m_checksumFileUrl.c_str());
+      throw OperationCoreException(OperationCoreException::BrokenIndexFile, url);
+    }
+}
+
 std::string Repository::buildInfoFileUrl() const
 {
   assert(!m_url.empty());
@@ -22,6 +22,7 @@
 #include"deepsolver/AbstractPkgRecipient.h"
 #include"deepsolver/RepoParams.h"
 #include"deepsolver/PkgUrlsFile.h"
+#include"deepsolver/Md5File.h"
 
 namespace Deepsolver
 {
@@ -43,7 +44,8 @@ namespace Deepsolver
 	m_takeFileList(confRepo.takeFileList),
 	m_takeSources(confRepo.takeSources),
 	m_compressionType(RepoParams::CompressionTypeNone),
-	m_formatType(RepoParams::FormatTypeText)
+	m_formatType(RepoParams::FormatTypeText),
+	m_hasComponentSnapshot(0)
     {
       assert(!m_url.empty());
       assert(!m_arch.empty());
@@ -69,6 +71,13 @@ namespace Deepsolver
 			 AbstractPkgRecipient& pkgInfoData);
 
   private:
+    void loadComponentSnapshot(const StringToStringMap& files,
+			       const Md5File& md5File,
+			       AbstractPkgRecipient& transactData,
+			       PkgUrlsFile& urlsFile);
+    void verifyIndexFile(const Md5File& md5File,
+			 const std::string& url,
+			 const std::string& fileName) const;
     std::string buildInfoFileUrl() const;
     std::string buildChecksumFileUrl() const;
     std::string buildBinaryPackageUrl(const PkgFile& pkgFile) const;
@@ -81,6 +90,8 @@ namespace Deepsolver
     std::string m_checksumFileUrl, m_checksums;
     char m_compressionType;
     char m_formatType;
+    bool m_hasComponentSnapshot;//The binary packages snapshot is taken instead of the text packages file;
+    std::string m_pkgSnapshotFileUrl;
     std::string m_pkgFileUrl, m_pkgDescrFileUrl, m_pkgFileListFileUrl, m_srcFileUrl, m_srcDescrFileUrl;
     std::string m_checksumFileName;
   }; //class Repository;
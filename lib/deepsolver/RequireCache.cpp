@@ -0,0 +1,80 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/RequireCache.h"
+
+DEEPSOLVER_BEGIN_SOLVER_NAMESPACE
+
+void RequireCache::selectMatchingVarsWithProvides(const AbstractPkgScope& scope,
+						  const IdPkgRel& rel,
+						  VarIdVector& vars)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_generation != scope.getGeneration())
+      {
+	m_rels.clear();
+	m_generation = scope.getGeneration();
+      }
+    RelToVarsMap::const_iterator it = m_rels.find(rel);
+    if (it != m_rels.end())
+      {
+	m_hitCount++;
+	vars = it->second;
+	return;
+      }
+    m_missCount++;
+  }
+  //The lookup is performed without the lock, concurrent solvings may only do it twice;
+  vars.clear();
+  const MatchingVars matching = scope.matchingVarsWithProvides(IdPkgRelRef(rel));
+  vars.insert(vars.end(), matching.begin(), matching.end());
+  noDoubling(vars);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_generation == scope.getGeneration())
+    m_rels.insert(RelToVarsMap::value_type(rel, vars));
+}
+
+void RequireCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_rels.clear();
+  m_generation = 0;
+  m_hitCount = 0;
+  m_missCount = 0;
+}
+
+size_t RequireCache::getHitCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_hitCount;
+}
+
+size_t RequireCache::getMissCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_missCount;
+}
+
+size_t RequireCache::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_rels.size();
+}
+
+DEEPSOLVER_END_SOLVER_NAMESPACE
@@ -0,0 +1,82 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_REQUIRE_CACHE_H
+#define DEEPSOLVER_REQUIRE_CACHE_H
+
+#include"deepsolver/SolverBase.h"
+
+namespace Deepsolver
+{
+  namespace Solver
+  {
+    /**\brief The memoized matching of package relations
+     *
+     * Many packages require the same relations (the C library, the shell
+     * and so on), so the lookup of matching packages with provides is
+     * performed only once for each relation. The stored list has no
+     * repeated items. The content depends only on the package scope, so
+     * one cache can be shared between several solvings with the same scope
+     * (even concurrent ones), but it is dropped once used with another
+     * scope or with the same one after a change of its content, as told by
+     * AbstractPkgScope::getGeneration().
+     */
+    class RequireCache
+    {
+    public:
+      typedef std::shared_ptr<RequireCache> Ptr;
+
+    public:
+      /**\brief The default constructor*/
+      RequireCache()
+	: m_generation(0),
+	  m_hitCount(0),
+	  m_missCount(0) {}
+
+      /**\brief The destructor*/
+      virtual ~RequireCache() {}
+
+    public:
+      /**\brief Selects packages matching the relation with provides
+       *
+       * \param [in] scope The package scope to perform lookup in
+       * \param [in] rel The relation to find matching packages for
+       * \param [out] vars The matching packages without repeated items
+       */
+      void selectMatchingVarsWithProvides(const AbstractPkgScope& scope,
+					  const IdPkgRel& rel,
+					  VarIdVector& vars);
+
+      void clear();
+      size_t getHitCount() const;
+      size_t getMissCount() const;
+      size_t size() const;
+
+    private:
+      typedef std::unordered_map<IdPkgRel, VarIdVector, IdPkgRelHash> RelToVarsMap;
+
+    private:
+      mutable std::mutex m_mutex;
+      size_t m_generation;//Of the scope the content is for, zero if none;
+      RelToVarsMap m_rels;
+      size_t m_hitCount;
+      size_t m_missCount;
+    }; //class RequireCache;
+  } //namespace Solver;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_REQUIRE_CACHE_H;
@@ -24,6 +24,7 @@ DEEPSOLVER_BEGIN_NAMESPACE
 
 static bool alreadyReadConfigFiles = 0;
 static int buildSenseFlags(const VerSubset& c);
+static int buildSenseFlags(VerDirection dir);
 
 void RpmBackEnd::initialize()
 {
@@ -45,6 +46,16 @@ bool RpmBackEnd::verOverlap(const VerSubset& ver1, const VerSubset& ver2) const
 			  "", ver2.version.c_str(), buildSenseFlags(ver2));
 }
 
+bool RpmBackEnd::verRangesOverlap(const char* ver1,
+				  VerDirection dir1,
+				  const char* ver2,
+				  VerDirection dir2) const
+{
+  assert(ver1 != NULL && ver2 != NULL);
+  return rpmRangesOverlap("", ver1, buildSenseFlags(dir1),
+			  "", ver2, buildSenseFlags(dir2));
+}
+
 bool RpmBackEnd::verEqual(const std::string& ver1, const std::string& ver2) const
 {
   return verOverlap(VerSubset(ver1), VerSubset(ver2));
@@ -62,21 +73,36 @@ AbstractInstalledPkgIterator::Ptr RpmBackEnd::enumInstalledPkg() const
   return rpmIt;
 }
 
-void RpmBackEnd::readPkgFile(const std::string& fileName, PkgFile& pkgFile) const
+void RpmBackEnd::readPkgFile(const std::string& fileName,
+			     PkgFile& pkgFile,
+			     int fields,
+			     std::string* digest) const
 {
   RpmFileHeaderReader reader;
-  reader.load(fileName);
-  reader.fillMainData(pkgFile);
-  reader.fillProvides(pkgFile.provides);
-  reader.fillConflicts(pkgFile.conflicts);
-  reader.fillObsoletes(pkgFile.obsoletes);
-  reader.fillRequires(pkgFile.requires);
-  reader.fillChangeLog(pkgFile.changeLog);
-  reader.fillFileList(pkgFile.fileList);
+  reader.load(fileName, digest);
+  if (fields & PkgFieldMainData)
+    reader.fillMainData(pkgFile);
+  if (fields & PkgFieldProvides)
+    reader.fillProvides(pkgFile.provides);
+  if (fields & PkgFieldConflicts)
+    reader.fillConflicts(pkgFile.conflicts);
+  if (fields & PkgFieldObsoletes)
+    reader.fillObsoletes(pkgFile.obsoletes);
+  if (fields & PkgFieldRequires)
+    reader.fillRequires(pkgFile.requires);
+  if (fields & PkgFieldChangeLog)
+    reader.fillChangeLog(pkgFile.changeLog);
+  if (fields & PkgFieldFileList)
+    reader.fillFileList(pkgFile.fileList);
   reader.close();
   pkgFile.fileName = fileName;
 }
 
+std::string RpmBackEnd::getPkgFileDigest(const std::string& fileName) const
+{
+  return RpmFileHeaderReader::digest(fileName);
+}
+
 bool RpmBackEnd::validPkgFileName(const std::string& fileName) const
 {
   if (fileName.length() <= 4)
@@ -100,13 +126,18 @@ bool RpmBackEnd::validSourcePkgFileName(const std::string& fileName) const
 }
 
 int buildSenseFlags(const VerSubset& c)
+{
+  return buildSenseFlags(c.type);
+}
+
+int buildSenseFlags(VerDirection dir)
 {
   int value = 0;
-  if (c.isEqual())
+  if (dir & VerEquals)
     value |= RPMSENSE_EQUAL;
-  if (c.isLess())
+  if (dir & VerLess)
     value |= RPMSENSE_LESS;
-  if (c.isGreater())
+  if (dir & VerGreater)
     value |= RPMSENSE_GREATER;
   return value;
 }
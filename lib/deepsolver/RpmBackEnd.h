@@ -49,10 +49,20 @@ namespace Deepsolver
     void initialize() override;
     int verCmp(const std::string& ver1, const std::string& ver2) const override;
     bool verOverlap(const VerSubset& ver1, const VerSubset& ver2) const override;
+
+    bool verRangesOverlap(const char* ver1,
+			  VerDirection dir1,
+			  const char* ver2,
+			  VerDirection dir2) const override;
+
     bool verEqual(const std::string& ver1, const std::string& ver2) const override;
     bool verGreater(const std::string& ver1, const std::string& ver2) const override;
     AbstractInstalledPkgIterator::Ptr enumInstalledPkg() const override;
-    void readPkgFile(const std::string& fileName, PkgFile& pkgFile) const override;
+    void readPkgFile(const std::string& fileName,
+		     PkgFile& pkgFile,
+		     int fields,
+		     std::string* digest) const override;
+    std::string getPkgFileDigest(const std::string& fileName) const override;
     bool validPkgFileName(const std::string& fileName) const override;
     bool validSourcePkgFileName(const std::string& fileName) const override;
 
@@ -24,13 +24,39 @@
 #include"deepsolver/deepsolver.h"
 #include"deepsolver/RpmFileHeaderReader.h"
 #include"deepsolver/rpmHeader.h"
+#include"deepsolver/Md5.h"
+
+#define RPM_LEAD_SIZE 96
+#define RPM_LEAD_MAJOR_OFFSET 4
+#define RPM_LEAD_SIGNATURE_TYPE_OFFSET 78
+#define RPM_SIGNATURE_TYPE_HEADER 5
+#define RPM_HEADER_PREFIX_SIZE 16
+#define RPM_HEADER_MAX_INDEX_COUNT 65536
+#define RPM_HEADER_MAX_DATA_SIZE 268435456
 
 DEEPSOLVER_BEGIN_NAMESPACE
 
-void RpmFileHeaderReader::load(const std::string& fileName)
+static Header loadMappedHeader(const std::string& fileName, std::string* digest);
+static std::string mappedDigest(const unsigned char* data, size_t size);
+static const unsigned char* mapFile(const std::string& fileName, size_t& size);
+static bool findMainHeader(const unsigned char* data, size_t size, size_t& offset, size_t& headerSize);
+static uint32_t readBigEndian32(const unsigned char* p);
+static bool headerBlockSize(const unsigned char* data, size_t size, size_t offset, size_t& blockSize);
+
+void RpmFileHeaderReader::load(const std::string& fileName, std::string* digest)
 {
   assert(m_fd == NULL);
   assert(m_header == NULL);
+  m_header = loadMappedHeader(fileName, digest);
+  if (m_header != NULL)
+    {
+      m_fileName = fileName;
+      return;
+    }
+  //Files not mapped above are read for the digest separately;
+  if (digest != NULL)
+    *digest = RpmFileHeaderReader::digest(fileName);
+  //Packages of unusual layout are left to librpm;
   m_fd = Fopen(fileName.c_str(), "r");
   if (m_fd == NULL)
     throw PkgBackEndException("Fopen(" + fileName + ")");
@@ -92,4 +118,120 @@ void RpmFileHeaderReader::fillFileList(StringVector& v)
   rpmFillFileList(m_header, v);
 }
 
+std::string RpmFileHeaderReader::digest(const std::string& fileName)
+{
+  size_t size;
+  const unsigned char* data = mapFile(fileName, size);
+  if (data != NULL)
+    {
+      const std::string res = mappedDigest(data, size);
+      munmap(const_cast<unsigned char*>(data), size);
+      return res;
+    }
+  Md5 md5;
+  md5.init();
+  File f;
+  f.openReadOnly(fileName);
+  char buf[4096];
+  while(1)
+    {
+      const size_t count = f.read(buf, sizeof(buf));
+      if (!count)
+	break;
+      md5.update(buf, count);
+    }
+  f.close();
+  return md5.commit();
+}
+
+//Static functions;
+
+/*
+ * The package file starts with the lead of fixed size, followed by the
+ * signature header padded to 8 bytes and the main header. Each header
+ * has 8 bytes of magic, the number of index entries, the size of data,
+ * 16 bytes for every index entry and the data itself. Only the pages
+ * with the headers are read from the disk, the payload is not touched.
+ * Packages older than format 4 need header conversions made by librpm,
+ * they are not handled here as well as anything unexpected.
+ */
+Header loadMappedHeader(const std::string& fileName, std::string* digest)
+{
+  size_t size;
+  const unsigned char* data = mapFile(fileName, size);
+  if (data == NULL)
+    return NULL;
+  Header header = NULL;
+  size_t offset, headerSize;
+  //The copy is made since the mapping doesn't live longer than this function;
+  if (findMainHeader(data, size, offset, headerSize))
+    header = headerCopyLoad(data + offset + 8);
+  if (header != NULL && digest != NULL)
+    *digest = mappedDigest(data, size);
+  munmap(const_cast<unsigned char*>(data), size);
+  if (header == NULL)
+    logMsg(LOG_DEBUG, "rpm:\'%s\' has no headers at expected places, reading it through librpm", fileName.c_str());
+  return header;
+}
+
+//The lead, the signature and the main header, or everything if the layout is unexpected;
+std::string mappedDigest(const unsigned char* data, size_t size)
+{
+  Md5 md5;
+  md5.init();
+  size_t offset, headerSize;
+  md5.update(data, findMainHeader(data, size, offset, headerSize)?offset + headerSize:size);
+  return md5.commit();
+}
+
+//Returns NULL if the file can't be mapped or it is too small to be a package;
+const unsigned char* mapFile(const std::string& fileName, size_t& size)
+{
+  const int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd == -1)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < RPM_LEAD_SIZE + RPM_HEADER_PREFIX_SIZE)
+    {
+      ::close(fd);
+      return NULL;
+    }
+  size = st.st_size;
+  void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    return NULL;
+  return static_cast<const unsigned char*>(addr);
+}
+
+bool findMainHeader(const unsigned char* data, size_t size, size_t& offset, size_t& headerSize)
+{
+  static const unsigned char leadMagic[] = {0xed, 0xab, 0xee, 0xdb};
+  size_t sigSize;
+  if (memcmp(data, leadMagic, sizeof(leadMagic)) != 0 || data[RPM_LEAD_MAJOR_OFFSET] < 4 ||
+      data[RPM_LEAD_SIGNATURE_TYPE_OFFSET] != 0 || data[RPM_LEAD_SIGNATURE_TYPE_OFFSET + 1] != RPM_SIGNATURE_TYPE_HEADER ||
+      !headerBlockSize(data, size, RPM_LEAD_SIZE, sigSize))
+    return 0;
+  offset = RPM_LEAD_SIZE + (sigSize + 7) / 8 * 8;
+  return headerBlockSize(data, size, offset, headerSize);
+}
+
+uint32_t readBigEndian32(const unsigned char* p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+bool headerBlockSize(const unsigned char* data, size_t size, size_t offset, size_t& blockSize)
+{
+  static const unsigned char headerMagic[] = {0x8e, 0xad, 0xe8, 0x01};
+  if (offset + RPM_HEADER_PREFIX_SIZE > size || memcmp(data + offset, headerMagic, sizeof(headerMagic)) != 0)
+    return 0;
+  const uint32_t indexCount = readBigEndian32(data + offset + 8);
+  const uint32_t dataSize = readBigEndian32(data + offset + 12);
+  if (indexCount == 0 || indexCount > RPM_HEADER_MAX_INDEX_COUNT || dataSize > RPM_HEADER_MAX_DATA_SIZE)
+    return 0;
+  blockSize = RPM_HEADER_PREFIX_SIZE + (size_t)indexCount * 16 + dataSize;
+  return offset + blockSize <= size;
+}
+
 DEEPSOLVER_END_NAMESPACE
@@ -34,7 +34,12 @@ namespace Deepsolver
     }
 
   public:
-    void load(const std::string& fileName);
+    /**\brief Reads the main header of the package file
+     *
+     * \param [in] fileName The name of the package file
+     * \param [out] digest The place to save the value of digest() to, may be NULL
+     */
+    void load(const std::string& fileName, std::string* digest = NULL);
     void close();
     void fillMainData(PkgFileBase& pkg);
     void fillProvides(NamedPkgRelVector& v);
@@ -44,6 +49,18 @@ namespace Deepsolver
     void fillChangeLog(ChangeLog& changeLog);
     void fillFileList(StringVector& v);
 
+    /**\brief Calculates md5 of the lead, the signature and the header
+     *
+     * The signature has the digests of the header and the payload, so
+     * the value changes with any change of the package content. Files
+     * of unexpected layout are taken completely.
+     *
+     * \param [in] fileName The name of the package file
+     *
+     * \return The md5 value in hexadecimal form
+     */
+    static std::string digest(const std::string& fileName);
+
   private:
     FD_t m_fd;
     Header m_header;
@@ -18,12 +18,170 @@
 #include"deepsolver/deepsolver.h"
 #include"deepsolver/Sat.h"
 #include"deepsolver/MinisatSolver.h"
+#include"deepsolver/CdclSolver.h"
+#include"deepsolver/PortfolioSatSolver.h"
+
+#define PORTFOLIO_MAX_MEMBERS 4
 
 DEEPSOLVER_BEGIN_SAT_NAMESPACE
 
+typedef std::map<std::string, SatSolverFactory> SatSolverFactoryMap;
+
+static std::mutex registryMutex;
+static SatSolverFactoryMap registry;
+static bool builtInRegistered = 0;
+
+static AbstractSatSolver::Ptr createMinisatSolver(unsigned int seed)
+{
+  return AbstractSatSolver::Ptr(new MinisatSolver());
+}
+
+static AbstractSatSolver::Ptr createCdclSolver(unsigned int seed)
+{
+  return AbstractSatSolver::Ptr(new CdclSolver(seed));
+}
+
+static AbstractSatSolver::Ptr createPortfolioSatSolver(unsigned int seed)
+{
+  //The built-in solver with different seeds, one per processor, minisat is not taken since it cannot be interrupted after losing;
+  size_t count = std::thread::hardware_concurrency();
+  if (count < 2)
+    count = 2;
+  if (count > PORTFOLIO_MAX_MEMBERS)
+    count = PORTFOLIO_MAX_MEMBERS;
+  StringVector members;
+  for(size_t i = 0;i < count;i++)
+    {
+      std::ostringstream ss;
+      ss << "cdcl:" << (seed + i);
+      members.push_back(ss.str());
+    }
+  return AbstractSatSolver::Ptr(new PortfolioSatSolver(members));
+}
+
+//Must be called with locked registryMutex;
+static void ensureBuiltInRegistered()
+{
+  if (builtInRegistered)
+    return;
+  registry.insert(SatSolverFactoryMap::value_type("minisat", createMinisatSolver));
+  registry.insert(SatSolverFactoryMap::value_type("cdcl", createCdclSolver));
+  registry.insert(SatSolverFactoryMap::value_type(SAT_SOLVER_PORTFOLIO, createPortfolioSatSolver));
+  builtInRegistered = 1;
+}
+
 AbstractSatSolver::Ptr createDefaultSatSolver()
 {
   return AbstractSatSolver::Ptr(new MinisatSolver());
 }
 
+void registerSatSolver(const std::string& name, SatSolverFactory factory)
+{
+  assert(!name.empty() && name.find(':') == std::string::npos);
+  assert(factory != NULL);
+  std::lock_guard<std::mutex> lock(registryMutex);
+  ensureBuiltInRegistered();
+  registry[name] = factory;
+}
+
+AbstractSatSolver::Ptr createSatSolver(const std::string& name)
+{
+  std::string solverName = name;
+  unsigned int seed = 0;
+  const std::string::size_type pos = name.find(':');
+  if (pos != std::string::npos)
+    {
+      solverName = name.substr(0, pos);
+      const std::string seedStr = name.substr(pos + 1);
+      char* end;
+      const unsigned long value = strtoul(seedStr.c_str(), &end, 10);
+      if (seedStr.empty() || *end != '\0')
+	return AbstractSatSolver::Ptr();
+      seed = (unsigned int)value;
+    }
+  SatSolverFactory factory = NULL;
+  {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ensureBuiltInRegistered();
+    SatSolverFactoryMap::const_iterator it = registry.find(solverName);
+    if (it == registry.end())
+      return AbstractSatSolver::Ptr();
+    factory = it->second;
+  }
+  return factory(seed);
+}
+
+void getSatSolverNames(StringVector& names)
+{
+  names.clear();
+  std::lock_guard<std::mutex> lock(registryMutex);
+  ensureBuiltInRegistered();
+  for(SatSolverFactoryMap::const_iterator it = registry.begin();it != registry.end();it++)
+    names.push_back(it->first);
+}
+
+void saveDimacs(const Sat& sat,
+		std::ostream& s,
+		VarIdVector& vars)
+{
+  vars.clear();
+  std::map<VarId, size_t> varIdToDimacs;
+  for(Sat::size_type i = 0;i < sat.size();++i)
+    for(Clause::size_type k = 0;k < sat[i].size();++k)
+      if (varIdToDimacs.find(sat[i][k].varId) == varIdToDimacs.end())
+	{
+	  vars.push_back(sat[i][k].varId);
+	  varIdToDimacs.insert(std::map<VarId, size_t>::value_type(sat[i][k].varId, vars.size()));
+	}
+  size_t clauseCount = 0;
+  for(Sat::size_type i = 0;i < sat.size();++i)
+    if (!sat[i].empty())//Empty clauses are skipped by SAT solvers as well;
+      clauseCount++;
+  s << "p cnf " << vars.size() << " " << clauseCount << std::endl;
+  for(Sat::size_type i = 0;i < sat.size();++i)
+    {
+      if (sat[i].empty())
+	continue;
+      for(Clause::size_type k = 0;k < sat[i].size();++k)
+	{
+	  std::map<VarId, size_t>::const_iterator it = varIdToDimacs.find(sat[i][k].varId);
+	  assert(it != varIdToDimacs.end());
+	  if (sat[i][k].neg)
+	    s << "-";
+	  s << it->second << " ";
+	}
+      s << "0" << std::endl;
+    }
+}
+
+bool loadDimacs(std::istream& s, Sat& sat)
+{
+  sat.clear();
+  Clause clause;
+  std::string line;
+  while(std::getline(s, line))
+    {
+      const std::string l = trim(line);
+      if (l.empty() || l[0] == 'c' || l[0] == 'p' || l[0] == '%')
+	continue;
+      std::istringstream ss(l);
+      long value;
+      while(ss >> value)
+	{
+	  if (value == 0)
+	    {
+	      sat.push_back(clause);
+	      clause.clear();
+	      continue;
+	    }
+	  clause.push_back(Lit((VarId)(value > 0?value:-value) - 1, value < 0));
+	}
+      if (!ss.eof())
+	return 0;
+    }
+  if (!clause.empty())
+    sat.push_back(clause);
+  return 1;
+}
+
 DEEPSOLVER_END_SAT_NAMESPACE
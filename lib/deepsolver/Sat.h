@@ -29,18 +29,15 @@ namespace Deepsolver
     {
       Lit()
 	: varId(BadVarId),
-	  neg(0),
-	  ambiguous(0) {}
+	  neg(0) {}
 
       Lit(VarId v)
 	: varId(v),
-	  neg(0),
-	  ambiguous(0) {}
+	  neg(0) {}
 
       Lit(VarId v, bool n)
 	: varId(v),
-	  neg(n),
-	  ambiguous(0) {}
+	  neg(n) {}
 
       bool operator ==(const Lit& lit) const
       {
@@ -78,7 +75,6 @@ namespace Deepsolver
 
       VarId varId;
       bool neg;
-      bool ambiguous;
     }; //struct Lit;
 
     typedef std::vector<Lit> Clause;
@@ -91,6 +87,23 @@ namespace Deepsolver
       return c;
     }
 
+    /**\brief The statistics of single SAT solving
+     *
+     * Not every SAT solver is able to provide these values, in that case
+     * AbstractSatSolver::getStat() returns zero.
+     */
+    struct SatStat
+    {
+      SatStat()
+	: decisions(0),
+	  conflicts(0),
+	  propagations(0) {}
+
+      size_t decisions;
+      size_t conflicts;
+      size_t propagations;
+    }; //struct SatStat;
+
     class AbstractSatSolver
     {
     public:
@@ -107,9 +120,168 @@ namespace Deepsolver
       virtual void reset() = 0;
       virtual void addClause(const Clause& clause) = 0;
       virtual bool solve(VarIdToBoolMap& res, VarIdVector& conflicts) = 0;
+
+      /**\brief Provides the statistics of the last solving
+       *
+       * \param [out] stat The object to save statistics to
+       *
+       * \return Non-zero if the statistics is available or zero otherwise
+       */
+      virtual bool getStat(SatStat& stat) const
+      {
+	return 0;
+      }
+
+      /**\brief Asks the running solving to stop as soon as possible
+       *
+       * This method may be called from any thread. The interrupted
+       * solve() call returns zero without any collisions. Solvers unable
+       * to stop in the middle of the work just ignore this request.
+       */
+      virtual void interrupt() {}
+
+      /**\brief Checks if the solver stops on interrupt() in the middle of the work
+       *
+       * The solving of uninterruptible solvers always runs until the
+       * answer, so the time limit and the user request cannot stop it and
+       * it is not worth running it on a separate thread.
+       *
+       * \return Non-zero if interrupt() stops the running solving
+       */
+      virtual bool isInterruptible() const
+      {
+	return 0;
+      }
+
+      /**\brief Sets the maximum number of conflicts for following solvings
+       *
+       * The solve() call stopped by the conflict limit returns zero and
+       * isAborted() returns non-zero after it. Solvers without conflicts
+       * counting ignore the limit.
+       *
+       * \param [in] limit The maximum number of conflicts, zero means no limit
+       */
+      virtual void setConflictLimit(size_t limit) {}
+
+      /**\brief Suggests the value to try first for the variable
+       *
+       * The suggestion affects only the order of the search, not the
+       * result existence. Solvers without such control ignore it.
+       *
+       * \param [in] lit The literal desired to be true
+       */
+      virtual void setPhase(const Lit& lit) {}
+
+      /**\brief Checks if the last solving was stopped without an answer
+       *
+       * The solving is aborted if it was interrupted or if the
+       * conflict limit was reached. In that case the zero returned by
+       * solve() doesn't mean the equation has no solution.
+       *
+       * \return Non-zero if the last solving was aborted
+       */
+      virtual bool isAborted() const
+      {
+	return 0;
+      }
+
+      /**\brief Checks if the solver is able to solve under assumptions
+       *
+       * Solvers with this feature implement solveAssuming() and keep the
+       * added clauses between solvings, so new clauses may be added after
+       * each solve() call without resetting.
+       */
+      virtual bool hasAssumptions() const
+      {
+	return 0;
+      }
+
+      /**\brief Solves the equation with some literals assumed to be true
+       *
+       * The assumptions are not added to the equation, they are in effect
+       * only during this call. If there is no solution the core receives
+       * the assumptions which are enough for the contradiction. The empty
+       * core means there is no solution at all (or the solving is
+       * aborted, see isAborted()). This method may be called only if
+       * hasAssumptions() returns non-zero.
+       *
+       * \param [in] assumptions The literals assumed to be true
+       * \param [out] res The solution if there is any
+       * \param [out] core The assumptions making the equation unsolvable
+       *
+       * \return Non-zero if there is a solution or zero otherwise
+       */
+      virtual bool solveAssuming(const Clause& assumptions,
+				 VarIdToBoolMap& res,
+				 Clause& core)
+      {
+	assert(0);
+	return 0;
+      }
     }; //class AbstractSatSolver;
 
+    /**\brief The function type constructing SAT solvers of particular kind
+     *
+     * The seed value is used by solvers with random decisions, so that the
+     * same backend can be started several times in portfolio mode with
+     * different behaviour. Other solvers ignore it.
+     */
+    typedef AbstractSatSolver::Ptr (*SatSolverFactory)(unsigned int seed);
+
     AbstractSatSolver::Ptr createDefaultSatSolver();
+
+    /**\brief Registers new kind of SAT solver
+     *
+     * Registering a name for the second time replaces the previous
+     * factory. The built-in solvers "minisat", "cdcl" and "portfolio" are
+     * registered automatically.
+     *
+     * \param [in] name The name of the solver
+     * \param [in] factory The function to construct solver instances
+     */
+    void registerSatSolver(const std::string& name, SatSolverFactory factory);
+
+    /**\brief Creates SAT solver by its registered name
+     *
+     * The name may have the seed value after the colon, like
+     * "cdcl:3". Without explicit seed the value of zero is used.
+     *
+     * \param [in] name The name of the solver with optional seed
+     *
+     * \return The new solver or empty pointer if there is no such name
+     */
+    AbstractSatSolver::Ptr createSatSolver(const std::string& name);
+
+    /**\brief Fills the list with names of all registered SAT solvers*/
+    void getSatSolverNames(StringVector& names);
+
+    /**\brief Saves SAT in DIMACS CNF format
+     *
+     * Variables are numbered in order of their first appearance in the
+     * equation, exactly as it is done by the MinisatSolver class. The
+     * numbers of DIMACS variables are mapped back to VarId through
+     * the vars vector: DIMACS variable n corresponds to vars[n - 1].
+     *
+     * \param [in] sat The equation to save
+     * \param [in] s The stream to write to
+     * \param [out] vars The VarId of each DIMACS variable
+     */
+    void saveDimacs(const Sat& sat,
+		    std::ostream& s,
+		    VarIdVector& vars);
+
+    /**\brief Loads SAT from a DIMACS CNF file
+     *
+     * DIMACS variable n is loaded as VarId n - 1. Comment lines and the
+     * problem line are skipped, the variable and clause counts mentioned
+     * in the problem line are not verified.
+     *
+     * \param [in] s The stream to read from
+     * \param [out] sat The loaded equation
+     *
+     * \return Non-zero if the content is valid or zero otherwise
+     */
+    bool loadDimacs(std::istream& s, Sat& sat);
   } //namespace Sat;
 } //namespace Deepsolver;
 
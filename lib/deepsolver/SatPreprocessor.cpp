@@ -0,0 +1,332 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/SatPreprocessor.h"
+
+DEEPSOLVER_BEGIN_SAT_NAMESPACE
+
+void SatPreprocessor::prefer(VarId varId, bool value)
+{
+  assert(varId != BadVarId);
+  m_preferred[varId] = value;
+}
+
+bool SatPreprocessor::run(const Sat& sat,
+			  SatVector& components,
+			  VarIdToBoolMap& fixed,
+			  VarIdVector& conflicts)
+{
+  components.clear();
+  fixed.clear();
+  conflicts.clear();
+  m_varIdToVar.clear();
+  m_varToVarId.clear();
+  m_clauses.clear();
+  m_occurs.clear();
+  m_unitCount = 0;
+  m_pureCount = 0;
+  m_subsumedCount = 0;
+  for(Sat::size_type i = 0;i < sat.size();i++)
+    {
+      if (sat[i].empty())//Empty clauses are skipped by SAT solvers as well;
+	continue;
+      PClause c;
+      for(Clause::size_type k = 0;k < sat[i].size();k++)
+	c.lits.push_back((mapVarId(sat[i][k].varId) << 1) | (sat[i][k].neg?1:0));
+      std::sort(c.lits.begin(), c.lits.end());
+      c.lits.erase(std::unique(c.lits.begin(), c.lits.end()), c.lits.end());
+      bool tautology = 0;
+      for(PLitVector::size_type k = 1;k < c.lits.size();k++)
+	if ((c.lits[k] >> 1) == (c.lits[k - 1] >> 1))
+	  tautology = 1;
+      if (tautology)
+	continue;
+      c.freeCount = c.lits.size();
+      for(PLitVector::size_type k = 0;k < c.lits.size();k++)
+	m_occurs[c.lits[k]].push_back(m_clauses.size());
+      m_clauses.push_back(c);
+    }
+  m_values.assign(m_varToVarId.size(), ValueUndef);
+  //Unit propagation;
+  PLitVector queue;
+  size_t conflict = m_clauses.size();
+  for(PClauseVector::size_type i = 0;i < m_clauses.size();i++)
+    if (m_clauses[i].lits.size() == 1 && !assign(m_clauses[i].lits[0], queue))
+      {
+	conflict = i;
+	break;
+      }
+  if (conflict < m_clauses.size() || !propagate(queue, conflict))
+    {
+      const PLitVector& lits = m_clauses[conflict].lits;
+      for(PLitVector::size_type i = 0;i < lits.size();i++)
+	conflicts.push_back(m_varToVarId[lits[i] >> 1]);
+      logMsg(LOG_DEBUG, "preprocessor:unit propagation has found a conflict, no solution");
+      return 0;
+    }
+  m_unitCount = queue.size();
+  eliminatePure();
+  removeSubsumed();
+  split(components);
+  //Variables without any clause are left unassigned by solvers, giving them preferred values;
+  std::vector<bool> used(m_varToVarId.size(), 0);
+  for(PClauseVector::size_type i = 0;i < m_clauses.size();i++)
+    if (m_clauses[i].alive)
+      for(PLitVector::size_type k = 0;k < m_clauses[i].lits.size();k++)
+	used[m_clauses[i].lits[k] >> 1] = 1;
+  for(size_t i = 0;i < m_varToVarId.size();i++)
+    {
+      if (m_values[i] != ValueUndef)
+	fixed.insert(VarIdToBoolMap::value_type(m_varToVarId[i], m_values[i] == ValueTrue)); else
+	if (!used[i])
+	  fixed.insert(VarIdToBoolMap::value_type(m_varToVarId[i], preferred(i)));
+    }
+  logMsg(LOG_DEBUG, "preprocessor:%zu variables, %zu fixed by units, %zu pure literals, %zu subsumed clauses, %zu components", m_varToVarId.size(), m_unitCount, m_pureCount, m_subsumedCount, components.size());
+  return 1;
+}
+
+size_t SatPreprocessor::mapVarId(VarId varId)
+{
+  assert(varId != BadVarId);
+  std::map<VarId, size_t>::const_iterator it = m_varIdToVar.find(varId);
+  if (it != m_varIdToVar.end())
+    return it->second;
+  const size_t var = m_varToVarId.size();
+  m_varIdToVar.insert(std::map<VarId, size_t>::value_type(varId, var));
+  m_varToVarId.push_back(varId);
+  m_occurs.resize(m_occurs.size() + 2);
+  return var;
+}
+
+bool SatPreprocessor::assign(size_t lit, PLitVector& queue)
+{
+  const unsigned char value = litValue(lit);
+  if (value != ValueUndef)
+    return value == ValueTrue;
+  m_values[lit >> 1] = (lit & 1)?ValueFalse:ValueTrue;
+  queue.push_back(lit);
+  return 1;
+}
+
+bool SatPreprocessor::propagate(PLitVector& queue, size_t& conflict)
+{
+  for(PLitVector::size_type i = 0;i < queue.size();i++)
+    {
+      const size_t lit = queue[i];
+      const SizeVector& satisfied = m_occurs[lit];
+      for(SizeVector::size_type k = 0;k < satisfied.size();k++)
+	m_clauses[satisfied[k]].alive = 0;
+      const SizeVector& reduced = m_occurs[lit ^ 1];
+      for(SizeVector::size_type k = 0;k < reduced.size();k++)
+	{
+	  PClause& c = m_clauses[reduced[k]];
+	  if (!c.alive)
+	    continue;
+	  assert(c.freeCount > 0);
+	  c.freeCount--;
+	  if (c.freeCount == 0)
+	    {
+	      conflict = reduced[k];
+	      return 0;
+	    }
+	  if (c.freeCount > 1)
+	    continue;
+	  //The only not false literal can be already true, but not processed yet;
+	  for(PLitVector::size_type j = 0;j < c.lits.size();j++)
+	    if (litValue(c.lits[j]) == ValueUndef)
+	      {
+		assign(c.lits[j], queue);
+		break;
+	      }
+	}
+    }
+  return 1;
+}
+
+void SatPreprocessor::eliminatePure()
+{
+  SizeVector counts(m_varToVarId.size() * 2, 0);
+  for(PClauseVector::size_type i = 0;i < m_clauses.size();i++)
+    if (m_clauses[i].alive)
+      for(PLitVector::size_type k = 0;k < m_clauses[i].lits.size();k++)
+	if (litValue(m_clauses[i].lits[k]) == ValueUndef)
+	  counts[m_clauses[i].lits[k]]++;
+  SizeVector candidates;
+  for(size_t i = 0;i < m_varToVarId.size();i++)
+    if (m_values[i] == ValueUndef)
+      candidates.push_back(i);
+  while(!candidates.empty())
+    {
+      const size_t var = candidates.back();
+      candidates.pop_back();
+      if (m_values[var] != ValueUndef)
+	continue;
+      const size_t pos = counts[var << 1], neg = counts[(var << 1) | 1];
+      if (pos == 0 && neg == 0)
+	continue;
+      size_t lit;
+      if (neg == 0 && preferred(var))
+	lit = var << 1; else
+	if (pos == 0 && !preferred(var))
+	  lit = (var << 1) | 1; else
+	  continue;
+      m_values[var] = (lit & 1)?ValueFalse:ValueTrue;
+      m_pureCount++;
+      //No alive clause has the opposite literal, so nothing becomes false;
+      const SizeVector& satisfied = m_occurs[lit];
+      for(SizeVector::size_type k = 0;k < satisfied.size();k++)
+	{
+	  PClause& c = m_clauses[satisfied[k]];
+	  if (!c.alive)
+	    continue;
+	  c.alive = 0;
+	  for(PLitVector::size_type j = 0;j < c.lits.size();j++)
+	    if (c.lits[j] != lit && litValue(c.lits[j]) == ValueUndef)
+	      {
+		assert(counts[c.lits[j]] > 0);
+		counts[c.lits[j]]--;
+		if (counts[c.lits[j]] == 0)
+		  candidates.push_back(c.lits[j] >> 1);
+	      }
+	}
+    }
+}
+
+void SatPreprocessor::removeSubsumed()
+{
+  //Alive clauses have no true literals, removing false ones;
+  SizeVector order;
+  for(PClauseVector::size_type i = 0;i < m_clauses.size();i++)
+    {
+      PClause& c = m_clauses[i];
+      if (!c.alive)
+	continue;
+      PLitVector::size_type k = 0;
+      for(PLitVector::size_type j = 0;j < c.lits.size();j++)
+	if (litValue(c.lits[j]) == ValueUndef)
+	  c.lits[k++] = c.lits[j]; else
+	  assert(litValue(c.lits[j]) == ValueFalse);
+      c.lits.resize(k);
+      assert(c.lits.size() >= 2);
+      order.push_back(i);
+    }
+  for(std::vector<SizeVector>::size_type i = 0;i < m_occurs.size();i++)
+    m_occurs[i].clear();
+  for(SizeVector::size_type i = 0;i < order.size();i++)
+    for(PLitVector::size_type k = 0;k < m_clauses[order[i]].lits.size();k++)
+      m_occurs[m_clauses[order[i]].lits[k]].push_back(order[i]);
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return m_clauses[a].lits.size() < m_clauses[b].lits.size();
+    });
+  for(SizeVector::size_type i = 0;i < order.size();i++)
+    {
+      const PClause& c = m_clauses[order[i]];
+      if (!c.alive)
+	continue;
+      //Every clause subsumed by this one contains its literal with the shortest occurrence list;
+      size_t best = c.lits[0];
+      for(PLitVector::size_type k = 1;k < c.lits.size();k++)
+	if (m_occurs[c.lits[k]].size() < m_occurs[best].size())
+	  best = c.lits[k];
+      const SizeVector& candidates = m_occurs[best];
+      for(SizeVector::size_type k = 0;k < candidates.size();k++)
+	{
+	  if (candidates[k] == order[i])
+	    continue;
+	  PClause& d = m_clauses[candidates[k]];
+	  if (!d.alive || d.lits.size() < c.lits.size())
+	    continue;
+	  if (isSubset(c.lits, d.lits))
+	    {
+	      d.alive = 0;
+	      m_subsumedCount++;
+	    }
+	}
+    }
+}
+
+void SatPreprocessor::split(SatVector& components) const
+{
+  SizeVector parents(m_varToVarId.size());
+  for(size_t i = 0;i < parents.size();i++)
+    parents[i] = i;
+  for(PClauseVector::size_type i = 0;i < m_clauses.size();i++)
+    {
+      const PClause& c = m_clauses[i];
+      if (!c.alive)
+	continue;
+      for(PLitVector::size_type k = 1;k < c.lits.size();k++)
+	{
+	  size_t a = c.lits[0] >> 1, b = c.lits[k] >> 1;
+	  while(parents[a] != a)
+	    a = parents[a] = parents[parents[a]];
+	  while(parents[b] != b)
+	    b = parents[b] = parents[parents[b]];
+	  if (a != b)
+	    parents[a] = b;
+	}
+    }
+  SizeVector componentOfRoot(parents.size(), (size_t)-1);
+  for(PClauseVector::size_type i = 0;i < m_clauses.size();i++)
+    {
+      const PClause& c = m_clauses[i];
+      if (!c.alive)
+	continue;
+      size_t root = c.lits[0] >> 1;
+      while(parents[root] != root)
+	root = parents[root];
+      if (componentOfRoot[root] == (size_t)-1)
+	{
+	  componentOfRoot[root] = components.size();
+	  components.push_back(Sat());
+	}
+      Clause clause;
+      for(PLitVector::size_type k = 0;k < c.lits.size();k++)
+	clause.push_back(Lit(m_varToVarId[c.lits[k] >> 1], (c.lits[k] & 1) != 0));
+      components[componentOfRoot[root]].push_back(clause);
+    }
+}
+
+bool SatPreprocessor::isSubset(const PLitVector& lits1, const PLitVector& lits2) const
+{
+  //Both vectors are sorted;
+  PLitVector::size_type i = 0, j = 0;
+  while(i < lits1.size() && j < lits2.size())
+    {
+      if (lits1[i] == lits2[j])
+	{
+	  i++;
+	  j++;
+	  continue;
+	}
+      if (lits1[i] < lits2[j])
+	return 0;
+      j++;
+    }
+  return i == lits1.size();
+}
+
+bool SatPreprocessor::preferred(size_t var) const
+{
+  VarIdToBoolMap::const_iterator it = m_preferred.find(m_varToVarId[var]);
+  if (it == m_preferred.end())
+    return 0;
+  return it->second;
+}
+
+DEEPSOLVER_END_SAT_NAMESPACE
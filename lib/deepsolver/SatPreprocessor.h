@@ -0,0 +1,152 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_SAT_PREPROCESSOR_H
+#define DEEPSOLVER_SAT_PREPROCESSOR_H
+
+#include"deepsolver/Sat.h"
+
+namespace Deepsolver
+{
+  namespace Sat
+  {
+    typedef std::vector<Sat> SatVector;
+
+    /**\brief Simplifies SAT and splits it into independent parts
+     *
+     * The preprocessing consists of the unit propagation, the pure literal
+     * elimination, removing of subsumed clauses and splitting of the rest
+     * into components without common variables. Every component can be
+     * solved separately, the solution of the original equation is the
+     * union of the components solutions and the fixed assignments made by
+     * the preprocessing itself.
+     *
+     * Since the pure literal elimination affects the solution (not only its
+     * existence), a pure literal is eliminated only if it gives the
+     * preferred value of its variable. The preferred values are the
+     * current states of the packages, so the preprocessing never decides
+     * to change a package by itself. Without any preference the variable
+     * is preferred to be false. Variables left without any clause are
+     * fixed to their preferred values as well.
+     */
+    class SatPreprocessor
+    {
+    public:
+      typedef AbstractSatSolver::VarIdToBoolMap VarIdToBoolMap;
+
+    public:
+      /**\brief The default constructor*/
+      SatPreprocessor()
+	: m_unitCount(0),
+	  m_pureCount(0),
+	  m_subsumedCount(0) {}
+
+      /**\brief The destructor*/
+      virtual ~SatPreprocessor() {}
+
+    public:
+      /**\brief Sets the preferred value of the variable
+       *
+       * \param [in] varId The variable to set preferred value for
+       * \param [in] value The preferred value
+       */
+      void prefer(VarId varId, bool value);
+
+      /**\brief Performs the preprocessing
+       *
+       * \param [in] sat The equation to process
+       * \param [out] components The independent parts of the simplified equation
+       * \param [out] fixed The values of variables assigned by the preprocessing
+       * \param [out] conflicts The variables of the falsified clause if there is no solution
+       *
+       * \return Zero if the equation is found to have no solution or non-zero otherwise
+       */
+      bool run(const Sat& sat,
+	       SatVector& components,
+	       VarIdToBoolMap& fixed,
+	       VarIdVector& conflicts);
+
+      size_t getUnitCount() const
+      {
+	return m_unitCount;
+      }
+
+      size_t getPureCount() const
+      {
+	return m_pureCount;
+      }
+
+      size_t getSubsumedCount() const
+      {
+	return m_subsumedCount;
+      }
+
+    private:
+      typedef std::vector<size_t> PLitVector;//Variable number multiplied by 2 plus 1 if negative;
+
+      struct PClause
+      {
+	PClause()
+	  : alive(1),
+	    freeCount(0) {}
+
+	PLitVector lits;
+	bool alive;
+	size_t freeCount;
+      }; //struct PClause;
+
+      typedef std::vector<PClause> PClauseVector;
+
+      enum {
+	ValueFalse = 0,
+	ValueTrue = 1,
+	ValueUndef = 2
+      };
+
+    private:
+      size_t mapVarId(VarId varId);
+      bool assign(size_t lit, PLitVector& queue);
+      bool propagate(PLitVector& queue, size_t& conflict);
+      void eliminatePure();
+      void removeSubsumed();
+      void split(SatVector& components) const;
+      bool isSubset(const PLitVector& lits1, const PLitVector& lits2) const;
+      bool preferred(size_t var) const;
+
+      unsigned char litValue(size_t lit) const
+      {
+	const unsigned char v = m_values[lit >> 1];
+	if (v == ValueUndef)
+	  return ValueUndef;
+	return v ^ (unsigned char)(lit & 1);
+      }
+
+    private:
+      VarIdToBoolMap m_preferred;
+      std::map<VarId, size_t> m_varIdToVar;
+      VarIdVector m_varToVarId;
+      std::vector<unsigned char> m_values;
+      PClauseVector m_clauses;
+      std::vector<SizeVector> m_occurs;//Clauses of each literal;
+      size_t m_unitCount;
+      size_t m_pureCount;
+      size_t m_subsumedCount;
+    }; //class SatPreprocessor;
+  } //namespace Sat;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_SAT_PREPROCESSOR_H;
@@ -0,0 +1,262 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/Sha256.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA256_X86
+#include<immintrin.h>
+#include<cpuid.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define SHA256_ARM
+#include<arm_neon.h>
+#endif
+
+DEEPSOLVER_BEGIN_NAMESPACE
+
+typedef void (*Sha256Blocks)(uint32_t state[8], const unsigned char* data, size_t count);
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static void blocksPortable(uint32_t state[8], const unsigned char* data, size_t count);
+static Sha256Blocks selectBlocks(const char*& name);
+static Sha256Blocks getBlocks();
+
+static const char* implName = NULL;
+
+void Sha256::init()
+{
+  m_state[0] = 0x6a09e667;
+  m_state[1] = 0xbb67ae85;
+  m_state[2] = 0x3c6ef372;
+  m_state[3] = 0xa54ff53a;
+  m_state[4] = 0x510e527f;
+  m_state[5] = 0x9b05688c;
+  m_state[6] = 0x1f83d9ab;
+  m_state[7] = 0x5be0cd19;
+  m_size = 0;
+}
+
+void Sha256::update(const void* buf, size_t len)
+{
+  assert(buf || len == 0);
+  const unsigned char* c = static_cast<const unsigned char*>(buf);
+  size_t used = m_size % 64;
+  m_size += len;
+  if (used > 0)
+    {
+      const size_t count = std::min(len, 64 - used);
+      memcpy(m_buf + used, c, count);
+      c += count;
+      len -= count;
+      used += count;
+      if (used < 64)
+	return;
+      getBlocks()(m_state, m_buf, 1);
+    }
+  //The complete blocks are taken directly from the given data;
+  if (len >= 64)
+    {
+      getBlocks()(m_state, c, len / 64);
+      c += len - len % 64;
+      len %= 64;
+    }
+  if (len > 0)
+    memcpy(m_buf, c, len);
+}
+
+std::string Sha256::commit()
+{
+  const uint64_t bits = m_size * 8;
+  unsigned char tail[72];
+  //The padding reaches the position of 56 modulo 64, then the length is added;
+  const size_t padding = 64 - (m_size + 8) % 64;
+  memset(tail, 0, sizeof(tail));
+  tail[0] = 0x80;
+  for(size_t i = 0;i < 8;i++)
+    tail[padding + i] = (unsigned char)(bits >> (56 - 8 * i));
+  update(tail, padding + 8);
+  assert(m_size % 64 == 0);
+  char res[65];
+  for(size_t i = 0;i < 8;i++)
+    snprintf(res + 8 * i, 9, "%08x", m_state[i]);
+  return std::string(res, 64);
+}
+
+const char* Sha256::getImplName()
+{
+  getBlocks();
+  return implName;
+}
+
+#ifdef SHA256_X86
+__attribute__((target("sha,sse4.1")))
+static void blocksShaNi(uint32_t state[8], const unsigned char* data, size_t count)
+{
+  const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  //The instructions take the state as ABEF and CDGH;
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xb1);
+  __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1b);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+  while(count > 0)
+    {
+      const __m128i save0 = state0, save1 = state1;
+      __m128i w[4];
+      for(size_t i = 0;i < 16;i++)
+	{
+	  __m128i& cur = w[i % 4];
+	  if (i < 4)
+	    cur = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), mask); else
+	    cur = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(cur, w[(i + 1) % 4]), _mm_alignr_epi8(w[(i + 3) % 4], w[(i + 2) % 4], 4)), w[(i + 3) % 4]);
+	  __m128i msg = _mm_add_epi32(cur, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[4 * i])));
+	  state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+	  msg = _mm_shuffle_epi32(msg, 0x0e);
+	  state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+	}
+      state0 = _mm_add_epi32(state0, save0);
+      state1 = _mm_add_epi32(state1, save1);
+      data += 64;
+      count--;
+    }
+  tmp = _mm_shuffle_epi32(state0, 0x1b);
+  state1 = _mm_shuffle_epi32(state1, 0xb1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+#endif //SHA256_X86;
+
+#ifdef SHA256_ARM
+static void blocksArm(uint32_t state[8], const unsigned char* data, size_t count)
+{
+  uint32x4_t state0 = vld1q_u32(&state[0]);
+  uint32x4_t state1 = vld1q_u32(&state[4]);
+  while(count > 0)
+    {
+      const uint32x4_t save0 = state0, save1 = state1;
+      uint32x4_t w[4];
+      for(size_t i = 0;i < 16;i++)
+	{
+	  uint32x4_t& cur = w[i % 4];
+	  if (i < 4)
+	    cur = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i))); else
+	    cur = vsha256su1q_u32(vsha256su0q_u32(cur, w[(i + 1) % 4]), w[(i + 2) % 4], w[(i + 3) % 4]);
+	  const uint32x4_t msg = vaddq_u32(cur, vld1q_u32(&K[4 * i]));
+	  const uint32x4_t prev0 = state0;
+	  state0 = vsha256hq_u32(state0, state1, msg);
+	  state1 = vsha256h2q_u32(state1, prev0, msg);
+	}
+      state0 = vaddq_u32(state0, save0);
+      state1 = vaddq_u32(state1, save1);
+      data += 64;
+      count--;
+    }
+  vst1q_u32(&state[0], state0);
+  vst1q_u32(&state[4], state1);
+}
+#endif //SHA256_ARM;
+
+//Static functions;
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+void blocksPortable(uint32_t state[8], const unsigned char* data, size_t count)
+{
+  while(count > 0)
+    {
+      uint32_t w[64];
+      for(size_t i = 0;i < 16;i++)
+	w[i] = ((uint32_t)data[4 * i] << 24) | ((uint32_t)data[4 * i + 1] << 16) | ((uint32_t)data[4 * i + 2] << 8) | (uint32_t)data[4 * i + 3];
+      for(size_t i = 16;i < 64;i++)
+	{
+	  const uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+	  const uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+	  w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+      uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+      for(size_t i = 0;i < 64;i++)
+	{
+	  const uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+	  const uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+	  h = g;
+	  g = f;
+	  f = e;
+	  e = d + t1;
+	  d = c;
+	  c = b;
+	  b = a;
+	  a = t1 + t2;
+	}
+      state[0] += a;
+      state[1] += b;
+      state[2] += c;
+      state[3] += d;
+      state[4] += e;
+      state[5] += f;
+      state[6] += g;
+      state[7] += h;
+      data += 64;
+      count--;
+    }
+}
+
+Sha256Blocks selectBlocks(const char*& name)
+{
+#ifdef SHA256_X86
+  unsigned int eax, ebx, ecx, edx;
+  //SHA extensions are reported in leaf 7, SSSE3 and SSE4.1 in leaf 1;
+  if (__get_cpuid_max(0, NULL) >= 7 && __get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+      (ecx & bit_SSSE3) && (ecx & bit_SSE4_1))
+    {
+      __cpuid_count(7, 0, eax, ebx, ecx, edx);
+      if (ebx & (1 << 29))
+	{
+	  name = "x86-sha";
+	  return blocksShaNi;
+	}
+    }
+#endif //SHA256_X86;
+#ifdef SHA256_ARM
+  name = "armv8-crypto";
+  return blocksArm;
+#endif //SHA256_ARM;
+  name = "portable";
+  return blocksPortable;
+}
+
+Sha256Blocks getBlocks()
+{
+  //The processor is checked once on the first use;
+  static const Sha256Blocks blocks = selectBlocks(implName);
+  return blocks;
+}
+
+DEEPSOLVER_END_NAMESPACE
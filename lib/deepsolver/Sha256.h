@@ -0,0 +1,55 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_SHA256_H
+#define DEEPSOLVER_SHA256_H
+
+#include"deepsolver/AbstractChecksum.h"
+
+namespace Deepsolver
+{
+  /**\brief The SHA-256 calculation
+   *
+   * The blocks are processed with SHA extensions of x86 processors if
+   * they are detected at run time. On ARMv8 the crypto extensions are
+   * used if the code is compiled with them enabled. Otherwise the
+   * portable implementation is taken.
+   */
+  class Sha256: public AbstractChecksum
+  {
+  public:
+    Sha256()
+      : m_size(0) {}
+
+    virtual ~Sha256() {}
+
+  public:
+    void init() override;
+    void update(const void* buf, size_t len) override;
+    std::string commit() override;
+
+    /**\brief Returns the name of block processing implementation in use*/
+    static const char* getImplName();
+
+  private:
+    uint32_t m_state[8];
+    unsigned char m_buf[64];
+    uint64_t m_size;//The total number of bytes given;
+  }; //class Sha256;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_SHA256_H;
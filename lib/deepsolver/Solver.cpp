@@ -22,51 +22,166 @@
 #define FILTER_SOLUTION
 #define UPDATES_ITERATIONS
 
+#define BUDGET_POLL_PERIOD 256//Packages processed by SatBuilder between the budget checks;
+#define BUDGET_POLL_INTERVAL 50//Milliseconds between the budget checks while SAT solver is working;
+#define COMPONENT_MIN_CLAUSES 64//Smaller components are grouped together to save on solver creation;
+#define PARALLEL_MIN_FRONTIER 32//Smaller frontiers of pending packages are expanded serially;
+
+//Weights of the minimal change, the greater one always takes precedence;
+#define MAXSAT_REMOVE_WEIGHT 3//Removing without any replacement;
+#define MAXSAT_DOWNGRADE_WEIGHT 2
+#define MAXSAT_CHANGE_WEIGHT 1//New installation or replacing with newer version;
+
 DEEPSOLVER_BEGIN_SOLVER_NAMESPACE
 
-class Bfs
+//The state shared with the thread running SAT solver;
+struct SatSolvingState
 {
-public:
-  Bfs(RefCountedEntries& p)
-    : m_p(p) {}
+  SatSolvingState()
+    : done(0),
+      result(0) {}
 
-      virtual ~Bfs() {}
+  std::mutex mutex;
+  std::condition_variable cond;
+  Clause assumptions;//Set before the thread is started;
+  bool done;
+  bool result;
+  VarIdToBoolMap res;
+  Clause core;
+  std::exception_ptr error;
+}; //struct SatSolvingState;
 
-  public:
-      void go(const VarIdSet& startFrom)
-      {
-	assert(!startFrom.empty());
-	for(VarIdSet::const_iterator i = startFrom.begin();i != startFrom.end();++i)
-	  {
-	    assert(!m_p.getEntry(*i).ambiguous);
-	    m_pending.push_back(*i);
-	  }
-	while(!m_pending.empty())
-	  {
-	    const VarId varId = m_pending.back();
-	    m_pending.pop_back();
-	    assert(m_p.hasEntry(varId));
-	    RefCountedEntry& e = m_p.getEntry(varId);
-	    assert(!e.ambiguous);
-	    if (e.bfsMark)
-	      continue;
-	    e.bfsMark = 1;
-	    for(Sat::size_type s = 0;s < e.sat.size();++s)
-	      for(Clause::size_type c = 0;c < e.sat[s].size();++c)
-		{
-		  const VarId v = e.sat[s][c].varId;
-		  const bool ambiguous = e.sat[s][c].ambiguous;
-		  if (!ambiguous && v != e.varId && 
-		      !m_p.getEntry(v).ambiguous)
-		    m_pending.push_back(v);
-		  }
-	  }
-      }
+//The state shared with the threads solving independent components;
+struct ComponentsSolvingState
+{
+  ComponentsSolvingState()
+    : next(0),
+      running(0),
+      stopped(0),
+      unsolvable(0),
+      aborted(0) {}
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::vector<AbstractSatSolver::Ptr> solvers;
+  std::vector<VarIdToBoolMap> results;
+  size_t next;
+  size_t running;
+  bool stopped;
+  bool unsolvable;
+  bool aborted;
+  std::exception_ptr error;
+}; //struct ComponentsSolvingState;
 
-  private:
-      RefCountedEntries& m_p;
-      VarIdVector m_pending;
-}; //class Bfs;
+static void noDoublingRels(IdPkgRelVector& rels);
+static bool solveAssumingIfAny(AbstractSatSolver& satSolver,
+			       const Clause& assumptions,
+			       VarIdToBoolMap& res,
+			       Clause& core);
+static void runSatSolving(std::shared_ptr<SatSolvingState> state, AbstractSatSolver::Ptr satSolver);
+static void runComponentsSolving(std::shared_ptr<ComponentsSolvingState> state);
+static std::string describeSatSolving(const SolverBudget& budget,
+				      const AbstractSatSolver* satSolver,
+				      const Sat& sat);
+
+void ClauseGraph::build(const RefCountedEntries& p)
+{
+  const ClauseArena& arena = p.getArena();
+  m_offsets.assign(p.size() + 1, 0);
+  m_userOffsets.assign(p.size() + 1, 0);
+  m_lits.clear();
+  m_targets.clear();
+  for(VarId i = 0;i < p.size();++i)
+    {
+      m_offsets[i] = m_lits.size();
+      if (!p.hasEntry(i))
+	continue;
+      const RefCountedEntry& e = p.getEntry(i);
+      for(size_t s = e.sat.begin;s < e.sat.end;++s)
+	for(size_t c = arena.litBegin(s);c < arena.litEnd(s);++c)
+	  if (arena.varId(c) != i)
+	    {
+	      m_lits.push_back(c);
+	      m_targets.push_back(arena.varId(c));
+	      m_userOffsets[arena.varId(c) + 1]++;
+	    }
+    }
+  m_offsets[p.size()] = m_lits.size();
+  //The reverse edges are placed by the counting sort;
+  for(VarId i = 0;i < p.size();++i)
+    m_userOffsets[i + 1] += m_userOffsets[i];
+  m_users.resize(m_targets.size());
+  SizeVector pos(m_userOffsets.begin(), m_userOffsets.end() - 1);
+  for(VarId i = 0;i < p.size();++i)
+    for(size_t k = m_offsets[i];k < m_offsets[i + 1];++k)
+      m_users[pos[m_targets[k]]++] = i;
+}
+
+void ClauseGraph::reach(const RefCountedEntries& p,
+			const VarIdVector& seed,
+			const VarIdBitset& blocked,
+			VarIdBitset& reached) const
+{
+  assert(!seed.empty());
+  const ClauseArena& arena = p.getArena();
+  const size_t vertexCount = m_offsets.size() - 1;
+  VarIdBitset frontier, next;
+  reached.init(vertexCount);
+  frontier.init(vertexCount);
+  next.init(vertexCount);
+  for(VarIdVector::size_type i = 0;i < seed.size();++i)
+    {
+      assert(!blocked.test(seed[i]));
+      reached.set(seed[i]);
+      frontier.set(seed[i]);
+    }
+  while(1)
+    {
+      for(size_t w = 0;w < frontier.wordCount();++w)
+	{
+	  VarIdBitset::Word word = frontier.word(w);
+	  while(word != 0)
+	    {
+	      const VarId varId = VarIdBitset::takeLowest(w, word);
+	      for(size_t k = m_offsets[varId];k < m_offsets[varId + 1];++k)
+		if (!arena.ambiguous(m_lits[k]))
+		  next.set(m_targets[k]);
+	    }
+	}
+      bool found = 0;
+      for(size_t w = 0;w < next.wordCount();++w)
+	{
+	  VarIdBitset::Word& word = next.word(w);
+	  word &= ~(reached.word(w) | blocked.word(w));
+	  reached.word(w) |= word;
+	  if (word != 0)
+	    found = 1;
+	}
+      if (!found)
+	return;
+      frontier.swap(next);
+      next.clear();
+    }
+}
+
+void ClauseGraph::getAffected(const VarIdVector& vars, VarIdVector& affected) const
+{
+  affected.clear();
+  VarIdBitset seen;
+  seen.init(m_offsets.size() - 1);
+  for(VarIdVector::size_type i = 0;i < vars.size();++i)
+    {
+      seen.set(vars[i]);
+      for(size_t k = m_userOffsets[vars[i]];k < m_userOffsets[vars[i] + 1];++k)
+	seen.set(m_users[k]);
+    }
+  for(size_t w = 0;w < seen.wordCount();++w)
+    {
+      VarIdBitset::Word word = seen.word(w);
+      while(word != 0)
+	affected.push_back(VarIdBitset::takeLowest(w, word));
+    }
+}
 
 namespace 
 {
@@ -74,13 +189,14 @@ namespace
   {
     assert(varId != BadVarId && p.hasEntry(varId) && p.getEntry(varId).replacementFor != BadVarId);
     const RefCountedEntry& e = p.getEntry(varId);
-    for(Sat::size_type s = 0;s < e.sat.size();++s)
+    const ClauseArena& arena = p.getArena();
+    for(size_t s = e.sat.begin;s < e.sat.end;++s)
       {
-	Clause::size_type c;
-	for(c = 0;c < e.sat[s].size();++c)
+	size_t c;
+	for(c = arena.litBegin(s);c < arena.litEnd(s);++c)
 	  {
-	    const VarId v = e.sat[s][c].varId;
-	    const bool n = e.sat[s][c].neg;
+	    const VarId v = arena.varId(c);
+	    const bool n = arena.neg(c);
 	    assert(p.hasEntry(v));
 	    if (v == varId && !n)//Actually shouldn'd happen;
 	      break;
@@ -92,7 +208,7 @@ namespace
 	    if (n && !p.getEntry(v).newState)
 	      break;
 	  }
-	if (c >= e.sat[s].size())
+	if (c >= arena.litEnd(s))
 	  return 0;
       }
     return 1;
@@ -107,16 +223,28 @@ void SatBuilder::build(const UserTask& userTask)
   m_userTaskInstall.clear();
   m_userTaskRemove.clear();
   m_pending.clear();
+  m_pendingCounts.assign(m_scope.getPkgCount(), 0);
+  m_reconstructStamps.assign(m_scope.getPkgCount(), 0);
+  m_reconstructGeneration = 0;
+  m_expansions.clear();
+  m_expansions.resize(m_scope.getPkgCount());
+  m_scannedPending = 0;
 #ifdef DEEPSOLVER_SOLVER_DEBUG
   m_debugReferences.resize(m_scope.getPkgCount());
   for(VarIdVector::size_type i = 0;i < m_debugReferences.size();++i)
     m_debugReferences[i] = BadVarId;
 #endif //DEEPSOLVER_SOLVER_DEBUG;
   onUserTask(userTask);
-  for(VarIdSet::const_iterator it1 = m_userTaskInstall.begin();it1 != m_userTaskInstall.end();++it1)
-  for(VarIdSet::const_iterator it2 = m_userTaskRemove.begin();it2 != m_userTaskRemove.end();++it2)
-    if (*it1 == *it2)
-      throw TaskException(TaskException::Contradiction, m_scope.getDesignationDef(*it1));
+  m_installMask.assign(m_scope.getPkgCount(), 0);
+  m_removeMask.assign(m_scope.getPkgCount(), 0);
+  for(VarIdSet::const_iterator it = m_userTaskInstall.begin();it != m_userTaskInstall.end();++it)
+    m_installMask[*it] = 1;
+  for(VarIdSet::const_iterator it = m_userTaskRemove.begin();it != m_userTaskRemove.end();++it)
+    {
+      if (m_installMask[*it])
+	throw TaskException(TaskException::Contradiction, m_scope.getDesignationDef(*it));
+      m_removeMask[*it] = 1;
+    }
   for(VarIdSet::const_iterator it = m_userTaskInstall.begin();it != m_userTaskInstall.end();++it)
     {
       if (m_scope.isInstalled(*it))
@@ -186,6 +314,7 @@ void SatBuilder::build(const UserTask& userTask)
   logMsg(LOG_DEBUG, "solver:%zu installed germs involved", installedGermCount);
   logMsg(LOG_DEBUG, "solver:%zu uninstalled germs involved", uninstalledGermCount);
   assert(ensureSatCorrect());
+  m_expansions.clear();
   p.clearGerms();
 #ifdef DEEPSOLVER_SOLVER_DEBUG
   logMsg(LOG_DEBUG, "solver:dumping references to installed packages:");
@@ -203,45 +332,75 @@ bool SatBuilder::ensureSatCorrect() const
 {
   //Each variable, involved in SAT, must have corresponding entry in table and this entry may not be a germ;
   size_t clauseNum = 0, litNum = 0;
+  const ClauseArena& arena = p.getArena();
   for(VarId i = 0;i < p.size();++i)
     if(p.hasEntry(i))
       {
 	const RefCountedEntry& e = p.getEntry(i);
-	for(Sat::size_type s = 0;s < e.sat.size();++s)
+	for(size_t s = e.sat.begin;s < e.sat.end;++s)
 	  {
-	    litNum += e.sat[s].size();
-	    for(Clause::size_type c = 0;c < e.sat[s].size();++c)
+	    litNum += arena.clauseSize(s);
+	    for(size_t c = arena.litBegin(s);c < arena.litEnd(s);++c)
 	      {
-	      if (!p.hasEntry(e.sat[s][c].varId))
+	      if (!p.hasEntry(arena.varId(c)))
 		{
 		  logMsg(LOG_ERR, "%s contains %s literal without entry %s", m_scope.getDesignationDef(i).c_str(),
-			 (e.sat[s][c].neg?"negative":"positive"),
-			 m_scope.getDesignationDef(e.sat[s][c].varId).c_str());
+			 (arena.neg(c)?"negative":"positive"),
+			 m_scope.getDesignationDef(arena.varId(c)).c_str());
 		  return 0;
 		}
-	      if (p.getEntry(e.sat[s][c].varId).germ)
+	      if (p.getEntry(arena.varId(c)).germ)
 		{
 		  logMsg(LOG_ERR, "%s contains %s literal with germ entry %s", m_scope.getDesignationDef(i).c_str(), 
-			 (e.sat[s][c].neg?"negative":"positive"),
-			 m_scope.getDesignationDef(e.sat[s][c].varId).c_str());
+			 (arena.neg(c)?"negative":"positive"),
+			 m_scope.getDesignationDef(arena.varId(c)).c_str());
 		  return 0;
 		}
 	      } //for(literals); 
 	  } //for(clauses);
-	clauseNum += e.sat.size();
+	clauseNum += e.sat.end - e.sat.begin;
       } //if(hasEntry());
   logMsg(LOG_DEBUG, "solver:SAT check completed successfully: %zu clauses with %zu literals", clauseNum, litNum);
   return 1;
 }
 
+bool SolverBudget::expired(int& code) const
+{
+  if (m_timeLimit > 0 && getElapsed() >= (double)m_timeLimit)
+    {
+      code = TaskException::LimitExceeded;
+      return 1;
+    }
+  if (m_continueRequest != NULL && !m_continueRequest->onContinueOperationRequest())
+    {
+      code = TaskException::Cancelled;
+      return 1;
+    }
+  return 0;
+}
+
+double SolverBudget::getElapsed() const
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_started).count();
+}
+
 void SatBuilder::onPending()
 {
   while(!m_pending.empty())
     {
+      if (m_threadCount > 1 && m_pending.size() > m_scannedPending)
+	expandFrontier();
       const VarId varId = m_pending.back();
       m_pending.pop_back();
+      assert(m_pendingCounts[varId] > 0);
+      m_pendingCounts[varId]--;
+      if (m_scannedPending > m_pending.size())
+	m_scannedPending = m_pending.size();
       if (p.hasEntry(varId) && !p.getEntry(varId).germ)
 	continue;
+      m_processedCount++;
+      if (m_processedCount % BUDGET_POLL_PERIOD == 0)
+	checkBudget();
       if (!m_scope.isInstalled(varId))
 	toBeInstalled(varId); else
 	toBeRemoved(varId);
@@ -250,15 +409,137 @@ void SatBuilder::onPending()
 
 void SatBuilder::reconstruct(const VarIdVector& vars)
 {
+  //The same package may be referenced by several constructions of the same entry;
+  const size_t generation = ++m_reconstructGeneration;
   for(VarIdVector::size_type i = 0;i < vars.size();++i)
     {
       assert(p.hasEntry(vars[i]) && !p.getEntry(vars[i]).germ);
+      if (m_reconstructStamps[vars[i]] == generation)
+	continue;
+      m_reconstructStamps[vars[i]] = generation;
       if (!m_scope.isInstalled(vars[i]))
 	toBeInstalled(vars[i]); else
 	toBeRemoved(vars[i]);
     }
 }
 
+const PkgExpansion& SatBuilder::expand(VarId varId, PkgExpansion& local)
+{
+  assert(varId < m_expansions.size());
+  //Serial construction does not keep the expansions;
+  if (m_threadCount <= 1)
+    {
+      fillExpansion(varId, local);
+      return local;
+    }
+  if (!m_expansions[varId])
+    {
+      std::unique_ptr<PkgExpansion> expansion(new PkgExpansion());
+      fillExpansion(varId, *expansion.get());
+      m_expansions[varId] = std::move(expansion);
+    }
+  return *m_expansions[varId].get();
+}
+
+void SatBuilder::fillExpansion(VarId varId, PkgExpansion& expansion) const
+{
+  if (!m_scope.isInstalled(varId))
+    {
+      m_scope.selectMatchingVarsRealNames(m_scope.pkgIdOfVarId(varId), expansion.otherVer);
+      noDoubling(expansion.otherVer);
+      m_scope.getRequires(varId, expansion.rels);
+      noDoublingRels(expansion.rels);
+      expansion.alternatives.resize(expansion.rels.size());
+      for(IdPkgRelVector::size_type i = 0;i < expansion.rels.size();++i)
+	m_requireCache.selectMatchingVarsWithProvides(m_scope, expansion.rels[i], expansion.alternatives[i]);
+      m_scope.getConflicts(varId, expansion.conflicts);
+      noDoublingRels(expansion.conflicts);
+      expansion.conflictVars.resize(expansion.conflicts.size());
+      for(IdPkgRelVector::size_type i = 0;i < expansion.conflicts.size();++i)
+	m_requireCache.selectMatchingVarsWithProvides(m_scope, expansion.conflicts[i], expansion.conflictVars[i]);
+      IdPkgRelVector rels;
+      m_scope.whatConflictAmongInstalled(varId, expansion.installedVars, rels);
+      return;
+    }
+  m_scope.whatDependAmongInstalled(varId, expansion.installedVars, expansion.rels);
+  expansion.alternatives.resize(expansion.rels.size());
+  for(IdPkgRelVector::size_type i = 0;i < expansion.rels.size();++i)
+    m_requireCache.selectMatchingVarsWithProvides(m_scope, expansion.rels[i], expansion.alternatives[i]);
+  m_scope.selectMatchingVarsRealNames(m_scope.pkgIdOfVarId(varId), expansion.otherVer);
+  noDoubling(expansion.otherVer);
+}
+
+void SatBuilder::expandFrontier()
+{
+  //Only packages pushed since the previous call are taken, so each push is looked at once;
+  VarIdVector frontier;
+  for(VarIdVector::size_type i = m_scannedPending;i < m_pending.size();++i)
+    {
+      const VarId varId = m_pending[i];
+      if (m_expansions[varId] || (p.hasEntry(varId) && !p.getEntry(varId).germ))
+	continue;
+      frontier.push_back(varId);
+    }
+  m_scannedPending = m_pending.size();
+  noDoubling(frontier);
+  if (frontier.size() < PARALLEL_MIN_FRONTIER)
+    return;
+  std::vector<std::unique_ptr<PkgExpansion> > expansions(frontier.size());
+  std::atomic<size_t> next(0);
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  auto worker = [&]() {
+    try {
+      size_t i;
+      while((i = next++) < frontier.size())
+	{
+	  std::unique_ptr<PkgExpansion> expansion(new PkgExpansion());
+	  fillExpansion(frontier[i], *expansion.get());
+	  expansions[i] = std::move(expansion);
+	}
+    }
+    catch(...)
+      {
+	std::lock_guard<std::mutex> lock(errorMutex);
+	if (!error)
+	  error = std::current_exception();
+	next = frontier.size();
+      }
+  };
+  std::vector<std::thread> threads;
+  const size_t threadCount = std::min(m_threadCount, frontier.size());
+  for(size_t i = 1;i < threadCount;++i)
+    {
+      try {
+	threads.push_back(std::thread(worker));
+      }
+      catch(const std::system_error& e)
+	{
+	  logMsg(LOG_WARNING, "solver:unable to start new thread (%s), %zu threads are used for SAT construction", e.what(), threads.size() + 1);
+	  break;
+	}
+    }
+  worker();
+  for(std::vector<std::thread>::size_type i = 0;i < threads.size();++i)
+    threads[i].join();
+  if (error)
+    std::rethrow_exception(error);
+  //The results do not depend on the order of computing, the serial construction consumes them as usual;
+  for(VarIdVector::size_type i = 0;i < frontier.size();++i)
+    m_expansions[frontier[i]] = std::move(expansions[i]);
+}
+
+void SatBuilder::checkBudget() const
+{
+  int code;
+  if (!m_budget.expired(code))
+    return;
+  std::ostringstream ss;
+  ss << "SAT construction after " << std::fixed << std::setprecision(1) << m_budget.getElapsed() << " sec, " << m_processedCount << " packages processed, " << m_pending.size() << " pending";
+  logMsg(LOG_DEBUG, "solver:the budget is expired during %s", ss.str().c_str());
+  throw TaskException(code, ss.str());
+}
+
 void SatBuilder::onUserTask(const UserTask& userTask)
 {
   // To install;
@@ -302,24 +583,23 @@ void SatBuilder::use(VarId varId, VarId referenceFrom)
     m_debugReferences[varId] = referenceFrom;
 #endif //DEEPSOLVER_SOLVER_DEBUG;
   m_pending.push_back(varId);
+  m_pendingCounts[varId]++;
 }
 
 bool SatBuilder::useGermInstalled(VarId varId, VarId reconstruct)
 {
   assert(varId != BadVarId && reconstruct != BadVarId);
-  for(VarIdVector::size_type i = 0;i < m_pending.size();++i)
-    if (m_pending[i] == varId)
-      return 0;
+  if (m_pendingCounts[varId] > 0)
+    return 0;
   if (p.hasEntry(varId))
     {
       RefCountedEntry& e = p.getEntry(varId);
       assert(e.oldState && e.newState);
       if (!e.germ)
 	return 0;
-      for(VarIdVector::size_type i = 0;i < e.reconstruct.size();++i)
-	if (e.reconstruct[i] == reconstruct)
-	  return 1;
-      e.reconstruct.push_back(reconstruct);
+      //All references from one entry are made during its single construction;
+      if (e.reconstruct.empty() || e.reconstruct.back() != reconstruct)
+	e.reconstruct.push_back(reconstruct);
       return 1;
     }
   //  logMsg(LOG_DEBUG, "Creating germ for %s", m_scope.getDesignation(varId).c_str());
@@ -332,19 +612,17 @@ bool SatBuilder::useGermInstalled(VarId varId, VarId reconstruct)
 bool SatBuilder::useGermUninstalled(VarId varId, VarId reconstruct)
 {
   assert(varId != BadVarId && reconstruct != BadVarId);
-  for(VarIdVector::size_type i = 0;i < m_pending.size();++i)
-    if (m_pending[i] == varId)
-      return 0;
+  if (m_pendingCounts[varId] > 0)
+    return 0;
   if (p.hasEntry(varId))
     {
       RefCountedEntry& e = p.getEntry(varId);
       assert(!e.oldState && !e.newState);
       if (!e.germ)
 	return 0;
-      for(VarIdVector::size_type i = 0;i < e.reconstruct.size();++i)
-	if (e.reconstruct[i] == reconstruct)
-	  return 1;
-      e.reconstruct.push_back(reconstruct);
+      //All references from one entry are made during its single construction;
+      if (e.reconstruct.empty() || e.reconstruct.back() != reconstruct)
+	e.reconstruct.push_back(reconstruct);
       return 1;
     }
   RefCountedEntry& e = p.newEntry(varId, 0);//0 means the package is currently uninstalled;
@@ -364,7 +642,7 @@ void SatBuilder::toBeInstalled(VarId varId, VarId replacementFor)
 #ifdef UNBOUNDED_LOG
     logMsg(LOG_DEBUG, "to install %s", m_scope.getDesignation(varId).c_str());
 #endif //UNBOUNDED_LOG;
-    assert(m_userTaskRemove.find(varId) == m_userTaskRemove.end());
+    assert(!m_removeMask[varId]);
   RefCountedEntry& entry = p.ensureEntryExists(varId, 0);//0 means currently not installed;
   assert(!entry.oldState && !entry.newState);
   if (entry.germ)
@@ -375,17 +653,17 @@ void SatBuilder::toBeInstalled(VarId varId, VarId replacementFor)
     }
   if (replacementFor != BadVarId && entry.replacementFor == BadVarId)
     entry.replacementFor = replacementFor;
-  entry.sat.clear();
+  entry.clearSat();
+  PkgExpansion localExpansion;
+  const PkgExpansion& expansion = expand(varId, localExpansion);
   //Blocking other versions of this package (FIXME:Not every package requires that);
-  VarIdVector otherVer;
-  m_scope.selectMatchingVarsRealNames(m_scope.pkgIdOfVarId(varId), otherVer);
-  noDoubling(otherVer);
+  const VarIdVector& otherVer = expansion.otherVer;
   for(VarIdVector::size_type i = 0;i < otherVer.size();++i)
-    if (otherVer[i] != varId && m_userTaskRemove.find(otherVer[i]) == m_userTaskRemove.end())
+    if (otherVer[i] != varId && !m_removeMask[otherVer[i]])
       {
-	if (m_userTaskInstall.find(otherVer[i]) != m_userTaskInstall.end())
+	if (m_installMask[otherVer[i]])
 	  {
-	    entry.sat.clear();
+	    entry.clearSat();
 	    entry.uninstallable();
 	    return;
 	  }
@@ -400,18 +678,11 @@ void SatBuilder::toBeInstalled(VarId varId, VarId replacementFor)
 	  }
       } //Blocking other versions;
   //Requires;
-  IdPkgRelVector requires;
-  m_scope.getRequires(varId, requires);
+  const IdPkgRelVector& requires = expansion.rels;
   for(IdPkgRelVector::size_type i = 0;i < requires.size();++i)
     {
-      IdPkgRelVector::size_type doubling;
-      for(doubling = 0;doubling < i;++doubling)
-	if (requires[doubling] == requires[i])
-	  break;
-      if (doubling < i)
-	continue;
-      VarIdVector alternatives;
-      m_scope.selectMatchingVarsWithProvides(requires[i], alternatives);
+      VarIdVector& alternatives = m_alternatives;
+      alternatives.assign(expansion.alternatives[i].begin(), expansion.alternatives[i].end());
       if (alternatives.empty())
 	{
 	  logMsg(LOG_ERR, "unmet %s in package %s",
@@ -422,10 +693,9 @@ void SatBuilder::toBeInstalled(VarId varId, VarId replacementFor)
 				  m_scope.getDesignation(requires[i]));
 
 	}
-      noDoubling(alternatives);
       size_t offset = 0;
       for(VarIdVector::size_type k = 0;k < alternatives.size();++k)
-	if (m_userTaskRemove.find(alternatives[k]) != m_userTaskRemove.end())
+	if (m_removeMask[alternatives[k]])
 	  ++offset; else
 	  alternatives[k - offset] = alternatives[k];
       assert(offset <= alternatives.size());
@@ -433,14 +703,14 @@ void SatBuilder::toBeInstalled(VarId varId, VarId replacementFor)
       //The package is not installable as it has a require without installable alternatives;
       if (alternatives.empty())
 	{
-	  entry.sat.clear();
+	  entry.clearSat();
 	  entry.uninstallable();//It looks slightly strange but it's the most proper way;
 return;
 	}
       VarIdVector::size_type k;
       for(k = 0;k < alternatives.size();++k)
 	//One of the alternatives will be installed anyway;
-	if (m_userTaskInstall.find(alternatives[k]) != m_userTaskInstall.end())
+	if (m_installMask[alternatives[k]])
 	  break ;
       if (k < alternatives.size())
 	continue;
@@ -467,27 +737,17 @@ return;
       entry.onRequire(alternatives);
     }
   //Conflicts;
-  IdPkgRelVector conflicts;
-  m_scope.getConflicts(varId, conflicts);
-  for(IdPkgRelVector::size_type i = 0;i < conflicts.size();++i)
+  for(IdPkgRelVector::size_type i = 0;i < expansion.conflicts.size();++i)
     {
-      IdPkgRelVector::size_type doubling;
-      for(doubling = 0;doubling < i;++doubling)
-	if (conflicts[doubling] == conflicts[i])
-	  break;
-      if (doubling < i)
-	continue;
-      VarIdVector vars;
-      m_scope.selectMatchingVarsWithProvides(conflicts[i], vars);
-      noDoubling(vars);
+      const VarIdVector& vars = expansion.conflictVars[i];
       for(VarIdVector::size_type k = 0;k < vars.size();++k)
 	if (vars[k] != varId &&//Package may not conflict with itself;
-	    m_userTaskRemove.find(vars[k]) == m_userTaskRemove.end())
+	    !m_removeMask[vars[k]])
 	  {
 	    //The package conflicts with the package that will be installed anyway, marking as uninstallabel;
-	    if (m_userTaskInstall.find(vars[i]) != m_userTaskInstall.end())
+	    if (m_installMask[vars[k]])
 	      {
-		entry.sat.clear();
+		entry.clearSat();
 		entry.uninstallable();
 		return;
 	      }
@@ -503,20 +763,18 @@ return;
 	  }
     }
   //Here we check are there any conflicts among the installed packages;
-  VarIdVector vars;
-  IdPkgRelVector rels;
-  m_scope.whatConflictAmongInstalled(varId, vars, rels);
+  const VarIdVector& vars = expansion.installedVars;
   for(VarIdVector::size_type i = 0;i < vars.size();++i)
     {
       assert(m_scope.isInstalled(vars[i]));
       //The package being checked will remain installed anyway, any conflicts are pointless;
-      if (m_userTaskInstall.find(vars[i]) != m_userTaskInstall.end())
+      if (m_installMask[vars[i]])
 	{
-	  entry.sat.clear();
+	  entry.clearSat();
 	  entry.uninstallable();
 	  return;
 	}
-      if (m_userTaskRemove.find(vars[i]) == m_userTaskRemove.end())
+      if (!m_removeMask[vars[i]])
 	continue;
       entry.onConflict(vars[i]);
       use(vars[i], varId);
@@ -526,7 +784,7 @@ return;
 void SatBuilder::toBeRemoved(VarId varId)
 {
   assert(varId != BadVarId && m_scope.isInstalled(varId));
-  assert(m_userTaskInstall.find(varId) == m_userTaskInstall.end());
+  assert(!m_installMask[varId]);
   RefCountedEntry& entry = p.ensureEntryExists(varId, 1);//1 means currently installed;
   assert(entry.oldState && entry.newState);
   if (entry.germ)
@@ -535,28 +793,26 @@ void SatBuilder::toBeRemoved(VarId varId)
       reconstruct(entry.reconstruct);
       entry.reconstruct.clear();
     }
-  entry.sat.clear();
-  VarIdVector dependent;
-  IdPkgRelVector rels;
-  m_scope.whatDependAmongInstalled(varId, dependent, rels);
-  assert(dependent.size() == rels.size());
+  entry.clearSat();
+  PkgExpansion localExpansion;
+  const PkgExpansion& expansion = expand(varId, localExpansion);
+  const VarIdVector& dependent = expansion.installedVars;
+  assert(dependent.size() == expansion.rels.size());
   for(VarIdVector::size_type i = 0;i < dependent.size();++i)
     {
-      if (m_userTaskRemove.find(dependent[i]) != m_userTaskRemove.end())
+      if (m_removeMask[dependent[i]])
 	continue;
-      if(m_userTaskInstall.find(dependent[i]) != m_userTaskInstall.end())
+      if(m_installMask[dependent[i]])
 	{
-	  entry.sat.clear();
+	  entry.clearSat();
 	  entry.unremovable();
 	  return;
 	}
-      VarIdVector alternatives;
-      m_scope.selectMatchingVarsWithProvides(rels[i], alternatives);
-      noDoubling(alternatives);
-
+      VarIdVector& alternatives = m_alternatives;
+      alternatives.assign(expansion.alternatives[i].begin(), expansion.alternatives[i].end());
       size_t offset = 0;
       for(VarIdVector::size_type k = 0;k < alternatives.size();++k)
-	if (alternatives[k] == varId || m_userTaskRemove.find(alternatives[k]) != m_userTaskRemove.end())
+	if (alternatives[k] == varId || m_removeMask[alternatives[k]])
 	  ++offset; else
 	  alternatives[k - offset] = alternatives[k];
       assert(offset <= alternatives.size());
@@ -564,7 +820,7 @@ void SatBuilder::toBeRemoved(VarId varId)
       //If one of the alternatives will be installed anyway we can safely skip this clause;
       VarIdVector::size_type k;
       for(k = 0;k < alternatives.size();++k)
-	if (m_userTaskInstall.find(alternatives[k]) != m_userTaskInstall.end())
+	if (m_installMask[alternatives[k]])
 	  break;
       if (k < alternatives.size())
 	continue;
@@ -585,15 +841,13 @@ void SatBuilder::toBeRemoved(VarId varId)
       use(dependent[i], varId);
     }
   //What about a replacement with newer version?
-  VarIdVector replacements;
-  m_scope.selectMatchingVarsRealNames(m_scope.pkgIdOfVarId(varId), replacements);
-  noDoubling(replacements);
+  VarIdVector replacements = expansion.otherVer;
   for(VarIdVector::size_type i = 0;i < replacements.size();++i)
-    if (replacements[i] == varId)
+    while (i < replacements.size() &&
+	   (replacements[i] == varId || m_removeMask[replacements[i]]))//Replacement cannot be the package explicitly requested to remove;
       {
 	replacements[i] = replacements.back();
 	replacements.pop_back();
-	break;
       }
   if (!replacements.empty())
     {
@@ -675,7 +929,9 @@ VarId SatBuilder::byProvidesPrioritySorting(const VarIdVector& vars) const
   return v.back();
 }
 
-void Solver::doMainWork(SatBuilder& builder, const UserTask& userTask) const
+void Solver::doMainWork(SatBuilder& builder,
+			const SolverBudget& budget,
+			const UserTask& userTask) const
 {
   VarIdVector updates;
   logMsg(LOG_DEBUG, "solver:SAT constructing");
@@ -683,10 +939,11 @@ void Solver::doMainWork(SatBuilder& builder, const UserTask& userTask) const
   if (builder.userTaskInstall() .empty() && builder.userTaskRemove().empty())
     return;
   logMsg(LOG_DEBUG, "solver:initial SAT solving");
-  if (!solveSat(builder.p, builder.userTaskInstall(), builder.userTaskRemove(), updates))
+  std::string explanation;
+  if (!solveSat(builder.p, budget, builder.userTaskInstall(), builder.userTaskRemove(), updates, m_taskSolverData.satOptimize, &explanation))
     {
       logMsg(LOG_DEBUG, "Initial SAT solving failed");
-      throw TaskException(TaskException::UnsolvableSat);
+      throw TaskException(TaskException::UnsolvableSat, explanation);
     }
   assert(builder.p.newStatesValid());
 #ifdef FILTER_SOLUTION
@@ -694,6 +951,9 @@ void Solver::doMainWork(SatBuilder& builder, const UserTask& userTask) const
   filterSolution(builder.p, builder.userTaskInstall(), builder.userTaskRemove(), updates);
   assert(builder.p.newStatesValid());
 #endif //FILTER_SOLUTION;
+  //The optimal solution already has all possible updates;
+  if (m_taskSolverData.satOptimize)
+    return;
 #ifdef UPDATES_ITERATIONS
   while(1)
     {
@@ -712,7 +972,7 @@ void Solver::doMainWork(SatBuilder& builder, const UserTask& userTask) const
       logMsg(LOG_DEBUG, "solver:%zu new updates found", newUpdates.size() - updates.size());
       if (newUpdates.size() == updates.size())
 	break;
-      if (!solveSat(builder.p, builder.userTaskInstall(), builder.userTaskRemove(), newUpdates))
+      if (!solveSat(builder.p, budget, builder.userTaskInstall(), builder.userTaskRemove(), newUpdates, 0, NULL))
 	break;
 #ifdef FILTER_SOLUTION
       filterSolution(builder.p, builder.userTaskInstall(), builder.userTaskRemove(), newUpdates);
@@ -721,7 +981,7 @@ void Solver::doMainWork(SatBuilder& builder, const UserTask& userTask) const
       updates = newUpdates;
     }
   logMsg(LOG_DEBUG, "Final solving");
-  const bool finalSatSolved = solveSat(builder.p, builder.userTaskInstall(), builder.userTaskRemove(), updates);
+  const bool finalSatSolved = solveSat(builder.p, budget, builder.userTaskInstall(), builder.userTaskRemove(), updates, 0, NULL);
   assert(finalSatSolved);
 #ifdef FILTER_SOLUTION
   filterSolution(builder.p, builder.userTaskInstall(), builder.userTaskRemove(), updates);
@@ -734,8 +994,10 @@ void Solver::solve(const UserTask& userTask,
 		   VarIdVector& install,
 		   VarIdVector& remove) const
 {
-  SatBuilder builder(m_taskSolverData.backend, m_taskSolverData.scope, m_taskSolverData.providePriority);
-  doMainWork(builder, userTask);
+  SolverBudget budget(m_taskSolverData);
+  SatBuilder builder(m_taskSolverData.backend, m_taskSolverData.scope, m_taskSolverData.providePriority, budget, *m_requireCache.get(), buildThreadCount());
+  doMainWork(builder, budget, userTask);
+  logMsg(LOG_DEBUG, "solver:require cache has %zu relations, %zu hits, %zu misses", m_requireCache->size(), m_requireCache->getHitCount(), m_requireCache->getMissCount());
   for(size_t i = 0;i < builder.p.size();++i)
     {
       if (!builder.p.hasEntry(i))
@@ -752,8 +1014,9 @@ void Solver::solve(const UserTask& userTask,
 
 void Solver::dumpSat(const UserTask& userTask, std::ostream& s) const
 {
-  SatBuilder builder(m_taskSolverData.backend, m_taskSolverData.scope, m_taskSolverData.providePriority);
-  doMainWork(builder, userTask);
+  SolverBudget budget(m_taskSolverData);
+  SatBuilder builder(m_taskSolverData.backend, m_taskSolverData.scope, m_taskSolverData.providePriority, budget, *m_requireCache.get(), buildThreadCount());
+  doMainWork(builder, budget, userTask);
   for(size_t i = 0;i < builder.p.size();++i)
     if (builder.p.hasEntry(i) && !builder.p.getEntry(i).germ)
       {
@@ -764,14 +1027,15 @@ void Solver::dumpSat(const UserTask& userTask, std::ostream& s) const
 	if (e.replacementFor != BadVarId)
 	  s << "# Replacement for: " << m_scope.getDesignationDef(e.replacementFor) << std::endl;
 	s << "# Ambiguous: " << (e.ambiguous?"yes":"no") << std::endl;
-	for(Sat::size_type ss = 0;ss < e.sat.size();++ss)
+	const ClauseArena& arena = builder.p.getArena();
+	for(size_t ss = e.sat.begin;ss < e.sat.end;++ss)
 	  {
 	    s << "(" << std::endl;
-	    for(Clause::size_type c = 0;c < e.sat[ss].size();++c)
+	    for(size_t c = arena.litBegin(ss);c < arena.litEnd(ss);++c)
 	      {
-		const VarId varId = e.sat[ss][c].varId;
-		const bool neg = e.sat[ss][c].neg;
-		const bool ambiguous = e.sat[ss][c].ambiguous;
+		const VarId varId = arena.varId(c);
+		const bool neg = arena.neg(c);
+		const bool ambiguous = arena.ambiguous(c);
 		if (ambiguous)
 		  s << "#"; else
 		  s << " ";
@@ -787,41 +1051,581 @@ void Solver::dumpSat(const UserTask& userTask, std::ostream& s) const
       }
 }
 
-bool Solver::solveSat(RefCountedEntries& p,
-			   const VarIdSet& userTaskInstall,
-		      const VarIdSet& userTaskRemove,
-		      const VarIdVector& fixedToInstall) const
+void Solver::dumpDimacs(const UserTask& userTask,
+			std::ostream& s,
+			std::ostream& varsMap) const
 {
-  assert(!userTaskInstall.empty() || !userTaskRemove.empty());
-  AbstractSatSolver::Ptr satSolver = createDefaultSatSolver();
+  SolverBudget budget(m_taskSolverData);
+  SatBuilder builder(m_taskSolverData.backend, m_taskSolverData.scope, m_taskSolverData.providePriority, budget, *m_requireCache.get(), buildThreadCount());
+  logMsg(LOG_DEBUG, "solver:SAT constructing for DIMACS output");
+  builder.build(userTask);
+  Sat sat;
+  if (!builder.userTaskInstall().empty() || !builder.userTaskRemove().empty())
+    fillSat(builder.p, builder.userTaskInstall(), builder.userTaskRemove(), VarIdVector(), sat);
+  VarIdVector vars;
+  saveDimacs(sat, s, vars);
+  for(VarIdVector::size_type i = 0;i < vars.size();++i)
+    varsMap << (i + 1) << " " << m_scope.getDesignationDef(vars[i]) << std::endl;
+  logMsg(LOG_DEBUG, "solver:DIMACS output has %zu variables in %zu clauses", vars.size(), sat.size());
+}
+
+void Solver::fillSat(const RefCountedEntries& p,
+		     const VarIdSet& userTaskInstall,
+		     const VarIdSet& userTaskRemove,
+		     const VarIdVector& fixedToInstall,
+		     Sat& sat) const
+{
+  sat.clear();
   for(VarIdSet::const_iterator it = userTaskInstall.begin();it != userTaskInstall.end();++it)
     //    if (p.hasEntry(*it))//The variable could be optimized by SAT builder;
-    satSolver->addClause(unitClause(Lit(*it)));
+    sat.push_back(unitClause(Lit(*it)));
   for(VarIdVector::size_type i = 0;i < fixedToInstall.size();++i)
     //    if (p.hasEntry(fixedToInstall[i]))//The variable could be optimized by SAT builder;
-    satSolver->addClause(unitClause(Lit(fixedToInstall[i])));
+    sat.push_back(unitClause(Lit(fixedToInstall[i])));
   for(VarIdSet::const_iterator it = userTaskRemove.begin();it != userTaskRemove.end();++it)
     //    if (p.hasEntry(*it))//The variable could be optimized by SAT builder;
-    satSolver->addClause(unitClause(Lit(*it, 1)));
+    sat.push_back(unitClause(Lit(*it, 1)));
+  const ClauseArena& arena = p.getArena();
+  for(VarId i = 0;i < p.size();++i)
+    if (p.hasEntry(i))
+      for(size_t k = p.getEntry(i).sat.begin;k < p.getEntry(i).sat.end;++k)
+	{
+	  sat.push_back(Clause());
+	  arena.getClause(k, sat.back());
+	}
+}
+
+void Solver::explainUnsolvable(const RefCountedEntries& p,
+			       const SolverBudget& budget,
+			       const VarIdSet& userTaskInstall,
+			       const VarIdSet& userTaskRemove,
+			       const VarIdVector& fixedToInstall,
+			       std::string& explanation) const
+{
+  //User task items are assumed directly, each clause gets the selector variable following the packages;
+  Clause assumptions;
+  for(VarIdSet::const_iterator it = userTaskInstall.begin();it != userTaskInstall.end();++it)
+    assumptions.push_back(Lit(*it));
+  for(VarIdSet::const_iterator it = userTaskRemove.begin();it != userTaskRemove.end();++it)
+    assumptions.push_back(Lit(*it, 1));
+  Sat sat;
+  for(VarIdVector::size_type i = 0;i < fixedToInstall.size();++i)
+    sat.push_back(unitClause(Lit(fixedToInstall[i])));
+  const ClauseArena& arena = p.getArena();
   for(VarId i = 0;i < p.size();++i)
     if (p.hasEntry(i))
-      for(Sat::size_type k = 0;k < p.getEntry(i).sat.size();++k)
-	satSolver->addClause(p.getEntry(i).sat[k]);
+      for(size_t k = p.getEntry(i).sat.begin;k < p.getEntry(i).sat.end;++k)
+	{
+	  const Lit selector(p.size() + k);
+	  sat.push_back(Clause());
+	  arena.getClause(k, sat.back());
+	  sat.back().push_back(Lit(selector.varId, 1));
+	  assumptions.push_back(selector);
+	}
+  //The soft literals cannot make the hard part satisfiable, so they are not needed here;
+  AbstractSatSolver::Ptr satSolver = createAssumingSatSolver();
+  satSolver->setConflictLimit(budget.getConflictLimit());
+  for(Sat::size_type i = 0;i < sat.size();++i)
+    satSolver->addClause(sat[i]);
   VarIdToBoolMap res;
-  VarIdVector conflicts;//FIXME:Remove conflicts;
-  if (!satSolver->solve(res, conflicts))
-    return 0;
+  Clause core;
+  bool solved;
+  try {
+    solved = callSatSolver(budget, satSolver, sat, assumptions, res, core);
+  }
+  catch(const TaskException& e)
+    {
+      //The task is already known to be unsolvable, the expiry only leaves it without the explanation;
+      logMsg(LOG_DEBUG, "solver:no unsatisfiable core is taken: %s", e.getMessage().c_str());
+      return;
+    }
+  if (solved || core.empty())
+    {
+      logMsg(LOG_DEBUG, "solver:the tracked solving gives no unsatisfiable core");
+      return;
+    }
+  const size_t initialSize = core.size();
+  minimizeCore(budget, satSolver, sat, core);
+  logMsg(LOG_DEBUG, "solver:the unsatisfiable core has %zu assumptions (%zu before minimization, %zu total)", core.size(), initialSize, assumptions.size());
+  explanation = describeCore(p, core);
+}
+
+void Solver::minimizeCore(const SolverBudget& budget,
+			  AbstractSatSolver::Ptr satSolver,
+			  const Sat& sat,
+			  Clause& core) const
+{
+  //Every assumption whose removal keeps the contradiction is dropped;
+  size_t attempts = 0;
+  for(Clause::size_type i = 0;i < core.size() && attempts < m_taskSolverData.explainMinimize;++attempts)
+    {
+      int code;
+      if (budget.isPolled() && budget.expired(code))
+	{
+	  logMsg(LOG_DEBUG, "solver:the budget is expired, the unsatisfiable core is left without further minimization");
+	  return;
+	}
+      Clause candidate(core);
+      candidate.erase(candidate.begin() + i);
+      VarIdToBoolMap res;
+      Clause newCore;
+      bool solved;
+      try {
+	solved = callSatSolver(budget, satSolver, sat, candidate, res, newCore);
+      }
+      catch(const TaskException& e)
+	{
+	  //The task is already known to be unsolvable, the expiry only stops the minimization;
+	  logMsg(LOG_DEBUG, "solver:the unsatisfiable core minimization is stopped: %s", e.getMessage().c_str());
+	  return;
+	}
+      if (solved || newCore.empty())
+	{
+	  //The assumption is needed (or it is unknown, since the solving is aborted);
+	  ++i;
+	  continue;
+	}
+      //The new core is a subset of the candidate, keeping the order of the checked assumptions;
+      std::sort(newCore.begin(), newCore.end());
+      core.clear();
+      for(Clause::size_type k = 0;k < candidate.size();++k)
+	if (std::binary_search(newCore.begin(), newCore.end(), candidate[k]))
+	  core.push_back(candidate[k]);
+    }
+}
+
+std::string Solver::describeCore(const RefCountedEntries& p, const Clause& core) const
+{
+  const ClauseArena& arena = p.getArena();
+  StringVector lines;
+  for(Clause::size_type i = 0;i < core.size();++i)
+    {
+      if (core[i].varId < p.size())
+	{
+	  const std::string name = m_scope.getDesignationDef(core[i].varId);
+	  lines.push_back(core[i].neg?"the removal of " + name + " is requested":"the installation of " + name + " is requested");
+	  continue;
+	}
+      Clause clause;
+      arena.getClause(core[i].varId - p.size(), clause);
+      lines.push_back(describeClause(clause));
+    }
+  std::sort(lines.begin(), lines.end());
+  lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+  std::string explanation;
+  for(StringVector::size_type i = 0;i < lines.size();++i)
+    {
+      logMsg(LOG_DEBUG, "solver:unsatisfiable core: %s", lines[i].c_str());
+      if (!explanation.empty())
+	explanation += "\n";
+      explanation += lines[i];
+    }
+  return explanation;
+}
+
+std::string Solver::describeClause(const Clause& clause) const
+{
+  //The shapes of the clauses are determined by the methods of RefCountedEntry;
+  assert(!clause.empty());
+  const std::string name = m_scope.getDesignationDef(clause[0].varId);
+  if (clause.size() == 1)
+    return clause[0].neg?name + " cannot be installed":name + " cannot be removed";
+  std::string alternatives;
+  for(Clause::size_type i = clause[0].neg?1:2;i < clause.size();++i)
+    {
+      if (!alternatives.empty())
+	alternatives += ", ";
+      alternatives += m_scope.getDesignationDef(clause[i].varId);
+    }
+  if (clause[0].neg)
+    {
+      if (clause.size() == 2 && clause[1].neg)
+	return name + " conflicts with " + m_scope.getDesignationDef(clause[1].varId);
+      return name + " requires one of: " + alternatives;
+    }
+  //The dependent package needs the installed one or any of its alternatives;
+  assert(clause[1].neg);
+  const std::string dependent = m_scope.getDesignationDef(clause[1].varId);
+  if (alternatives.empty())
+    return dependent + " requires " + name;
+  return dependent + " requires " + name + " or one of: " + alternatives;
+}
+
+void Solver::fillSoftLits(const RefCountedEntries& p,
+			  const VarIdSet& userTaskInstall,
+			  const VarIdSet& userTaskRemove,
+			  Sat& sat,
+			  SoftLitVector& softs) const
+{
+  std::unordered_map<VarId, VarIdVector> replacements;
+  for(VarId i = 0;i < p.size();++i)
+    if (p.hasEntry(i) && !p.getEntry(i).oldState && p.getEntry(i).replacementFor != BadVarId)
+      replacements[p.getEntry(i).replacementFor].push_back(i);
+  //Auxiliary variables follow the packages and the variables already used in clauses;
+  VarId nextVarId = p.size();
+  for(Sat::size_type i = 0;i < sat.size();++i)
+    for(Clause::size_type k = 0;k < sat[i].size();++k)
+      if (sat[i][k].varId >= nextVarId)
+	nextVarId = sat[i][k].varId + 1;
+  for(VarId i = 0;i < p.size();++i)
+    {
+      if (!p.hasEntry(i) ||
+	  userTaskInstall.find(i) != userTaskInstall.end() ||
+	  userTaskRemove.find(i) != userTaskRemove.end())
+	continue;
+      const RefCountedEntry& e = p.getEntry(i);
+      if (e.oldState)
+	{
+	  std::unordered_map<VarId, VarIdVector>::const_iterator it = replacements.find(i);
+	  if (it == replacements.end())
+	    {
+	      softs.push_back(SoftLit(Lit(i), MAXSAT_REMOVE_WEIGHT));
+	      continue;
+	    }
+	  //The auxiliary variable is true only if the package remains or one of its replacements is installed;
+	  const VarId aux = nextVarId++;
+	  sat.push_back(Clause());
+	  Clause& clause = sat.back();
+	  clause.push_back(Lit(aux, 1));
+	  clause.push_back(Lit(i));
+	  for(VarIdVector::size_type k = 0;k < it->second.size();++k)
+	    clause.push_back(Lit(it->second[k]));
+	  softs.push_back(SoftLit(Lit(aux), MAXSAT_REMOVE_WEIGHT));
+	  softs.push_back(SoftLit(Lit(i), MAXSAT_CHANGE_WEIGHT));
+	  continue;
+	}
+      size_t weight = MAXSAT_CHANGE_WEIGHT;
+      if (e.replacementFor != BadVarId && p.hasEntry(e.replacementFor) && p.getEntry(e.replacementFor).oldState)
+	{
+	  VarIdVector vars;
+	  vars.push_back(e.replacementFor);
+	  vars.push_back(i);
+	  m_scope.selectTheNewest(vars);
+	  if (vars.size() == 1 && vars.front() == e.replacementFor)
+	    weight = MAXSAT_DOWNGRADE_WEIGHT;
+	}
+      softs.push_back(SoftLit(Lit(i, 1), weight));
+    }
+  logMsg(LOG_DEBUG, "solver:%zu soft literals for the minimal change", softs.size());
+}
+
+bool Solver::solveSat(RefCountedEntries& p,
+		      const SolverBudget& budget,
+			   const VarIdSet& userTaskInstall,
+		      const VarIdSet& userTaskRemove,
+		      const VarIdVector& fixedToInstall,
+		      bool optimize,
+		      std::string* explanation) const
+{
+  assert(!userTaskInstall.empty() || !userTaskRemove.empty());
+  Sat sat;
+  fillSat(p, userTaskInstall, userTaskRemove, fixedToInstall, sat);
+  SoftLitVector softs;
+  if (optimize)
+    fillSoftLits(p, userTaskInstall, userTaskRemove, sat, softs);
+  VarIdToBoolMap res;
+  bool solved;
+  if (m_taskSolverData.satPreprocess)
+    {
+      SatPreprocessor preprocessor;
+      //The preprocessing must not change packages by itself;
+      for(VarId i = 0;i < p.size();++i)
+	if (p.hasEntry(i))
+	  preprocessor.prefer(i, p.getEntry(i).oldState);
+      //Pure literals may be eliminated only if it doesn't falsify soft ones;
+      for(SoftLitVector::size_type i = 0;i < softs.size();++i)
+	preprocessor.prefer(softs[i].lit.varId, !softs[i].lit.neg);
+      SatVector components;
+      VarIdVector conflicts;
+      if (preprocessor.run(sat, components, res, conflicts))
+	solved = solveComponents(budget, components, softs, sat, res); else
+	solved = 0;
+    } else
+    solved = solveFormula(budget, sat, softs, res);
+  if (!solved)
+    {
+      if (explanation != NULL && m_taskSolverData.satExplain)
+	explainUnsolvable(p, budget, userTaskInstall, userTaskRemove, fixedToInstall, *explanation);
+      return 0;
+    }
+  applySolution(p, res);
+  return 1;
+}
+
+void Solver::applySolution(RefCountedEntries& p, const VarIdToBoolMap& res) const
+{
   for(VarIdToBoolMap::const_iterator it = res.begin();it != res.end();++it)
     {
+      //Auxiliary variables of soft literals;
+      if (it->first >= p.size())
+	continue;
       assert(it->first < m_scope.getPkgCount());
       //      logMsg(LOG_DEBUG, "%s", m_scope.getDesignation(it->first).c_str());
 
       assert(p.hasEntry(it->first));
     p.getEntry(it->first).newState = it->second;
     }
+}
+
+bool Solver::solveFormula(const SolverBudget& budget,
+			  const Sat& sat,
+			  const SoftLitVector& softs,
+			  VarIdToBoolMap& res) const
+{
+  AbstractSatSolver::Ptr satSolver = prepareSatSolver(budget, sat, softs);
+  Clause core;
+  const bool solved = callSatSolver(budget, satSolver, sat, Clause(), res, core);
+  if (!solved && satSolver->isAborted())
+    throw TaskException(TaskException::LimitExceeded, describeSatSolving(budget, satSolver.get(), sat));
+  return solved;
+}
+
+bool Solver::solveComponents(const SolverBudget& budget,
+			     const SatVector& components,
+			     const SoftLitVector& softs,
+			     const Sat& sat,
+			     VarIdToBoolMap& res) const
+{
+  SatVector groups;
+  std::unordered_map<VarId, size_t> varGroups;
+  for(SatVector::size_type i = 0;i < components.size();++i)
+    {
+      if (groups.empty() || groups.back().size() >= COMPONENT_MIN_CLAUSES)
+	groups.push_back(Sat());
+      groups.back().insert(groups.back().end(), components[i].begin(), components[i].end());
+      if (!softs.empty())
+	for(Sat::size_type k = 0;k < components[i].size();++k)
+	  for(Clause::size_type j = 0;j < components[i][k].size();++j)
+	    varGroups[components[i][k][j].varId] = groups.size() - 1;
+    }
+  //Soft literals of variables fixed by the preprocessing are not needed;
+  std::vector<SoftLitVector> groupSofts(groups.size());
+  for(SoftLitVector::size_type i = 0;i < softs.size();++i)
+    {
+      std::unordered_map<VarId, size_t>::const_iterator it = varGroups.find(softs[i].lit.varId);
+      if (it != varGroups.end())
+	groupSofts[it->second].push_back(softs[i]);
+    }
+  logMsg(LOG_DEBUG, "solver:%zu independent components in %zu groups", components.size(), groups.size());
+  if (m_taskSolverData.parallelComponents && groups.size() > 1)
+    return solveComponentsParallel(budget, groups, groupSofts, sat, res);
+  for(SatVector::size_type i = 0;i < groups.size();++i)
+    {
+      int code;
+      if (i > 0 && budget.isPolled() && budget.expired(code))
+	throw TaskException(code, describeSatSolving(budget, NULL, sat));
+      VarIdToBoolMap groupRes;
+      if (!solveFormula(budget, groups[i], groupSofts[i], groupRes))
+	return 0;
+      res.insert(groupRes.begin(), groupRes.end());
+    }
   return 1;
 }
 
+bool Solver::solveComponentsParallel(const SolverBudget& budget,
+				     const SatVector& components,
+				     const std::vector<SoftLitVector>& softs,
+				     const Sat& sat,
+				     VarIdToBoolMap& res) const
+{
+  assert(softs.size() == components.size());
+  std::shared_ptr<ComponentsSolvingState> state(new ComponentsSolvingState());
+  //The solving may be stopped by the budget only if every solver can be interrupted;
+  bool polled = budget.isPolled();
+  for(SatVector::size_type i = 0;i < components.size();++i)
+    {
+      state->solvers.push_back(prepareSatSolver(budget, components[i], softs[i]));
+      if (!state->solvers.back()->isInterruptible())
+	polled = 0;
+    }
+  state->results.resize(components.size());
+  size_t threadCount = std::thread::hardware_concurrency();
+  if (threadCount == 0 || threadCount > components.size())
+    threadCount = components.size();
+  std::vector<std::thread> threads;
+  for(size_t i = 0;i < threadCount;++i)
+    {
+      {
+	std::lock_guard<std::mutex> lock(state->mutex);
+	state->running++;
+      }
+      try {
+	threads.push_back(std::thread(runComponentsSolving, state));
+      }
+      catch(const std::system_error& e)
+	{
+	  logMsg(LOG_WARNING, "solver:unable to start new thread (%s), %zu threads are used for components", e.what(), threads.size());
+	  std::lock_guard<std::mutex> lock(state->mutex);
+	  state->running--;
+	  break;
+	}
+    }
+  if (threads.empty())
+    {
+      logMsg(LOG_WARNING, "solver:solving components in the current thread without limits");
+      state->running++;
+      runComponentsSolving(state);
+    }
+  int code;
+  bool expired = 0;
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while(state->running > 0 && !expired)
+      {
+	if (!polled)
+	  {
+	    state->cond.wait(lock);
+	    continue;
+	  }
+	state->cond.wait_for(lock, std::chrono::milliseconds(BUDGET_POLL_INTERVAL));
+	if (state->running == 0)
+	  break;
+	lock.unlock();
+	expired = budget.expired(code);
+	lock.lock();
+      }
+  }
+  if (!expired)
+    {
+      for(std::vector<std::thread>::size_type i = 0;i < threads.size();++i)
+	threads[i].join();
+      if (state->error)
+	std::rethrow_exception(state->error);
+      if (state->unsolvable)
+	return 0;
+      if (state->aborted)
+	throw TaskException(TaskException::LimitExceeded, describeSatSolving(budget, NULL, sat));
+      for(std::vector<VarIdToBoolMap>::size_type i = 0;i < state->results.size();++i)
+	res.insert(state->results[i].begin(), state->results[i].end());
+      return 1;
+    }
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->stopped = 1;
+  }
+  for(std::vector<AbstractSatSolver::Ptr>::size_type i = 0;i < state->solvers.size();++i)
+    state->solvers[i]->interrupt();
+  for(std::vector<std::thread>::size_type i = 0;i < threads.size();++i)
+    threads[i].join();
+  throw TaskException(code, describeSatSolving(budget, NULL, sat));
+}
+
+bool Solver::callSatSolver(const SolverBudget& budget,
+			   AbstractSatSolver::Ptr satSolver,
+			   const Sat& sat,
+			   const Clause& assumptions,
+			   VarIdToBoolMap& res,
+			   Clause& core) const
+{
+  if (budget.isPolled() && satSolver->isInterruptible())
+    return solveSatPolled(budget, satSolver, sat, assumptions, res, core);
+  //Uninterruptible solvers ignore the budget, it is checked only between the solvings;
+  return solveAssumingIfAny(*satSolver.get(), assumptions, res, core);
+}
+
+bool Solver::solveSatPolled(const SolverBudget& budget,
+			    AbstractSatSolver::Ptr satSolver,
+			    const Sat& sat,
+			    const Clause& assumptions,
+			    VarIdToBoolMap& res,
+			    Clause& core) const
+{
+  std::shared_ptr<SatSolvingState> state(new SatSolvingState());
+  state->assumptions = assumptions;
+  std::thread thread;
+  try {
+    thread = std::thread(runSatSolving, state, satSolver);
+  }
+  catch(const std::system_error& e)
+    {
+      logMsg(LOG_WARNING, "solver:unable to start new thread (%s), solving without limits", e.what());
+      return solveAssumingIfAny(*satSolver.get(), assumptions, res, core);
+    }
+  int code;
+  bool expired = 0;
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while(!state->done && !expired)
+      {
+	state->cond.wait_for(lock, std::chrono::milliseconds(BUDGET_POLL_INTERVAL));
+	if (state->done)
+	  break;
+	//The continue request may take some time, SAT solver must not wait for it;
+	lock.unlock();
+	expired = budget.expired(code);
+	lock.lock();
+      }
+  }
+  if (!expired)
+    {
+      thread.join();
+      if (state->error)
+	std::rethrow_exception(state->error);
+      res.swap(state->res);
+      core.swap(state->core);
+      return state->result;
+    }
+  //Only interruptible solvers get here, so the thread stops shortly;
+  satSolver->interrupt();
+  thread.join();
+  throw TaskException(code, describeSatSolving(budget, satSolver.get(), sat));
+}
+
+size_t Solver::buildThreadCount() const
+{
+  if (m_taskSolverData.buildThreads > 0)
+    return m_taskSolverData.buildThreads;
+  const size_t count = std::thread::hardware_concurrency();
+  return count > 0?count:1;
+}
+
+AbstractSatSolver::Ptr Solver::createSatSolver() const
+{
+  if (m_taskSolverData.satSolver == SAT_SOLVER_PORTFOLIO && !m_taskSolverData.satPortfolio.empty())
+    return AbstractSatSolver::Ptr(new PortfolioSatSolver(m_taskSolverData.satPortfolio));
+  AbstractSatSolver::Ptr satSolver = Deepsolver::Sat::createSatSolver(m_taskSolverData.satSolver);
+  if (!satSolver)
+    {
+      logMsg(LOG_WARNING, "solver:unknown SAT solver \'%s\', using the default one", m_taskSolverData.satSolver.c_str());
+      return createDefaultSatSolver();
+    }
+  logMsg(LOG_DEBUG, "solver:using SAT solver \'%s\'", m_taskSolverData.satSolver.c_str());
+  return satSolver;
+}
+
+AbstractSatSolver::Ptr Solver::createAssumingSatSolver() const
+{
+  AbstractSatSolver::Ptr satSolver = createSatSolver();
+  if (satSolver->hasAssumptions())
+    return satSolver;
+  logMsg(LOG_DEBUG, "solver:the chosen SAT solver has no assumptions, taking \'cdcl\'");
+  satSolver = Deepsolver::Sat::createSatSolver("cdcl");
+  assert(satSolver && satSolver->hasAssumptions());
+  return satSolver;
+}
+
+AbstractSatSolver::Ptr Solver::prepareSatSolver(const SolverBudget& budget,
+						const Sat& sat,
+						const SoftLitVector& softs) const
+{
+  if (softs.empty())
+    {
+      AbstractSatSolver::Ptr satSolver = createSatSolver();
+      satSolver->setConflictLimit(budget.getConflictLimit());
+      for(Sat::size_type i = 0;i < sat.size();++i)
+	satSolver->addClause(sat[i]);
+      return satSolver;
+    }
+  AbstractSatSolver::Ptr satSolver = createAssumingSatSolver();
+  std::shared_ptr<MaxSatSolver> maxSatSolver(new MaxSatSolver(satSolver));
+  maxSatSolver->setConflictLimit(budget.getConflictLimit());
+  for(Sat::size_type i = 0;i < sat.size();++i)
+    maxSatSolver->addClause(sat[i]);
+  for(SoftLitVector::size_type i = 0;i < softs.size();++i)
+    maxSatSolver->addSoftLit(softs[i]);
+  return maxSatSolver;
+}
+
 void Solver::filterSolution(RefCountedEntries& p,
 			    const VarIdSet& userTaskInstall,
 			    const VarIdSet& userTaskRemove,
@@ -836,92 +1640,121 @@ void Solver::filterSolution(RefCountedEntries& p,
     seed.insert(*it);
   for(VarIdVector::size_type i = 0;i < fixedToInstall.size();++i)
 	seed.insert(fixedToInstall[i]);
+  const VarIdVector seedVars(seed.begin(), seed.end());
 
+  ClauseGraph graph;
+  graph.build(p);
+  VarIdBitset blocked, changed, reached;
+  blocked.init(p.size());
+  changed.init(p.size());
+  //The first pass visits all entries;
+  VarIdVector affected;
+  for(VarId i = 0;i < p.size();++i)
+    if (p.hasEntry(i))
+      {
+	affected.push_back(i);
+	if (p.getEntry(i).oldState != p.getEntry(i).newState)
+	  changed.set(i);
+      }
   while(1)
     {
-      logMsg(LOG_DEBUG, "solver:new filtering pass");
+      logMsg(LOG_DEBUG, "solver:new filtering pass over %zu entries", affected.size());
       size_t changedNum = 0;
-      for(VarId i = 0;i < p.size();++i)
-	if (p.hasEntry(i))
-	  makeAmbiguousMarks(p, seed, p.getEntry(i), changedNum);
+      for(VarIdVector::size_type i = 0;i < affected.size();++i)
+	{
+	  RefCountedEntry& e = p.getEntry(affected[i]);
+	  makeAmbiguousMarks(p, seed, e, changedNum);
+	  if (e.ambiguous)
+	    blocked.set(e.varId);
+	}
       logMsg(LOG_DEBUG, "solver:%zu references released", changedNum);
       if (changedNum == 0)
 	return;
-      p.clearBfsMarks();
-      Bfs(p).go(seed);
-      size_t rolledBackCount = 0;
-      for(VarId i = 0;i < p.size();++i)
-	if (p.hasEntry(i))
-	  {
-	    RefCountedEntry& e = p.getEntry(i);
-	    if (!e.bfsMark && e.oldState != e.newState)
-	      {
-		e.newState = e.oldState;
-		rolledBackCount++;
-	      }
-	  }
-      logMsg(LOG_DEBUG, "solver:%zu packages have been rolled back", rolledBackCount);
-      if (rolledBackCount == 0)
+      graph.reach(p, seedVars, blocked, reached);
+      VarIdVector rolledBack;
+      for(size_t w = 0;w < changed.wordCount();++w)
+	{
+	  VarIdVector::size_type k = rolledBack.size();
+	  VarIdBitset::Word word = changed.word(w) & ~reached.word(w);
+	  changed.word(w) &= reached.word(w);
+	  while(word != 0)
+	    rolledBack.push_back(VarIdBitset::takeLowest(w, word));
+	  for(;k < rolledBack.size();++k)
+	    {
+	      RefCountedEntry& e = p.getEntry(rolledBack[k]);
+	      e.newState = e.oldState;
+	    }
+	}
+      logMsg(LOG_DEBUG, "solver:%zu packages have been rolled back", rolledBack.size());
+      if (rolledBack.empty())
 	return;
+      /*
+       * The marks of an entry depend only on its own state and on the
+       * states of the variables of its clauses, so the next pass needs only
+       * the rolled back entries and the entries referencing them.
+       */
+      graph.getAffected(rolledBack, affected);
     }
 }
 
-void Solver::makeAmbiguousMarks(const RefCountedEntries& p, 
+void Solver::makeAmbiguousMarks(RefCountedEntries& p, 
 				const VarIdSet& seed,
 				RefCountedEntry& e,
 				size_t& changedNum) const
 {
   if (e.ambiguous)
     return;
+  ClauseArena& arena = p.getArena();
   if (e.oldState == e.newState &&
       seed.find(e.varId) == seed.end())
     {
       e.ambiguous = 1;
-      for(Sat::size_type s = 0;s < e.sat.size();++s)
-	for(Clause::size_type c = 0;c < e.sat[s].size();++c)
-	  if (e.sat[s][c].varId != e.varId &&
-	      !e.sat[s][c].ambiguous)
+      for(size_t s = e.sat.begin;s < e.sat.end;++s)
+	for(size_t c = arena.litBegin(s);c < arena.litEnd(s);++c)
+	  if (arena.varId(c) != e.varId &&
+	      !arena.ambiguous(c))
 	    {
-	      e.sat[s][c].ambiguous = 1;
+	      arena.setAmbiguous(c);
 	      changedNum++;
 	    }
       return;
     } //the package not changed;
   //all cases when oldState != newState;
-  for(Sat::size_type s = 0;s < e.sat.size();++s)
+  for(size_t s = e.sat.begin;s < e.sat.end;++s)
     {
-      Clause::size_type c;
+      const size_t begin = arena.litBegin(s), end = arena.litEnd(s);
+      size_t c;
       //The clause should be without ambiguous literals;
-      for(c = 0;c < e.sat[s].size();++c)
-	if (e.sat[s][c].ambiguous)
+      for(c = begin;c < end;++c)
+	if (arena.ambiguous(c))
 	  break;
-      if (c < e.sat[s].size())
+      if (c < end)
 	//Going to next clause;
 	continue;
 
       bool atLeastOneChanged = 0;
-      for(c = 0;c < e.sat[s].size();++c)
+      for(c = begin;c < end;++c)
 	//Preferably we need the package that was installed and remains installed; 
-	if (e.sat[s][c].varId != e.varId &&
-	    !e.sat[s][c].neg &&
-		      p.getEntry(e.sat[s][c].varId).oldState &&
-	    p.getEntry(e.sat[s][c].varId).newState)
+	if (arena.varId(c) != e.varId &&
+	    !arena.neg(c) &&
+		      p.getEntry(arena.varId(c)).oldState &&
+	    p.getEntry(arena.varId(c)).newState)
 	  break;
       //If there is no preferable choice we take any installed variable;
-      if 	      (c >= e.sat[s].size())
+      if 	      (c >= end)
 	{
-	  for(c = 0;c < e.sat[s].size();++c)
-	    if (e.sat[s][c].varId != e.varId  &&
-		!e.sat[s][c].neg &&
-		p.getEntry(e.sat[s][c].varId).newState)
+	  for(c = begin;c < end;++c)
+	    if (arena.varId(c) != e.varId  &&
+		!arena.neg(c) &&
+		p.getEntry(arena.varId(c)).newState)
 	      break;
 	}
-      if 	      (c < e.sat[s].size())
-	for(Clause::size_type c1 = 0;c1 < e.sat[s].size();++c1)
-	  if (			e.sat[s][c1].varId != e.varId &&
+      if 	      (c < end)
+	for(size_t c1 = begin;c1 < end;++c1)
+	  if (			arena.varId(c1) != e.varId &&
 				c1 != c)
 	    {
-	      e.sat[s][c1].ambiguous = 1;
+	      arena.setAmbiguous(c1);
 	      changedNum ++;
 	      atLeastOneChanged = 1;
 	    }
@@ -932,22 +1765,140 @@ void Solver::makeAmbiguousMarks(const RefCountedEntries& p,
       if (e.newState)
 	continue;
 
-      for(c = 0;c < e.sat[s].size();++c)
-	if (		      e.sat[s][c].varId != e.varId && //Actually shouldn't happen;
-			      e.sat[s][c].neg &&
-			      !p.getEntry(e.sat[s][c].varId).newState)
+      for(c = begin;c < end;++c)
+	if (		      arena.varId(c) != e.varId && //Actually shouldn't happen;
+			      arena.neg(c) &&
+			      !p.getEntry(arena.varId(c)).newState)
 	  break;
-      if 	      (c < e.sat[s].size())
-	for(Clause::size_type c1 = 0;c1 < e.sat[s].size();++c1)
-	  if (e.sat[s][c1].varId != e.varId &&
+      if 	      (c < end)
+	for(size_t c1 = begin;c1 < end;++c1)
+	  if (arena.varId(c1) != e.varId &&
 	      c1 != c)
 	    {
-	      e.sat[s][c1].ambiguous = 1;
+	      arena.setAmbiguous(c1);
 	      changedNum++;
 	    }
     } //for(clauses);
 }
 
+//Static functions;
+
+//Keeps the first occurrence of each relation preserving the order;
+void noDoublingRels(IdPkgRelVector& rels)
+{
+  if (rels.size() < 2)
+    return;
+  std::unordered_set<IdPkgRel, IdPkgRelHash> seen;
+  seen.reserve(rels.size());
+  IdPkgRelVector::size_type k = 0;
+  for(IdPkgRelVector::size_type i = 0;i < rels.size();++i)
+    if (seen.insert(rels[i]).second)
+      {
+	if (k != i)
+	  rels[k] = rels[i];
+	++k;
+      }
+  rels.resize(k);
+}
+
+bool solveAssumingIfAny(AbstractSatSolver& satSolver,
+			const Clause& assumptions,
+			VarIdToBoolMap& res,
+			Clause& core)
+{
+  core.clear();
+  if (assumptions.empty())
+    {
+      VarIdVector conflicts;
+      return satSolver.solve(res, conflicts);
+    }
+  return satSolver.solveAssuming(assumptions, res, core);
+}
+
+void runSatSolving(std::shared_ptr<SatSolvingState> state, AbstractSatSolver::Ptr satSolver)
+{
+  VarIdToBoolMap res;
+  Clause core;
+  bool result = 0;
+  std::exception_ptr error;
+  try {
+    result = solveAssumingIfAny(*satSolver.get(), state->assumptions, res, core);
+  }
+  catch(...)
+    {
+      error = std::current_exception();
+    }
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->done = 1;
+  state->result = result;
+  state->res.swap(res);
+  state->core.swap(core);
+  state->error = error;
+  state->cond.notify_all();
+}
+
+void runComponentsSolving(std::shared_ptr<ComponentsSolvingState> state)
+{
+  std::unique_lock<std::mutex> lock(state->mutex);
+  while(!state->stopped && state->next < state->solvers.size())
+    {
+      const size_t index = state->next++;
+      AbstractSatSolver::Ptr satSolver = state->solvers[index];
+      lock.unlock();
+      VarIdToBoolMap res;
+      VarIdVector conflicts;
+      bool result = 0;
+      std::exception_ptr error;
+      try {
+	result = satSolver->solve(res, conflicts);
+      }
+      catch(...)
+	{
+	  error = std::current_exception();
+	}
+      lock.lock();
+      if (error)
+	{
+	  if (!state->error)
+	    state->error = error;
+	} else
+	if (result)
+	  state->results[index].swap(res); else
+	  if (satSolver->isAborted())
+	    state->aborted = 1; else
+	    state->unsolvable = 1;
+      if (result)
+	continue;
+      //There is no sense to solve other components;
+      if (!state->stopped)
+	{
+	  state->stopped = 1;
+	  for(std::vector<AbstractSatSolver::Ptr>::size_type i = 0;i < state->solvers.size();++i)
+	    if (i != index)
+	      state->solvers[i]->interrupt();
+	}
+    }
+  state->running--;
+  state->cond.notify_all();
+}
+
+std::string describeSatSolving(const SolverBudget& budget,
+			       const AbstractSatSolver* satSolver,
+			       const Sat& sat)
+{
+  VarIdSet vars;
+  for(Sat::size_type i = 0;i < sat.size();++i)
+    for(Clause::size_type k = 0;k < sat[i].size();++k)
+      vars.insert(sat[i][k].varId);
+  std::ostringstream ss;
+  ss << "SAT solving after " << std::fixed << std::setprecision(1) << budget.getElapsed() << " sec, " << vars.size() << " variables in " << sat.size() << " clauses";
+  Deepsolver::Sat::SatStat stat;
+  if (satSolver != NULL && satSolver->getStat(stat))
+    ss << ", " << stat.decisions << " decisions, " << stat.conflicts << " conflicts";
+  logMsg(LOG_DEBUG, "solver:the budget is expired during %s", ss.str().c_str());
+  return ss.str();
+}
+
 DEEPSOLVER_END_SOLVER_NAMESPACE
 
 Deepsolver::AbstractTaskSolver::Ptr Deepsolver::createTaskSolver(const Deepsolver::TaskSolverData& taskSolverData)
@@ -23,6 +23,9 @@
 #include"deepsolver/AbstractPkgBackEnd.h"
 #include"deepsolver/SolverBase.h"
 #include"deepsolver/Sat.h"
+#include"deepsolver/PortfolioSatSolver.h"
+#include"deepsolver/SatPreprocessor.h"
+#include"deepsolver/MaxSatSolver.h"
 #include"deepsolver/AbstractTaskSolver.h"
 
 namespace Deepsolver
@@ -34,20 +37,174 @@ namespace Deepsolver
     using Sat::unitClause;
     using Sat::AbstractSatSolver;
     using Sat::createDefaultSatSolver;
+    using Sat::PortfolioSatSolver;
+    using Sat::saveDimacs;
+    using Sat::SatPreprocessor;
+    using Sat::SatVector;
+    using Sat::MaxSatSolver;
+    using Sat::SoftLit;
+    using Sat::SoftLitVector;
     using Sat::Sat;
     typedef AbstractSatSolver::VarIdToBoolMap VarIdToBoolMap;
 
+    /**\brief The contiguous storage of clauses of all RefCountedEntry objects
+     *
+     * Literals of all clauses are kept in one array encoded as variable
+     * number multiplied by 2 plus 1 if negative, the ambiguity marks are
+     * kept in a separate bitset with the same indices. Each clause is a
+     * range of literals, each entry owns a range of clauses. Clauses of an
+     * entry must be consecutive, so if an entry gets a new clause while its
+     * range is not at the end of the storage, the range is moved to the
+     * end. The space of moved and cleared ranges is not reused until the
+     * storage is cleared, since the entries are rebuilt rarely.
+     */
+    class ClauseArena
+    {
+    public:
+      struct Range
+      {
+	Range()
+	  : begin(0),
+	    end(0) {}
+
+	size_t begin, end;
+      }; //struct Range;
+
+    public:
+      /**\brief The default constructor*/
+      ClauseArena() {}
+
+      /**\brief The destructor*/
+      virtual ~ClauseArena() {}
+
+    public:
+      void clear()
+      {
+	m_lits.clear();
+	m_ambiguous.clear();
+	m_clauses.clear();
+      }
+
+      /**\brief Starts new clause of the entry, its literals must be added right after that*/
+      void addClause(Range& range)
+      {
+	if (range.end != m_clauses.size())
+	  {
+	    const size_t count = range.end - range.begin;
+	    const size_t newBegin = m_clauses.size();
+	    for(size_t i = 0;i < count;++i)
+	      m_clauses.push_back(m_clauses[range.begin + i]);
+	    range.begin = newBegin;
+	    range.end = newBegin + count;
+	  }
+	m_clauses.push_back(Range());
+	m_clauses.back().begin = m_lits.size();
+	m_clauses.back().end = m_lits.size();
+	range.end++;
+      }
+
+      void addLit(const Range& range, const Lit& lit)
+      {
+	assert(lit.varId != BadVarId);
+	assert(range.end == m_clauses.size() && m_clauses.back().end == m_lits.size());
+	m_lits.push_back((lit.varId << 1) | (lit.neg?1:0));
+	m_ambiguous.push_back(0);
+	m_clauses.back().end++;
+      }
+
+      size_t litBegin(size_t clause) const
+      {
+	assert(clause < m_clauses.size());
+	return m_clauses[clause].begin;
+      }
+
+      size_t litEnd(size_t clause) const
+      {
+	assert(clause < m_clauses.size());
+	return m_clauses[clause].end;
+      }
+
+      size_t clauseSize(size_t clause) const
+      {
+	assert(clause < m_clauses.size());
+	return m_clauses[clause].end - m_clauses[clause].begin;
+      }
+
+      VarId varId(size_t lit) const
+      {
+	assert(lit < m_lits.size());
+	return m_lits[lit] >> 1;
+      }
+
+      bool neg(size_t lit) const
+      {
+	assert(lit < m_lits.size());
+	return m_lits[lit] & 1;
+      }
+
+      Lit getLit(size_t lit) const
+      {
+	return Lit(varId(lit), neg(lit));
+      }
+
+      bool ambiguous(size_t lit) const
+      {
+	assert(lit < m_ambiguous.size());
+	return m_ambiguous[lit];
+      }
+
+      void setAmbiguous(size_t lit)
+      {
+	assert(lit < m_ambiguous.size());
+	m_ambiguous[lit] = 1;
+      }
+
+      void clearAmbiguous()
+      {
+	m_ambiguous.assign(m_ambiguous.size(), 0);
+      }
+
+      void clearAmbiguous(const Range& range)
+      {
+	for(size_t i = range.begin;i < range.end;++i)
+	  for(size_t k = m_clauses[i].begin;k < m_clauses[i].end;++k)
+	    m_ambiguous[k] = 0;
+      }
+
+      void getClause(size_t clause, Clause& c) const
+      {
+	c.clear();
+	for(size_t i = litBegin(clause);i < litEnd(clause);++i)
+	  c.push_back(getLit(i));
+      }
+
+      size_t getLitCount() const
+      {
+	return m_lits.size();
+      }
+
+      size_t getClauseCount() const
+      {
+	return m_clauses.size();
+      }
+
+    private:
+      SizeVector m_lits;
+      std::vector<bool> m_ambiguous;
+      std::vector<Range> m_clauses;
+    }; //class ClauseArena;
+
     class RefCountedEntry
     {
     public:
-      RefCountedEntry(VarId v, bool s)
-	: varId(v),
+      RefCountedEntry(ClauseArena& a, VarId v, bool s)
+	: arena(&a),
+	  varId(v),
 	  oldState(s),
 	  newState(s),
 	  refNum(0), 
 	  germ(0),
 	  ambiguous(0),
-	  bfsMark(0),
 	  replacementFor(BadVarId) {}
 
       virtual ~RefCountedEntry() {}
@@ -55,21 +212,22 @@ namespace Deepsolver
     public:
       void uninstallable()
       {
-	sat.push_back(unitClause(Lit(varId, 1)));
+	arena->addClause(sat);
+	arena->addLit(sat, Lit(varId, 1));
       }
 
       void unremovable()
       {
-	sat.push_back(unitClause(Lit(varId)));
+	arena->addClause(sat);
+	arena->addLit(sat, Lit(varId));
       }
 
       void onConflict(VarId v)
       {
 	assert(v != BadVarId);
-	Clause c;
-	c.push_back(Lit(varId, 1));
-	c.push_back(Lit(v, 1));
-	sat.push_back(c);
+	arena->addClause(sat);
+	arena->addLit(sat, Lit(varId, 1));
+	arena->addLit(sat, Lit(v, 1));
       }
 
       void onRequire(const VarIdVector& alternatives)
@@ -79,53 +237,60 @@ namespace Deepsolver
 	    logMsg(LOG_WARNING, "solver:trying to add a require without alternatives");
 	    return;
 	  }
-	Clause c;
-	c.push_back(Lit(varId, 1));
+	arena->addClause(sat);
+	arena->addLit(sat, Lit(varId, 1));
 	for(VarIdVector::size_type i = 0;i < alternatives.size();++i)
 	  {
 	    assert(alternatives[i] != BadVarId);
-	    c.push_back(Lit(alternatives[i]));
+	    arena->addLit(sat, Lit(alternatives[i]));
 	  }
-	sat.push_back(c);
       }
 
       void onDependent(VarId dependent, const VarIdVector& alternatives)
       {
 	assert(dependent != BadVarId);
-	Clause c;
-	c.push_back(Lit(varId));
-	c.push_back(Lit(dependent, 1));
+	arena->addClause(sat);
+	arena->addLit(sat, Lit(varId));
+	arena->addLit(sat, Lit(dependent, 1));
 	for(VarIdVector::size_type i = 0;i < alternatives.size();++i)
 	  {
 	    assert(alternatives[i] != BadVarId);
-	    c.push_back(Lit(alternatives[i]));
-  }
-	sat.push_back(c);
+	    arena->addLit(sat, Lit(alternatives[i]));
+	  }
+      }
+
+      void clearSat()
+      {
+	sat = ClauseArena::Range();
       }
 
       void clearAllMarks()
       {
 	ambiguous = 0;
-	bfsMark = 0;
-	for(Sat::size_type i = 0;i < sat.size();++i)
-	  for(Clause::size_type j = 0;j < sat[i].size();++j)
-	    sat[i][j].ambiguous = 0;
+	arena->clearAmbiguous(sat);
       }
 
     public:
+      ClauseArena* arena;
       VarId varId;
       bool oldState, newState;
       size_t refNum;
-      Sat sat;
+      ClauseArena::Range sat;//The clauses in the arena;
       bool germ;
       VarIdVector reconstruct;
-      bool ambiguous, bfsMark;
+      bool ambiguous;
       VarId replacementFor;
     }; //class RefCountedEntry;
 
     typedef std::vector<RefCountedEntry*> RefCountedEntryVector;
     typedef std::list<RefCountedEntry*> RefCountedEntryList;
 
+    /**\brief The table of entries of the variables involved in SAT
+     *
+     * The entries are allocated in the pool with stable addresses and the
+     * released ones are reused, all clauses are kept in the common
+     * ClauseArena.
+     */
     class RefCountedEntries
     {
     public:
@@ -148,39 +313,30 @@ namespace Deepsolver
       void erase(VarId varId)
       {
 	assert(varId != BadVarId && hasEntry(varId));
-	delete m_entries[varId];
-	m_entries[varId] = NULL;
+	release(varId);
       }
 
       void clear()
       {
-	for(RefCountedEntryVector::size_type i = 0;i < m_entries.size();++i)
-	  delete m_entries[i];
 	m_entries.clear();
+	m_pool.clear();
+	m_released.clear();
+	m_arena.clear();
       }
 
       void clearGerms()
       {
 	for(RefCountedEntryVector::size_type i = 0;i < m_entries.size();++i)
 	  if (m_entries[i] != NULL && m_entries[i]->germ)
-	    {
-	      delete m_entries[i];
-	      m_entries[i] = NULL;
-	    }
-      }
-
-      void clearBfsMarks()
-      {
-	for(RefCountedEntryVector::size_type i = 0;i < m_entries.size();++i)
-	  if (m_entries[i] != NULL)
-	    m_entries[i]->bfsMark = 0;
+	    release(i);
       }
 
       void clearAllMarks()
       {
 	for(RefCountedEntryVector::size_type i = 0;i < m_entries.size();++i)
 	  if (m_entries[i] != NULL)
-	    m_entries[i]->clearAllMarks();
+	    m_entries[i]->ambiguous = 0;
+	m_arena.clearAmbiguous();
       }
 
       bool newStatesValid() const
@@ -190,23 +346,23 @@ namespace Deepsolver
 	  if (m_entries[i] != NULL)
 	    {
 	      const RefCountedEntry& e = *m_entries[i];
-	      for(Sat::size_type s = 0;s < e.sat.size();++s)
+	      for(size_t s = e.sat.begin;s < e.sat.end;++s)
 		{
-		  Clause::size_type c;
-		  for(c = 0;c < e.sat[s].size();++c)
+		  size_t c;
+		  for(c = m_arena.litBegin(s);c < m_arena.litEnd(s);++c)
 		    {
-		      const VarId v = e.sat[s][c].varId;
-		      const bool n = e.sat[s][c].neg;
+		      const VarId v = m_arena.varId(c);
+		      const bool n = m_arena.neg(c);
 		      assert(hasEntry(v));
 		      if (!n && getEntry(v).newState)
 			break;
 		      if (n && !getEntry(v).newState)
 			break;
 		    }
-		  if (c >= e.sat[s].size())
+		  if (c >= m_arena.litEnd(s))
 		    return 0;
 		}
-	      count += e.sat.size();
+	      count += e.sat.end - e.sat.begin;
 	    } //if(entry exists);
 	logMsg(LOG_DEBUG, "solver:%zu clauses are checked and OK!", count);
 	return 1;
@@ -235,6 +391,16 @@ namespace Deepsolver
 	return *m_entries[varId];
       }
 
+      ClauseArena& getArena()
+      {
+	return m_arena;
+      }
+
+      const ClauseArena& getArena() const
+      {
+	return m_arena;
+      }
+
       void incRef(VarId varId)
       {
 	assert(hasEntry(varId));
@@ -251,7 +417,7 @@ namespace Deepsolver
       {
 	assert(varId != BadVarId && !hasEntry(varId));
 	assert(varId < m_entries.size());
-	m_entries[varId] = new RefCountedEntry(varId, installed);
+	m_entries[varId] = allocate(varId, installed);
 	return *m_entries[varId];
       }
 
@@ -261,24 +427,242 @@ namespace Deepsolver
 	if (hasEntry(varId))
 	  return getEntry(varId);
 	assert(varId < m_entries.size());
-	m_entries[varId] = new RefCountedEntry(varId, installed);
+	m_entries[varId] = allocate(varId, installed);
 	return *m_entries[varId];
       }
 
+    private:
+      RefCountedEntry* allocate(VarId varId, bool installed)
+      {
+	if (m_released.empty())
+	  {
+	    m_pool.push_back(RefCountedEntry(m_arena, varId, installed));
+	    return &m_pool.back();
+	  }
+	RefCountedEntry* e = m_released.back();
+	m_released.pop_back();
+	*e = RefCountedEntry(m_arena, varId, installed);
+	return e;
+      }
+
+      void release(VarId varId)
+      {
+	m_released.push_back(m_entries[varId]);
+	m_entries[varId] = NULL;
+      }
 
     private:
       RefCountedEntryVector m_entries;
+      std::deque<RefCountedEntry> m_pool;//Never reallocates existing items;
+      RefCountedEntryVector m_released;
+      ClauseArena m_arena;
     }; //class RefCountedEntries;Ref
 
+    /**\brief The set of variables processed by whole words*/
+    class VarIdBitset
+    {
+    public:
+      typedef uint64_t Word;
+
+      enum {
+	WordBits = 64
+      };
+
+    public:
+      VarIdBitset() {}
+      virtual ~VarIdBitset() {}
+
+    public:
+      void init(size_t size)
+      {
+	m_words.assign((size + WordBits - 1) / WordBits, 0);
+      }
+
+      void clear()
+      {
+	m_words.assign(m_words.size(), 0);
+      }
+
+      void set(VarId varId)
+      {
+	assert(varId / WordBits < m_words.size());
+	m_words[varId / WordBits] |= (Word)1 << (varId % WordBits);
+      }
+
+      bool test(VarId varId) const
+      {
+	assert(varId / WordBits < m_words.size());
+	return (m_words[varId / WordBits] >> (varId % WordBits)) & 1;
+      }
+
+      size_t wordCount() const
+      {
+	return m_words.size();
+      }
+
+      Word& word(size_t index)
+      {
+	assert(index < m_words.size());
+	return m_words[index];
+      }
+
+      Word word(size_t index) const
+      {
+	assert(index < m_words.size());
+	return m_words[index];
+      }
+
+      void swap(VarIdBitset& bitset)
+      {
+	m_words.swap(bitset.m_words);
+      }
+
+      //Removes the lowest variable of the word and returns it;
+      static VarId takeLowest(size_t index, Word& word)
+      {
+	assert(word != 0);
+	const VarId varId = index * WordBits + __builtin_ctzll(word);
+	word &= word - 1;
+	return varId;
+      }
+
+    private:
+      std::vector<Word> m_words;
+    }; //class VarIdBitset;
+
+    /**\brief The clause graph of RefCountedEntries in compressed sparse rows
+     *
+     * Each entry has the edges to the variables of its clauses, every edge
+     * keeps the literal position in ClauseArena to check its ambiguity
+     * mark. The reverse edges give the entries referencing a
+     * variable. The graph is built once for the solution filtering, the
+     * ambiguity marks are only added during it, so the edges are never
+     * added and the dead ones are just skipped.
+     */
+    class ClauseGraph
+    {
+    public:
+      ClauseGraph() {}
+      virtual ~ClauseGraph() {}
+
+    public:
+      void build(const RefCountedEntries& p);
+
+      /**\brief Finds all entries reachable over unambiguous edges
+       *
+       * The search goes level by level, the frontier of each level is
+       * the bitset, so the visited and blocked entries are excluded by
+       * whole words.
+       *
+       * \param [in] p The entries the graph was built for
+       * \param [in] seed The entries to start from
+       * \param [in] blocked The ambiguous entries not to visit
+       * \param [out] reached The reachable entries including the seed
+       */
+      void reach(const RefCountedEntries& p,
+		 const VarIdVector& seed,
+		 const VarIdBitset& blocked,
+		 VarIdBitset& reached) const;
+
+      //Fills the list with the given entries and all entries referencing them, without duplicates;
+      void getAffected(const VarIdVector& vars, VarIdVector& affected) const;
+
+    private:
+      SizeVector m_offsets, m_lits;
+      VarIdVector m_targets;
+      SizeVector m_userOffsets;
+      VarIdVector m_users;
+    }; //class ClauseGraph;
+
+    /**\brief The limits of single task solving
+     *
+     * This class checks the deadline and asks the continue request object
+     * given in TaskSolverData. It is created at the beginning of each
+     * solving and consulted periodically by SatBuilder and by Solver while
+     * SAT solver is working. All checks are made only in the thread the
+     * solving was called in, so continue request objects need not be
+     * thread-safe. The conflict limit is just passed to SAT solvers.
+     */
+    class SolverBudget
+    {
+    public:
+      /**\brief The constructor
+       *
+       * \param [in] taskSolverData The data with limits and continue request
+       */
+      SolverBudget(const TaskSolverData& taskSolverData)
+	: m_started(std::chrono::steady_clock::now()),
+	  m_timeLimit(taskSolverData.timeLimit),
+	  m_conflictLimit(taskSolverData.conflictLimit),
+	  m_continueRequest(taskSolverData.continueRequest) {}
+
+      /**\brief The destructor*/
+      virtual ~SolverBudget() {}
+
+    public:
+      /**\brief Checks if the solving may not be continued
+       *
+       * \param [out] code The code of TaskException to throw if the solving must be stopped
+       *
+       * \return Non-zero if the solving must be stopped
+       */
+      bool expired(int& code) const;
+
+      /**\brief Returns the number of seconds since the solving beginning*/
+      double getElapsed() const;
+
+      /**\brief Checks if there is anything to poll while SAT solver is working*/
+      bool isPolled() const
+      {
+	return m_timeLimit > 0 || m_continueRequest != NULL;
+      }
+
+      size_t getConflictLimit() const
+      {
+	return m_conflictLimit;
+      }
+
+    private:
+      const std::chrono::steady_clock::time_point m_started;
+      const size_t m_timeLimit;
+      const size_t m_conflictLimit;
+      const AbstractOperationContinueRequest* const m_continueRequest;
+    }; //class SolverBudget;
+
+    /**\brief The scope data needed to construct the clauses of a package
+     *
+     * Everything here depends only on the package scope, not on the user
+     * task, so the expansions can be prepared in parallel threads and
+     * consumed by the serial construction in its usual order.
+     */
+    struct PkgExpansion
+    {
+      VarIdVector otherVer;//Other versions for installation, replacements for removing;
+      IdPkgRelVector rels;//Requires for installation, relations of dependent packages for removing;
+      std::vector<VarIdVector> alternatives;//Matching packages for each item of rels;
+      IdPkgRelVector conflicts;
+      std::vector<VarIdVector> conflictVars;//Matching packages for each item of conflicts;
+      VarIdVector installedVars;//Conflicting installed packages for installation, dependent ones for removing;
+    }; //struct PkgExpansion;
+
     class SatBuilder
     {
     public:
       SatBuilder(const AbstractPkgBackEnd& backend,
 		 const AbstractPkgScope& scope,
-		 const AbstractProvidePriority& providePriority)
+		 const AbstractProvidePriority& providePriority,
+		 const SolverBudget& budget,
+		 RequireCache& requireCache,
+		 size_t threadCount)
 	: m_backend(backend),
 	  m_scope(scope),
-	  m_providePriority(providePriority) {}
+	  m_providePriority(providePriority),
+	  m_budget(budget),
+	  m_requireCache(requireCache),
+	  m_threadCount(threadCount),
+	  m_processedCount(0),
+	  m_reconstructGeneration(0),
+	  m_scannedPending(0) {}
 
       /**\brief The destructor*/
       virtual ~SatBuilder() {}
@@ -317,6 +701,12 @@ namespace Deepsolver
       void onPending();
       //This method in contrast to onPending() doesn't care whether packages are processed or not;
       void reconstruct(const VarIdVector& vars);
+      void checkBudget() const;
+      const PkgExpansion& expand(VarId varId, PkgExpansion& local);
+      void fillExpansion(VarId varId, PkgExpansion& expansion) const;
+
+      //Prepares expansions of newly pending packages in parallel threads;
+      void expandFrontier();
 
       bool ensureSatCorrect() const;
 
@@ -327,8 +717,19 @@ namespace Deepsolver
       const AbstractPkgBackEnd& m_backend;
       const AbstractPkgScope& m_scope; 
       const AbstractProvidePriority& m_providePriority;
+      const SolverBudget& m_budget;
+      RequireCache& m_requireCache;
+      const size_t m_threadCount;
+      size_t m_processedCount;
       VarIdSet m_userTaskInstall, m_userTaskRemove;
       VarIdVector m_pending;
+      SizeVector m_pendingCounts;//Occurrences of each package in m_pending;
+      std::vector<bool> m_installMask, m_removeMask;//The content of m_userTaskInstall and m_userTaskRemove during the construction;
+      SizeVector m_reconstructStamps;
+      size_t m_reconstructGeneration;
+      std::vector<std::unique_ptr<PkgExpansion> > m_expansions;
+      size_t m_scannedPending;//The number of pending packages already taken by expandFrontier();
+      VarIdVector m_alternatives;//Reused by every require to avoid the memory allocation;
       //      VarIdToVarIdMap m_replPending;
 #ifdef DEEPSOLVER_SOLVER_DEBUG
       VarIdVector m_debugReferences;
@@ -340,7 +741,8 @@ namespace Deepsolver
     public:
       Solver(const TaskSolverData& taskSolverData)
 	: m_taskSolverData(taskSolverData),
-	  m_scope(taskSolverData.scope) {}
+	  m_scope(taskSolverData.scope),
+	  m_requireCache(taskSolverData.requireCache?taskSolverData.requireCache:RequireCache::Ptr(new RequireCache())) {}
 
       virtual ~Solver() {}
 
@@ -351,20 +753,107 @@ namespace Deepsolver
 
       void dumpSat(const UserTask& userTask, std::ostream& s) const;
 
-    private:
-      void doMainWork(SatBuilder& builder, const UserTask& userTask) const;
+      void dumpDimacs(const UserTask& userTask,
+		      std::ostream& s,
+		      std::ostream& varsMap) const override;
 
+    private:
+      void doMainWork(SatBuilder& builder,
+		      const SolverBudget& budget,
+		      const UserTask& userTask) const;
+
+      void fillSat(const RefCountedEntries& p,
+		   const VarIdSet& userTaskInstall,
+		   const VarIdSet& userTaskRemove,
+		   const VarIdVector& fixedToInstall,
+		   Sat& sat) const;
+
+      //Called only after the task is found unsolvable, solves again with the selector of each relation clause to take the core;
+      void explainUnsolvable(const RefCountedEntries& p,
+			     const SolverBudget& budget,
+			     const VarIdSet& userTaskInstall,
+			     const VarIdSet& userTaskRemove,
+			     const VarIdVector& fixedToInstall,
+			     std::string& explanation) const;
+
+      //Drops the core assumptions not needed for the contradiction while the attempts and the budget last;
+      void minimizeCore(const SolverBudget& budget,
+			AbstractSatSolver::Ptr satSolver,
+			const Sat& sat,
+			Clause& core) const;
+
+      //Returns the relations of the core, one per line;
+      std::string describeCore(const RefCountedEntries& p, const Clause& core) const;
+      std::string describeClause(const Clause& clause) const;
+
+      //Adds the soft literals of the minimal change and the clauses of their auxiliary variables;
+      void fillSoftLits(const RefCountedEntries& p,
+			const VarIdSet& userTaskInstall,
+			const VarIdSet& userTaskRemove,
+			Sat& sat,
+			SoftLitVector& softs) const;
+
+      //The failure is explained if the explanation is not NULL and it is enabled;
       bool solveSat(RefCountedEntries& p,
+		    const SolverBudget& budget,
 		    const VarIdSet& userTaskInstall,
 		    const VarIdSet& userTaskRemove,
-		    const VarIdVector& fixedToInstall) const;
+		    const VarIdVector& fixedToInstall,
+		    bool optimize,
+		    std::string* explanation) const;
+
+      void applySolution(RefCountedEntries& p, const VarIdToBoolMap& res) const;
+
+      //Solves the equation as a whole, throws TaskException if solver is aborted;
+      bool solveFormula(const SolverBudget& budget,
+			const Sat& sat,
+			const SoftLitVector& softs,
+			VarIdToBoolMap& res) const;
+
+      bool solveComponents(const SolverBudget& budget,
+			   const SatVector& components,
+			   const SoftLitVector& softs,
+			   const Sat& sat,
+			   VarIdToBoolMap& res) const;
+
+      bool solveComponentsParallel(const SolverBudget& budget,
+				   const SatVector& components,
+				   const std::vector<SoftLitVector>& softs,
+				   const Sat& sat,
+				   VarIdToBoolMap& res) const;
+
+      //Runs SAT solver polling the budget if needed and the solver is interruptible, the assumptions are used if there are any;
+      bool callSatSolver(const SolverBudget& budget,
+			 AbstractSatSolver::Ptr satSolver,
+			 const Sat& sat,
+			 const Clause& assumptions,
+			 VarIdToBoolMap& res,
+			 Clause& core) const;
+
+      //Runs SAT solver in separate thread polling the budget, throws TaskException on expiry;
+      bool solveSatPolled(const SolverBudget& budget,
+			  AbstractSatSolver::Ptr satSolver,
+			  const Sat& sat,
+			  const Clause& assumptions,
+			  VarIdToBoolMap& res,
+			  Clause& core) const;
+
+      AbstractSatSolver::Ptr createSatSolver() const;
+      //Takes "cdcl" if the chosen solver has no assumptions;
+      AbstractSatSolver::Ptr createAssumingSatSolver() const;
+
+      //Creates the solver with all clauses, it is MaxSatSolver if there are soft literals;
+      AbstractSatSolver::Ptr prepareSatSolver(const SolverBudget& budget,
+					      const Sat& sat,
+					      const SoftLitVector& softs) const;
+      size_t buildThreadCount() const;
 
       void filterSolution(RefCountedEntries& p,
 			  const VarIdSet& userTaskInstall,
 			  const VarIdSet& userTaskRemove,
 			  const VarIdVector& fixedToInstall) const;
 
-      void makeAmbiguousMarks(const RefCountedEntries& p, 
+      void makeAmbiguousMarks(RefCountedEntries& p, 
 			      const VarIdSet& seed,
 			      RefCountedEntry& e,
 			      size_t& changedNum) const;
@@ -372,6 +861,7 @@ namespace Deepsolver
     private:
       const TaskSolverData& m_taskSolverData;
       const AbstractPkgScope& m_scope;
+      const RequireCache::Ptr m_requireCache;
     }; //class Solver;
   } //namespace Solver;
 } //namespace Deepsolver;
@@ -19,6 +19,7 @@
 #define DEEPSOLVER_SOLVER_BASE_H
 
 #include"deepsolver/AbstractPkgBackEnd.h"
+#include"deepsolver/PkgSnapshot.h"
 
 #define DEEPSOLVER_BEGIN_SOLVER_NAMESPACE namespace Deepsolver { namespace Solver{
 #define DEEPSOLVER_END_SOLVER_NAMESPACE }}
@@ -27,6 +28,182 @@ namespace Deepsolver
 {
   namespace Solver
   {
+    /**\brief The read-only range of package relations stored in the snapshot
+     *
+     * The items are given as IdPkgRelRef objects pointing to the version
+     * strings of the snapshot, so neither the span nor the items may be
+     * used after the snapshot is destroyed.
+     */
+    class IdPkgRelSpan
+    {
+    public:
+      typedef size_t size_type;
+
+    public:
+      IdPkgRelSpan()
+	: m_begin(NULL),
+	  m_end(NULL) {}
+
+      IdPkgRelSpan(const PkgSnapshot::Relation* b, const PkgSnapshot::Relation* e)
+	: m_begin(b),
+	  m_end(e) {}
+
+    public:
+      size_type size() const
+      {
+	return m_end - m_begin;
+      }
+
+      bool empty() const
+      {
+	return m_begin == m_end;
+      }
+
+      IdPkgRelRef operator [](size_type index) const
+      {
+	assert(index < size());
+	const PkgSnapshot::Relation& rel = m_begin[index];
+	return IdPkgRelRef(rel.pkgId, rel.ver != NULL ? rel.verDir : (VerDirection)VerNone, rel.ver);
+      }
+
+    private:
+      const PkgSnapshot::Relation* m_begin;
+      const PkgSnapshot::Relation* m_end;
+    }; //class IdPkgRelSpan;
+
+    /**\brief The packages which may satisfy a relation before the version check
+     *
+     * The packages with the name of the relation take the continuous range
+     * of VarId values from namedBegin to namedEnd, the packages having the
+     * provide entry with this name are listed in providers. The same
+     * package may appear in both parts.
+     */
+    struct RelCandidates
+    {
+      RelCandidates()
+	: namedBegin(0),
+	  namedEnd(0) {}
+
+      size_t size() const
+      {
+	return namedEnd - namedBegin + providers.size();
+      }
+
+      VarId operator [](size_t index) const
+      {
+	assert(index < size());
+	const size_t namedCount = namedEnd - namedBegin;
+	return index < namedCount ? namedBegin + index : providers[index - namedCount];
+      }
+
+      VarId namedBegin, namedEnd;
+      VarIdSpan providers;
+    }; //struct RelCandidates;
+
+    class AbstractPkgScope;
+
+    /**\brief The iterator over candidates matching the relation with provides
+     *
+     * The iterator walks through the candidates of the relation skipping
+     * the packages which don't satisfy its version restriction. The
+     * relation without version is satisfied by all candidates. Nothing is
+     * copied or allocated, so the scope and the version string of the
+     * relation must remain valid while the iterator is used.
+     */
+    class MatchingVarIterator
+    {
+    public:
+      typedef std::input_iterator_tag iterator_category;
+      typedef VarId value_type;
+      typedef ptrdiff_t difference_type;
+      typedef const VarId* pointer;
+      typedef VarId reference;
+
+    public:
+      MatchingVarIterator()
+	: m_scope(NULL),
+	  m_pos(0) {}
+
+      MatchingVarIterator(const AbstractPkgScope& scope,
+			  const IdPkgRelRef& rel,
+			  const RelCandidates& candidates,
+			  size_t pos)
+	: m_scope(&scope),
+	  m_rel(rel),
+	  m_candidates(candidates),
+	  m_pos(pos)
+      {
+	skipUnmatched();
+      }
+
+    public:
+      VarId operator *() const
+      {
+	return m_candidates[m_pos];
+      }
+
+      MatchingVarIterator& operator ++()
+      {
+	assert(m_pos < m_candidates.size());
+	m_pos++;
+	skipUnmatched();
+	return *this;
+      }
+
+      bool operator ==(const MatchingVarIterator& it) const
+      {
+	return m_pos == it.m_pos;
+      }
+
+      bool operator !=(const MatchingVarIterator& it) const
+      {
+	return m_pos != it.m_pos;
+      }
+
+    private:
+      void skipUnmatched();
+
+    private:
+      const AbstractPkgScope* m_scope;
+      IdPkgRelRef m_rel;
+      RelCandidates m_candidates;
+      size_t m_pos;
+    }; //class MatchingVarIterator;
+
+    /**\brief The range of packages matching the relation with provides
+     *
+     * \sa MatchingVarIterator
+     */
+    class MatchingVars
+    {
+    public:
+      typedef MatchingVarIterator const_iterator;
+
+    public:
+      MatchingVars(const AbstractPkgScope& scope,
+		   const IdPkgRelRef& rel,
+		   const RelCandidates& candidates)
+	: m_scope(scope),
+	  m_rel(rel),
+	  m_candidates(candidates) {}
+
+    public:
+      const_iterator begin() const
+      {
+	return const_iterator(m_scope, m_rel, m_candidates, 0);
+      }
+
+      const_iterator end() const
+      {
+	return const_iterator(m_scope, m_rel, m_candidates, m_candidates.size());
+      }
+
+    private:
+      const AbstractPkgScope& m_scope;
+      const IdPkgRelRef m_rel;
+      const RelCandidates m_candidates;
+    }; //class MatchingVars;
+
     class AbstractPkgScope
     {
     public:
@@ -37,7 +214,9 @@ namespace Deepsolver
       };
 
     public:
-      AbstractPkgScope() {}
+      AbstractPkgScope()
+	: m_generation(nextGeneration()) {}
+
       virtual ~AbstractPkgScope() {}
 
     public:
@@ -79,6 +258,57 @@ namespace Deepsolver
 
       virtual void whatSatisfyAmongInstalled(const IdPkgRel& rel, VarIdVector& res) const = 0;
 
+    public:
+      /**\brief Returns the requires of the package without copying them
+       *
+       * \param [in] varId The package to get requires of
+       *
+       * \return The span over the requires stored in the scope
+       */
+      virtual IdPkgRelSpan getRequiresSpan(VarId varId) const = 0;
+
+      /**\brief Returns the conflicts of the package without copying them
+       *
+       * \param [in] varId The package to get conflicts of
+       *
+       * \return The span over the conflicts stored in the scope
+       */
+      virtual IdPkgRelSpan getConflictsSpan(VarId varId) const = 0;
+
+      /**\brief Returns packages having the name or providing it
+       *
+       * The lookup takes constant time and makes no copies, the version
+       * of packages is not checked.
+       *
+       * \param [in] pkgId The name to find packages for
+       *
+       * \return The packages with the name followed by the providing ones
+       */
+      virtual RelCandidates getCandidates(PkgId pkgId) const = 0;
+
+      /**\brief Checks if the package satisfies the relation with its name or provides
+       *
+       * \param [in] varId The package to check
+       * \param [in] rel The relation with version restriction
+       *
+       * \return Non-zero if the version of the package or one of its provides matches the relation
+       */
+      virtual bool satisfiesWithProvides(VarId varId, const IdPkgRelRef& rel) const = 0;
+
+      /**\brief Selects packages matching the relation with provides without copying
+       *
+       * This method gives the same packages in the same order as
+       * selectMatchingVarsWithProvides() but doesn't allocate any memory.
+       *
+       * \param [in] rel The relation to find packages for
+       *
+       * \return The range of matching packages
+       */
+      MatchingVars matchingVarsWithProvides(const IdPkgRelRef& rel) const
+      {
+	return MatchingVars(*this, rel, getCandidates(rel.pkgId));
+      }
+
     public:
       virtual size_t getPkgCount() const = 0;
       virtual bool knownPkgName(const std::string& name) const = 0;
@@ -102,8 +332,46 @@ namespace Deepsolver
       {
 	return getVersion(varId, EpochIfNonZero);
       }
+
+      /**\brief Returns the value identifying the current content of the scope
+       *
+       * Every scope object gets its own value on construction and a new
+       * one on each change of its content, so two values are equal only
+       * for the same content, even if one scope is created at the address
+       * of another one destroyed before.
+       */
+      size_t getGeneration() const
+      {
+	return m_generation;
+      }
+
+    protected:
+      /**\brief Must be called by derived classes changing the content in place*/
+      void contentChanged()
+      {
+	m_generation = nextGeneration();
+      }
+
+    private:
+      static size_t nextGeneration()
+      {
+	static std::atomic<size_t> next(1);
+	return next++;
+      }
+
+    private:
+      size_t m_generation;
     }; //class AbstractPkgScope;
 
+    inline void MatchingVarIterator::skipUnmatched()
+    {
+      if (!m_rel.verRestricted())
+	return;
+      assert(m_scope != NULL);
+      while(m_pos < m_candidates.size() && !m_scope->satisfiesWithProvides(m_candidates[m_pos], m_rel))
+	m_pos++;
+    }
+
     class AbstractProvidePriority
     {
     public:
@@ -116,6 +384,9 @@ namespace Deepsolver
   } //namespace Solver;
 
   using Solver::AbstractPkgScope;
+  using Solver::IdPkgRelSpan;
+  using Solver::RelCandidates;
+  using Solver::MatchingVars;
 } //namespace Deepsolver;
 
 #endif //DEEPSOLVER_SOLVER_BASE_H;
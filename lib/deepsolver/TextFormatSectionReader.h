@@ -19,6 +19,7 @@
 #define DEEPSOLVER_TEXT_FORMAT_SECTION_READER_H
 
 #include"deepsolver/GzipInterface.h"
+#include"deepsolver/ZstdInterface.h"
 
 namespace Deepsolver
 {
@@ -112,6 +113,41 @@ namespace Deepsolver
   private:
     GzipInputFile m_file;
   }; //class TextFormatSectionReader;
+
+#ifdef HAVE_ZSTD
+  class TextFormatSectionReaderZstd: public AbstractTextFormatSectionReader
+  {
+  public:
+    typedef std::shared_ptr<TextFormatSectionReaderZstd> Ptr;
+
+  public:
+    /**\brief The default constructor*/
+    TextFormatSectionReaderZstd() {}
+
+    /**\brief The destructor*/
+    virtual ~TextFormatSectionReaderZstd() {}
+
+  public:
+    void open(const std::string& fileName)
+    {
+      m_file.open(fileName);
+    }
+
+    void close()
+    {
+      m_file.close();
+    }
+
+  protected:
+    size_t readData(void* buf, size_t bufSize)
+    {
+      return m_file.read(buf, bufSize);
+    }
+
+  private:
+    ZstdInputFile m_file;
+  }; //class TextFormatSectionReaderZstd;
+#endif //HAVE_ZSTD;
 } //namespace Deepsolver;
 
 #endif //DEEPSOLVER_TEXT_FORMAT_SECTION_READER_H;
@@ -0,0 +1,142 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/Xxh64.h"
+
+#define PRIME1 0x9e3779b185ebca87ULL
+#define PRIME2 0xc2b2ae3d27d4eb4fULL
+#define PRIME3 0x165667b19e3779f9ULL
+#define PRIME4 0x85ebca77c2b2ae63ULL
+#define PRIME5 0x27d4eb2f165667c5ULL
+
+DEEPSOLVER_BEGIN_NAMESPACE
+
+static uint64_t rotl(uint64_t x, int n);
+static uint64_t read64(const unsigned char* c);
+static uint32_t read32(const unsigned char* c);
+static uint64_t stripeRound(uint64_t acc, uint64_t value);
+static uint64_t mergeRound(uint64_t acc, uint64_t value);
+
+void Xxh64::init()
+{
+  m_acc[0] = PRIME1 + PRIME2;
+  m_acc[1] = PRIME2;
+  m_acc[2] = 0;
+  m_acc[3] = 0 - PRIME1;
+  m_size = 0;
+}
+
+void Xxh64::update(const void* buf, size_t len)
+{
+  assert(buf || len == 0);
+  const unsigned char* c = static_cast<const unsigned char*>(buf);
+  size_t used = m_size % 32;
+  m_size += len;
+  if (used > 0)
+    {
+      const size_t count = std::min(len, 32 - used);
+      memcpy(m_buf + used, c, count);
+      c += count;
+      len -= count;
+      used += count;
+      if (used < 32)
+	return;
+      for(size_t i = 0;i < 4;i++)
+	m_acc[i] = stripeRound(m_acc[i], read64(m_buf + 8 * i));
+    }
+  //The stripes are taken directly from the given data;
+  uint64_t acc0 = m_acc[0], acc1 = m_acc[1], acc2 = m_acc[2], acc3 = m_acc[3];
+  while(len >= 32)
+    {
+      acc0 = stripeRound(acc0, read64(c));
+      acc1 = stripeRound(acc1, read64(c + 8));
+      acc2 = stripeRound(acc2, read64(c + 16));
+      acc3 = stripeRound(acc3, read64(c + 24));
+      c += 32;
+      len -= 32;
+    }
+  m_acc[0] = acc0;
+  m_acc[1] = acc1;
+  m_acc[2] = acc2;
+  m_acc[3] = acc3;
+  if (len > 0)
+    memcpy(m_buf, c, len);
+}
+
+std::string Xxh64::commit()
+{
+  uint64_t h;
+  if (m_size >= 32)
+    {
+      h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+      for(size_t i = 0;i < 4;i++)
+	h = mergeRound(h, m_acc[i]);
+    } else
+    h = PRIME5;
+  h += m_size;
+  const unsigned char* c = m_buf;
+  size_t len = m_size % 32;
+  for(;len >= 8;len -= 8, c += 8)
+    h = rotl(h ^ stripeRound(0, read64(c)), 27) * PRIME1 + PRIME4;
+  if (len >= 4)
+    {
+      h = rotl(h ^ (read32(c) * PRIME1), 23) * PRIME2 + PRIME3;
+      c += 4;
+      len -= 4;
+    }
+  for(;len > 0;len--, c++)
+    h = rotl(h ^ (*c * PRIME5), 11) * PRIME1;
+  h ^= h >> 33;
+  h *= PRIME2;
+  h ^= h >> 29;
+  h *= PRIME3;
+  h ^= h >> 32;
+  char res[17];
+  snprintf(res, sizeof(res), "%016llx", (unsigned long long)h);
+  return std::string(res, 16);
+}
+
+//Static functions;
+
+uint64_t rotl(uint64_t x, int n)
+{
+  return (x << n) | (x >> (64 - n));
+}
+
+uint64_t read64(const unsigned char* c)
+{
+  //Compilers turn this into the single load on little endian processors;
+  return (uint64_t)read32(c) | ((uint64_t)read32(c + 4) << 32);
+}
+
+uint32_t read32(const unsigned char* c)
+{
+  return (uint32_t)c[0] | ((uint32_t)c[1] << 8) | ((uint32_t)c[2] << 16) | ((uint32_t)c[3] << 24);
+}
+
+uint64_t stripeRound(uint64_t acc, uint64_t value)
+{
+  return rotl(acc + value * PRIME2, 31) * PRIME1;
+}
+
+uint64_t mergeRound(uint64_t acc, uint64_t value)
+{
+  return (acc ^ stripeRound(0, value)) * PRIME1 + PRIME4;
+}
+
+DEEPSOLVER_END_NAMESPACE
@@ -0,0 +1,52 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_XXH64_H
+#define DEEPSOLVER_XXH64_H
+
+#include"deepsolver/AbstractChecksum.h"
+
+namespace Deepsolver
+{
+  /**\brief The XXH64 hash calculation
+   *
+   * This is the 64-bit variant of xxHash with zero seed, its result is
+   * equal to the one printed by xxhsum utility. The hash is several
+   * times faster than md5, but it cannot be used to protect against
+   * intended data changes.
+   */
+  class Xxh64: public AbstractChecksum
+  {
+  public:
+    Xxh64()
+      : m_size(0) {}
+
+    virtual ~Xxh64() {}
+
+  public:
+    void init() override;
+    void update(const void* buf, size_t len) override;
+    std::string commit() override;
+
+  private:
+    uint64_t m_acc[4];
+    unsigned char m_buf[32];
+    uint64_t m_size;//The total number of bytes given;
+  }; //class Xxh64;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_XXH64_H;
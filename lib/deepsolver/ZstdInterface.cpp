@@ -0,0 +1,173 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/ZstdInterface.h"
+#include<zstd.h>
+
+DEEPSOLVER_BEGIN_NAMESPACE
+
+#define ZSTD_STOP(x) throw ZstdException(x)
+
+void ZstdOutputFile::open(const std::string& fileName, int level, size_t threadCount)
+{
+  assert(m_cctx == NULL);
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  if (cctx == NULL)
+    ZSTD_STOP("ZSTD_createCCtx() cannot create compression context for " + fileName);
+  size_t res = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+  if (!ZSTD_isError(res))
+    res = ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+  if (ZSTD_isError(res))
+    {
+      ZSTD_freeCCtx(cctx);
+      ZSTD_STOP(fileName + ":" + ZSTD_getErrorName(res));
+    }
+  if (threadCount > 0)
+    {
+      res = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, (int)threadCount);
+      //libzstd may be built without multithreading support, the result is the same in this case;
+      if (ZSTD_isError(res))
+	logMsg(LOG_WARNING, "zstd:%s is compressed in single thread:%s", fileName.c_str(), ZSTD_getErrorName(res));
+    }
+  try {
+    m_file.create(fileName);
+  }
+  catch(...)
+    {
+      ZSTD_freeCCtx(cctx);
+      throw;
+    }
+  m_cctx = cctx;
+  m_outBuf.resize(ZSTD_CStreamOutSize());
+  m_fileName = fileName;
+}
+
+void ZstdOutputFile::write(const void* buf, size_t bufSize)
+{
+  if (bufSize == 0)
+    return;
+  assert(buf);
+  assert(m_cctx != NULL);
+  compress(buf, bufSize, ZSTD_e_continue);
+}
+
+void ZstdOutputFile::close()
+{
+  if (m_cctx == NULL)
+    return;
+  //The frame epilogue is written by the last call;
+  while(compress(NULL, 0, ZSTD_e_end) > 0);
+  ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(m_cctx));
+  m_cctx = NULL;
+  m_file.close();
+  m_outBuf.clear();
+  m_fileName.erase();
+}
+
+size_t ZstdOutputFile::compress(const void* buf, size_t bufSize, int mode)
+{
+  assert(m_cctx != NULL);
+  ZSTD_CCtx* cctx = static_cast<ZSTD_CCtx*>(m_cctx);
+  ZSTD_inBuffer input = {buf, bufSize, 0};
+  size_t remaining = 0;
+  do {
+    ZSTD_outBuffer output = {&m_outBuf[0], m_outBuf.size(), 0};
+    remaining = ZSTD_compressStream2(cctx, &output, &input, (ZSTD_EndDirective)mode);
+    if (ZSTD_isError(remaining))
+      ZSTD_STOP(m_fileName + ":" + ZSTD_getErrorName(remaining));
+    if (output.pos > 0)
+      {
+	m_file.write(&m_outBuf[0], output.pos);
+	if (m_checksum != NULL)
+	  m_checksum->update(&m_outBuf[0], output.pos);
+      }
+  } while(input.pos < input.size);
+  return remaining;
+}
+
+void ZstdInputFile::open(const std::string& fileName)
+{
+  assert(m_dctx == NULL);
+  m_file.openReadOnly(fileName);
+  ZSTD_DCtx* dctx = ZSTD_createDCtx();
+  if (dctx == NULL)
+    {
+      m_file.close();
+      ZSTD_STOP("ZSTD_createDCtx() cannot create decompression context for " + fileName);
+    }
+  m_dctx = dctx;
+  m_inBuf.resize(ZSTD_DStreamInSize());
+  m_inPos = 0;
+  m_inSize = 0;
+  m_noMoreInput = 0;
+  m_frameEnd = 0;
+  m_fileName = fileName;
+}
+
+size_t ZstdInputFile::read(void* buf, size_t bufSize)
+{
+  if (bufSize == 0)
+    return 0;
+  assert(buf);
+  assert(m_dctx != NULL);
+  ZSTD_DCtx* dctx = static_cast<ZSTD_DCtx*>(m_dctx);
+  ZSTD_outBuffer output = {buf, bufSize, 0};
+  while(output.pos < output.size)
+    {
+      if (m_inPos >= m_inSize && !m_noMoreInput)
+	{
+	  m_inSize = m_file.read(&m_inBuf[0], m_inBuf.size());
+	  m_inPos = 0;
+	  if (m_inSize < m_inBuf.size())
+	    m_noMoreInput = 1;
+	}
+      //All frames are decoded and the file has nothing more;
+      if (m_noMoreInput && m_inPos >= m_inSize && m_frameEnd)
+	break;
+      ZSTD_inBuffer input = {&m_inBuf[0], m_inSize, m_inPos};
+      const size_t prevOutPos = output.pos;
+      const size_t res = ZSTD_decompressStream(dctx, &output, &input);
+      if (ZSTD_isError(res))
+	ZSTD_STOP(m_fileName + ":" + ZSTD_getErrorName(res));
+      const bool progress = input.pos > m_inPos || output.pos > prevOutPos;
+      m_inPos = input.pos;
+      m_frameEnd = res == 0;
+      //The decoder may keep the data of the last block even if the input is consumed;
+      if (m_noMoreInput && m_inPos >= m_inSize && output.pos < output.size && (res == 0 || !progress))
+	{
+	  //Non-zero value at the end of the input means the frame is not completed;
+	  if (res != 0)
+	    ZSTD_STOP(m_fileName + ":unexpected end of compressed data");
+	  break;
+	}
+    }
+  return output.pos;
+}
+
+void ZstdInputFile::close()
+{
+  if (m_dctx == NULL)
+    return;
+  ZSTD_freeDCtx(static_cast<ZSTD_DCtx*>(m_dctx));
+  m_dctx = NULL;
+  m_file.close();
+  m_inBuf.clear();
+  m_fileName.erase();
+}
+
+DEEPSOLVER_END_NAMESPACE
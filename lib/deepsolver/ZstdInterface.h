@@ -0,0 +1,108 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_ZSTD_INTERFACE_H
+#define DEEPSOLVER_ZSTD_INTERFACE_H
+
+#include"deepsolver/AbstractChecksum.h"
+
+namespace Deepsolver
+{
+  /**\brief The file compressed with Zstandard on writing
+   *
+   * The data is compressed as a single frame by the streaming
+   * interface. If the number of threads is given, the compression is
+   * performed by libzstd worker threads in parallel with the writing
+   * code.
+   */
+  class ZstdOutputFile
+  {
+  public:
+    ZstdOutputFile()
+      : m_cctx(NULL),
+	m_checksum(NULL) {}
+
+    virtual ~ZstdOutputFile()
+    {
+      close();
+    }
+
+  public:
+    /**\brief Creates the file and prepares the compression
+     *
+     * \param [in] fileName The name of the file to create
+     * \param [in] level The compression level
+     * \param [in] threadCount The number of worker threads, zero means compressing in the calling thread
+     */
+    void open(const std::string& fileName, int level, size_t threadCount);
+
+    void write(const void* buf, size_t bufSize);
+    void close();
+
+    /**\brief Passes all bytes written to the disk to the checksum calculation
+     *
+     * \param [in] checksum The initialized checksum object, may be NULL to stop the passing
+     */
+    void setChecksum(AbstractChecksum* checksum)
+    {
+      m_checksum = checksum;
+    }
+
+  private:
+    //Returns the number of bytes libzstd still has to flush;
+    size_t compress(const void* buf, size_t bufSize, int mode);
+
+  private:
+    File m_file;
+    void* m_cctx;
+    std::vector<char> m_outBuf;
+    AbstractChecksum* m_checksum;
+    std::string m_fileName;
+  }; //class ZstdOutputFile;
+
+  class ZstdInputFile
+  {
+  public:
+    ZstdInputFile()
+      : m_dctx(NULL),
+	m_inPos(0),
+	m_inSize(0),
+	m_noMoreInput(0),
+	m_frameEnd(0) {}
+
+    virtual ~ZstdInputFile()
+    {
+      close();
+    }
+
+  public:
+    void open(const std::string& fileName);
+    //The method below returns less data than requested block size in case of end of file;
+    size_t read(void* buf, size_t bufSize);
+    void close();
+
+  private:
+    File m_file;
+    void* m_dctx;
+    std::vector<char> m_inBuf;
+    size_t m_inPos, m_inSize;
+    bool m_noMoreInput, m_frameEnd;
+    std::string m_fileName;
+  }; //class ZstdInputFile;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_ZSTD_INTERFACE_H;
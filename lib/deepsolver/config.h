@@ -23,12 +23,21 @@
 #define DEFAULT_CONFIG_DIR_NAME "/etc/deepsolver/conf.d"
 #define CONF_DEFAULT_PKG_DATA "/var/lib/deepsolver/pkg-data"
 #define CONF_DEFAULT_PKG_CACHE "/var/lib/deepsolver/pkg-cache"
+#define CONF_DEFAULT_SAT_SOLVER "minisat"
+#define CONF_DEFAULT_EXPLAIN_MINIMIZE 16
+#define SAT_SOLVER_PORTFOLIO "portfolio"
 #define PKG_DATA_FILE_NAME "pkgs-data.bin"
 #define PKG_URLS_FILE_NAME "pkgs-urls.txt"
 #define PKG_DATA_FETCH_DIR "__tmp_pkg_data"
+#define PKG_SOLUTION_CACHE_DIR "solutions"
+#define SOLUTION_CACHE_MAX_ENTRIES 64
 
 //Data files and directories;
 #define COMPRESSION_SUFFIX_GZIP ".gz"
+#define COMPRESSION_SUFFIX_ZSTD ".zst"
+#define GZIP_PARALLEL_BLOCK_SIZE 1048576
+#define ZSTD_COMPRESSION_LEVEL 9
+#define PROVIDES_FILTER_BUFFER_SIZE 268435456
 
 //Repo structure;
 #define REPO_INDEX_DIR "base"
@@ -43,7 +52,11 @@
 #define REPO_INDEX_SOURCES_FILE "srpms.data"
 #define REPO_INDEX_SOURCES_DESCR_FILE "srpms.descr.data"
 #define REPO_INDEX_PACKAGES_COMPLETE_FILE ".rpms.complete.data"
+#define REPO_INDEX_PACKAGES_SNAPSHOT_FILE "rpms.bin"
 #define REPO_INDEX_MD5SUM_FILE "md5sum.txt"
+#define REPO_REFS_CACHE_FILE ".refs.cache"//Followed by the checksum of the source path;
+#define REPO_INDEX_MANIFEST_FILE ".manifest"
+#define REGEXP_RESULTS_MAX_ENTRIES 65536
 
 //Info file;
 #define INFO_FILE_FORMAT_TYPE "format_type"
@@ -52,6 +65,7 @@
 #define INFO_FILE_COMPRESSION_TYPE "compression_type"
 #define INFO_FILE_COMPRESSION_TYPE_NONE "none"
 #define INFO_FILE_COMPRESSION_TYPE_GZIP "gzip"
+#define INFO_FILE_COMPRESSION_TYPE_ZSTD "zstd"
 #define INFO_FILE_VERSION "version"
 #define INFO_FILE_MD5SUM "md5sum_file"
 #define INFO_FILE_FILTER_PROVIDES_BY_DIRS "filter_provides_by_dirs"
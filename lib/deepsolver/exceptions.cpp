@@ -43,6 +43,7 @@ const ConfigException::Descr ConfigException::m_descr[] = {
   {InvalidIntValue, "an invalid integer value"},
   {InvalidUIntValue, "an invalid unsigned integer value"},
   {InvalidUrl, "an invalid URL"},
+  {UnknownSatSolver, "an unknown SAT solver"},
   {-1, NULL}
 };
 
@@ -73,9 +74,15 @@ std::string TaskException::getMessage() const
     case Contradiction:
       return "the task requires \'" + m_param + "\' to be installed and removed simultaneously";
     case UnsolvableSat:
-      return "the task has no solutions";
+      if (m_param.empty())
+	return "the task has no solutions";
+      return "the task has no solutions:\n" + m_param;
     case Unmet:
       return "no packages matching the require entry:" + m_param;
+    case LimitExceeded:
+      return "the solving limit is exceeded: " + m_param;
+    case Cancelled:
+      return "the solving is cancelled: " + m_param;
     default:
       assert(0);
       return "";//Just to reduce warning 
@@ -114,6 +121,12 @@ std::string IndexCoreException::getMessage() const
       return "file \'" + m_param + "\' is corrupted (wrong checksum)";
     case MissedChecksumFileName:
       return "the repository info file has no entry with checksum file name or it is empty";
+    case MissedManifest:
+      return "directory \'" + m_param + "\' is not empty and has no index manifest to be updated incrementally";
+    case InvalidManifest:
+      return "index manifest \'" + m_param + "\' is corrupted";
+    case ParamsMismatch:
+      return "the index in \'" + m_param + "\' was built with different parameters, it must be rebuilt from scratch";
     default:
       assert(0);
     } //switch(m_code);
@@ -180,6 +193,11 @@ std::string GzipException::getMessage() const
   return m_msg;
 }
 
+std::string ZstdException::getMessage() const
+{
+  return m_msg;
+}
+
 std::string CurlException::getMessage() const
 {
   return m_url + ":" + m_descr;
@@ -34,6 +34,7 @@ namespace Deepsolver
   class InfoFileSyntaxException;
   class InfoFileValueException;
   class GzipException;
+  class ZstdException;
   class CurlException;
   class RegExpException;
   class Md5FileException;
@@ -122,6 +123,12 @@ namespace Deepsolver
      */
     virtual void visit(const GzipException& e) {}
 
+    /**\brief The action for Zstandard compression/decompression errors
+     *
+     * \param [in] e The reference to the exception object
+     */
+    virtual void visit(const ZstdException& e) {}
+
     /**\brief The action for downloading errors
      *
      * \param [in] e The reference to the exception object
@@ -408,8 +415,10 @@ namespace Deepsolver
     enum {
       UnknownPkg, //the parameter contains name of the unknown package;
       Contradiction, //the parameter contains full package designation which is considered to install and remove simultaneously;
-      UnsolvableSat, //SAT equation has no solution, parameter is empty;
+      UnsolvableSat, //SAT equation has no solution, the parameter contains the contradicting relations one per line, if they are found;
       Unmet, //the parameter contains the package caused the problem and the its unsatisfied require entry;
+      LimitExceeded, //the time or conflict limit is exceeded, the parameter contains the description of the reached stage;
+      Cancelled, //the solving is cancelled by the continue request, the parameter contains the description of the reached stage;
 CodeCount
     };
 
@@ -560,6 +569,9 @@ CodeCount
       DirectoryNotEmpty,
       CorruptedFile,
       MissedChecksumFileName,
+      MissedManifest,
+      InvalidManifest,
+      ParamsMismatch,
       CodeCount
     };
 
@@ -785,6 +797,7 @@ CodeCount
       InvalidIntValue,
       InvalidUIntValue,
       InvalidUrl,
+      UnknownSatSolver,
 CodeCount
     };
 
@@ -1131,6 +1144,42 @@ CodeCount
     const std::string m_msg;
   }; //class GzipException;
 
+  /**\brief The exception for errors of Zstandard handling code
+   *
+   * This class brings information about the errors raised in Zstandard
+   * wrapper. Like GzipException it provides only single-line
+   * description.
+   */
+  class ZstdException: public AbstractException
+  {
+  public:
+    /**\brief The constructor
+     *
+     * \param [in] message An error description
+     */
+    ZstdException(const std::string& msg)
+      : m_msg(msg) {}
+
+    /**\brief The destructor*/
+    virtual ~ZstdException() {}
+
+  public://AbstractException;
+    std::string getMessage() const;
+
+    std::string getType() const
+    {
+      return "zstd";
+    }
+
+    void accept(ExceptionVisitor& visitor) const
+    {
+      visitor.visit(*this);
+    }
+
+  private:
+    const std::string m_msg;
+  }; //class ZstdException;
+
   /**\brief The exception class for libcurl errors
    *
    * This class is used for notifications about the errors occurred during
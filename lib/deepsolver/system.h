@@ -28,13 +28,22 @@
 #include<string>
 #include<vector>
 #include<list>
+#include<deque>
 #include<set>
 #include<map>
+#include<unordered_map>
+#include<unordered_set>
 #include<sstream>
+#include<iomanip>
 #include<fstream>
 #include<iostream>
 #include<algorithm>
 #include<memory>
+#include<atomic>
+#include<mutex>
+#include<condition_variable>
+#include<thread>
+#include<chrono>
 
 #include<sys/types.h>
 #include<unistd.h>
@@ -52,6 +61,7 @@
 #include<sys/un.h>
 #include<pthread.h>
 #include<fcntl.h>
+#include<sys/mman.h>
 #include<iconv.h>
 #include<locale.h>
 #include<time.h>
@@ -63,6 +73,7 @@ typedef std::vector<const char*> ConstCharStarVector;
 typedef std::vector<std::string> StringVector;
 typedef std::list<std::string> StringList;
 typedef std::set<std::string> StringSet;
+typedef std::unordered_set<std::string> StringHashSet;
 typedef std::map<std::string, std::string> StringToStringMap;
 typedef std::vector<const char*> ConstCharVector;
 
@@ -60,6 +60,58 @@ namespace Deepsolver
   typedef std::set<VarId> VarIdSet;
   typedef std::map<VarId, VarId> VarIdToVarIdMap;
 
+  /**\brief The read-only range of VarId values kept in some other storage
+   *
+   * The span doesn't own the values and remains valid only until the
+   * storage it points to is modified or destroyed.
+   */
+  class VarIdSpan
+  {
+  public:
+    typedef const VarId* const_iterator;
+    typedef size_t size_type;
+
+  public:
+    VarIdSpan()
+      : m_begin(NULL),
+	m_end(NULL) {}
+
+    VarIdSpan(const VarId* b, const VarId* e)
+      : m_begin(b),
+	m_end(e) {}
+
+  public:
+    const_iterator begin() const
+    {
+      return m_begin;
+    }
+
+    const_iterator end() const
+    {
+      return m_end;
+    }
+
+    size_type size() const
+    {
+      return m_end - m_begin;
+    }
+
+    bool empty() const
+    {
+      return m_begin == m_end;
+    }
+
+    VarId operator [](size_type index) const
+    {
+      assert(index < size());
+      return m_begin[index];
+    }
+
+  private:
+    const VarId* m_begin;
+    const VarId* m_end;
+  }; //class VarIdSpan;
+
   typedef char VerDirection;
   typedef unsigned short Epoch;
 
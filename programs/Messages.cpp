@@ -83,6 +83,7 @@ void Messages::dsInstallInitCliParser(CliParser& cliParser) const
   cliParser.addKeyDoubleName("-u", "--urls", "print URLs of packages for installation and do nothing");
   cliParser.addKeyDoubleName("-f", "--files", "fetch packages and print file names");
   cliParser.addKeyDoubleName("-s", "--sat", "print SAT equation and do not touch any packages");
+  cliParser.addKey("--dimacs", "FILE", "save SAT equation in DIMACS format to FILE, variables designations to FILE.vars, and do not touch any packages");
   cliParser.addKeyDoubleName("-h", "--help", "print this help screen and exit");
   cliParser.addKey("--log", "print log to console instead of user progress information");
   cliParser.addKey("--debug", "relax filtering level for log output");
@@ -112,6 +113,7 @@ void Messages::dsRemoveInitCliParser(CliParser& cliParser) const
   cliParser.addKeyDoubleName("-u", "--urls", "print URLs of packages for installation and do nothing");
   cliParser.addKeyDoubleName("-f", "--files", "fetch packages and print file names");
   cliParser.addKeyDoubleName("-s", "--sat", "print SAT equation and do not touch any packages");
+  cliParser.addKey("--dimacs", "FILE", "save SAT equation in DIMACS format to FILE, variables designations to FILE.vars, and do not touch any packages");
   cliParser.addKeyDoubleName("-h", "--help", "print this help screen and exit");
   cliParser.addKey("--log", "print log to console instead of user progress information");
   cliParser.addKey("--debug", "relax filtering level for log output");
@@ -151,9 +151,24 @@ int doMainWork()
       Messages(std::cerr).onNoPkgMentionedError();
       return EXIT_FAILURE;
     }
+  std::string dimacsFileName;
+  if (cliParser.isKeyUsed("--dimacs", dimacsFileName))
+    {
+      std::ostringstream dimacs, varsMap;
+      core.generateDimacs(transactionProgress, userTask, dimacs, varsMap);
+      File f;
+      f.create(dimacsFileName);
+      f.write(dimacs.str().c_str(), dimacs.str().length());
+      f.close();
+      f.create(dimacsFileName + ".vars");
+      f.write(varsMap.str().c_str(), varsMap.str().length());
+      f.close();
+      return EXIT_SUCCESS;
+    }
   if (!cliParser.isKeyUsed("--sat"))
     {
-      TransactionIterator::Ptr it = core.transaction(transactionProgress, userTask);
+      AlwaysTrueContinueRequest continueRequest;
+      TransactionIterator::Ptr it = core.transaction(transactionProgress, continueRequest, userTask);
       if (cliParser.isKeyUsed("--urls"))
 	{
 	  printUrls(*it.get());
@@ -168,7 +183,6 @@ int doMainWork()
 	  return 0;
       std::cout << std::endl;
       FilesFetchProgress progress(std::cout, cliParser.isKeyUsed("--log"));
-      AlwaysTrueContinueRequest continueRequest;
       it->fetchPackages(progress, continueRequest);
       if (cliParser.isKeyUsed("--files"))
 	{
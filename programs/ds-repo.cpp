@@ -115,6 +115,21 @@ char selectCompressionType(const std::string& value)
     return RepoParams::CompressionTypeNone;
   if (value == "gzip")
     return RepoParams::CompressionTypeGzip;
+#ifdef HAVE_ZSTD
+  if (value == "zstd")
+    return RepoParams::CompressionTypeZstd;
+#endif //HAVE_ZSTD;
+  return -1;
+}
+
+char selectChecksumType(const std::string& value)
+{
+  if (value == "md5")
+    return AbstractChecksum::TypeMd5;
+  if (value == "sha256")
+    return AbstractChecksum::TypeSha256;
+  if (value == "xxh64")
+    return AbstractChecksum::TypeXxh64;
   return -1;
 }
 
@@ -152,6 +167,8 @@ bool processUserParam(const std::string& s)
 void initCliParser()
 {
   cliParser.addKeyDoubleName("-c", "--compression", "TYPE", "set compression method");
+  cliParser.addKeyDoubleName("-m", "--checksum", "TYPE", "set checksum algorithm: md5 (default), sha256 or xxh64");
+  cliParser.addKeyDoubleName("-j", "--jobs", "NUM", "use NUM threads for compression of each file (all processors by default)");
   cliParser.addKeyDoubleName("-lb", "--changelog-binary", "include changelog for binary packages");
   cliParser.addKeyDoubleName("-ls", "--changelog-source", "include changelog for source packages");
   cliParser.addKeyDoubleName("-u", "--user", "NAME=VALUE[:...]", "add custom user parameters to information file");
@@ -160,6 +177,7 @@ void initCliParser()
   cliParser.addKeyDoubleName("-d", "--dirs", "LIST", "write only file provides  from listed directories (list should be colon-delimited)");
   cliParser.addKeyDoubleName("-ep", "--external-provides", "FILENAME", "read from FILENAME list of provides not to exclude from index, must be used in conjunction with  \'-r\'");
   cliParser.addKeyDoubleName("-nr", "--no-requires", "FILENAME", "skip requires listed by regexp in FILENAME");
+  cliParser.addKeyDoubleName("-i", "--incremental", "update existing index reading only new and changed packages");
   cliParser.addKeyDoubleName("-h", "--help", "print this help screen and exit");
   cliParser.addKey("--log", "print log to console instead of user progress information");
   cliParser.addKey("--debug", "relax filtering level for log output");
@@ -182,6 +200,7 @@ void printHelp()
 	 "Valid command line options are:\n");
   cliParser.printHelp(std::cout);
   printf("\nIf PACKAGES_DIR1 is not specified current directory is used to search packages.\n");
+  printf("With --incremental the index must be created with the same options, the empty INDEX_DIR is filled as usual.\n");
 }
 
 void parseCmdLine(int argc, char* argv[])
@@ -205,6 +224,27 @@ void parseCmdLine(int argc, char* argv[])
 	  exit(EXIT_FAILURE);
 	}
     }
+  if (cliParser.isKeyUsed("--checksum", arg))
+    {
+      params.checksumType = selectChecksumType(arg);
+      if (params.checksumType == -1)
+	{
+	  std::cerr << PREFIX << "unknown checksum type \'" << arg << "\'" << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+    }
+  params.compressionThreads = std::thread::hardware_concurrency();
+  if (cliParser.isKeyUsed("--jobs", arg))
+    {
+      char* end = NULL;
+      const unsigned long value = strtoul(arg.c_str(), &end, 10);
+      if (arg.empty() || *end != '\0')
+	{
+	  std::cerr << PREFIX << "invalid number of threads \'" << arg << "\'" << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+      params.compressionThreads = value;
+    }
   params.changeLogBinary = cliParser.isKeyUsed("--changelog-binary");
   params.changeLogSources = cliParser.isKeyUsed("--changelog-source");
   if (cliParser.isKeyUsed("--user", arg))
@@ -285,7 +325,9 @@ int main(int argc, char* argv[])
       }
     IndexConstructionListener listener(cliParser.isKeyUsed("--log") || cliParser.isKeyUsed("--quiet"));
     IndexCore indexCore(listener);
-    indexCore.buildIndex(params);
+    if (cliParser.isKeyUsed("--incremental"))
+      indexCore.updateIndex(params); else
+      indexCore.buildIndex(params);
   }
   catch(const AbstractException& e)
     {
@@ -0,0 +1,198 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/PkgSection.h"
+#include"deepsolver/GzipInterface.h"
+#include"SyntheticRepo.h"
+
+DEEPSOLVER_BEGIN_NAMESPACE
+
+void SyntheticRepo::generate(PkgFileVector& pkgs, PkgVector& installed)
+{
+  pkgs.clear();
+  installed.clear();
+  const size_t pkgCount = m_params.pkgCount;
+  const size_t versionCount = m_params.versionCount > 0?m_params.versionCount:1;
+  //Choosing providers for virtual names;
+  std::vector<SizeVector> virtualsOfPkg(pkgCount), providersOfVirtual(m_params.virtualCount);
+  if (pkgCount > 0)
+    for(size_t i = 0;i < m_params.virtualCount;++i)
+      for(size_t k = 0;k < m_params.providersPerVirtual;++k)
+	{
+	  const size_t p = rand(pkgCount);
+	  if (std::find(providersOfVirtual[i].begin(), providersOfVirtual[i].end(), p) != providersOfVirtual[i].end())
+	    continue;
+	  providersOfVirtual[i].push_back(p);
+	  virtualsOfPkg[p].push_back(i);
+	}
+  //The packages, which the oldest version of each package depends on, used for installed set closure;
+  std::vector<SizeVector> oldestDeps(pkgCount);
+  for(size_t i = 0;i < pkgCount;++i)
+    for(size_t j = 0;j < versionCount;++j)
+      {
+	PkgFile pkg;
+	pkg.name = pkgName(i);
+	pkg.epoch = 0;
+	pkg.version = versionStr(j);
+	pkg.release = "alt1";
+	pkg.arch = "x86_64";
+	pkg.buildTime = 1300000000 + (time_t)j * 86400 + (time_t)i;
+	pkg.fileName = pkg.name + "-" + pkg.version + "-" + pkg.release + "." + pkg.arch + ".rpm";
+	pkg.isSource = 0;
+	for(size_t k = 0;k < virtualsOfPkg[i].size();++k)
+	  pkg.provides.push_back(NamedPkgRel(virtualName(virtualsOfPkg[i][k])));
+	for(size_t k = 0;k < m_params.filesPerPkg;++k)
+	  pkg.fileList.push_back(fileName(i, k));
+	//Requires may reference only packages with smaller numbers;
+	const size_t requiresCount = i > 0?rand(m_params.requiresPerPkg + 1):0;
+	for(size_t k = 0;k < requiresCount;++k)
+	  {
+	    if (m_params.virtualCount > 0 && chance(m_params.virtualRequirePercents))
+	      {
+		const size_t v = rand(m_params.virtualCount);
+		if (providersOfVirtual[v].empty())
+		  continue;
+		pkg.requires.push_back(NamedPkgRel(virtualName(v)));
+		if (j == 0)
+		  oldestDeps[i].push_back(providersOfVirtual[v].front());
+		continue;
+	      }
+	    const size_t target = rand(i);
+	    if (m_params.filesPerPkg > 0 && chance(m_params.fileRequirePercents))
+	      pkg.requires.push_back(NamedPkgRel(fileName(target, rand(m_params.filesPerPkg)))); else
+	      {
+		//The version restriction never exceeds own version number, so the oldest versions are always consistent;
+		const size_t minVer = rand(j + 1);
+		if (minVer > 0)
+		  pkg.requires.push_back(NamedPkgRel(pkgName(target), VerGreater | VerEquals, versionStr(minVer))); else
+		  pkg.requires.push_back(NamedPkgRel(pkgName(target)));
+	      }
+	    if (j == 0)
+	      oldestDeps[i].push_back(target);
+	  }
+	//Only newer versions have conflicts, making an upgrade of the neighbours necessary;
+	if (j > 0 && pkgCount > 1 && chance(m_params.conflictPercents))
+	  {
+	    const size_t target = rand(pkgCount);
+	    if (target != i)
+	      pkg.conflicts.push_back(NamedPkgRel(pkgName(target), VerLess, versionStr(j)));
+	  }
+	pkgs.push_back(pkg);
+      }
+  //Installed set must be closed by requires;
+  std::vector<bool> isInstalled(pkgCount, 0);
+  SizeVector queue;
+  for(size_t i = 0;i < pkgCount;++i)
+    if (chance(m_params.installedPercents))
+      {
+	isInstalled[i] = 1;
+	queue.push_back(i);
+      }
+  while(!queue.empty())
+    {
+      const size_t i = queue.back();
+      queue.pop_back();
+      for(size_t k = 0;k < oldestDeps[i].size();++k)
+	if (!isInstalled[oldestDeps[i][k]])
+	  {
+	    isInstalled[oldestDeps[i][k]] = 1;
+	    queue.push_back(oldestDeps[i][k]);
+	  }
+    }
+  for(size_t i = 0;i < pkgCount;++i)
+    if (isInstalled[i])
+      {
+	const PkgFile& pkgFile = pkgs[i * versionCount];
+	Pkg pkg;
+	static_cast<PkgBase&>(pkg) = pkgFile;
+	static_cast<PkgRelations&>(pkg) = pkgFile;
+	installed.push_back(pkg);
+      }
+}
+
+void SyntheticRepo::savePkgList(const PkgFileVector& pkgs,
+				const std::string& fileName,
+				bool gzip)
+{
+  const StringVector noDirs;
+  if (gzip)
+    {
+      GzipOutputFile f;
+      f.open(fileName);
+      for(PkgFileVector::size_type i = 0;i < pkgs.size();++i)
+	{
+	  const std::string s = PkgSection::saveBaseInfo(pkgs[i], noDirs);
+	  f.write(s.c_str(), s.length());
+	}
+      f.close();
+      return;
+    }
+  File f;
+  f.create(fileName);
+  for(PkgFileVector::size_type i = 0;i < pkgs.size();++i)
+    {
+      const std::string s = PkgSection::saveBaseInfo(pkgs[i], noDirs);
+      f.write(s.c_str(), s.length());
+    }
+  f.close();
+}
+
+std::string SyntheticRepo::pkgName(size_t index)
+{
+  std::ostringstream ss;
+  ss << "synth-pkg" << index;
+  return ss.str();
+}
+
+std::string SyntheticRepo::virtualName(size_t index)
+{
+  std::ostringstream ss;
+  ss << "synth-virtual" << index;
+  return ss.str();
+}
+
+std::string SyntheticRepo::fileName(size_t pkgIndex, size_t fileIndex)
+{
+  std::ostringstream ss;
+  ss << "/usr/lib/synth/libsynth" << pkgIndex << ".so." << fileIndex;
+  return ss.str();
+}
+
+std::string SyntheticRepo::versionStr(size_t index)
+{
+  std::ostringstream ss;
+  ss << "1." << index;
+  return ss.str();
+}
+
+size_t SyntheticRepo::rand(size_t upperBound)
+{
+  assert(upperBound > 0);
+  //xorshift32, the results must not depend on the platform C library;
+  m_randState ^= m_randState << 13;
+  m_randState ^= m_randState >> 17;
+  m_randState ^= m_randState << 5;
+  return (size_t)m_randState % upperBound;
+}
+
+bool SyntheticRepo::chance(size_t percents)
+{
+  return rand(100) < percents;
+}
+
+DEEPSOLVER_END_NAMESPACE
@@ -0,0 +1,128 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#ifndef DEEPSOLVER_SYNTHETIC_REPO_H
+#define DEEPSOLVER_SYNTHETIC_REPO_H
+
+namespace Deepsolver
+{
+  /**\brief The parameters of synthetic package universe
+   *
+   * Every value here affects the shape of generated repository. Packages
+   * are named with consecutive numbers and can require only the packages
+   * with smaller numbers, so the dependency graph has no cycles and its
+   * depth grows with the package count. All random choices are made with
+   * the generator initialized by the seed value, therefore the same
+   * parameters always produce the same universe.
+   */
+  struct SyntheticRepoParams
+  {
+    SyntheticRepoParams()
+      : pkgCount(5000),
+	versionCount(3),
+	requiresPerPkg(4),
+	virtualCount(200),
+	providersPerVirtual(5),
+	virtualRequirePercents(20),
+	filesPerPkg(3),
+	fileRequirePercents(10),
+	conflictPercents(2),
+	installedPercents(40),
+	seed(1) {}
+
+    size_t pkgCount;//Number of distinct package names;
+    size_t versionCount;//Number of versions in chain for each package name;
+    size_t requiresPerPkg;//Maximum number of requires in each package;
+    size_t virtualCount;//Number of virtual provides;
+    size_t providersPerVirtual;//Number of packages providing each virtual name;
+    size_t virtualRequirePercents;//Probability of a require to reference virtual name instead of real package;
+    size_t filesPerPkg;//Number of files provided by each package;
+    size_t fileRequirePercents;//Probability of a require to reference a file instead of real package;
+    size_t conflictPercents;//Probability of a package to have a conflict;
+    size_t installedPercents;//Fraction of package names considered as installed in the oldest version;
+    unsigned int seed;
+  }; //struct SyntheticRepoParams;
+
+  /**\brief Generates synthetic package universes for benchmarking
+   *
+   * This class constructs realistic enough package sets without any RPM
+   * files and without any network access. Generated packages have version
+   * chains, requires with version restrictions, virtual provides with
+   * configurable fan-out, file provides and conflicts. Installed packages
+   * are generated as well, they are always the oldest versions of
+   * the chosen names, so that upgrade tasks have something to do.
+   *
+   * \sa SyntheticRepoParams
+   */
+  class SyntheticRepo
+  {
+  public:
+    /**\brief The constructor
+     *
+     * \param [in] params The parameters of universe to generate
+     */
+    SyntheticRepo(const SyntheticRepoParams& params)
+      : m_params(params),
+	m_randState(params.seed != 0?params.seed:1) {}
+
+    /**\brief The destructor*/
+    virtual ~SyntheticRepo() {}
+
+  public:
+    /**\brief Generates the universe
+     *
+     * \param [out] pkgs The list of all available packages
+     * \param [out] installed The list of packages considered as installed
+     */
+    void generate(PkgFileVector& pkgs, PkgVector& installed);
+
+    /**\brief Saves packages as a pkglist index file
+     *
+     * The file is written with the same format as main packages file
+     * of the repository index, optionally compressed by gzip.
+     *
+     * \param [in] pkgs The packages to save
+     * \param [in] fileName The name of the file to write to
+     * \param [in] gzip Compress the content with gzip or not
+     */
+    static void savePkgList(const PkgFileVector& pkgs,
+			    const std::string& fileName,
+			    bool gzip);
+
+    /**\brief Returns the name of the package with the given number*/
+    static std::string pkgName(size_t index);
+
+    /**\brief Returns the name of the virtual provide with the given number*/
+    static std::string virtualName(size_t index);
+
+    /**\brief Returns the name of the file provided by the package with the given number*/
+    static std::string fileName(size_t pkgIndex, size_t fileIndex);
+
+    /**\brief Returns the version string of the given item of version chain*/
+    static std::string versionStr(size_t index);
+
+  private:
+    size_t rand(size_t upperBound);
+    bool chance(size_t percents);
+
+  private:
+    const SyntheticRepoParams m_params;
+    uint32_t m_randState;
+  }; //class SyntheticRepo;
+} //namespace Deepsolver;
+
+#endif //DEEPSOLVER_SYNTHETIC_REPO_H;
@@ -0,0 +1,452 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/AbstractPkgBackEnd.h"
+#include"deepsolver/AbstractTaskSolver.h"
+#include"deepsolver/PkgSnapshot.h"
+#include"deepsolver/PkgSection.h"
+#include"deepsolver/PkgScope.h"
+#include"deepsolver/TextFormatSectionReader.h"
+#include"deepsolver/AutoReleaseStrings.h"
+#include"SyntheticRepo.h"
+
+#include<iomanip>
+
+using namespace Deepsolver;
+
+class BenchmarkProvidePriority: public Solver::AbstractProvidePriority
+{
+public:
+  BenchmarkProvidePriority() {}
+  virtual ~BenchmarkProvidePriority() {}
+
+public:
+  VarId byProvidesPriorityList(const VarIdVector& vars, PkgId provideEntry) const
+  {
+    return BadVarId;
+  }
+}; //class BenchmarkProvidePriority;
+
+struct BenchmarkSolverParams
+{
+  BenchmarkSolverParams()
+    : satSolver(CONF_DEFAULT_SAT_SOLVER),
+      timeLimit(0),
+      conflictLimit(0),
+      preprocess(1),
+      parallelComponents(0),
+      buildThreads(1),
+      optimize(0),
+      explain(1) {}
+
+  std::string satSolver;
+  size_t timeLimit;
+  size_t conflictLimit;
+  bool preprocess;
+  bool parallelComponents;
+  size_t buildThreads;
+  bool optimize;
+  bool explain;
+}; //struct BenchmarkSolverParams;
+
+class Stopwatch
+{
+public:
+  Stopwatch()
+    : m_started(std::chrono::steady_clock::now()) {}
+
+public:
+  //The wall time, since the CPU time of parallel stages is summed over all threads;
+  void report(const std::string& stage)
+  {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::cout << stage << ": " << std::fixed << std::setprecision(3) << std::chrono::duration<double>(now - m_started).count() << " sec" << std::endl;
+    m_started = std::chrono::steady_clock::now();
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_started;
+}; //class Stopwatch;
+
+void splitSectionLines(const std::string& sect, StringVector& lines)
+{
+  lines.clear();
+  std::string line;
+  for(std::string::size_type i = 0;i < sect.length();i++)
+    {
+      if (sect[i] == '\n')
+	{
+	  line = trim(line);
+	  if (!line.empty())
+	    lines.push_back(line);
+	  line.erase();
+	  continue;
+	}
+      line += sect[i];
+    }
+  line = trim(line);
+  if (!line.empty())
+    lines.push_back(line);
+}
+
+size_t parsePkgList(AbstractTextFormatSectionReader& reader, AbstractPkgRecipient& recipient)
+{
+  size_t count = 0;
+  size_t invalidLineNum;
+  std::string invalidLineValue;
+  std::string sect;
+  StringVector lines;
+  reader.init();
+  while(reader.readNext(sect))
+    {
+      PkgFile pkgFile;
+      splitSectionLines(sect, lines);
+      if (!PkgSection::parsePkgFileSection(lines, pkgFile, invalidLineNum, invalidLineValue))
+	throw OperationCoreException(OperationCoreException::BrokenIndexFile);
+      recipient.onNewPkgFile(pkgFile);
+      count++;
+    }
+  reader.close();
+  return count;
+}
+
+void markInstalled(PkgSnapshot::Snapshot& snapshot,
+		   const PkgVector& installed,
+		   ConstCharVector& strings)
+{
+  PkgSnapshot::removeEqualPkgs(snapshot);
+  PkgVector toEnhanceWith;
+  for(PkgVector::size_type i = 0;i < installed.size();++i)
+    {
+      const PkgId pkgId = PkgSnapshot::strToPkgId(snapshot, installed[i].name);
+      if (pkgId == BadPkgId)
+	{
+	  toEnhanceWith.push_back(installed[i]);
+	  continue;
+	}
+      VarId fromVarId, toVarId;
+      PkgSnapshot::locateRange(snapshot, pkgId, fromVarId, toVarId);
+      bool found = 0;
+      for(VarId varId = fromVarId;varId < toVarId;varId++)
+	if (PkgSnapshot::theSameVersion(installed[i], snapshot.pkgs[varId]))
+	  {
+	    snapshot.pkgs[varId].flags |= PkgFlagInstalled;
+	    found = 1;
+	  }
+      if (!found)
+	toEnhanceWith.push_back(installed[i]);
+    }
+  PkgSnapshot::enhance(snapshot, toEnhanceWith, PkgFlagInstalled, strings);
+}
+
+void runTask(const std::string& title,
+	     const AbstractTaskSolver& solver,
+	     const UserTask& task)
+{
+  Stopwatch stopwatch;
+  VarIdVector install, remove;
+  try {
+    solver.solve(task, install, remove);
+  }
+  catch(const TaskException& e)
+    {
+      std::cout << title << ": task error: " << e.getMessage() << std::endl;
+    }
+  std::ostringstream ss;
+  ss << title << " (" << install.size() << " to install, " << remove.size() << " to remove)";
+  stopwatch.report(ss.str());
+}
+
+//Only SAT construction, measured through the DIMACS output to the memory;
+void runConstruction(const std::string& title,
+		     const AbstractTaskSolver& solver,
+		     const UserTask& task)
+{
+  Stopwatch stopwatch;
+  std::ostringstream dimacs, varsMap;
+  try {
+    solver.dumpDimacs(task, dimacs, varsMap);
+  }
+  catch(const TaskException& e)
+    {
+      std::cout << title << ": task error: " << e.getMessage() << std::endl;
+    }
+  std::ostringstream ss;
+  ss << title << " (" << dimacs.str().length() << " bytes of DIMACS)";
+  stopwatch.report(ss.str());
+}
+
+bool parseArg(const std::string& arg,
+	      SyntheticRepoParams& params,
+	      std::string& dir,
+	      BenchmarkSolverParams& solverParams)
+{
+  const std::string::size_type pos = arg.find('=');
+  if (pos == std::string::npos)
+    return 0;
+  const std::string name = arg.substr(0, pos);
+  const std::string value = arg.substr(pos + 1);
+  if (name == "dir")
+    {
+      dir = value;
+      return 1;
+    }
+  if (name == "solver")
+    {
+      solverParams.satSolver = value;
+      return !value.empty();
+    }
+  char* end;
+  const unsigned long v = strtoul(value.c_str(), &end, 10);
+  if (value.empty() || *end != '\0')
+    return 0;
+  if (name == "time-limit")
+    {
+      solverParams.timeLimit = v;
+      return 1;
+    }
+  if (name == "conflict-limit")
+    {
+      solverParams.conflictLimit = v;
+      return 1;
+    }
+  if (name == "preprocess")
+    {
+      solverParams.preprocess = v != 0;
+      return 1;
+    }
+  if (name == "parallel-components")
+    {
+      solverParams.parallelComponents = v != 0;
+      return 1;
+    }
+  if (name == "build-threads")
+    {
+      solverParams.buildThreads = v;
+      return 1;
+    }
+  if (name == "optimize")
+    {
+      solverParams.optimize = v != 0;
+      return 1;
+    }
+  if (name == "explain")
+    {
+      solverParams.explain = v != 0;
+      return 1;
+    }
+  if (name == "pkgs")
+    params.pkgCount = v; else
+    if (name == "versions")
+      params.versionCount = v; else
+      if (name == "requires")
+	params.requiresPerPkg = v; else
+	if (name == "virtuals")
+	  params.virtualCount = v; else
+	  if (name == "providers")
+	    params.providersPerVirtual = v; else
+	    if (name == "virtual-requires")
+	      params.virtualRequirePercents = v; else
+	      if (name == "files")
+		params.filesPerPkg = v; else
+		if (name == "file-requires")
+		  params.fileRequirePercents = v; else
+		  if (name == "conflicts")
+		    params.conflictPercents = v; else
+		    if (name == "installed")
+		      params.installedPercents = v; else
+		      if (name == "seed")
+			params.seed = v; else
+			return 0;
+  return 1;
+}
+
+class Benchmark: private AutoReleaseStrings
+{
+public:
+  Benchmark(const SyntheticRepoParams& params,
+	    const std::string& dir,
+	    const BenchmarkSolverParams& solverParams)
+    : m_params(params),
+      m_dir(dir),
+      m_solverParams(solverParams) {}
+
+  virtual ~Benchmark() {}
+
+public:
+  int run();
+
+private:
+  const SyntheticRepoParams m_params;
+  const std::string m_dir;
+  const BenchmarkSolverParams m_solverParams;
+}; //class Benchmark;
+
+int Benchmark::run()
+{
+  AbstractPkgBackEnd::Ptr backend = CREATE_PKG_BACKEND;
+  backend->initialize();
+  Directory::ensureExists(m_dir);
+  const std::string pkgListFileName = Directory::mixNameComponents(m_dir, REPO_INDEX_PACKAGES_FILE);
+  const std::string pkgListGzipFileName = pkgListFileName + COMPRESSION_SUFFIX_GZIP;
+  const std::string componentFileName = Directory::mixNameComponents(m_dir, REPO_INDEX_PACKAGES_SNAPSHOT_FILE);
+  const std::string snapshotFileName = Directory::mixNameComponents(m_dir, PKG_DATA_FILE_NAME);
+  Stopwatch stopwatch;
+  PkgFileVector pkgs;
+  PkgVector installed;
+  SyntheticRepo repo(m_params);
+  repo.generate(pkgs, installed);
+  std::cout << "universe: " << pkgs.size() << " packages, " << installed.size() << " installed" << std::endl;
+  stopwatch.report("generation");
+  SyntheticRepo::savePkgList(pkgs, pkgListFileName, 0);
+  stopwatch.report("pkglist writing");
+  SyntheticRepo::savePkgList(pkgs, pkgListGzipFileName, 1);
+  stopwatch.report("pkglist writing (gzip)");
+  {
+    PkgSnapshot::Snapshot snapshot;
+    StringToPkgIdMap stringToPkgIdMap;
+    StringVector fileNames, arches;
+    for(PkgFileVector::size_type i = 0;i < pkgs.size();i++)
+      {
+	PkgSnapshot::addNewPkg(snapshot, pkgs[i], m_autoReleaseStrings, stringToPkgIdMap);
+	fileNames.push_back(pkgs[i].fileName);
+	arches.push_back(pkgs[i].arch);
+      }
+    PkgSnapshot::saveComponentToFile(snapshot, fileNames, arches, componentFileName);
+    stopwatch.report("component snapshot writing");
+  }
+  freeAutoReleaseStrings();
+  pkgs.clear();
+  {
+    PkgSnapshot::Snapshot snapshot;
+    StringToPkgIdMap stringToPkgIdMap;
+    PkgSnapshot::PkgRecipientAdapter adapter(snapshot, m_autoReleaseStrings, stringToPkgIdMap);
+    TextFormatSectionReader reader;
+    reader.open(pkgListFileName);
+    parsePkgList(reader, adapter);
+    PkgSnapshot::rearrangeNames(snapshot);
+    std::sort(snapshot.pkgs.begin(), snapshot.pkgs.end());
+    stopwatch.report("pkglist parsing");
+  }
+  freeAutoReleaseStrings();
+  {
+    PkgSnapshot::Snapshot snapshot;
+    StringToPkgIdMap stringToPkgIdMap;
+    PkgSnapshot::Component component;
+    if (!PkgSnapshot::loadComponentFromFile(component, componentFileName, m_autoReleaseStrings))
+      {
+	std::cerr << "benchmark:" << componentFileName << " is not a valid component snapshot" << std::endl;
+	return 1;
+      }
+    PkgSnapshot::addComponent(snapshot, component, m_autoReleaseStrings, stringToPkgIdMap);
+    PkgSnapshot::rearrangeNames(snapshot);
+    std::sort(snapshot.pkgs.begin(), snapshot.pkgs.end());
+    stopwatch.report("component snapshot loading");
+  }
+  freeAutoReleaseStrings();
+  PkgSnapshot::Snapshot snapshot;
+  {
+    StringToPkgIdMap stringToPkgIdMap;
+    PkgSnapshot::PkgRecipientAdapter adapter(snapshot, m_autoReleaseStrings, stringToPkgIdMap);
+    TextFormatSectionReaderGzip reader;
+    reader.open(pkgListGzipFileName);
+    parsePkgList(reader, adapter);
+    PkgSnapshot::rearrangeNames(snapshot);
+    std::sort(snapshot.pkgs.begin(), snapshot.pkgs.end());
+    stopwatch.report("pkglist parsing (gzip)");
+  }
+  PkgSnapshot::saveToFile(snapshot, snapshotFileName, m_autoReleaseStrings);
+  stopwatch.report("snapshot saving");
+  freeAutoReleaseStrings();
+  snapshot = PkgSnapshot::Snapshot();
+  PkgSnapshot::loadFromFile(snapshot, snapshotFileName, m_autoReleaseStrings);
+  std::cout << "snapshot: " << snapshot.pkgs.size() << " packages, " << snapshot.pkgNames.size() << " names, " << snapshot.relations.size() << " relations" << std::endl;
+  stopwatch.report("snapshot loading");
+  markInstalled(snapshot, installed, m_autoReleaseStrings);
+  stopwatch.report("installed packages marking");
+  PkgScope scope(*backend.get(), snapshot);
+  scope.initMetadata();
+  stopwatch.report("scope initialization");
+  BenchmarkProvidePriority providePriority;
+  TaskSolverData taskSolverData(*backend.get(), scope, providePriority);
+  taskSolverData.satSolver = m_solverParams.satSolver;
+  taskSolverData.timeLimit = m_solverParams.timeLimit;
+  taskSolverData.conflictLimit = m_solverParams.conflictLimit;
+  taskSolverData.satPreprocess = m_solverParams.preprocess;
+  taskSolverData.parallelComponents = m_solverParams.parallelComponents;
+  taskSolverData.buildThreads = m_solverParams.buildThreads;
+  taskSolverData.satOptimize = m_solverParams.optimize;
+  taskSolverData.satExplain = m_solverParams.explain;
+  taskSolverData.requireCache = Solver::RequireCache::Ptr(new Solver::RequireCache());
+  AbstractTaskSolver::Ptr solver = createTaskSolver(taskSolverData);
+  if (m_params.pkgCount == 0)
+    return EXIT_SUCCESS;
+  //The standard set of tasks;
+  UserTask task;
+  task.itemsToInstall.push_back(UserTaskItemToInstall(SyntheticRepo::pkgName(m_params.pkgCount - 1)));
+  runTask("task: install the topmost package", *solver.get(), task);
+  task = UserTask();
+  for(size_t i = 0;i < 10;++i)
+    task.itemsToInstall.push_back(UserTaskItemToInstall(SyntheticRepo::pkgName(m_params.pkgCount - 1 - (i * m_params.pkgCount / 10))));
+  runTask("task: install 10 packages", *solver.get(), task);
+  if (!installed.empty())
+    {
+      task = UserTask();
+      task.namesToRemove.insert(installed.front().name);
+      runTask("task: remove the basic installed package", *solver.get(), task);
+      task = UserTask();
+      for(PkgVector::size_type i = 0;i < installed.size();++i)
+	task.itemsToInstall.push_back(UserTaskItemToInstall(installed[i].name));
+      runConstruction("task: upgrade all installed packages, SAT construction only", *solver.get(), task);
+      runTask("task: upgrade all installed packages", *solver.get(), task);
+    }
+  std::cout << "require cache: " << taskSolverData.requireCache->size() << " relations, " << taskSolverData.requireCache->getHitCount() << " hits, " << taskSolverData.requireCache->getMissCount() << " misses" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+void printUsage()
+{
+  std::cerr << "Usage: benchmark [NAME=VALUE ...]" << std::endl;
+  std::cerr << "Available names: pkgs, versions, requires, virtuals, providers, virtual-requires," << std::endl;
+  std::cerr << "files, file-requires, conflicts, installed, seed, dir," << std::endl;
+  std::cerr << "solver, time-limit, conflict-limit, preprocess, parallel-components," << std::endl;
+  std::cerr << "build-threads, optimize, explain" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  initLogging(LOG_WARNING, 1);
+  SyntheticRepoParams params;
+  std::string dir = "benchmark-data";
+  BenchmarkSolverParams solverParams;
+  for(int i = 1;i < argc;++i)
+    if (!parseArg(argv[i], params, dir, solverParams))
+      {
+	printUsage();
+	return EXIT_FAILURE;
+      }
+  try {
+    Benchmark benchmark(params, dir, solverParams);
+    return benchmark.run();
+  }
+  catch(const AbstractException& e)
+    {
+      std::cerr << e.getType() << " error:" << e.getMessage() << std::endl;
+      return EXIT_FAILURE;
+    }
+}
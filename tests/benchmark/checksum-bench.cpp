@@ -0,0 +1,102 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/Md5.h"
+#include"deepsolver/Sha256.h"
+#include"deepsolver/Xxh64.h"
+
+#include<iomanip>
+
+using namespace Deepsolver;
+
+#define SYNTHETIC_SIZE (64 * 1048576)
+#define UPDATE_SIZE 65536
+
+static bool readData(const std::string& fileName, std::string& data)
+{
+  std::ifstream f(fileName.c_str(), std::ios::binary);
+  if (!f)
+    return 0;
+  std::ostringstream ss;
+  ss << f.rdbuf();
+  data = ss.str();
+  return 1;
+}
+
+static void generateData(std::string& data)
+{
+  data.resize(SYNTHETIC_SIZE);
+  unsigned int seed = 1;
+  for(std::string::size_type i = 0;i < data.size();++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      data[i] = (char)(seed >> 16);
+    }
+}
+
+static void measure(const std::string& title, AbstractChecksum& checksum, const std::string& data)
+{
+  const clock_t started = clock();
+  checksum.init();
+  //Updates go in blocks like in index writing;
+  for(std::string::size_type pos = 0;pos < data.size();pos += UPDATE_SIZE)
+    checksum.update(data.data() + pos, std::min<size_t>(UPDATE_SIZE, data.size() - pos));
+  const std::string value = checksum.commit();
+  const double duration = (double)(clock() - started) / CLOCKS_PER_SEC;
+  std::cout << "  " << std::setw(7) << std::left << title << std::right << std::fixed << std::setprecision(3) << duration << " sec";
+  if (duration > 0)
+    std::cout << ", " << std::setprecision(1) << (double)data.size() / 1048576 / duration << " MB/s";
+  std::cout << ", " << value << std::endl;
+}
+
+static void run(const std::string& title, const std::string& data)
+{
+  std::cout << title << ": " << data.size() << " bytes" << std::endl;
+  Md5 md5;
+  Sha256 sha256;
+  Xxh64 xxh64;
+  measure("md5", md5, data);
+  measure("sha256", sha256, data);
+  measure("xxh64", xxh64, data);
+}
+
+int main(int argc, char* argv[])
+{
+  initLogging(LOG_WARNING, 1);
+  std::cout << "SHA-256 implementation: " << Sha256::getImplName() << std::endl;
+  if (argc < 2)
+    {
+      std::string data;
+      generateData(data);
+      run("synthetic data", data);
+      return EXIT_SUCCESS;
+    }
+  bool allValid = 1;
+  for(int i = 1;i < argc;++i)
+    {
+      std::string data;
+      if (!readData(argv[i], data))
+	{
+	  std::cerr << argv[i] << ": unable to read the file" << std::endl;
+	  allValid = 0;
+	  continue;
+	}
+      run(argv[i], data);
+    }
+  return allValid?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/Sat.h"
+
+#include<iomanip>
+
+using namespace Deepsolver;
+using namespace Deepsolver::Sat;
+
+bool replay(const std::string& fileName, const std::string& solverName)
+{
+  std::ifstream f(fileName.c_str());
+  if (!f)
+    {
+      std::cerr << fileName << ": unable to open the file" << std::endl;
+      return 0;
+    }
+  Deepsolver::Sat::Sat sat;
+  if (!loadDimacs(f, sat))
+    {
+      std::cerr << fileName << ": invalid DIMACS content" << std::endl;
+      return 0;
+    }
+  if (sat.empty())
+    {
+      std::cout << fileName << ": empty equation, skipping" << std::endl;
+      return 1;
+    }
+  VarIdSet vars;
+  for(Deepsolver::Sat::Sat::size_type i = 0;i < sat.size();++i)
+    for(Clause::size_type k = 0;k < sat[i].size();++k)
+      vars.insert(sat[i][k].varId);
+  AbstractSatSolver::Ptr solver = solverName.empty()?createDefaultSatSolver():createSatSolver(solverName);
+  assert(solver);
+  //The wall time, since portfolio members work in parallel threads;
+  const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  for(Deepsolver::Sat::Sat::size_type i = 0;i < sat.size();++i)
+    solver->addClause(sat[i]);
+  AbstractSatSolver::VarIdToBoolMap res;
+  VarIdVector conflicts;
+  const bool solved = solver->solve(res, conflicts);
+  const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  std::cout << fileName << ": ";
+  if (!solverName.empty())
+    std::cout << solverName << ", ";
+  std::cout << vars.size() << " variables, " << sat.size() << " clauses, " << (solved?"SAT":"UNSAT") << ", " << std::fixed << std::setprecision(3) << duration << " sec";
+  SatStat stat;
+  if (solver->getStat(stat))
+    std::cout << ", " << stat.decisions << " decisions, " << stat.conflicts << " conflicts, " << stat.propagations << " propagations";
+  if (!solved)
+    std::cout << ", " << conflicts.size() << " highlighted collisions";
+  std::cout << std::endl;
+  return 1;
+}
+
+int main(int argc, char* argv[])
+{
+  initLogging(LOG_WARNING, 1);
+  std::string solverName;
+  int first = 1;
+  if (argc > 2 && std::string(argv[1]) == "--solver")
+    {
+      solverName = argv[2];
+      first = 3;
+      if (!createSatSolver(solverName))
+	{
+	  StringVector names;
+	  getSatSolverNames(names);
+	  std::cerr << solverName << ": unknown SAT solver, available are:";
+	  for(StringVector::size_type i = 0;i < names.size();++i)
+	    std::cerr << " " << names[i];
+	  std::cerr << std::endl;
+	  return EXIT_FAILURE;
+	}
+    }
+  if (argc <= first)
+    {
+      std::cerr << "Usage: sat-replay [--solver NAME[:SEED]] FILE1 [FILE2 [...]]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  bool allValid = 1;
+  try {
+    for(int i = first;i < argc;++i)
+      if (!replay(argv[i], solverName))
+	allValid = 0;
+  }
+  catch(const AbstractException& e)
+    {
+      std::cerr << e.getType() << " error:" << e.getMessage() << std::endl;
+      return EXIT_FAILURE;
+    }
+  return allValid?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/Sha256.h"
+#include"deepsolver/Xxh64.h"
+
+#define MILLION_SIZE 1000000
+
+using namespace Deepsolver;
+
+static bool check(const std::string& title,
+		  AbstractChecksum& checksum,
+		  const std::string& data,
+		  const std::string& expected)
+{
+  //The data goes in uneven pieces to pass through all buffering paths;
+  checksum.init();
+  size_t pos = 0, step = 1;
+  while(pos < data.length())
+    {
+      const size_t len = std::min(step, data.length() - pos);
+      checksum.update(data.c_str() + pos, len);
+      pos += len;
+      step = step * 3 + 1;
+    }
+  const std::string value = checksum.commit();
+  std::cout << title << ": " << value;
+  if (value != expected)
+    {
+      std::cout << " (expected " << expected << ")" << std::endl;
+      return 0;
+    }
+  std::cout << " OK" << std::endl;
+  return 1;
+}
+
+int main(int argc, char* argv[])
+{
+  Sha256 sha256;
+  Xxh64 xxh64;
+  std::cout << "SHA-256 implementation: " << Sha256::getImplName() << std::endl;
+  bool ok = 1;
+  ok = check("SHA-256 of \"abc\"", sha256, "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") && ok;
+  ok = check("SHA-256 of \"\"", sha256, "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855") && ok;
+  ok = check("SHA-256 of million of \'a\'", sha256, std::string(MILLION_SIZE, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0") && ok;
+  ok = check("XXH64 of \"\"", xxh64, "", "ef46db3751d8e999") && ok;
+  ok = check("XXH64 of \"abc\"", xxh64, "abc", "44bc2cf5ad770999") && ok;
+  return ok?0:1;
+}
@@ -0,0 +1,99 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/GzipInterface.h"
+
+#define TEST_THREAD_COUNT 4
+#define TEST_WRITE_SIZE 12345//Not aligned with the block size;
+
+#define ORIG_FILE_NAME "orig.data"
+#define COMPRESSED_FILE_NAME "compressed.data.gz"
+#define EMPTY_FILE_NAME "empty.data.gz"
+
+using namespace Deepsolver;
+
+void fillRandomData(std::string& data, size_t len)
+{
+  data.resize(len);
+  srand(len);
+  for(size_t i = 0;i < len;i++)
+    data[i] = (rand() % 10) + '0';//Using only digits to make data more suitable for compressing;
+}
+
+void compress(const std::string& data, const std::string& fileName)
+{
+  GzipParallelOutputFile gzip;
+  gzip.open(fileName, TEST_THREAD_COUNT);
+  for(size_t pos = 0;pos < data.length();pos += TEST_WRITE_SIZE)
+    gzip.write(data.c_str() + pos, std::min((size_t)TEST_WRITE_SIZE, data.length() - pos));
+  gzip.close();
+}
+
+bool decompress(const std::string& data, const std::string& fileName)
+{
+  GzipInputFile gzip;
+  gzip.open(fileName);
+  std::string res;
+  while(1)
+    {
+      char buf[DEEPSOLVER_IO_BLOCK_SIZE];
+      const size_t readCount = gzip.read(buf, sizeof(buf));
+      res.append(buf, readCount);
+      if (readCount < sizeof(buf))
+	break;
+    }
+  gzip.close();
+  return res == data;
+}
+
+int main(int argc, char* argv[])
+{
+  try {
+    //Several complete members with the partial last one;
+    std::string data;
+    fillRandomData(data, GZIP_PARALLEL_BLOCK_SIZE * 5 + GZIP_PARALLEL_BLOCK_SIZE / 3);
+    File orig;
+    orig.create(ORIG_FILE_NAME);
+    orig.write(data.c_str(), data.length());
+    orig.close();
+    std::cout << "Compressing " << data.length() / 1024 << "k of random data with " << TEST_THREAD_COUNT << " threads" << std::endl;
+    compress(data, COMPRESSED_FILE_NAME);
+    std::cout << "Decompressing..." << std::endl;
+    if (!decompress(data, COMPRESSED_FILE_NAME))
+      {
+	std::cerr << "The decompressed data differs from the original one" << std::endl;
+	return 1;
+      }
+    //The empty file must be the valid gzip file as well;
+    data.erase();
+    compress(data, EMPTY_FILE_NAME);
+    const bool emptyValid = decompress(data, EMPTY_FILE_NAME);
+    File::unlink(EMPTY_FILE_NAME);
+    if (!emptyValid)
+      {
+	std::cerr << "The empty data is not decompressed properly" << std::endl;
+	return 1;
+      }
+  }
+  catch (const AbstractException& e)
+    {
+      std::cerr << e.getType() << " error:" << e.getMessage() << std::endl;
+      return 1;
+    }
+  return 0;
+}
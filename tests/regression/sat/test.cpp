@@ -0,0 +1,326 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/CdclSolver.h"
+#include"deepsolver/SatPreprocessor.h"
+#include"deepsolver/MaxSatSolver.h"
+
+#define TEST_ROUNDS 500
+#define TEST_MAX_VARS 10
+#define TEST_ASSUMPTION_ROUNDS 4
+#define TEST_MAX_WEIGHT 3
+
+using namespace Deepsolver;
+using Deepsolver::Sat::Lit;
+using Deepsolver::Sat::Clause;
+using Deepsolver::Sat::CdclSolver;
+using Deepsolver::Sat::SatPreprocessor;
+using Deepsolver::Sat::MaxSatSolver;
+using Deepsolver::Sat::SoftLit;
+using Deepsolver::Sat::SoftLitVector;
+
+typedef Deepsolver::Sat::Sat Formula;
+typedef Deepsolver::Sat::SatVector FormulaVector;
+typedef Deepsolver::Sat::AbstractSatSolver::VarIdToBoolMap VarIdToBoolMap;
+
+//Random formulas with the number of clauses around the satisfiability threshold, so both answers are frequent;
+void generate(Formula& sat, size_t& varCount)
+{
+  sat.clear();
+  varCount = 3 + rand() % (TEST_MAX_VARS - 2);
+  const size_t clauseCount = varCount + rand() % (varCount * 4);
+  for(size_t i = 0;i < clauseCount;i++)
+    {
+      Clause clause;
+      const size_t len = rand() % 8 == 0?1:2 + rand() % 2;
+      for(size_t k = 0;k < len;k++)
+	clause.push_back(Lit(rand() % varCount, rand() % 2));
+      sat.push_back(clause);
+    }
+}
+
+bool litValue(const Lit& lit, size_t assignment)
+{
+  return (((assignment >> lit.varId) & 1) != 0) != lit.neg;
+}
+
+bool satisfies(const Formula& sat, size_t assignment)
+{
+  for(Formula::size_type i = 0;i < sat.size();i++)
+    {
+      bool satisfied = 0;
+      for(Clause::size_type k = 0;k < sat[i].size() && !satisfied;k++)
+	satisfied = litValue(sat[i][k], assignment);
+      if (!satisfied)
+	return 0;
+    }
+  return 1;
+}
+
+bool satisfiesAll(const Clause& lits, size_t assignment)
+{
+  for(Clause::size_type i = 0;i < lits.size();i++)
+    if (!litValue(lits[i], assignment))
+      return 0;
+  return 1;
+}
+
+//Checks all assignments, the literals must be true in the found one;
+bool bruteForce(const Formula& sat, size_t varCount, const Clause& assumptions)
+{
+  for(size_t assignment = 0;assignment < ((size_t)1 << varCount);assignment++)
+    if (satisfiesAll(assumptions, assignment) && satisfies(sat, assignment))
+      return 1;
+  return 0;
+}
+
+//Variables without any value in the solution are taken as false;
+size_t toAssignment(const VarIdToBoolMap& res, size_t varCount)
+{
+  size_t assignment = 0;
+  for(VarIdToBoolMap::const_iterator it = res.begin();it != res.end();it++)
+    if (it->first < varCount && it->second)
+      assignment |= (size_t)1 << it->first;
+  return assignment;
+}
+
+bool checkCdcl(const Formula& sat, size_t varCount, unsigned int seed)
+{
+  CdclSolver solver(seed);
+  for(Formula::size_type i = 0;i < sat.size();i++)
+    solver.addClause(sat[i]);
+  VarIdToBoolMap res;
+  VarIdVector conflicts;
+  const bool expected = bruteForce(sat, varCount, Clause());
+  const bool solved = solver.solve(res, conflicts);
+  if (solved != expected)
+    {
+      std::cerr << "cdcl:the answer is " << (solved?"SAT":"UNSAT") << " instead of " << (expected?"SAT":"UNSAT") << std::endl;
+      return 0;
+    }
+  if (solved && !satisfies(sat, toAssignment(res, varCount)))
+    {
+      std::cerr << "cdcl:the solution doesn't satisfy the formula" << std::endl;
+      return 0;
+    }
+  //The same solver is used incrementally under different assumptions;
+  for(size_t round = 0;round < TEST_ASSUMPTION_ROUNDS;round++)
+    {
+      Clause assumptions;
+      const size_t count = 1 + rand() % 3;
+      for(size_t i = 0;i < count;i++)
+	assumptions.push_back(Lit(rand() % varCount, rand() % 2));
+      const bool expectedAssuming = bruteForce(sat, varCount, assumptions);
+      Clause core;
+      res.clear();
+      const bool solvedAssuming = solver.solveAssuming(assumptions, res, core);
+      if (solvedAssuming != expectedAssuming)
+	{
+	  std::cerr << "cdcl:the answer under assumptions is " << (solvedAssuming?"SAT":"UNSAT") << " instead of " << (expectedAssuming?"SAT":"UNSAT") << std::endl;
+	  return 0;
+	}
+      if (solvedAssuming)
+	{
+	  const size_t assignment = toAssignment(res, varCount);
+	  if (!satisfies(sat, assignment) || !satisfiesAll(assumptions, assignment))
+	    {
+	      std::cerr << "cdcl:the solution doesn't satisfy the formula under assumptions" << std::endl;
+	      return 0;
+	    }
+	  continue;
+	}
+      //The core must consist of the assumptions and must be enough for the contradiction;
+      for(Clause::size_type i = 0;i < core.size();i++)
+	if (std::find(assumptions.begin(), assumptions.end(), core[i]) == assumptions.end())
+	  {
+	    std::cerr << "cdcl:the core has the literal not given as an assumption" << std::endl;
+	    return 0;
+	  }
+      if (bruteForce(sat, varCount, core))
+	{
+	  std::cerr << "cdcl:the formula is solvable under the core" << std::endl;
+	  return 0;
+	}
+    }
+  return 1;
+}
+
+//The components must be independent and the union of their solutions with the fixed values must satisfy the original formula;
+bool checkPreprocessor(const Formula& sat, size_t varCount)
+{
+  SatPreprocessor preprocessor;
+  for(size_t i = 0;i < varCount;i++)
+    if (rand() % 2)
+      preprocessor.prefer(i, rand() % 2);
+  FormulaVector components;
+  VarIdToBoolMap fixed;
+  VarIdVector conflicts;
+  const bool expected = bruteForce(sat, varCount, Clause());
+  if (!preprocessor.run(sat, components, fixed, conflicts))
+    {
+      if (expected)
+	{
+	  std::cerr << "preprocessor:the solvable formula is rejected" << std::endl;
+	  return 0;
+	}
+      return 1;
+    }
+  VarIdToBoolMap res = fixed;
+  bool solved = 1;
+  std::map<VarId, size_t> owners;
+  for(FormulaVector::size_type i = 0;i < components.size();i++)
+    {
+      CdclSolver solver;
+      for(Formula::size_type k = 0;k < components[i].size();k++)
+	{
+	  const Clause& clause = components[i][k];
+	  for(Clause::size_type j = 0;j < clause.size();j++)
+	    {
+	      if (fixed.find(clause[j].varId) != fixed.end())
+		{
+		  std::cerr << "preprocessor:the fixed variable is left in a component" << std::endl;
+		  return 0;
+		}
+	      std::map<VarId, size_t>::const_iterator it = owners.find(clause[j].varId);
+	      if (it != owners.end() && it->second != i)
+		{
+		  std::cerr << "preprocessor:the components have a common variable" << std::endl;
+		  return 0;
+		}
+	      owners[clause[j].varId] = i;
+	    }
+	  solver.addClause(clause);
+	}
+      VarIdToBoolMap componentRes;
+      if (!solver.solve(componentRes, conflicts))
+	{
+	  solved = 0;
+	  break;
+	}
+      res.insert(componentRes.begin(), componentRes.end());
+    }
+  if (solved != expected)
+    {
+      std::cerr << "preprocessor:the components are " << (solved?"solvable":"unsolvable") << ", but the formula is " << (expected?"solvable":"unsolvable") << std::endl;
+      return 0;
+    }
+  if (solved && !satisfies(sat, toAssignment(res, varCount)))
+    {
+      std::cerr << "preprocessor:the merged solution doesn't satisfy the formula" << std::endl;
+      return 0;
+    }
+  return 1;
+}
+
+//The numbers of falsified soft literals of each weight, starting from the greatest one;
+SizeVector falsifiedByWeight(const SoftLitVector& softs, size_t assignment)
+{
+  SizeVector res(TEST_MAX_WEIGHT, 0);
+  for(SoftLitVector::size_type i = 0;i < softs.size();i++)
+    if (!litValue(softs[i].lit, assignment))
+      res[TEST_MAX_WEIGHT - softs[i].weight]++;
+  return res;
+}
+
+size_t falsifiedWeight(const SoftLitVector& softs, size_t assignment)
+{
+  size_t res = 0;
+  for(SoftLitVector::size_type i = 0;i < softs.size();i++)
+    if (!litValue(softs[i].lit, assignment))
+      res += softs[i].weight;
+  return res;
+}
+
+//The solution must be lexicographically optimal over the weights and must have the reported cost;
+bool checkMaxSat(const Formula& sat, size_t varCount)
+{
+  MaxSatSolver solver(Deepsolver::Sat::AbstractSatSolver::Ptr(new CdclSolver()));
+  for(Formula::size_type i = 0;i < sat.size();i++)
+    solver.addClause(sat[i]);
+  SoftLitVector softs;
+  const size_t softCount = 1 + rand() % (varCount * 2);
+  for(size_t i = 0;i < softCount;i++)
+    {
+      softs.push_back(SoftLit(Lit(rand() % varCount, rand() % 2), 1 + rand() % TEST_MAX_WEIGHT));
+      solver.addSoftLit(softs.back());
+    }
+  bool expected = 0;
+  SizeVector optimum;
+  for(size_t assignment = 0;assignment < ((size_t)1 << varCount);assignment++)
+    if (satisfies(sat, assignment))
+      {
+	const SizeVector falsified = falsifiedByWeight(softs, assignment);
+	if (!expected || falsified < optimum)
+	  optimum = falsified;
+	expected = 1;
+      }
+  VarIdToBoolMap res;
+  VarIdVector conflicts;
+  const bool solved = solver.solve(res, conflicts);
+  if (solved != expected)
+    {
+      std::cerr << "maxsat:the answer is " << (solved?"SAT":"UNSAT") << " instead of " << (expected?"SAT":"UNSAT") << std::endl;
+      return 0;
+    }
+  if (!solved)
+    return 1;
+  for(VarIdToBoolMap::const_iterator it = res.begin();it != res.end();it++)
+    if (it->first >= varCount)
+      {
+	std::cerr << "maxsat:the solution has the auxiliary variable" << std::endl;
+	return 0;
+      }
+  const size_t assignment = toAssignment(res, varCount);
+  if (!satisfies(sat, assignment))
+    {
+      std::cerr << "maxsat:the solution doesn't satisfy the hard clauses" << std::endl;
+      return 0;
+    }
+  if (falsifiedByWeight(softs, assignment) != optimum)
+    {
+      std::cerr << "maxsat:the solution is not optimal" << std::endl;
+      return 0;
+    }
+  if (solver.getCost() != falsifiedWeight(softs, assignment))
+    {
+      std::cerr << "maxsat:the cost is " << solver.getCost() << " instead of " << falsifiedWeight(softs, assignment) << std::endl;
+      return 0;
+    }
+  return 1;
+}
+
+int main(int argc, char* argv[])
+{
+  srand(1);
+  size_t satCount = 0;
+  for(size_t round = 0;round < TEST_ROUNDS;round++)
+    {
+      Formula sat;
+      size_t varCount;
+      generate(sat, varCount);
+      if (bruteForce(sat, varCount, Clause()))
+	satCount++;
+      if (!checkCdcl(sat, varCount, round % 3) || !checkPreprocessor(sat, varCount) || !checkMaxSat(sat, varCount))
+	{
+	  std::cerr << "Failed on formula " << round << std::endl;
+	  return 1;
+	}
+    }
+  std::cout << TEST_ROUNDS << " formulas checked, " << satCount << " of them are solvable" << std::endl;
+  return 0;
+}
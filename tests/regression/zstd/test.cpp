@@ -0,0 +1,139 @@
+/*
+   Copyright 2011-2014 ALT Linux
+   Copyright 2011-2014 Michael Pozhidaev
+
+   This file is part of the Deepsolver.
+
+   Deepsolver is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   Deepsolver is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+*/
+
+#include"deepsolver/deepsolver.h"
+#include"deepsolver/ZstdInterface.h"
+
+#define TEST_COMPRESSION_LEVEL 9
+#define TEST_THREAD_COUNT 4
+#define TEST_DATA_SIZE 5592405
+#define TEST_WRITE_SIZE 12345
+
+#define ORIG_FILE_NAME "orig.data"
+#define COMPRESSED_FILE_NAME "compressed.data.zst"
+#define EMPTY_FILE_NAME "empty.data.zst"
+#define TRUNCATED_FILE_NAME "truncated.data.zst"
+
+using namespace Deepsolver;
+
+void fillRandomData(std::string& data, size_t len)
+{
+  data.resize(len);
+  srand(len);
+  for(size_t i = 0;i < len;i++)
+    data[i] = (rand() % 10) + '0';//Using only digits to make data more suitable for compressing;
+}
+
+void compress(const std::string& data, const std::string& fileName, size_t threadCount)
+{
+  ZstdOutputFile zstd;
+  zstd.open(fileName, TEST_COMPRESSION_LEVEL, threadCount);
+  for(size_t pos = 0;pos < data.length();pos += TEST_WRITE_SIZE)
+    zstd.write(data.c_str() + pos, std::min((size_t)TEST_WRITE_SIZE, data.length() - pos));
+  zstd.close();
+}
+
+bool decompress(const std::string& data, const std::string& fileName)
+{
+  ZstdInputFile zstd;
+  zstd.open(fileName);
+  std::string res;
+  while(1)
+    {
+      char buf[DEEPSOLVER_IO_BLOCK_SIZE];
+      const size_t readCount = zstd.read(buf, sizeof(buf));
+      res.append(buf, readCount);
+      if (readCount < sizeof(buf))
+	break;
+    }
+  zstd.close();
+  return res == data;
+}
+
+bool truncatedRejected(const std::string& data)
+{
+  std::string compressed;
+  File f;
+  f.openReadOnly(COMPRESSED_FILE_NAME);
+  while(1)
+    {
+      char buf[DEEPSOLVER_IO_BLOCK_SIZE];
+      const size_t count = f.read(buf, sizeof(buf));
+      if (!count)
+	break;
+      compressed.append(buf, count);
+    }
+  f.close();
+  f.create(TRUNCATED_FILE_NAME);
+  f.write(compressed.c_str(), compressed.length() / 2);
+  f.close();
+  bool rejected = 0;
+  try {
+    decompress(data, TRUNCATED_FILE_NAME);
+  }
+  catch(const ZstdException& e)
+    {
+      std::cout << "The truncated file is rejected:" << e.getMessage() << std::endl;
+      rejected = 1;
+    }
+  File::unlink(TRUNCATED_FILE_NAME);
+  return rejected;
+}
+
+int main(int argc, char* argv[])
+{
+  try {
+    std::string data;
+    fillRandomData(data, TEST_DATA_SIZE);
+    File orig;
+    orig.create(ORIG_FILE_NAME);
+    orig.write(data.c_str(), data.length());
+    orig.close();
+    //The single-threaded compression goes first, the file is replaced by the multi-threaded one;
+    for(size_t threadCount = 0;threadCount <= TEST_THREAD_COUNT;threadCount += TEST_THREAD_COUNT)
+      {
+	std::cout << "Compressing " << data.length() / 1024 << "k of random data with " << threadCount << " worker threads" << std::endl;
+	compress(data, COMPRESSED_FILE_NAME, threadCount);
+	std::cout << "Decompressing..." << std::endl;
+	if (!decompress(data, COMPRESSED_FILE_NAME))
+	  {
+	    std::cerr << "The decompressed data differs from the original one" << std::endl;
+	    return 1;
+	  }
+      }
+    if (!truncatedRejected(data))
+      {
+	std::cerr << "The truncated file is read without an error" << std::endl;
+	return 1;
+      }
+    std::string empty;
+    compress(empty, EMPTY_FILE_NAME, 0);
+    const bool emptyValid = decompress(empty, EMPTY_FILE_NAME);
+    File::unlink(EMPTY_FILE_NAME);
+    if (!emptyValid)
+      {
+	std::cerr << "The empty data is not decompressed properly" << std::endl;
+	return 1;
+      }
+  }
+  catch (const AbstractException& e)
+    {
+      std::cerr << e.getType() << " error:" << e.getMessage() << std::endl;
+      return 1;
+    }
+  return 0;
+}